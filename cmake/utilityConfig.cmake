@@ -1,3 +1,6 @@
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+
 include("${CMAKE_CURRENT_LIST_DIR}/utility-stringConfig.cmake")
 include("${CMAKE_CURRENT_LIST_DIR}/utility-commonConfig.cmake")
 include("${CMAKE_CURRENT_LIST_DIR}/utility-processConfig.cmake")
@@ -0,0 +1,108 @@
+#ifndef base64_h__
+#define base64_h__
+
+/*
+*   base64.h
+*
+*   v0.1 2023-06 by GuoJH
+*/
+
+#include <string>
+#include <common/bytedata.hpp>
+#include <common/common_cfg.h>
+
+namespace util {
+
+//! base64 编码选项, 可以组合使用
+enum base64_flag
+{
+    base64_default  = 0,
+    base64_url      = 1,    //!< 使用URL安全的字母表('-', '_' 代替 '+', '/'), RFC 4648 §5
+    base64_nopad    = 2,    //!< 编码时不输出填充的'='
+    base64_mime     = 4,    //!< 编码时每76个字符换行, RFC 2045
+    base64_wrap_lf  = 8,    //!< 换行使用LF, 默认为CRLF
+};
+
+/*!
+ *  \brief  返回编码后的确切长度.
+ */
+UTILITY_FUNCT_DECL size_t base64_encoded_size(size_t size, int flags = base64_default);
+
+/*!
+ *  \brief  返回解码后的最大长度, 实际长度由 base64_decode() 返回.
+ */
+UTILITY_FUNCT_DECL size_t base64_decoded_size(size_t size);
+
+/*!
+ *  \brief  将数据编码为base64.
+ *  \param  out 输出缓冲区, 长度至少为 base64_encoded_size(size, flags)
+ *  \return 返回写入out 的字符数
+ *
+ *  \note   会根据 util::cpu 检测的结果选择AVX2, SSSE3 或NEON 的实现.
+ */
+UTILITY_FUNCT_DECL size_t base64_encode(char* out, const void* data, size_t size, int flags = base64_default);
+
+/*!
+ *  \brief  将base64 解码为数据.
+ *  \param  out       输出缓冲区, 长度至少为 base64_decoded_size(size)
+ *  \param  out_size  返回写入out 的字节数, 失败时为出错前已解码的字节数
+ *  \param  flags     仅 base64_url 有效
+ *  \return 成功返回true, 遇到字母表之外的字符(空白除外)或填充不正确时返回false
+ *
+ *  \note   会忽略空白字符(包括换行), 缺少填充也可以解码.
+ */
+UTILITY_FUNCT_DECL bool base64_decode(
+    void* out, size_t& out_size, const char* data, size_t size, int flags = base64_default);
+
+/*!
+ *  \brief  分段编码, 适用于数据分块到达的场景, 结果与一次性编码相同.
+ */
+class UTILITY_CLASS_DECL base64_encoder
+{
+public:
+    UTILITY_MEMBER_DECL explicit base64_encoder(int flags = base64_default);
+
+    //! 编码一段数据, 结果追加到out
+    UTILITY_MEMBER_DECL void update(const void* data, size_t size, std::string& out);
+
+    //! 输出剩余的数据与填充, 之后可以开始新的编码
+    UTILITY_MEMBER_DECL void finalize(std::string& out);
+
+protected:
+    UTILITY_MEMBER_DECL void _append(const uint8_t* data, size_t size, std::string& out);
+
+    int     _flags;
+    uint8_t _pending[3];    // 不足3字节的剩余数据
+    size_t  _pending_size;
+    size_t  _column;        // 当前行已输出的字符数, 用于换行
+};
+
+/*!
+ *  \brief  分段解码, 输入可以在任意位置分段.
+ */
+class UTILITY_CLASS_DECL base64_decoder
+{
+public:
+    UTILITY_MEMBER_DECL explicit base64_decoder(int flags = base64_default);
+
+    //! 解码一段数据, 结果追加到out, 数据无效时返回false
+    UTILITY_MEMBER_DECL bool update(const char* data, size_t size, bytedata& out);
+
+    //! 结束解码, 若剩余的数据不完整则返回false, 之后可以开始新的解码
+    UTILITY_MEMBER_DECL bool finalize(bytedata& out);
+
+protected:
+    int      _flags;
+    uint32_t _quad;         // 当前4字符组已解码的位
+    int      _count;        // 当前4字符组的有效字符数
+    int      _padding;      // 已读取的'='数
+    bool     _failed;
+};
+
+} // util
+
+#ifndef UTILITY_DISABLE_HEADONLY
+#   include "impl/base64.ipp"
+#endif
+
+#endif // base64_h__
@@ -0,0 +1,394 @@
+#ifndef byte_archive_h__
+#define byte_archive_h__
+
+/*
+*   byte_archive.hpp
+*
+*   v0.1 2023-06 by GuoJH
+*/
+
+#include <map>
+#include <set>
+#include <list>
+#include <deque>
+#include <array>
+#include <vector>
+#include <string>
+#include <utility>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <common/byte_stream.hpp>
+
+namespace util {
+namespace detail {
+
+// 是否存在 serialize(Archive&, const unsigned int) 成员
+template<class _Type, class _Archive, class = void>
+struct _has_serialize_member : std::false_type {};
+
+template<class _Type, class _Archive>
+struct _has_serialize_member<_Type, _Archive, decltype(
+    std::declval<_Type&>().serialize(std::declval<_Archive&>(), 0u), void())> : std::true_type {};
+
+// 是否存在可通过ADL 找到的 serialize(Archive&, T&, const unsigned int)
+template<class _Type, class _Archive, class = void>
+struct _has_serialize_free : std::false_type {};
+
+template<class _Type, class _Archive>
+struct _has_serialize_free<_Type, _Archive, decltype(
+    serialize(std::declval<_Archive&>(), std::declval<_Type&>(), 0u), void())> : std::true_type {};
+
+// 数值与枚举, 按小端序读写
+template<class _Type>
+struct _is_archive_scalar : std::integral_constant<bool,
+    std::is_arithmetic<_Type>::value || std::is_enum<_Type>::value> {};
+
+// 没有 serialize() 的可平凡复制的类型, 按原始字节读写
+template<class _Type, class _Archive>
+struct _is_archive_bitwise : std::integral_constant<bool,
+    std::is_trivially_copyable<_Type>::value && std::is_class<_Type>::value &&
+    !_has_serialize_member<_Type, _Archive>::value && !_has_serialize_free<_Type, _Archive>::value> {};
+
+} // detail
+
+/*!
+ *  \brief  将对象写入 bytedata 的存档, 兼容boost 的 serialize() 约定:
+ *
+ *          template<class Archive>
+ *          void serialize(Archive& ar, const unsigned int version) { ar & a; ar & b; }
+ *
+ *  \note   数值为小端序, 容器的长度为varint; 数值与可平凡复制的类型组成的
+ *          vector/array/数组 整体复制. 没有存档头与类型信息, 格式与boost 的存档不兼容,
+ *          version 总是为0.
+ */
+class byte_oarchive : public byte_writer
+{
+public:
+    typedef std::true_type  is_saving;
+    typedef std::false_type is_loading;
+
+    //! 追加到arena 的末尾
+    explicit byte_oarchive(bytedata& arena)
+        : byte_writer(arena, byte_order_little) {}
+
+    template<class _Type>
+    byte_oarchive& operator<<(const _Type& value) {
+        save(value);
+        return *this;
+    }
+
+    template<class _Type>
+    byte_oarchive& operator&(const _Type& value) {
+        return *this << value;
+    }
+
+    template<class _Type>
+    void save(const _Type& value)
+    {
+        if constexpr (detail::_is_archive_scalar<_Type>::value)
+            put(value);
+        else if constexpr (detail::_has_serialize_member<_Type, byte_oarchive>::value)
+            const_cast<_Type&>(value).serialize(*this, 0u);
+        else if constexpr (detail::_has_serialize_free<_Type, byte_oarchive>::value)
+            serialize(*this, const_cast<_Type&>(value), 0u);
+        else
+        {
+            static_assert(detail::_is_archive_bitwise<_Type, byte_oarchive>::value,
+                "The type must provide serialize() or be trivially copyable.");
+            write(&value, sizeof(value));
+        }
+    }
+
+    template<class _Char, class _Traits, class _Alloc>
+    void save(const std::basic_string<_Char, _Traits, _Alloc>& value)
+    {
+        put_varint(value.size());
+        write(value.data(), value.size() * sizeof(_Char));
+    }
+
+    void save(const bytedata& value) {
+        save(static_cast<const std::string&>(value));
+    }
+
+    template<class _Type, class _Alloc>
+    void save(const std::vector<_Type, _Alloc>& value)
+    {
+        put_varint(value.size());
+        _save_range(value.data(), value.size());
+    }
+
+    template<class _Alloc>
+    void save(const std::vector<bool, _Alloc>& value)
+    {
+        put_varint(value.size());
+        for (bool bit : value)
+            put<uint8_t>(bit);
+    }
+
+    template<class _Type, size_t _Size>
+    void save(const std::array<_Type, _Size>& value) {
+        _save_range(value.data(), _Size);
+    }
+
+    template<class _Type, size_t _Size>
+    void save(const _Type (&value)[_Size]) {
+        _save_range(value, _Size);
+    }
+
+    template<class _First, class _Second>
+    void save(const std::pair<_First, _Second>& value)
+    {
+        save(value.first);
+        save(value.second);
+    }
+
+    template<class _Type, class _Alloc>
+    void save(const std::list<_Type, _Alloc>& value) { _save_each(value); }
+
+    template<class _Type, class _Alloc>
+    void save(const std::deque<_Type, _Alloc>& value) { _save_each(value); }
+
+    template<class _Key, class _Compare, class _Alloc>
+    void save(const std::set<_Key, _Compare, _Alloc>& value) { _save_each(value); }
+
+    template<class _Key, class _Hash, class _Equal, class _Alloc>
+    void save(const std::unordered_set<_Key, _Hash, _Equal, _Alloc>& value) { _save_each(value); }
+
+    template<class _Key, class _Value, class _Compare, class _Alloc>
+    void save(const std::map<_Key, _Value, _Compare, _Alloc>& value) { _save_each(value); }
+
+    template<class _Key, class _Value, class _Hash, class _Equal, class _Alloc>
+    void save(const std::unordered_map<_Key, _Value, _Hash, _Equal, _Alloc>& value) { _save_each(value); }
+
+protected:
+    template<class _Type>
+    void _save_range(const _Type* values, size_t count)
+    {
+        if constexpr (detail::_is_archive_scalar<_Type>::value)
+            put_array(values, count);
+        else if constexpr (detail::_is_archive_bitwise<_Type, byte_oarchive>::value)
+            write(values, count * sizeof(_Type));
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+                save(values[i]);
+        }
+    }
+
+    template<class _Container>
+    void _save_each(const _Container& value)
+    {
+        put_varint(value.size());
+        for (auto& item : value)
+            save(item);
+    }
+};
+
+/*!
+ *  \brief  从 byte_oarchive 写入的数据中读取对象, 不复制输入数据.
+ *
+ *  \note   数据不足或格式无效时抛出std::runtime_error 异常.
+ *          容器的长度会与剩余的数据量比较, 以免因数据损坏而分配过多的内存,
+ *          因此每个元素至少应占用1字节.
+ */
+class byte_iarchive : public byte_reader
+{
+public:
+    typedef std::false_type is_saving;
+    typedef std::true_type  is_loading;
+
+    explicit byte_iarchive(bytes_view bytes)
+        : byte_reader(bytes, byte_order_little) {}
+
+    template<class _Type>
+    byte_iarchive& operator>>(_Type& value) {
+        load(value);
+        return *this;
+    }
+
+    template<class _Type>
+    byte_iarchive& operator&(_Type& value) {
+        return *this >> value;
+    }
+
+    template<class _Type>
+    void load(_Type& value)
+    {
+        if constexpr (detail::_is_archive_scalar<_Type>::value)
+            value = get<_Type>();
+        else if constexpr (detail::_has_serialize_member<_Type, byte_iarchive>::value)
+            value.serialize(*this, 0u);
+        else if constexpr (detail::_has_serialize_free<_Type, byte_iarchive>::value)
+            serialize(*this, value, 0u);
+        else
+        {
+            static_assert(detail::_is_archive_bitwise<_Type, byte_iarchive>::value,
+                "The type must provide serialize() or be trivially copyable.");
+            read(&value, sizeof(value));
+        }
+    }
+
+    template<class _Char, class _Traits, class _Alloc>
+    void load(std::basic_string<_Char, _Traits, _Alloc>& value)
+    {
+        size_t count = _count(sizeof(_Char));
+        value.resize(count);
+        read(&value[0], count * sizeof(_Char));
+    }
+
+    void load(bytedata& value) {
+        load(static_cast<std::string&>(value));
+    }
+
+    template<class _Type, class _Alloc>
+    void load(std::vector<_Type, _Alloc>& value)
+    {
+        value.resize(_count(_element_size<_Type>()));
+        _load_range(value.data(), value.size());
+    }
+
+    template<class _Alloc>
+    void load(std::vector<bool, _Alloc>& value)
+    {
+        value.resize(_count(1));
+        for (size_t i = 0; i < value.size(); ++i)
+            value[i] = get<uint8_t>() != 0;
+    }
+
+    template<class _Type, size_t _Size>
+    void load(std::array<_Type, _Size>& value) {
+        _load_range(value.data(), _Size);
+    }
+
+    template<class _Type, size_t _Size>
+    void load(_Type (&value)[_Size]) {
+        _load_range(value, _Size);
+    }
+
+    template<class _First, class _Second>
+    void load(std::pair<_First, _Second>& value)
+    {
+        load(value.first);
+        load(value.second);
+    }
+
+    template<class _Type, class _Alloc>
+    void load(std::list<_Type, _Alloc>& value) { _load_sequence(value); }
+
+    template<class _Type, class _Alloc>
+    void load(std::deque<_Type, _Alloc>& value) { _load_sequence(value); }
+
+    template<class _Key, class _Compare, class _Alloc>
+    void load(std::set<_Key, _Compare, _Alloc>& value) { _load_set(value); }
+
+    template<class _Key, class _Hash, class _Equal, class _Alloc>
+    void load(std::unordered_set<_Key, _Hash, _Equal, _Alloc>& value) { _load_set(value); }
+
+    template<class _Key, class _Value, class _Compare, class _Alloc>
+    void load(std::map<_Key, _Value, _Compare, _Alloc>& value) { _load_map(value); }
+
+    template<class _Key, class _Value, class _Hash, class _Equal, class _Alloc>
+    void load(std::unordered_map<_Key, _Value, _Hash, _Equal, _Alloc>& value) { _load_map(value); }
+
+protected:
+    template<class _Type>
+    static constexpr size_t _element_size()
+    {
+        return detail::_is_archive_scalar<_Type>::value ||
+            detail::_is_archive_bitwise<_Type, byte_iarchive>::value ? sizeof(_Type) : 1;
+    }
+
+    // 读取容器的长度, 并检查剩余的数据是否足够
+    size_t _count(size_t element_size)
+    {
+        uint64_t count = get_varint();
+        if (count > remaining() / element_size)
+            throw std::runtime_error("The data is too short.");
+
+        return size_t(count);
+    }
+
+    template<class _Type>
+    void _load_range(_Type* values, size_t count)
+    {
+        if constexpr (detail::_is_archive_scalar<_Type>::value)
+            get_array(values, count);
+        else if constexpr (detail::_is_archive_bitwise<_Type, byte_iarchive>::value)
+            read(values, count * sizeof(_Type));
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+                load(values[i]);
+        }
+    }
+
+    template<class _Container>
+    void _load_sequence(_Container& value)
+    {
+        value.clear();
+        for (size_t count = _count(_element_size<typename _Container::value_type>()); count > 0; --count)
+        {
+            value.emplace_back();
+            load(value.back());
+        }
+    }
+
+    template<class _Container>
+    void _load_set(_Container& value)
+    {
+        value.clear();
+        for (size_t count = _count(_element_size<typename _Container::value_type>()); count > 0; --count)
+        {
+            typename _Container::value_type item;
+            load(item);
+            value.insert(std::move(item));
+        }
+    }
+
+    template<class _Container>
+    void _load_map(_Container& value)
+    {
+        value.clear();
+        for (size_t count = _count(1); count > 0; --count)
+        {
+            std::pair<typename _Container::key_type, typename _Container::mapped_type> item;
+            load(item);
+            value.insert(std::move(item));
+        }
+    }
+};
+
+/*!
+ *  \brief  将对象序列化到arena, 与 bytes_serialize() 使用相同的 serialize() 约定.
+ *
+ *  \note   arena 会被清空但保留已分配的容量, 重复使用同一个arena 时不会再分配内存.
+ *          可能会抛出std::runtime_error 异常.
+ */
+template<class _Type>
+inline bytedata& bytes_pack(bytedata& arena, const _Type& value)
+{
+    arena.clear();
+    byte_oarchive oa(arena);
+    oa << value;
+
+    return arena;
+}
+
+/*!
+ *  \brief  从 bytes_pack() 的结果中反序列化对象.
+ *
+ *  \note   数据不足或格式无效时抛出std::runtime_error 异常.
+ */
+template<class _Type>
+inline _Type& bytes_unpack(_Type& value, bytes_view bytes)
+{
+    byte_iarchive ia(bytes);
+    ia >> value;
+
+    return value;
+}
+
+} // util
+
+#endif // byte_archive_h__
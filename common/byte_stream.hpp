@@ -0,0 +1,313 @@
+#ifndef byte_stream_h__
+#define byte_stream_h__
+
+/*
+*   byte_stream.hpp
+*
+*   v0.1 2023-06 by GuoJH
+*/
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <common/bytedata.hpp>
+
+namespace util {
+
+//! 多字节数值的字节序
+enum byte_order
+{
+    byte_order_little   = 0,    //!< 小端序
+    byte_order_big      = 1,    //!< 大端序, 即网络字节序
+};
+
+namespace detail {
+
+// order 是否与本机字节序相同
+inline bool _bytes_native_order(int order)
+{
+#ifdef CPU_BIG_ENDIAN
+    return order == byte_order_big;
+#else
+    return order == byte_order_little;
+#endif
+}
+
+// 在本机字节序与order 之间转换数值
+template<class _Type>
+inline _Type _bytes_order(_Type value, int order)
+{
+    static_assert(std::is_arithmetic<_Type>::value || std::is_enum<_Type>::value,
+        "Only arithmetic or enum types have a byte order, use write()/read() for other types.");
+
+    return _bytes_native_order(order) ? value : _bytes_reverse(value);
+}
+
+template<class _Type>
+inline constexpr size_t _bytes_total_size()
+{
+    return sizeof(_Type);
+}
+
+template<class _Type, class _Next, class... _Rest>
+inline constexpr size_t _bytes_total_size()
+{
+    return sizeof(_Type) + _bytes_total_size<_Next, _Rest...>();
+}
+
+} // detail
+
+/*!
+ *  \brief  向 bytedata 末尾顺序写入字段.
+ *
+ *  \note   数值按构造时指定的字节序写入, 转换使用bswap 指令;
+ *          put_all() 将多个字段合并为一次追加, 适合固定的消息头.
+ */
+class byte_writer
+{
+public:
+    explicit byte_writer(bytedata& bytes, int order = byte_order_little)
+        : _bytes(bytes), _order(order) {}
+
+    //! 已写入的全部数据(包括构造前已有的内容)
+    bytedata& bytes() { return _bytes; }
+    size_t size() const { return _bytes.size(); }
+
+    //! 写入原始字节
+    byte_writer& write(const void* data, size_t size)
+    {
+        _bytes.append(static_cast<const char*>(data), size);
+        return *this;
+    }
+
+    byte_writer& write(bytes_view bytes)
+    {
+        return write(bytes.data(), bytes.size());
+    }
+
+    //! 按指定的字节序写入数值
+    template<class _Type>
+    byte_writer& put(_Type value)
+    {
+        value = detail::_bytes_order(value, _order);
+        return write(&value, sizeof(value));
+    }
+
+    //! 一次写入多个数值, 只扩展一次缓冲区
+    template<class... _Types>
+    byte_writer& put_all(_Types... values)
+    {
+        uint8_t buffer[detail::_bytes_total_size<_Types...>()];
+        uint8_t* cursor = buffer;
+        int dummy[] = { (_store(cursor, values), 0)... };
+        (void)dummy;
+
+        return write(buffer, sizeof(buffer));
+    }
+
+    //! 写入数值数组, 字节序与本机相同时直接复制
+    template<class _Type>
+    byte_writer& put_array(const _Type* values, size_t count)
+    {
+        if (detail::_bytes_native_order(_order))
+            return write(values, count * sizeof(_Type));
+
+        size_t offset = _bytes.size();
+        _bytes.resize(offset + count * sizeof(_Type));
+
+        uint8_t* cursor = reinterpret_cast<uint8_t*>(&_bytes[offset]);
+        for (size_t i = 0; i < count; ++i)
+            _store(cursor, values[i]);
+
+        return *this;
+    }
+
+    //! 以LEB128 写入无符号整数, 每字节7位, 最多10字节
+    byte_writer& put_varint(uint64_t value)
+    {
+        uint8_t buffer[10];
+        size_t  size = 0;
+
+        for (; value >= 0x80; value >>= 7)
+            buffer[size++] = uint8_t(value | 0x80);
+        buffer[size++] = uint8_t(value);
+
+        return write(buffer, size);
+    }
+
+    //! 以zigzag + LEB128 写入有符号整数, 绝对值较小的负数也只占用较少的字节
+    byte_writer& put_zigzag(int64_t value)
+    {
+        return put_varint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+    }
+
+    //! 写入以varint 长度为前缀的字符串
+    byte_writer& put_string(bytes_view str)
+    {
+        put_varint(str.size());
+        return write(str);
+    }
+
+protected:
+    template<class _Type>
+    void _store(uint8_t*& cursor, _Type value)
+    {
+        value = detail::_bytes_order(value, _order);
+        std::memcpy(cursor, &value, sizeof(value));
+        cursor += sizeof(value);
+    }
+
+    bytedata& _bytes;
+    int       _order;
+};
+
+/*!
+ *  \brief  从 bytes_view 顺序读取字段, 不复制数据.
+ *
+ *  \note   数据不足或格式无效时抛出std::runtime_error 异常, 此时位置不变;
+ *          get_all()/get_array() 对整个范围只检查一次长度.
+ */
+class byte_reader
+{
+public:
+    explicit byte_reader(bytes_view bytes, int order = byte_order_little)
+        : _begin(bytes.data()), _cursor(bytes.data()), _end(bytes.data() + bytes.size()), _order(order) {}
+
+    size_t position() const { return size_t(_cursor - _begin); }
+    size_t remaining() const { return size_t(_end - _cursor); }
+    bool empty() const { return _cursor == _end; }
+
+    //! 剩余的数据
+    bytes_view rest() const { return bytes_view(_cursor, remaining()); }
+
+    //! 读取size 字节, 返回的视图指向原数据
+    bytes_view read(size_t size)
+    {
+        const uint8_t* data = _require(size);
+        return bytes_view(data, size);
+    }
+
+    void read(void* out, size_t size)
+    {
+        std::memcpy(out, _require(size), size);
+    }
+
+    void skip(size_t size)
+    {
+        _require(size);
+    }
+
+    //! 按指定的字节序读取数值
+    template<class _Type>
+    _Type get()
+    {
+        _Type value;
+        std::memcpy(&value, _require(sizeof(_Type)), sizeof(_Type));
+        return detail::_bytes_order(value, _order);
+    }
+
+    //! 一次读取多个数值, 只检查一次长度
+    template<class... _Types>
+    void get_all(_Types&... values)
+    {
+        const uint8_t* cursor = _require(detail::_bytes_total_size<_Types...>());
+        int dummy[] = { (_load(cursor, values), 0)... };
+        (void)dummy;
+    }
+
+    //! 读取数值数组
+    template<class _Type>
+    void get_array(_Type* values, size_t count)
+    {
+        if (count > remaining() / sizeof(_Type))
+            throw std::runtime_error("The data is too short.");
+
+        const uint8_t* cursor = _require(count * sizeof(_Type));
+        if (detail::_bytes_native_order(_order))
+        {
+            std::memcpy(values, cursor, count * sizeof(_Type));
+            return;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            _load(cursor, values[i]);
+    }
+
+    //! 读取LEB128 编码的无符号整数
+    uint64_t get_varint()
+    {
+        uint64_t value = 0;
+        const uint8_t* cursor = _cursor;
+
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (cursor == _end)
+                throw std::runtime_error("The data is too short.");
+
+            uint8_t byte = *cursor++;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+            {
+                // 第10字节只能贡献最高的1位
+                if (shift == 63 && byte > 1)
+                    break;
+
+                _cursor = cursor;
+                return value;
+            }
+        }
+
+        throw std::runtime_error("Invalid varint.");
+    }
+
+    int64_t get_zigzag()
+    {
+        uint64_t value = get_varint();
+        return int64_t(value >> 1) ^ -int64_t(value & 1);
+    }
+
+    //! 读取以varint 长度为前缀的字符串, 返回的视图指向原数据
+    bytes_view get_string()
+    {
+        const uint8_t* start = _cursor;
+        uint64_t size = get_varint();
+        if (size > remaining())
+        {
+            _cursor = start;
+            throw std::runtime_error("The data is too short.");
+        }
+
+        return read(size_t(size));
+    }
+
+protected:
+    // 检查剩余的长度并前进, 返回前进前的位置
+    const uint8_t* _require(size_t size)
+    {
+        if (size > remaining())
+            throw std::runtime_error("The data is too short.");
+
+        const uint8_t* data = _cursor;
+        _cursor += size;
+        return data;
+    }
+
+    template<class _Type>
+    void _load(const uint8_t*& cursor, _Type& value)
+    {
+        std::memcpy(&value, cursor, sizeof(_Type));
+        value = detail::_bytes_order(value, _order);
+        cursor += sizeof(_Type);
+    }
+
+    const uint8_t* _begin;
+    const uint8_t* _cursor;
+    const uint8_t* _end;
+    int            _order;
+};
+
+} // util
+
+#endif // byte_stream_h__
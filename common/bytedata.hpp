@@ -9,6 +9,13 @@
 */
 
 #include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
 #include <common/common_cfg.h>
 #include <filesystem/path_util.h>
 
@@ -56,6 +63,188 @@ public:
     }
 };
 
+namespace detail {
+
+inline uint16_t _bytes_swap(uint16_t value)
+{
+#if defined(COMPILER_MSVC)
+    return _byteswap_ushort(value);
+#else
+    return __builtin_bswap16(value);
+#endif
+}
+
+inline uint32_t _bytes_swap(uint32_t value)
+{
+#if defined(COMPILER_MSVC)
+    return _byteswap_ulong(value);
+#else
+    return __builtin_bswap32(value);
+#endif
+}
+
+inline uint64_t _bytes_swap(uint64_t value)
+{
+#if defined(COMPILER_MSVC)
+    return _byteswap_uint64(value);
+#else
+    return __builtin_bswap64(value);
+#endif
+}
+
+// 反转任意POD 类型的字节序, 1/2/4/8字节的类型使用bswap 指令
+template<class _Type>
+inline _Type _bytes_reverse(_Type value)
+{
+    static_assert(std::is_trivially_copyable<_Type>::value, "The type must be trivially copyable.");
+
+    if (sizeof(_Type) == 2 || sizeof(_Type) == 4 || sizeof(_Type) == 8)
+    {
+        typedef typename std::conditional<sizeof(_Type) == 2, uint16_t,
+            typename std::conditional<sizeof(_Type) == 4, uint32_t, uint64_t>::type>::type _Word;
+
+        _Word word;
+        std::memcpy(&word, &value, sizeof(word));
+        word = _bytes_swap(word);
+        std::memcpy(&value, &word, sizeof(word));
+    }
+    else
+    {
+        unsigned char* bytes = reinterpret_cast<unsigned char*>(&value);
+        std::reverse(bytes, bytes + sizeof(_Type));
+    }
+
+    return value;
+}
+
+} // detail
+
+/*!
+ *  /brief  字节数据的只读视图, 不持有也不复制数据, 调用者需保证数据在使用期间有效.
+ *
+ *  /note   load() 系列方法通过memcpy 读取, 不要求地址对齐;
+ *          越界时抛出std::runtime_error 异常.
+ */
+class bytes_view
+{
+public:
+    typedef const uint8_t* iterator;
+    typedef const uint8_t* const_iterator;
+
+    static const size_t npos = size_t(-1);
+
+    bytes_view()
+        : _data(nullptr), _size(0) {}
+    bytes_view(const void* data, size_t size)
+        : _data(static_cast<const uint8_t*>(data)), _size(size) {}
+    bytes_view(const std::string& bytes)
+        : _data(reinterpret_cast<const uint8_t*>(bytes.data())), _size(bytes.size()) {}
+    bytes_view(const char* str)
+        : _data(reinterpret_cast<const uint8_t*>(str)), _size(str ? std::strlen(str) : 0) {}
+
+    const uint8_t* data() const { return _data; }
+    const char* chars() const { return reinterpret_cast<const char*>(_data); }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+
+    uint8_t operator[](size_t index) const { return _data[index]; }
+
+    uint8_t at(size_t index) const
+    {
+        if (index >= _size)
+            throw std::runtime_error("Specified range error.");
+        return _data[index];
+    }
+
+    //! 从offset 开始, 最多length 字节的子视图
+    bytes_view subview(size_t offset, size_t length = npos) const
+    {
+        if (offset > _size)
+            throw std::runtime_error("Specified range error.");
+        return bytes_view(_data + offset, std::min(length, _size - offset));
+    }
+
+    //! [first, last) 的子视图
+    bytes_view slice(size_t first, size_t last) const
+    {
+        if (first > last || last > _size)
+            throw std::runtime_error("Specified range error.");
+        return bytes_view(_data + first, last - first);
+    }
+
+    void remove_prefix(size_t count)
+    {
+        if (count > _size)
+            throw std::runtime_error("Specified range error.");
+        _data += count;
+        _size -= count;
+    }
+
+    void remove_suffix(size_t count)
+    {
+        if (count > _size)
+            throw std::runtime_error("Specified range error.");
+        _size -= count;
+    }
+
+    //! 以本机字节序读取offset 处的值
+    template<class _Type>
+    _Type load(size_t offset = 0) const
+    {
+        static_assert(std::is_trivially_copyable<_Type>::value, "The type must be trivially copyable.");
+
+        if (offset > _size || _size - offset < sizeof(_Type))
+            throw std::runtime_error("The data is too short.");
+
+        _Type value;
+        std::memcpy(&value, _data + offset, sizeof(_Type));
+        return value;
+    }
+
+    //! 以小端序读取offset 处的值
+    template<class _Type>
+    _Type load_le(size_t offset = 0) const
+    {
+#ifdef CPU_BIG_ENDIAN
+        return detail::_bytes_reverse(load<_Type>(offset));
+#else
+        return load<_Type>(offset);
+#endif
+    }
+
+    //! 以大端序(网络字节序)读取offset 处的值
+    template<class _Type>
+    _Type load_be(size_t offset = 0) const
+    {
+#ifdef CPU_BIG_ENDIAN
+        return load<_Type>(offset);
+#else
+        return detail::_bytes_reverse(load<_Type>(offset));
+#endif
+    }
+
+    //! 复制为 bytedata
+    bytedata bytes() const {
+        return bytedata(_data, _size);
+    }
+
+    friend bool operator==(const bytes_view& left, const bytes_view& right) {
+        return left._size == right._size && (left._size == 0 || std::memcmp(left._data, right._data, left._size) == 0);
+    }
+
+    friend bool operator!=(const bytes_view& left, const bytes_view& right) {
+        return !(left == right);
+    }
+
+protected:
+    const uint8_t* _data;
+    size_t         _size;
+};
+
 /*!
  *   Calculates the size of memory used by the content between the start and end.
  */
@@ -96,6 +285,7 @@ inline bytedata bytes_from<QByteArray>(const QByteArray& value)
 
 /*!
  *   Returns byte data for the specified range through the specified address offset.
+ *   Use bytes_view::subview() to avoid the copy.
  */
 inline bytedata bytes_range(
     const bytedata& bytes, size_t offset, size_t length)
@@ -116,21 +306,18 @@ inline bytedata bytes_range(
  *   Converts byte data to any POD(Plain Old Data) type.
  */
 template<class _Type>
-inline _Type bytes_cast(const bytedata& bytes)
+inline _Type bytes_cast(bytes_view bytes)
 {
-    if (bytes.size() < sizeof(_Type))
-        throw std::runtime_error("The data is too short.");
-
-    return *reinterpret_cast<const _Type*>(&bytes[0]);
+    return bytes.load<_Type>();
 }
 
 /*!
  *   Converts byte data to any POD(Plain Old Data) type by specified offset.
  */
 template<class _Type>
-inline _Type bytes_cast(const bytedata& bytes, size_t offset)
+inline _Type bytes_cast(bytes_view bytes, size_t offset)
 {
-    return bytes_cast<_Type>(bytes_range(bytes, offset, sizeof(_Type)));
+    return bytes.load<_Type>(offset);
 }
 
 /*!
@@ -149,15 +336,7 @@ template<class _Type>
 inline _Type hton_type(_Type value)
 {
 #ifdef CPU_LITTLE_ENDIAN
-    unsigned char bytes[sizeof(_Type)] = { 0 };
-
-    for (unsigned n = 0; n < sizeof(_Type); ++n)
-    {
-        bytes[sizeof(_Type) - n - 1] =
-            static_cast<unsigned char>((value >> (n * 8)) & 0xff);
-    }
-    return *reinterpret_cast<_Type*>(bytes);
-
+    return detail::_bytes_reverse(value);
 #else
     return value;
 #endif
@@ -177,6 +356,7 @@ inline _Type ntoh_type(_Type value)
 /*!
  *  Serialize the object into byte data.
  *  throw: boost::archive::archive_exception.
+ *  See bytes_pack() in byte_archive.hpp for a faster archive using the same serialize() members.
  */
 template<class _Type>
 inline bytedata& bytes_serialize(bytedata& bytesRef, const _Type& type)
@@ -207,13 +387,14 @@ inline _Type& bytes_deserialize(_Type& typeRef, const bytedata& bytes)
 /*!
  *  Copy the byte data into the memory.
  */
-UTILITY_FUNCT_DECL void bytes_into_memory(void* address, int length, const bytedata& bytes);
+UTILITY_FUNCT_DECL void bytes_into_memory(void* address, int length, bytes_view bytes);
 
 /*!
  *   Format byte data as a string in hexadecimal.
+ *   The separator is inserted between groups of percount bytes.
  */
 UTILITY_FUNCT_DECL std::string bytes_into_hex(
-    const bytedata& bytes, const std::string& separator = "", const int percount = 1);
+    bytes_view bytes, const std::string& separator = "", const int percount = 1);
 
 /*!
  *   Converts hexadecimal string to byte data.
@@ -226,10 +407,28 @@ UTILITY_FUNCT_DECL bytedata bytes_from_hex(const std::string& hex);
  *  /param name     目标文件名称
  *  /param bytes    输出字节数据
  *  /param offset   读取偏移地址
- *  /param length   读取数据长度
+ *  /param length   读取数据长度, fsize(-1)表示读到文件末尾
+ *  /param flags    util::fstream_flag, 例如fstream_nocache 读取后不保留页缓存
+ *
+ *  /note   There is no size limit, the whole range must fit in memory;
+ *          use the bytes_sink overload for larger files.
  */
 UTILITY_FUNCT_DECL bytedata& bytes_from_file(
-    bytedata& bytes, const util::fpath& name, int offset = 0, int length = -1);
+    bytedata& bytes, const util::fpath& name, fsize offset = 0, fsize length = fsize(-1), int flags = fstream_default);
+
+//! Receives the file content chunk by chunk, returns false to stop.
+typedef std::function<bool(bytes_view)> bytes_sink;
+
+/*!
+ *  /brief  Read the file in chunks of 4MB and pass them to the sink, so that
+ *          the file never needs to be fully resident.
+ *
+ *  /return The number of bytes passed to the sink.
+ *  /note   The util::ferror exception is thrown when an error occurs.
+ *  /see    util::file_read_stream()
+ */
+UTILITY_FUNCT_DECL fsize bytes_from_file(
+    const util::fpath& name, const bytes_sink& sink, fsize offset = 0, fsize length = fsize(-1), int flags = fstream_default);
 
 /*!
  *  /brief  Writes byte data into the file.
@@ -237,13 +436,34 @@ UTILITY_FUNCT_DECL bytedata& bytes_from_file(
  *  /note   If the directory does not exist, try creating it.
  *          The util::ferror exception is thrown when an error occurs.
  */
-UTILITY_FUNCT_DECL void bytes_into_file(const util::fpath& name, const bytedata& bytes);
+UTILITY_FUNCT_DECL void bytes_into_file(const util::fpath& name, bytes_view bytes);
+
+/*!
+ *  /brief  Writes the data provided by the source into the file chunk by chunk.
+ *
+ *  /return The number of bytes written.
+ *  /note   Same as bytes_into_file(name, bytes), see util::file_write_stream().
+ */
+UTILITY_FUNCT_DECL fsize bytes_into_file(
+    const util::fpath& name, const fsource& source, int flags = fstream_default);
+
+/*!
+ *  /brief  Atomically replaces the file with the byte data, a crash leaves
+ *          either the old or the new content, never a torn file.
+ *
+ *  /param policy   util::fsync_policy, fsync_data by default
+ *  /note   If the directory does not exist, try creating it.
+ *          Use util::fatomic_batch to share one sync barrier between many files.
+ *  /see    util::file_write_atomic()
+ */
+UTILITY_FUNCT_DECL void bytes_into_file_atomic(
+    const util::fpath& name, bytes_view bytes, int policy = fsync_data);
 
 /*!
  *   Converts byte data to base64 string.
  */
 UTILITY_FUNCT_DECL std::string& bytes_into_base64(
-    std::string& base64, const bytedata& bytes, bool noline = true);
+    std::string& base64, bytes_view bytes, bool noline = true);
 
 /*!
  *   Converts base64 string to byte data.
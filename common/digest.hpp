@@ -1,141 +1,565 @@
-#ifndef digest_h__
-#define digest_h__
-
-/*
-*   digest.hpp
-*
-*   v0.1 2018-09 by GuoJH
-*/
-
-#ifdef UTILITY_SUPPORT_BOOST
-#   include <boost/uuid/detail/md5.hpp>
-#   include <boost/uuid/detail/sha1.hpp>
-#endif
-
-#include <common/bytedata.hpp>
-#include <common/common_cfg.h>
-
-namespace util {
-
-// need boost support 
-#ifdef UTILITY_SUPPORT_BOOST
-
-/// 计算数据的sha1摘要
-inline bytedata bytes_sha1_digest(const bytedata& bytes)
-{
-    boost::uuids::detail::sha1 sha1;
-    boost::uuids::detail::sha1::digest_type digest = { 0 };
-
-    sha1.process_bytes(bytes.data(), bytes.size());
-    sha1.get_digest(digest);
-
-    bytedata result;
-    for (unsigned int i = 0; i < arraysize(digest); i++)
-        result += bytes_from(hton_type(digest[i]));
-
-    return result;
-}
-
-/// 计算文件的sha1摘要
-inline bytedata file_sha1_digest(
-    const fpath& name, 
-    const fsize& blockSize = 1024 * 512,
-    const std::function<bool(fsize, fsize)>& call = {})
-{
-    boost::uuids::detail::sha1 sha1;
-    boost::uuids::detail::sha1::digest_type digest = { 0 };
-
-    ffile file = util::file_open(name, O_RDONLY);
-    fsize size = util::file_size(file);
-
-    fsize    processed = 0;
-    bytedata buf(blockSize, 0);
-    do
-    {
-        fsize len = std::min<fsize>(buf.size(), size - processed);
-
-        util::file_read(file, &buf[0], len);
-
-        sha1.process_bytes(buf.data(), len);
-
-        processed += len;
-
-        if (call)
-        {
-            if (!call(processed, size))
-                return {};
-        }
-    } 
-    while (processed < size);
-
-    sha1.get_digest(digest);
-
-    bytedata result;
-    for (unsigned i = 0; i < arraysize(digest); i++)
-        result += bytes_from(hton_type(digest[i]));
-
-    return result;
-}
-
-/// 计算数据的md5摘要
-inline bytedata bytes_md5_digest(const bytedata& bytes)
-{
-    boost::uuids::detail::md5 md5;
-    boost::uuids::detail::md5::digest_type digest;
-
-    md5.process_bytes(bytes.data(), bytes.size());
-    md5.get_digest(digest);
-
-    bytedata result;
-    for (unsigned i = 0; i < arraysize(digest); i++)
-        result += bytes_from(digest[i]);
-
-    return result;
-}
-
-/// 计算文件的md5摘要
-inline bytedata file_md5_digest(
-    const fpath& name,
-    const fsize& blockSize = 1024 * 512,
-    const std::function<bool(fsize, fsize)>& call = {})
-{
-    boost::uuids::detail::md5 md5;
-    boost::uuids::detail::md5::digest_type digest;
-
-    ffile file = util::file_open(name, O_RDONLY);
-    fsize size = util::file_size(file);
-
-    fsize    processed = 0;
-    bytedata buf(blockSize, 0);
-    do
-    {
-        fsize len = std::min<fsize>(buf.size(), size - processed);
-
-        util::file_read(file, &buf[0], len);
-
-        md5.process_bytes(buf.data(), len);
-
-        processed += len;
-        if (call)
-        {
-            if (!call(processed, size))
-                return {};
-        }
-    } 
-    while (processed < size);
-
-    md5.get_digest(digest);
-
-    bytedata result;
-    for (unsigned i = 0; i < arraysize(digest); i++)
-        result += bytes_from(digest[i]);
-
-    return result;
-}
-
-#endif // UTILITY_SUPPORT_BOOST
-
-} // util
-
-
+#ifndef digest_h__
+#define digest_h__
+
+/*
+*   digest.hpp
+*
+*   v0.1 2018-09 by GuoJH
+*   v0.2 2023-06 by GuoJH
+*/
+
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <common/hasher.h>
+#include <common/bytedata.hpp>
+#include <common/common_cfg.h>
+#include <filesystem/file_util.h>
+
+namespace util {
+
+namespace detail {
+
+// 按块读取并遍历文件内容, 通过pread() 读取, 不改变也不依赖文件指针.
+// 若计算期间文件被截断, 读取到达文件末尾时将抛出ferror 异常, 而不会因访问映射视图而崩溃.
+template<class _Process>
+inline bool _file_digest_foreach(
+    const fpath& name,
+    const fsize& blockSize,
+    const std::function<bool(fsize, fsize)>& call,
+    _Process process)
+{
+    ffile file = util::file_open(name, O_RDONLY);
+    fsize size = util::file_size(file);
+
+    fsize             processed = 0;
+    std::vector<char> buffer(size_t(std::max<fsize>(std::min<fsize>(blockSize, size), 1)));
+    do
+    {
+        fsize len = std::min<fsize>(buffer.size(), size - processed);
+
+        util::file_pread(file, buffer.data(), len, processed);
+
+        process(buffer.data(), len);
+
+        processed += len;
+
+        if (call)
+        {
+            if (!call(processed, size))
+                return false;
+        }
+    } 
+    while (processed < size);
+
+    return true;
+}
+
+} // detail
+
+/// 计算数据的摘要, algorithm 见 hash_algorithm
+inline bytedata bytes_digest(bytes_view bytes, int algorithm)
+{
+    std::unique_ptr<hasher> h = hasher_create(algorithm);
+    if (!h)
+        return {};
+
+    h->update(bytes);
+    return h->finalize();
+}
+
+/// 计算文件的摘要, algorithm 见 hash_algorithm; 被call 取消时返回空, 读取失败(如文件在计算期间被截断)时抛出ferror 异常
+inline bytedata file_digest(
+    const fpath& name,
+    int algorithm,
+    const fsize& blockSize = 1024 * 512,
+    const std::function<bool(fsize, fsize)>& call = {})
+{
+    std::unique_ptr<hasher> h = hasher_create(algorithm);
+    if (!h)
+        return {};
+
+    bool completed = detail::_file_digest_foreach(name, blockSize, call, 
+        [&](const char* data, fsize len) { h->update(data, static_cast<size_t>(len)); });
+
+    if (!completed)
+        return {};
+
+    return h->finalize();
+}
+
+/// 计算数据的sha1摘要
+inline bytedata bytes_sha1_digest(bytes_view bytes)
+{
+    return bytes_digest(bytes, hash_sha1);
+}
+
+/// 计算文件的sha1摘要
+inline bytedata file_sha1_digest(
+    const fpath& name, 
+    const fsize& blockSize = 1024 * 512,
+    const std::function<bool(fsize, fsize)>& call = {})
+{
+    return file_digest(name, hash_sha1, blockSize, call);
+}
+
+/// 计算数据的md5摘要
+inline bytedata bytes_md5_digest(bytes_view bytes)
+{
+    return bytes_digest(bytes, hash_md5);
+}
+
+/// 计算文件的md5摘要
+inline bytedata file_md5_digest(
+    const fpath& name,
+    const fsize& blockSize = 1024 * 512,
+    const std::function<bool(fsize, fsize)>& call = {})
+{
+    return file_digest(name, hash_md5, blockSize, call);
+}
+
+/// 计算数据的sha256摘要
+inline bytedata bytes_sha256_digest(bytes_view bytes)
+{
+    return bytes_digest(bytes, hash_sha256);
+}
+
+/// 计算文件的sha256摘要
+inline bytedata file_sha256_digest(
+    const fpath& name,
+    const fsize& blockSize = 1024 * 512,
+    const std::function<bool(fsize, fsize)>& call = {})
+{
+    return file_digest(name, hash_sha256, blockSize, call);
+}
+
+/*!
+ *  \brief  多文件摘要的选项
+ */
+struct fdigest_options
+{
+    int   algorithm;        //!< 摘要算法, 见 hash_algorithm
+    int   concurrency;      //!< 工作线程数, 不大于0时为处理器的线程数
+    fsize chunk_size;       //!< 每次读取的大小, 也是树摘要的分块大小
+    fsize tree_threshold;   //!< 不小于该大小的文件使用树摘要(见 file_tree_digest()), 0 表示不使用
+
+    fdigest_options(int algorithm = hash_sha256, int concurrency = 0)
+        : algorithm(algorithm)
+        , concurrency(concurrency)
+        , chunk_size(4 * 1024 * 1024)
+        , tree_threshold(0)
+    {}
+};
+
+namespace detail {
+
+// 工作线程的预读线程, 在工作线程计算当前块的同时读取下一块.
+// 每个工作线程至多拥有一个, 并在其整个生命周期中复用, 同一时间只有一个未完成的读取.
+class _digest_reader
+{
+public:
+    _digest_reader()
+        : _file(nullptr), _data(nullptr), _size(0), _offset(0)
+        , _pending(false), _stop(false)
+        , _thread(&_digest_reader::run, this)
+    {}
+
+    ~_digest_reader()
+    {
+        {
+            std::lock_guard<std::mutex> locker(_lock);
+            _stop = true;
+        }
+
+        _cond.notify_all();
+        _thread.join();
+    }
+
+    void submit(const ffile& file, char* data, fsize size, fsize offset)
+    {
+        {
+            std::lock_guard<std::mutex> locker(_lock);
+            _file    = &file;
+            _data    = data;
+            _size    = size;
+            _offset  = offset;
+            _pending = true;
+        }
+
+        _cond.notify_all();
+    }
+
+    void wait(ferror& ferr)
+    {
+        std::unique_lock<std::mutex> locker(_lock);
+        _cond.wait(locker, [this]() { return !_pending; });
+        ferr = _ferr;
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> locker(_lock);
+        for (;;)
+        {
+            _cond.wait(locker, [this]() { return _pending || _stop; });
+            if (!_pending)
+                return;
+
+            locker.unlock();
+            ferror ferr;
+            file_pread(*_file, _data, _size, _offset, ferr);
+            locker.lock();
+
+            _ferr    = ferr;
+            _pending = false;
+            _cond.notify_all();
+        }
+    }
+
+    std::mutex              _lock;
+    std::condition_variable _cond;
+    const ffile*            _file;
+    char*                   _data;
+    fsize                   _size;
+    fsize                   _offset;
+    ferror                  _ferr;
+    bool                    _pending;
+    bool                    _stop;
+    std::thread             _thread;    // 最后初始化, 此时其他成员均已就绪
+};
+
+typedef std::unique_ptr<_digest_reader> _digest_reader_ptr;
+
+// 在concurrency 个线程上执行 process(0 ... count-1, reader), 
+// reader 为各个工作线程私有, 需要预读时由process 创建
+template<class _Process>
+inline void _digest_parallel_for(int concurrency, size_t count, _Process process)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        _digest_reader_ptr reader;
+        for (size_t i = next++; i < count; i = next++)
+            process(i, reader);
+    };
+
+    size_t threads = std::min<size_t>(std::max(concurrency, 1), count);
+    if (threads <= 1)
+        return worker();
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+
+    worker();
+
+    for (auto& thread : pool)
+        thread.join();
+}
+
+// 多文件摘要的调度状态
+struct _digest_engine
+{
+    // 调度单元: 整个文件, 或树摘要的一个分块(chunk >= 0)
+    struct unit
+    {
+        size_t  file;
+        int64_t chunk;
+    };
+
+    // 树摘要文件的状态
+    struct tree
+    {
+        bytedata            leaves;     // 各分块摘要的串联
+        std::atomic<size_t> remaining;  // 未完成的分块数
+    };
+
+    const std::vector<fpath>&                   names;
+    const fdigest_options&                      options;
+    const std::function<bool(fsize, fsize)>&    call;
+
+    std::vector<bytedata>&  digests;
+    std::vector<ferror>&    errors;
+    std::vector<fsize>      sizes;
+    std::vector<unit>       units;
+    std::unique_ptr<tree[]> trees;
+    size_t                  digest_size;
+
+    std::atomic<bool>       canceled;
+    std::mutex              error_lock;
+    std::mutex              progress_lock;
+    fsize                   processed;
+    fsize                   total;
+
+    _digest_engine(
+        const std::vector<fpath>& names,
+        const fdigest_options& options,
+        const std::function<bool(fsize, fsize)>& call,
+        std::vector<bytedata>& digests,
+        std::vector<ferror>& errors)
+        : names(names), options(options), call(call)
+        , digests(digests), errors(errors)
+        , digest_size(hasher_create(options.algorithm)->digest_size())
+        , canceled(false), processed(0), total(0)
+    {}
+
+    // 串行调用进度回调, 返回false 表示已取消
+    bool progress(fsize len)
+    {
+        if (!call)
+            return !canceled;
+
+        std::lock_guard<std::mutex> locker(progress_lock);
+        if (canceled)
+            return false;
+
+        processed += len;
+        if (!call(processed, total))
+            canceled = true;
+
+        return !canceled;
+    }
+
+    // 只有一个分块的文件, 其树摘要与普通摘要相同
+    bool is_tree(size_t file) const
+    {
+        return options.tree_threshold > 0 && 
+               sizes[file] >= options.tree_threshold && sizes[file] > options.chunk_size;
+    }
+
+    void schedule()
+    {
+        int concurrency = options.concurrency > 0 ? 
+            options.concurrency : std::max<int>(std::thread::hardware_concurrency(), 1);
+
+        digests.assign(names.size(), bytedata());
+        errors.assign(names.size(), ferror());
+        sizes.assign(names.size(), 0);
+
+        // 先获取所有文件的大小, 用于进度与调度
+        _digest_parallel_for(concurrency, names.size(), [&](size_t i, _digest_reader_ptr&)
+        {
+            sizes[i] = file_status(names[i], true, errors[i]).size;
+        });
+
+        trees.reset(new tree[names.size()]);
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            if (errors[i])
+                continue;
+
+            total += sizes[i];
+
+            if (is_tree(i))
+            {
+                int64_t chunks = int64_t((sizes[i] + options.chunk_size - 1) / options.chunk_size);
+                trees[i].leaves.assign(size_t(chunks) * digest_size, 0);
+                trees[i].remaining = size_t(chunks);
+                for (int64_t c = 0; c < chunks; ++c)
+                    units.push_back({ i, c });
+            }
+            else
+            {
+                units.push_back({ i, -1 });
+            }
+        }
+
+        // 先处理大的单元, 避免大文件最后开始而拖长总耗时
+        std::stable_sort(units.begin(), units.end(), [&](const unit& l, const unit& r) {
+            return unit_size(l) > unit_size(r);
+        });
+
+        _digest_parallel_for(concurrency, units.size(), [&](size_t i, _digest_reader_ptr& reader)
+        {
+            process(units[i], reader);
+        });
+    }
+
+    fsize unit_size(const unit& u) const
+    {
+        if (u.chunk < 0)
+            return sizes[u.file];
+
+        return std::min<fsize>(options.chunk_size, sizes[u.file] - fsize(u.chunk) * options.chunk_size);
+    }
+
+    void process(const unit& u, _digest_reader_ptr& reader)
+    {
+        // 已取消的文件保留空的摘要
+        if (canceled)
+            return fail(u.file, ferror(ECANCELED, "The operation was canceled"));
+
+        ferror ferr;
+        ffile  file = file_open(names[u.file], O_RDONLY, ferr);
+        if (ferr)
+            return fail(u.file, ferr);
+
+        if (u.chunk < 0)
+            return process_file(u, file, reader);
+
+        // 树摘要的分块, 最后完成的分块负责计算根摘要
+        tree& t = trees[u.file];
+        bytedata leaf = digest_range(file, fsize(u.chunk) * options.chunk_size, unit_size(u), reader, ferr);
+        if (ferr)
+            return fail(u.file, ferr);
+
+        std::memcpy(&t.leaves[size_t(u.chunk) * digest_size], leaf.data(), digest_size);
+
+        // 失败的分块不会递减计数, 故计数归零时所有分块均已成功
+        if (--t.remaining == 0)
+            digests[u.file] = bytes_digest(t.leaves, options.algorithm);
+    }
+
+    void process_file(const unit& u, ffile& file, _digest_reader_ptr& reader)
+    {
+        ferror ferr;
+        bytedata digest = digest_range(file, 0, sizes[u.file], reader, ferr);
+        if (ferr)
+            return fail(u.file, ferr);
+
+        digests[u.file].swap(digest);
+    }
+
+    // 计算文件指定范围的摘要, 在计算当前块的同时由reader 读取下一块
+    bytedata digest_range(const ffile& file, fsize offset, fsize size, _digest_reader_ptr& reader, ferror& ferr)
+    {
+        std::unique_ptr<hasher> h = hasher_create(options.algorithm);
+
+        fsize chunk = std::max<fsize>(std::min<fsize>(options.chunk_size, size), 1);
+        std::vector<char> buffers[2];
+        buffers[0].resize(size_t(chunk));
+
+        // 只有一块时不需要预读
+        if (size > chunk && !reader)
+            reader.reset(new _digest_reader());
+
+        fsize pos = 0;
+        fsize len = std::min<fsize>(chunk, size);
+        file_pread(file, buffers[0].data(), len, offset, ferr);
+
+        for (int current = 0; !ferr && len > 0; current ^= 1)
+        {
+            fsize next_pos = pos + len;
+            fsize next_len = std::min<fsize>(chunk, size - next_pos);
+
+            if (next_len > 0)
+            {
+                std::vector<char>& buffer = buffers[current ^ 1];
+                buffer.resize(size_t(chunk));
+                reader->submit(file, buffer.data(), next_len, offset + next_pos);
+            }
+
+            h->update(buffers[current].data(), size_t(len));
+
+            if (!progress(len))
+                ferr = ferror(ECANCELED, "The operation was canceled");
+
+            // 无论是否已出错, 都需要等待预读完成后才能释放缓冲区
+            if (next_len > 0)
+            {
+                ferror next_ferr;
+                reader->wait(next_ferr);
+
+                if (!ferr)
+                    ferr = next_ferr;
+            }
+
+            pos = next_pos;
+            len = next_len;
+        }
+
+        return ferr ? bytedata() : h->finalize();
+    }
+
+    // 树摘要的多个分块可能同时失败
+    void fail(size_t file, const ferror& ferr)
+    {
+        std::lock_guard<std::mutex> locker(error_lock);
+        if (!errors[file])
+            errors[file] = ferr;
+    }
+};
+
+} // detail
+
+/*!
+ *  \brief  在有限的线程上并发计算多个文件的摘要.
+ *  \param  digests 输出, 与names 一一对应, 失败或被取消的文件为空
+ *  \param  errors  输出, 与names 一一对应, 被取消的文件错误码为ECANCELED
+ *  \param  call    进度回调, 参数为所有文件已处理与总的字节数, 返回false 取消计算;
+ *                  回调会在工作线程中被串行地调用.
+ *  \return 所有文件均成功时返回true
+ *
+ *  \note   1. 每个工作线程有一个复用的预读线程, 在计算当前块的同时读取下一块, 使读取与计算重叠;
+ *          2. 大文件可以通过 options.tree_threshold 使用树摘要, 使单个文件也能利用所有线程,
+ *             其结果与普通摘要不同, 参见 file_tree_digest().
+ */
+inline bool files_digest(
+    const std::vector<fpath>& names,
+    std::vector<bytedata>& digests,
+    std::vector<ferror>& errors,
+    const fdigest_options& options = fdigest_options(),
+    const std::function<bool(fsize, fsize)>& call = {})
+{
+    if (!hasher_create(options.algorithm))
+    {
+        digests.assign(names.size(), bytedata());
+        errors.assign(names.size(), ferror(EINVAL, "Invalid hash algorithm"));
+        return false;
+    }
+
+    fdigest_options opts = options;
+    if (opts.chunk_size == 0)
+        opts.chunk_size = fdigest_options().chunk_size;
+
+    detail::_digest_engine engine(names, opts, call, digests, errors);
+    engine.schedule();
+
+    for (auto& ferr : errors)
+    {
+        if (ferr)
+            return false;
+    }
+
+    return true;
+}
+
+/*!
+ *  \brief  以树的方式计算文件的摘要, 文件按chunk_size 分块后并发计算各块的摘要,
+ *          根摘要为各块摘要依次串联后的摘要, 只有一个分块(包括空文件)时与普通摘要相同.
+ *
+ *  \note   被call 取消时返回空, 其他错误将抛出ferror 异常.
+ */
+inline bytedata file_tree_digest(
+    const fpath& name,
+    int algorithm = hash_sha256,
+    const fsize& chunkSize = 4 * 1024 * 1024,
+    int concurrency = 0,
+    const std::function<bool(fsize, fsize)>& call = {})
+{
+    fdigest_options options(algorithm, concurrency);
+    options.chunk_size     = chunkSize;
+    options.tree_threshold = 1;
+
+    std::vector<bytedata> digests;
+    std::vector<ferror>   errors;
+    files_digest(std::vector<fpath>(1, name), digests, errors, options, call);
+
+    if (errors[0] && errors[0].code() != ECANCELED)
+        throw errors[0];
+
+    return digests[0];
+}
+
+} // util
+
+
 #endif // digest_h__
\ No newline at end of file
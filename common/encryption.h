@@ -19,7 +19,7 @@ namespace encryption {
  * 
  *  /note   密文与明文不等长, 可能会抛出std::runtime_error异常.
  */
-UTILITY_FUNCT_DECL bytedata& encrypt_with_tea32(bytedata& bytes, const bytedata& key);
+UTILITY_FUNCT_DECL bytedata& encrypt_with_tea32(bytedata& bytes, bytes_view key);
 
 /*!
  *  /brief  采用TEA-32的方式解密数据.
@@ -27,7 +27,7 @@ UTILITY_FUNCT_DECL bytedata& encrypt_with_tea32(bytedata& bytes, const bytedata&
  * 
  *  /note   可能会抛出std::runtime_error异常.
  */
-UTILITY_FUNCT_DECL bytedata& decrypt_with_tea32(bytedata& bytes, const bytedata& key);
+UTILITY_FUNCT_DECL bytedata& decrypt_with_tea32(bytedata& bytes, bytes_view key);
 
 } // encryption
 } // util
@@ -0,0 +1,225 @@
+#ifndef hasher_h__
+#define hasher_h__
+
+/*
+*   hasher.h
+*
+*   v0.1 2023-06 by GuoJH
+*/
+
+#include <memory>
+#include <common/bytedata.hpp>
+#include <common/common_cfg.h>
+
+namespace util {
+
+//! 摘要算法
+enum hash_algorithm
+{
+    hash_md5    = 0,    //!< 16字节
+    hash_sha1   = 1,    //!< 20字节
+    hash_sha256 = 2,    //!< 32字节
+    hash_crc32c = 3,    //!< 4字节(大端序), 非加密校验和, 与iSCSI/ext4/Btrfs 使用的相同
+    hash_blake3 = 4,    //!< 32字节
+};
+
+/*!
+ *  \brief  增量计算摘要的基类, 通过多次调用 update() 输入数据, 最后由 finalize() 得到摘要.
+ *
+ *  \note   各算法会在首次使用时根据 util::cpu 检测的结果选择最快的实现(如SHA-NI, SSE4.2, ARMv8),
+ *          不支持时回退到可移植的实现, 所有实现的结果完全一致.
+ *          finalize() 之后需要调用 reset() 才能计算新的摘要, 实例不是线程安全的.
+ */
+class UTILITY_CLASS_DECL hasher
+{
+public:
+    virtual ~hasher() {}
+
+    //! 输入数据
+    void update(const void* data, size_t size) {
+        _update(static_cast<const uint8_t*>(data), size);
+    }
+
+    void update(bytes_view bytes) {
+        _update(bytes.data(), bytes.size());
+    }
+
+    //! 结束计算, 将摘要写入digest, 其长度至少为 digest_size()
+    void finalize(void* digest) {
+        _finalize(static_cast<uint8_t*>(digest));
+    }
+
+    //! 结束计算, 返回摘要
+    bytedata finalize() {
+        bytedata digest(digest_size(), 0);
+        _finalize(reinterpret_cast<uint8_t*>(&digest[0]));
+        return digest;
+    }
+
+    //! 恢复到初始状态
+    void reset() {
+        _reset();
+    }
+
+    //! 摘要算法, 见 hash_algorithm
+    virtual int algorithm() const = 0;
+
+    //! 摘要的字节数
+    virtual size_t digest_size() const = 0;
+
+    //! 当前使用的实现, 如: "scalar", "sha-ni", "sse4.2", "armv8"
+    virtual const char* backend() const = 0;
+
+protected:
+    virtual void _update(const uint8_t* data, size_t size) = 0;
+    virtual void _finalize(uint8_t* digest) = 0;
+    virtual void _reset() = 0;
+};
+
+/*!
+ *  \brief  MD5, 仅用于兼容, 不应用于安全相关的场景.
+ */
+class UTILITY_CLASS_DECL md5_hasher : public hasher
+{
+public:
+    UTILITY_MEMBER_DECL md5_hasher();
+
+    int algorithm() const { return hash_md5; }
+    size_t digest_size() const { return 16; }
+    UTILITY_MEMBER_DECL const char* backend() const;
+
+protected:
+    UTILITY_MEMBER_DECL void _update(const uint8_t* data, size_t size);
+    UTILITY_MEMBER_DECL void _finalize(uint8_t* digest);
+    UTILITY_MEMBER_DECL void _reset();
+
+    uint32_t _state[4];
+    uint64_t _length;
+    uint8_t  _buffer[64];
+};
+
+/*!
+ *  \brief  SHA-1, 支持SHA-NI 与ARMv8 SHA1指令.
+ */
+class UTILITY_CLASS_DECL sha1_hasher : public hasher
+{
+public:
+    UTILITY_MEMBER_DECL sha1_hasher();
+
+    int algorithm() const { return hash_sha1; }
+    size_t digest_size() const { return 20; }
+    UTILITY_MEMBER_DECL const char* backend() const;
+
+protected:
+    UTILITY_MEMBER_DECL void _update(const uint8_t* data, size_t size);
+    UTILITY_MEMBER_DECL void _finalize(uint8_t* digest);
+    UTILITY_MEMBER_DECL void _reset();
+
+    uint32_t _state[5];
+    uint64_t _length;
+    uint8_t  _buffer[64];
+};
+
+/*!
+ *  \brief  SHA-256, 支持SHA-NI 与ARMv8 SHA2指令.
+ *
+ *  \note   需要一次计算大量(小)数据的摘要时, 应使用 sha256_digest_many(),
+ *          在不支持SHA-NI 但支持AVX2 的处理器上, 其会同时计算8路数据.
+ */
+class UTILITY_CLASS_DECL sha256_hasher : public hasher
+{
+public:
+    UTILITY_MEMBER_DECL sha256_hasher();
+
+    int algorithm() const { return hash_sha256; }
+    size_t digest_size() const { return 32; }
+    UTILITY_MEMBER_DECL const char* backend() const;
+
+protected:
+    UTILITY_MEMBER_DECL void _update(const uint8_t* data, size_t size);
+    UTILITY_MEMBER_DECL void _finalize(uint8_t* digest);
+    UTILITY_MEMBER_DECL void _reset();
+
+    uint32_t _state[8];
+    uint64_t _length;
+    uint8_t  _buffer[64];
+};
+
+/*!
+ *  \brief  CRC-32C(Castagnoli), 支持SSE4.2 与ARMv8 CRC32指令, 否则使用 slicing-by-8 查表.
+ */
+class UTILITY_CLASS_DECL crc32c_hasher : public hasher
+{
+public:
+    UTILITY_MEMBER_DECL crc32c_hasher();
+
+    int algorithm() const { return hash_crc32c; }
+    size_t digest_size() const { return 4; }
+    UTILITY_MEMBER_DECL const char* backend() const;
+
+    //! 当前的校验值, 不影响后续的 update()
+    uint32_t value() const { return ~_crc; }
+
+protected:
+    UTILITY_MEMBER_DECL void _update(const uint8_t* data, size_t size);
+    UTILITY_MEMBER_DECL void _finalize(uint8_t* digest);
+    UTILITY_MEMBER_DECL void _reset();
+
+    uint32_t _crc;
+};
+
+/*!
+ *  \brief  BLAKE3, 输出为默认的32字节.
+ */
+class UTILITY_CLASS_DECL blake3_hasher : public hasher
+{
+public:
+    UTILITY_MEMBER_DECL blake3_hasher();
+
+    int algorithm() const { return hash_blake3; }
+    size_t digest_size() const { return 32; }
+    UTILITY_MEMBER_DECL const char* backend() const;
+
+protected:
+    UTILITY_MEMBER_DECL void _update(const uint8_t* data, size_t size);
+    UTILITY_MEMBER_DECL void _finalize(uint8_t* digest);
+    UTILITY_MEMBER_DECL void _reset();
+
+    UTILITY_MEMBER_DECL void _push_chunk(const uint32_t cv[8], uint64_t total_chunks);
+
+    // 当前的块(1024字节)
+    uint32_t _chunk_cv[8];
+    uint64_t _chunk_counter;
+    uint8_t  _block[64];
+    uint32_t _block_len;
+    uint32_t _blocks_compressed;
+
+    // 已完成的子树的链值, 2^54 个块足以覆盖 2^64 字节
+    uint32_t _cv_stack[54][8];
+    uint32_t _cv_stack_len;
+};
+
+/*!
+ *  \brief  创建指定算法的 hasher, 算法无效时返回nullptr.
+ */
+UTILITY_FUNCT_DECL std::unique_ptr<hasher> hasher_create(int algorithm);
+
+/*!
+ *  \brief  计算多段数据各自的SHA-256摘要.
+ *  \param  datas   各段数据的首地址
+ *  \param  sizes   各段数据的长度
+ *  \param  count   数据的段数
+ *  \param  digests 输出的摘要, 长度至少为 count * 32
+ *
+ *  \note   在支持AVX2 而不支持SHA-NI 的处理器上, 会将长度相近的数据分为8路同时计算.
+ */
+UTILITY_FUNCT_DECL void sha256_digest_many(
+    const void* const* datas, const size_t* sizes, size_t count, uint8_t* digests);
+
+} // util
+
+#ifndef UTILITY_DISABLE_HEADONLY
+#   include "impl/hasher.ipp"
+#endif
+
+#endif // hasher_h__
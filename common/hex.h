@@ -0,0 +1,73 @@
+#ifndef hex_h__
+#define hex_h__
+
+/*
+*   hex.h
+*
+*   v0.1 2023-06 by GuoJH
+*/
+
+#include <string>
+#include <common/common_cfg.h>
+
+namespace util {
+
+//! 十六进制编码选项
+enum hex_flag
+{
+    hex_lower = 0,  //!< 使用小写字母 a~f
+    hex_upper = 1,  //!< 使用大写字母 A~F
+};
+
+/*!
+ *  \brief  返回编码后的确切长度.
+ *  \param  separator_size 分隔符的长度, 为0时不分隔
+ *  \param  group          每组的字节数, 组与组之间插入分隔符
+ */
+UTILITY_FUNCT_DECL size_t hex_encoded_size(size_t size, size_t separator_size = 0, size_t group = 1);
+
+/*!
+ *  \brief  将数据编码为十六进制字符串.
+ *  \param  out 输出缓冲区, 长度至少为 hex_encoded_size(size)
+ *  \return 返回写入out 的字符数
+ *
+ *  \note   会根据 util::cpu 检测的结果选择AVX2 或SSSE3 的实现.
+ */
+UTILITY_FUNCT_DECL size_t hex_encode(char* out, const void* data, size_t size, int flags = hex_lower);
+
+/*!
+ *  \brief  将数据编码为十六进制字符串, 每group 个字节之间插入separator.
+ *  \param  out 输出缓冲区, 长度至少为 hex_encoded_size(size, separator.size(), group)
+ *  \return 返回写入out 的字符数
+ *
+ *  \note   对于单字节分组与单字符分隔符(如 "aa:bb:cc")使用专门的向量化实现.
+ */
+UTILITY_FUNCT_DECL size_t hex_encode(
+    char* out, const void* data, size_t size, const std::string& separator, size_t group = 1, int flags = hex_lower);
+
+/*!
+ *  \brief  严格地解码十六进制字符串, 仅接受 0~9, a~f, A~F, 且长度必须为偶数.
+ *  \param  out          输出缓冲区, 长度至少为 size / 2
+ *  \param  out_size     返回写入out 的字节数, 失败时为出错前已解码的字节数
+ *  \param  error_offset 若不为nullptr, 失败时返回第一个无效字符的位置,
+ *                       长度为奇数时为 size
+ */
+UTILITY_FUNCT_DECL bool hex_decode(
+    void* out, size_t& out_size, const char* data, size_t size, size_t* error_offset = nullptr);
+
+/*!
+ *  \brief  严格地解码由 hex_encode() 以相同的separator 与group 编码的字符串.
+ *
+ *  \note   除最后一组外, 每组必须恰好为 group 个字节, 且组之间必须为separator.
+ */
+UTILITY_FUNCT_DECL bool hex_decode(
+    void* out, size_t& out_size, const char* data, size_t size,
+    const std::string& separator, size_t group = 1, size_t* error_offset = nullptr);
+
+} // util
+
+#ifndef UTILITY_DISABLE_HEADONLY
+#   include "impl/hex.ipp"
+#endif
+
+#endif // hex_h__
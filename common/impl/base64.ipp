@@ -0,0 +1,683 @@
+/*
+*   base64.ipp
+*
+*   v0.1 2023-06 by GuoJH
+*/
+
+#ifdef UTILITY_DISABLE_HEADONLY
+#   include "../base64.h"
+#endif
+
+#include <cstring>
+#include <platform/cpu.h>
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#   if defined(COMPILER_MSVC)
+#       include <intrin.h>
+#   endif
+#   include <immintrin.h>
+#   define UTILITY_BASE64_X86 1
+#elif defined(ARCH_CPU_ARM64) && defined(__ARM_NEON)
+#   include <arm_neon.h>
+#   define UTILITY_BASE64_NEON 1
+#endif
+
+namespace util {
+namespace detail {
+
+enum
+{
+    _base64_line_chars  = 76,   // MIME 每行的字符数
+    _base64_line_bytes  = 57,   // 对应的字节数
+};
+
+enum
+{
+    _base64_pad         = 0x40, // '='
+    _base64_space       = 0x80, // 空白字符, 解码时忽略
+    _base64_invalid     = 0xFF,
+};
+
+inline const char* _base64_alphabet(bool url)
+{
+    return url ?
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_" :
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+}
+
+struct _base64_decode_table
+{
+    uint8_t t[256];
+
+    explicit _base64_decode_table(bool url)
+    {
+        std::memset(t, _base64_invalid, sizeof(t));
+
+        const char* alphabet = _base64_alphabet(url);
+        for (uint8_t i = 0; i < 64; ++i)
+            t[uint8_t(alphabet[i])] = i;
+
+        t[uint8_t('=')]  = _base64_pad;
+        t[uint8_t(' ')]  = _base64_space;
+        t[uint8_t('\t')] = _base64_space;
+        t[uint8_t('\r')] = _base64_space;
+        t[uint8_t('\n')] = _base64_space;
+    }
+};
+
+inline const uint8_t* _base64_table(bool url)
+{
+    static const _base64_decode_table standard(false);
+    static const _base64_decode_table urlsafe(true);
+    return url ? urlsafe.t : standard.t;
+}
+
+// 向量化的实现: 尽可能多地处理完整的分组, 返回已处理的输入长度; 解码遇到无效字符时提前返回
+typedef size_t (*_base64_encode_func)(char* out, const uint8_t* in, size_t size, bool url);
+typedef size_t (*_base64_decode_func)(uint8_t* out, const char* in, size_t size, bool url);
+
+#if defined(UTILITY_BASE64_X86)
+
+// 编码与解码的原理参见:
+// http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+// http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html
+
+// 每次读取16字节, 使用其中的12字节
+ATTRIBUTE_TARGET("ssse3")
+inline size_t _base64_encode_ssse3(char* out, const uint8_t* in, size_t size, bool url)
+{
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i lut = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, char((url ? '-' : '+') - 62), char((url ? '_' : '/') - 63), 'A', 0, 0);
+
+    size_t done = 0;
+    for (; size - done >= 16; done += 12, out += 16)
+    {
+        __m128i v  = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + done)), shuffle);
+        __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i t1 = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i index = _mm_or_si128(t0, t1);
+
+        // 将0..63 映射到LUT的下标, 再加上对应区间的偏移
+        __m128i r = _mm_subs_epu8(index, _mm_set1_epi8(51));
+        r = _mm_or_si128(r, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), index), _mm_set1_epi8(13)));
+        r = _mm_add_epi8(_mm_shuffle_epi8(lut, r), index);
+
+        _mm_storeu_si128((__m128i*)out, r);
+    }
+
+    return done;
+}
+
+// 每次读取2x16字节, 使用其中的24字节
+ATTRIBUTE_TARGET("avx2")
+inline size_t _base64_encode_avx2(char* out, const uint8_t* in, size_t size, bool url)
+{
+    const __m256i shuffle = _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const char c62 = char((url ? '-' : '+') - 62);
+    const char c63 = char((url ? '_' : '/') - 63);
+    const __m256i lut = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, c62, c63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, c62, c63, 'A', 0, 0);
+
+    size_t done = 0;
+    for (; size - done >= 28; done += 24, out += 32)
+    {
+        __m256i v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(in + done))),
+            _mm_loadu_si128((const __m128i*)(in + done + 12)), 1);
+
+        v = _mm256_shuffle_epi8(v, shuffle);
+        __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        __m256i index = _mm256_or_si256(t0, t1);
+
+        __m256i r = _mm256_subs_epu8(index, _mm256_set1_epi8(51));
+        r = _mm256_or_si256(r, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), index), _mm256_set1_epi8(13)));
+        r = _mm256_add_epi8(_mm256_shuffle_epi8(lut, r), index);
+
+        _mm256_storeu_si256((__m256i*)out, r);
+    }
+
+    return done;
+}
+
+// 每16个字符输出12字节, 但会写入16字节, 因此要求剩余的输入足够长以保证不越界
+ATTRIBUTE_TARGET("ssse3")
+inline size_t _base64_decode_ssse3(uint8_t* out, const char* in, size_t size, bool url)
+{
+    const char c62 = url ? '-' : '+';
+    const char c63 = url ? '_' : '/';
+
+    size_t done = 0;
+    for (; size - done >= 24; done += 16, out += 12)
+    {
+        __m128i c = _mm_loadu_si128((const __m128i*)(in + done));
+
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+        __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+        __m128i is62  = _mm_cmpeq_epi8(c, _mm_set1_epi8(c62));
+        __m128i is63  = _mm_cmpeq_epi8(c, _mm_set1_epi8(c63));
+
+        __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+            break;
+
+        __m128i shift = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-65)), _mm_and_si128(lower, _mm_set1_epi8(-71))),
+            _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(4)), _mm_or_si128(
+                _mm_and_si128(is62, _mm_set1_epi8(char(62 - c62))), _mm_and_si128(is63, _mm_set1_epi8(char(63 - c63))))));
+
+        // 将16个6位的值合并为12字节
+        __m128i v = _mm_add_epi8(c, shift);
+        v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+        v = _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+        _mm_storeu_si128((__m128i*)out, v);
+    }
+
+    return done;
+}
+
+// 每32个字符输出24字节, 但会写入32字节
+ATTRIBUTE_TARGET("avx2")
+inline size_t _base64_decode_avx2(uint8_t* out, const char* in, size_t size, bool url)
+{
+    const char c62 = url ? '-' : '+';
+    const char c63 = url ? '_' : '/';
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t done = 0;
+    for (; size - done >= 48; done += 32, out += 24)
+    {
+        __m256i c = _mm256_loadu_si256((const __m256i*)(in + done));
+
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), c));
+        __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), c));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+        __m256i is62  = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(c62));
+        __m256i is63  = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(c63));
+
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(is62, is63)));
+        if (_mm256_movemask_epi8(valid) != -1)
+            break;
+
+        __m256i shift = _mm256_or_si256(
+            _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-65)), _mm256_and_si256(lower, _mm256_set1_epi8(-71))),
+            _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(4)), _mm256_or_si256(
+                _mm256_and_si256(is62, _mm256_set1_epi8(char(62 - c62))), _mm256_and_si256(is63, _mm256_set1_epi8(char(63 - c63))))));
+
+        __m256i v = _mm256_add_epi8(c, shift);
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, pack);
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+        _mm256_storeu_si256((__m256i*)out, v);
+    }
+
+    return done;
+}
+
+#endif // UTILITY_BASE64_X86
+
+#if defined(UTILITY_BASE64_NEON)
+
+// 通过vld3/vst4 完成3字节与4字符之间的交错, 查表使用vqtbl4
+inline size_t _base64_encode_neon(char* out, const uint8_t* in, size_t size, bool url)
+{
+    const uint8_t* alphabet = reinterpret_cast<const uint8_t*>(_base64_alphabet(url));
+
+    uint8x16x4_t lut;
+    for (int i = 0; i < 4; ++i)
+        lut.val[i] = vld1q_u8(alphabet + i * 16);
+
+    size_t done = 0;
+    for (; size - done >= 48; done += 48, out += 64)
+    {
+        uint8x16x3_t v = vld3q_u8(in + done);
+        uint8x16x4_t r;
+
+        r.val[0] = vshrq_n_u8(v.val[0], 2);
+        r.val[1] = vorrq_u8(vshlq_n_u8(vandq_u8(v.val[0], vdupq_n_u8(0x03)), 4), vshrq_n_u8(v.val[1], 4));
+        r.val[2] = vorrq_u8(vshlq_n_u8(vandq_u8(v.val[1], vdupq_n_u8(0x0F)), 2), vshrq_n_u8(v.val[2], 6));
+        r.val[3] = vandq_u8(v.val[2], vdupq_n_u8(0x3F));
+
+        for (int i = 0; i < 4; ++i)
+            r.val[i] = vqtbl4q_u8(lut, r.val[i]);
+
+        vst4q_u8(reinterpret_cast<uint8_t*>(out), r);
+    }
+
+    return done;
+}
+
+inline size_t _base64_decode_neon(uint8_t* out, const char* in, size_t size, bool url)
+{
+    const uint8_t c62 = url ? '-' : '+';
+    const uint8_t c63 = url ? '_' : '/';
+
+    size_t done = 0;
+    for (; size - done >= 64; done += 64, out += 48)
+    {
+        uint8x16x4_t c = vld4q_u8(reinterpret_cast<const uint8_t*>(in + done));
+        uint8x16_t   v[4];
+        uint8x16_t   invalid = vdupq_n_u8(0);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            uint8x16_t x = c.val[i];
+            uint8x16_t upper = vcltq_u8(vsubq_u8(x, vdupq_n_u8('A')), vdupq_n_u8(26));
+            uint8x16_t lower = vcltq_u8(vsubq_u8(x, vdupq_n_u8('a')), vdupq_n_u8(26));
+            uint8x16_t digit = vcltq_u8(vsubq_u8(x, vdupq_n_u8('0')), vdupq_n_u8(10));
+            uint8x16_t is62  = vceqq_u8(x, vdupq_n_u8(c62));
+            uint8x16_t is63  = vceqq_u8(x, vdupq_n_u8(c63));
+
+            uint8x16_t shift = vorrq_u8(
+                vorrq_u8(vandq_u8(upper, vdupq_n_u8(uint8_t(-65))), vandq_u8(lower, vdupq_n_u8(uint8_t(-71)))),
+                vorrq_u8(vandq_u8(digit, vdupq_n_u8(4)), vorrq_u8(
+                    vandq_u8(is62, vdupq_n_u8(uint8_t(62 - c62))), vandq_u8(is63, vdupq_n_u8(uint8_t(63 - c63))))));
+
+            uint8x16_t valid = vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, vorrq_u8(is62, is63)));
+            invalid = vorrq_u8(invalid, vmvnq_u8(valid));
+            v[i] = vaddq_u8(x, shift);
+        }
+
+        if (vmaxvq_u8(invalid) != 0)
+            break;
+
+        uint8x16x3_t r;
+        r.val[0] = vorrq_u8(vshlq_n_u8(v[0], 2), vshrq_n_u8(v[1], 4));
+        r.val[1] = vorrq_u8(vshlq_n_u8(v[1], 4), vshrq_n_u8(v[2], 2));
+        r.val[2] = vorrq_u8(vshlq_n_u8(v[2], 6), v[3]);
+        vst3q_u8(out, r);
+    }
+
+    return done;
+}
+
+#endif // UTILITY_BASE64_NEON
+
+struct _base64_kernels
+{
+    _base64_encode_func encode;
+    _base64_decode_func decode;
+};
+
+inline const _base64_kernels& _base64_select()
+{
+    static const _base64_kernels kernels = []() -> _base64_kernels
+    {
+#if defined(UTILITY_BASE64_X86)
+        util::cpu cpu;
+        if (cpu.has_avx2())
+            return { _base64_encode_avx2, _base64_decode_avx2 };
+        if (cpu.has_ssse3())
+            return { _base64_encode_ssse3, _base64_decode_ssse3 };
+#elif defined(UTILITY_BASE64_NEON)
+        return { _base64_encode_neon, _base64_decode_neon };
+#endif
+        return { nullptr, nullptr };
+    }();
+    return kernels;
+}
+
+// 编码完整的3字节分组, size 必须为3的倍数, 返回写入的字符数
+inline size_t _base64_encode_groups(char* out, const uint8_t* in, size_t size, bool url)
+{
+    size_t done = 0;
+    char*  dest = out;
+
+    const _base64_kernels& kernels = _base64_select();
+    if (kernels.encode)
+    {
+        done  = kernels.encode(dest, in, size, url);
+        dest += done / 3 * 4;
+    }
+
+    const char* alphabet = _base64_alphabet(url);
+    for (; done < size; done += 3, dest += 4)
+    {
+        uint32_t v = uint32_t(in[done]) << 16 | uint32_t(in[done + 1]) << 8 | in[done + 2];
+        dest[0] = alphabet[(v >> 18) & 0x3F];
+        dest[1] = alphabet[(v >> 12) & 0x3F];
+        dest[2] = alphabet[(v >> 6)  & 0x3F];
+        dest[3] = alphabet[v & 0x3F];
+    }
+
+    return size_t(dest - out);
+}
+
+// 编码最后不足3字节的部分, 返回写入的字符数
+inline size_t _base64_encode_tail(char* out, const uint8_t* in, size_t size, int flags)
+{
+    if (size == 0)
+        return 0;
+
+    const char* alphabet = _base64_alphabet((flags & base64_url) != 0);
+    uint32_t v = uint32_t(in[0]) << 16 | (size > 1 ? uint32_t(in[1]) << 8 : 0);
+
+    out[0] = alphabet[(v >> 18) & 0x3F];
+    out[1] = alphabet[(v >> 12) & 0x3F];
+    if (size > 1)
+        out[2] = alphabet[(v >> 6) & 0x3F];
+
+    // 无填充时只写入size + 1个字符, 与base64_encoded_size()一致
+    if (flags & base64_nopad)
+        return size + 1;
+
+    if (size == 1)
+        out[2] = '=';
+    out[3] = '=';
+
+    return 4;
+}
+
+inline size_t _base64_line_break(char* out, int flags)
+{
+    if (flags & base64_wrap_lf)
+    {
+        out[0] = '\n';
+        return 1;
+    }
+
+    out[0] = '\r';
+    out[1] = '\n';
+    return 2;
+}
+
+// 解码的状态, 可以在任意位置中断并继续
+struct _base64_decode_state
+{
+    uint32_t& quad;
+    int&      count;
+    int&      padding;
+
+    // 返回false 表示遇到无效的数据, in 指向出错的位置
+    bool run(uint8_t*& out, const char*& in, const char* end, bool url)
+    {
+        const uint8_t* table = _base64_table(url);
+        const _base64_kernels& kernels = _base64_select();
+
+        while (in < end)
+        {
+            // 在4字符组的边界上尝试向量化的实现
+            if (count == 0 && padding == 0 && kernels.decode)
+            {
+                size_t done = kernels.decode(out, in, size_t(end - in), url);
+                in  += done;
+                out += done / 4 * 3;
+
+                if (in >= end)
+                    break;
+            }
+
+            // 逐个字符处理, 直到回到组的边界
+            do
+            {
+                uint8_t v = table[uint8_t(*in)];
+                if (v < 64)
+                {
+                    if (padding > 0)
+                        return false;
+
+                    quad = quad << 6 | v;
+                    if (++count == 4)
+                    {
+                        out[0] = uint8_t(quad >> 16);
+                        out[1] = uint8_t(quad >> 8);
+                        out[2] = uint8_t(quad);
+                        out += 3;
+                        quad = 0;
+                        count = 0;
+                    }
+                }
+                else if (v == _base64_pad)
+                {
+                    // 至少需要2个有效字符, 完整的组之后不能再出现'='
+                    if (count < 2)
+                        return false;
+
+                    if (count + ++padding == 4)
+                        flush(out);
+                }
+                else if (v != _base64_space)
+                {
+                    return false;
+                }
+
+                ++in;
+            }
+            while (in < end && count != 0);
+        }
+
+        return true;
+    }
+
+    // 输出不完整的组
+    void flush(uint8_t*& out)
+    {
+        quad <<= 6 * (4 - count);
+        out[0] = uint8_t(quad >> 16);
+        if (count == 3)
+            out[1] = uint8_t(quad >> 8);
+
+        out += count - 1;
+        quad = 0;
+        count = 0;
+    }
+};
+
+} // detail
+
+size_t base64_encoded_size(size_t size, int flags/* = base64_default*/)
+{
+    size_t chars = (flags & base64_nopad) ?
+        size / 3 * 4 + (size % 3 ? size % 3 + 1 : 0) : (size + 2) / 3 * 4;
+
+    if ((flags & base64_mime) && chars > 0)
+        chars += (chars - 1) / detail::_base64_line_chars * ((flags & base64_wrap_lf) ? 1 : 2);
+
+    return chars;
+}
+
+size_t base64_decoded_size(size_t size)
+{
+    return (size + 3) / 4 * 3;
+}
+
+size_t base64_encode(char* out, const void* data, size_t size, int flags/* = base64_default*/)
+{
+    const uint8_t* in   = static_cast<const uint8_t*>(data);
+    char*          dest = out;
+    bool           url  = (flags & base64_url) != 0;
+
+    if (flags & base64_mime)
+    {
+        for (; size > detail::_base64_line_bytes; size -= detail::_base64_line_bytes)
+        {
+            dest += detail::_base64_encode_groups(dest, in, detail::_base64_line_bytes, url);
+            dest += detail::_base64_line_break(dest, flags);
+            in   += detail::_base64_line_bytes;
+        }
+    }
+
+    size_t groups = size / 3 * 3;
+    dest += detail::_base64_encode_groups(dest, in, groups, url);
+    dest += detail::_base64_encode_tail(dest, in + groups, size - groups, flags);
+
+    return size_t(dest - out);
+}
+
+bool base64_decode(
+    void* out, size_t& out_size, const char* data, size_t size, int flags/* = base64_default*/)
+{
+    uint32_t quad = 0;
+    int      count = 0, padding = 0;
+    uint8_t* dest = static_cast<uint8_t*>(out);
+
+    detail::_base64_decode_state state = { quad, count, padding };
+    bool result = state.run(dest, data, data + size, (flags & base64_url) != 0);
+
+    // 缺少填充的最后一组
+    if (result && count > 0)
+    {
+        if (count == 1 || padding > 0)
+            result = false;
+        else
+            state.flush(dest);
+    }
+
+    out_size = size_t(dest - static_cast<uint8_t*>(out));
+    return result;
+}
+
+/// base64_encoder
+
+base64_encoder::base64_encoder(int flags/* = base64_default*/)
+    : _flags(flags)
+    , _pending_size(0)
+    , _column(0)
+{
+}
+
+void base64_encoder::update(const void* data, size_t size, std::string& out)
+{
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+
+    if (_pending_size > 0)
+    {
+        size_t fill = std::min<size_t>(3 - _pending_size, size);
+        std::memcpy(_pending + _pending_size, in, fill);
+        _pending_size += fill;
+        in   += fill;
+        size -= fill;
+
+        if (_pending_size < 3)
+            return;
+
+        _append(_pending, 3, out);
+        _pending_size = 0;
+    }
+
+    size_t groups = size / 3 * 3;
+    _append(in, groups, out);
+
+    _pending_size = size - groups;
+    std::memcpy(_pending, in + groups, _pending_size);
+}
+
+void base64_encoder::finalize(std::string& out)
+{
+    if (_pending_size > 0)
+    {
+        char tail[4];
+        size_t n = detail::_base64_encode_tail(tail, _pending, _pending_size, _flags);
+
+        if ((_flags & base64_mime) && _column == detail::_base64_line_chars)
+            out += (_flags & base64_wrap_lf) ? "\n" : "\r\n";
+
+        out.append(tail, n);
+    }
+
+    _pending_size = 0;
+    _column = 0;
+}
+
+void base64_encoder::_append(const uint8_t* data, size_t size, std::string& out)
+{
+    bool url = (_flags & base64_url) != 0;
+
+    if (!(_flags & base64_mime))
+    {
+        size_t offset = out.size();
+        out.resize(offset + size / 3 * 4);
+        detail::_base64_encode_groups(&out[offset], data, size, url);
+        return;
+    }
+
+    // 换行在下一行开始输出时才写入, 与一次性编码的结果保持一致
+    out.reserve(out.size() + base64_encoded_size(size, _flags) + 2);
+    while (size > 0)
+    {
+        if (_column == detail::_base64_line_chars)
+        {
+            out += (_flags & base64_wrap_lf) ? "\n" : "\r\n";
+            _column = 0;
+        }
+
+        size_t bytes  = std::min<size_t>(size, (detail::_base64_line_chars - _column) / 4 * 3);
+        size_t offset = out.size();
+        out.resize(offset + bytes / 3 * 4);
+        detail::_base64_encode_groups(&out[offset], data, bytes, url);
+
+        _column += bytes / 3 * 4;
+        data    += bytes;
+        size    -= bytes;
+    }
+}
+
+/// base64_decoder
+
+base64_decoder::base64_decoder(int flags/* = base64_default*/)
+    : _flags(flags)
+    , _quad(0)
+    , _count(0)
+    , _padding(0)
+    , _failed(false)
+{
+}
+
+bool base64_decoder::update(const char* data, size_t size, bytedata& out)
+{
+    if (_failed)
+        return false;
+
+    // 向量化的实现可能会多写入最多8字节
+    size_t offset = out.size();
+    out.resize(offset + base64_decoded_size(size) + 8);
+
+    uint8_t* dest = reinterpret_cast<uint8_t*>(&out[offset]);
+    detail::_base64_decode_state state = { _quad, _count, _padding };
+    _failed = !state.run(dest, data, data + size, (_flags & base64_url) != 0);
+
+    out.resize(size_t(reinterpret_cast<char*>(dest) - &out[0]));
+    return !_failed;
+}
+
+bool base64_decoder::finalize(bytedata& out)
+{
+    bool result = !_failed;
+    if (result && _count > 0)
+    {
+        if (_count == 1 || _padding > 0)
+        {
+            result = false;
+        }
+        else
+        {
+            uint8_t tail[3];
+            uint8_t* dest = tail;
+            detail::_base64_decode_state state = { _quad, _count, _padding };
+            state.flush(dest);
+            out.append(reinterpret_cast<char*>(tail), size_t(dest - tail));
+        }
+    }
+
+    _quad = 0;
+    _count = 0;
+    _padding = 0;
+    _failed = false;
+    return result;
+}
+
+} // util
@@ -12,6 +12,8 @@
 #include <vector>
 #include <iterator>
 #include <boost/filesystem.hpp>
+#include "../base64.h"
+#include "../hex.h"
 
 namespace util {
 namespace detail {
@@ -32,138 +34,177 @@ inline bool _hex_from_character(char ch, char& hex)
     return true;
 }
 
-// base64 支持
-#include "base64.hpp"
-
 } // detail
 
-void bytes_into_memory(void* address, int length, const bytedata& bytes)
+void bytes_into_memory(void* address, int length, bytes_view bytes)
 {
+    if (length < 0 || bytes.size() > static_cast<size_t>(length))
+        throw std::runtime_error("The memory is too small to hold the bytes.");
+
 #if OS_WIN
-    ::memcpy_s(address, length, &bytes[0], bytes.size());
+    ::memcpy_s(address, length, bytes.data(), bytes.size());
 #else
-    memcpy(address, &bytes[0], bytes.size());
+    memcpy(address, bytes.data(), bytes.size());
 #endif
 }
 
 std::string bytes_into_hex(
-    const bytedata& bytes, 
+    bytes_view bytes, 
     const std::string& separator/* = ""*/, 
     const int percount/* = 1*/)
 {
-    std::string result;
-    const char _hex[] = "0123456789abcdef";
+    size_t group = static_cast<size_t>(std::max(percount, 1));
+    std::string result(hex_encoded_size(bytes.size(), separator.size(), group), '\0');
 
-    for (size_t i = 0; i < bytes.size(); ++i)
-    {
-        result.append(1, _hex[(bytes.at(i) >> 4) & 0x0f]);
-        result.append(1, _hex[bytes.at(i) & 0x0f]);
-
-        if ((i + 1) < bytes.size() && i % percount == 0)
-            result += separator;
-    }
+    if (!result.empty())
+        hex_encode(&result[0], bytes.data(), bytes.size(), separator, group);
 
     return result;
 }
 
 bytedata bytes_from_hex(const std::string& hex)
 {
-    std::vector<char> hex_array;
-
     // 若存在0x, 则跳过
-    int pos = 0;
+    size_t pos = 0;
     if (hex.size() > 2)
     {
         if (hex[0] == '0' && hex[1] == 'x')
             pos = 2;
     }
 
-    for (size_t i = pos; i < hex.size(); ++i)
+    bytedata result((hex.size() - pos) / 2, '\0');
+    if (result.empty())
+        return result;
+
+    // 大多数情况下不含分隔符, 可以直接严格地解码
+    size_t size = 0;
+    if (hex_decode(&result[0], size, hex.data() + pos, hex.size() - pos))
+        return result;
+
+    // 否则从出错的字符对开始逐个跳过非十六进制的字符, 不成对的最后一个字符被忽略
+    char hi = -1;
+    for (size_t i = pos + size * 2; i < hex.size(); ++i)
     {
-        char h = 0, ch = hex[i];
-        if (detail::_hex_from_character(ch, h))
-            hex_array.push_back(h);
+        char h = 0;
+        if (!detail::_hex_from_character(hex[i], h))
+            continue;
+
+        if (hi < 0)
+        {
+            hi = h;
+        }
+        else
+        {
+            result[size++] = char(hi << 4 | h);
+            hi = -1;
+        }
     }
 
-    bytedata result;
-    for (size_t i = 0; i < hex_array.size(); i += 2)
-        result.append(1, char(hex_array[i] << 4) | hex_array[i + 1]);
-
+    result.resize(size);
     return result;
 }
 
 bytedata& bytes_from_file(
-    bytedata& bytes, const util::fpath& name, int offset/* = 0*/, int length/* = -1*/)
+    bytedata& bytes, const util::fpath& name, fsize offset/* = 0*/, fsize length/* = fsize(-1)*/, int flags/* = fstream_default*/)
 {
+    if (flags != fstream_default)
+    {
+        bytes.clear();
+        util::file_read_stream(name, [&](const void* data, size_t size) {
+            bytes.append(static_cast<const char*>(data), size);
+            return true;
+        }, offset, length, flags);
+
+        return bytes;
+    }
+
     util::ffile  file = util::file_open(name, O_RDONLY);
     util::fsize  size = util::file_size(file);
 
-    if (-1 == length)
-        length = static_cast<int>(size - offset);
-
-    if (size == 0 && (offset + length) > size)
+    if (offset > size || (length != fsize(-1) && length > size - offset))
         throw std::runtime_error("The file too short or param invalid.");
 
-    if (offset != 0)
-        util::file_seek(file, offset);
+    if (length == fsize(-1))
+        length = size - offset;
 
-    if (length > 0x3200000) // 50MB
-        throw std::runtime_error("A single read cannot be greater than 50MB");
+    if (length > bytes.max_size())
+        throw std::runtime_error("The range is too large to be read into memory.");
 
-    if (size > 0)
-    {
-        bytes.resize(length);
-        util::file_read(file, &bytes[0], static_cast<int>(bytes.size()));
-    }
+    bytes.resize(static_cast<size_t>(length));
+    if (length > 0)
+        util::file_pread(file, &bytes[0], length, offset);
 
     return bytes;
 }
 
-void bytes_into_file(const util::fpath& name, const bytedata& bytes)
+fsize bytes_from_file(
+    const util::fpath& name, const bytes_sink& sink, fsize offset/* = 0*/, fsize length/* = fsize(-1)*/, int flags/* = fstream_default*/)
+{
+    return util::file_read_stream(name, [&](const void* data, size_t size) {
+        return sink(bytes_view(data, size));
+    }, offset, length, flags);
+}
+
+namespace detail {
+
+inline boost::filesystem::path _bytes_file_prepare(const util::fpath& name)
 {
     auto filename = boost::filesystem::absolute(name.wstring());
     if (!util::file_exist(filename.parent_path()))
         util::directories_create(filename.parent_path());
 
+    return filename;
+}
+
+} // detail
+
+void bytes_into_file(const util::fpath& name, bytes_view bytes)
+{
+    auto filename = detail::_bytes_file_prepare(name);
+
     util::ffile file = util::file_open(filename, O_CREAT | O_TRUNC | O_WRONLY);
-    util::file_write(file, bytes.data(), static_cast<int>(bytes.size()));
+    util::file_write(file, bytes.data(), bytes.size());
 }
 
-std::string& bytes_into_base64(
-    std::string& base64, const bytedata& bytes, bool noline/* = true*/)
+fsize bytes_into_file(const util::fpath& name, const fsource& source, int flags/* = fstream_default*/)
 {
-    base64.clear();
+    return util::file_write_stream(detail::_bytes_file_prepare(name), source, flags);
+}
 
-    std::insert_iterator<std::string> ii(base64, base64.begin());
-    detail::base64<char> b64;
-    int state = 0;
+void bytes_into_file_atomic(const util::fpath& name, bytes_view bytes, int policy/* = fsync_data*/)
+{
+    util::file_write_atomic(detail::_bytes_file_prepare(name), bytes.data(), bytes.size(), policy);
+}
 
-    if (noline)
-    {
-        b64.put(bytes.begin(), bytes.end(), ii, state, detail::base64<>::noline());
-    }
-    else
+std::string& bytes_into_base64(
+    std::string& base64, bytes_view bytes, bool noline/* = true*/)
+{
+    int flags = base64_default;
+    if (!noline)
     {
 #if defined(OS_WIN)
-        b64.put(bytes.begin(), bytes.end(), ii, state, detail::base64<>::crlf());
+        flags = base64_mime;
 #else
-        b64.put(bytes.begin(), bytes.end(), ii, state, detail::base64<>::lf());
+        flags = base64_mime | base64_wrap_lf;
 #endif
     }
 
+    base64.resize(base64_encoded_size(bytes.size(), flags));
+    if (!base64.empty())
+        base64_encode(&base64[0], bytes.data(), bytes.size(), flags);
+
     return base64;
 }
 
 bytedata& bytes_from_base64(
     bytedata& bytes, const std::string& base64)
 {
-    bytes.clear();
-
-    std::insert_iterator<std::string> ii(bytes, bytes.begin());
-    detail::base64<char> b64;
-    int state = 0;
-    b64.get(base64.begin(), base64.end(), ii, state);
+    size_t size = 0;
+    bytes.resize(base64_decoded_size(base64.size()));
+    if (!bytes.empty())
+        base64_decode(&bytes[0], size, base64.data(), base64.size());
 
+    bytes.resize(size);
     return bytes;
 }
 
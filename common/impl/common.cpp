@@ -14,8 +14,11 @@
 #include "unit.ipp"
 #include "version.ipp"
 #include "bytedata.ipp"
+#include "base64.ipp"
+#include "hex.ipp"
 #include "math_util.ipp"
 #include "encryption.ipp"
+#include "hasher.ipp"
 #include "acronym_for_pinyin.ipp"
 
 #if UTILITY_SUPPORT_BOOST
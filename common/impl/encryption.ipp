@@ -14,6 +14,14 @@ namespace detail {
 
 /// TEA(Tiny Encryption Algorithm)
 
+// 取密钥的前128位, 不足的以0填充
+inline void _tea32_key(uint32_t k[4], bytes_view key)
+{
+    std::memset(k, 0, 16);
+    if (!key.empty())
+        std::memcpy(k, key.data(), std::min<size_t>(key.size(), 16));
+}
+
 inline void _encrypt_with_tea32(
     uint32_t* t, uint32_t *s, const uint32_t * k)
 {
@@ -48,9 +56,20 @@ inline void _decrypt_with_tea32(
     t[1] = z;
 }
 
+// 以memcpy 读写64位的块, 避免通过uint32_t* 访问uint64_t 或char 数组而违反严格别名规则
+inline void _tea32_load(uint32_t v[2], const void* p)
+{
+    std::memcpy(v, p, 8);
+}
+
+inline void _tea32_store(void* p, const uint32_t v[2])
+{
+    std::memcpy(p, v, 8);
+}
+
 } // detail
 
-bytedata& encrypt_with_tea32(bytedata& bytes, const bytedata& key)
+bytedata& encrypt_with_tea32(bytedata& bytes, bytes_view key)
 {
     uint64_t origin =  bytes.size();
     uint64_t length = (bytes.size() + 7) & (~7);
@@ -60,55 +79,52 @@ bytedata& encrypt_with_tea32(bytedata& bytes, const bytedata& key)
     else
         bytes.append(8u, 0);
 
-    bytedata password = key;
-    if (password.size() < 16u)
-        password.append(16u - password.size(), 0);
+    uint32_t password[4];
+    detail::_tea32_key(password, key);
 
-    uint64_t now  = origin;
-    uint64_t next = *reinterpret_cast<uint64_t*>(&bytes[0]);
+    uint32_t now[2], next[2];
+    detail::_tea32_load(now, &origin);
+    detail::_tea32_load(next, &bytes[0]);
 
     for (size_t i = 0; i < bytes.size(); i += 8)
     {
-        detail::_encrypt_with_tea32(
-            reinterpret_cast<uint32_t*>(&bytes[i]), 
-            reinterpret_cast<uint32_t*>(&now), 
-            reinterpret_cast<const uint32_t*>(password.data()));
+        uint32_t block[2];
+        detail::_encrypt_with_tea32(block, now, password);
+        detail::_tea32_store(&bytes[i], block);
 
         if(i + 8 < bytes.size())
         {
-            now = next;
-            next = *reinterpret_cast<uint64_t*>(&bytes[i + 8]);
+            std::memcpy(now, next, sizeof(now));
+            detail::_tea32_load(next, &bytes[i + 8]);
         }
     }
 
     return bytes;
 }
 
-bytedata& decrypt_with_tea32(bytedata& bytes, const bytedata& key)
+bytedata& decrypt_with_tea32(bytedata& bytes, bytes_view key)
 {
     uint64_t length = (bytes.size() + 7) & (~7);
 
     if (length != bytes.size())
         throw std::runtime_error("The length of the decrypted data is incorrect.");
 
-    bytedata password = key;
-    if (password.size() < 16u)
-        password.append(16u - password.size(), 0);
+    uint32_t password[4];
+    detail::_tea32_key(password, key);
 
-    detail::_decrypt_with_tea32(
-        reinterpret_cast<uint32_t*>(&length),
-        reinterpret_cast<uint32_t*>(&bytes[0]),
-        reinterpret_cast<const uint32_t*>(password.data()));
+    uint32_t block[2];
+    detail::_tea32_load(block, &bytes[0]);
+    detail::_decrypt_with_tea32(block, block, password);
+    detail::_tea32_store(&length, block);
 
     if(bytes.size() - 8 < length)
         throw std::runtime_error("The decrypted data is incorrect.");
 
     for (size_t i = 0; i < bytes.size() - 8; i += 8)
     {
-        detail::_decrypt_with_tea32(
-            reinterpret_cast<uint32_t*>(&bytes[i]),
-            reinterpret_cast<uint32_t*>(&bytes[i+8]),
-            reinterpret_cast<const uint32_t*>(password.data()));
+        detail::_tea32_load(block, &bytes[i + 8]);
+        detail::_decrypt_with_tea32(block, block, password);
+        detail::_tea32_store(&bytes[i], block);
     }
 
     bytes.resize(static_cast<size_t>(length));
@@ -0,0 +1,340 @@
+/*
+*   hasher.ipp
+*
+*   v0.1 2023-06 by GuoJH
+*/
+
+#ifdef UTILITY_DISABLE_HEADONLY
+#   include "../hasher.h"
+#endif
+
+#include "hasher_kernels.hpp"
+
+namespace util {
+
+/// md5_hasher
+
+md5_hasher::md5_hasher()
+{
+    _reset();
+}
+
+const char* md5_hasher::backend() const
+{
+    return "scalar";
+}
+
+void md5_hasher::_update(const uint8_t* data, size_t size)
+{
+    detail::_hash_md_update(detail::_md5_compress_scalar, _state, _buffer, _length, data, size);
+}
+
+void md5_hasher::_finalize(uint8_t* digest)
+{
+    detail::_hash_md_finalize(detail::_md5_compress_scalar, _state, _buffer, _length, false);
+
+    for (int i = 0; i < 4; ++i)
+        detail::_hash_store_le32(digest + i * 4, _state[i]);
+}
+
+void md5_hasher::_reset()
+{
+    _state[0] = 0x67452301;
+    _state[1] = 0xefcdab89;
+    _state[2] = 0x98badcfe;
+    _state[3] = 0x10325476;
+    _length   = 0;
+}
+
+/// sha1_hasher
+
+sha1_hasher::sha1_hasher()
+{
+    _reset();
+}
+
+const char* sha1_hasher::backend() const
+{
+    return detail::_sha1_backend().name;
+}
+
+void sha1_hasher::_update(const uint8_t* data, size_t size)
+{
+    detail::_hash_md_update(detail::_sha1_backend().compress, _state, _buffer, _length, data, size);
+}
+
+void sha1_hasher::_finalize(uint8_t* digest)
+{
+    detail::_hash_md_finalize(detail::_sha1_backend().compress, _state, _buffer, _length, true);
+
+    for (int i = 0; i < 5; ++i)
+        detail::_hash_store_be32(digest + i * 4, _state[i]);
+}
+
+void sha1_hasher::_reset()
+{
+    _state[0] = 0x67452301;
+    _state[1] = 0xefcdab89;
+    _state[2] = 0x98badcfe;
+    _state[3] = 0x10325476;
+    _state[4] = 0xc3d2e1f0;
+    _length   = 0;
+}
+
+/// sha256_hasher
+
+sha256_hasher::sha256_hasher()
+{
+    _reset();
+}
+
+const char* sha256_hasher::backend() const
+{
+    return detail::_sha256_backend().name;
+}
+
+void sha256_hasher::_update(const uint8_t* data, size_t size)
+{
+    detail::_hash_md_update(detail::_sha256_backend().compress, _state, _buffer, _length, data, size);
+}
+
+void sha256_hasher::_finalize(uint8_t* digest)
+{
+    detail::_hash_md_finalize(detail::_sha256_backend().compress, _state, _buffer, _length, true);
+
+    for (int i = 0; i < 8; ++i)
+        detail::_hash_store_be32(digest + i * 4, _state[i]);
+}
+
+void sha256_hasher::_reset()
+{
+    std::memcpy(_state, detail::_sha256_iv(), sizeof(_state));
+    _length = 0;
+}
+
+/// crc32c_hasher
+
+crc32c_hasher::crc32c_hasher()
+{
+    _reset();
+}
+
+const char* crc32c_hasher::backend() const
+{
+    return detail::_crc32c_select().name;
+}
+
+void crc32c_hasher::_update(const uint8_t* data, size_t size)
+{
+    _crc = detail::_crc32c_select().update(_crc, data, size);
+}
+
+void crc32c_hasher::_finalize(uint8_t* digest)
+{
+    detail::_hash_store_be32(digest, value());
+}
+
+void crc32c_hasher::_reset()
+{
+    _crc = 0xFFFFFFFF;
+}
+
+/// blake3_hasher
+
+blake3_hasher::blake3_hasher()
+{
+    _reset();
+}
+
+const char* blake3_hasher::backend() const
+{
+    return "scalar";
+}
+
+void blake3_hasher::_update(const uint8_t* data, size_t size)
+{
+    uint32_t out[16];
+
+    while (size > 0)
+    {
+        // 当前块已满且仍有输入, 则该块不是最后一块, 可以结束并合并到树中
+        if (_blocks_compressed == 15 && _block_len == 64)
+        {
+            detail::_blake3_compress(_chunk_cv, _block, _chunk_counter, 64, detail::_blake3_chunk_end, out);
+            _push_chunk(out, ++_chunk_counter);
+
+            std::memcpy(_chunk_cv, detail::_sha256_iv(), sizeof(_chunk_cv));
+            _block_len = 0;
+            _blocks_compressed = 0;
+        }
+
+        if (_block_len == 64)
+        {
+            uint32_t flags = _blocks_compressed == 0 ? detail::_blake3_chunk_start : 0;
+            detail::_blake3_compress(_chunk_cv, _block, _chunk_counter, 64, flags, out);
+            std::memcpy(_chunk_cv, out, sizeof(_chunk_cv));
+            _block_len = 0;
+            ++_blocks_compressed;
+        }
+
+        // 不是块内最后一块的完整输入块直接计算, 不复制
+        while (_block_len == 0 && size > 64 && _blocks_compressed < 15)
+        {
+            uint32_t flags = _blocks_compressed == 0 ? detail::_blake3_chunk_start : 0;
+            detail::_blake3_compress(_chunk_cv, data, _chunk_counter, 64, flags, out);
+            std::memcpy(_chunk_cv, out, sizeof(_chunk_cv));
+            ++_blocks_compressed;
+            data += 64;
+            size -= 64;
+        }
+
+        size_t take = std::min<size_t>(64 - _block_len, size);
+        std::memcpy(_block + _block_len, data, take);
+        _block_len += uint32_t(take);
+        data += take;
+        size -= take;
+    }
+}
+
+void blake3_hasher::_push_chunk(const uint32_t cv[8], uint64_t total_chunks)
+{
+    uint32_t merged[8];
+    std::memcpy(merged, cv, sizeof(merged));
+
+    // 完整的子树数目与 total_chunks 二进制末尾的0个数相同
+    for (; (total_chunks & 1) == 0; total_chunks >>= 1)
+        detail::_blake3_parent_cv(_cv_stack[--_cv_stack_len], merged, 0, merged);
+
+    std::memcpy(_cv_stack[_cv_stack_len++], merged, sizeof(merged));
+}
+
+void blake3_hasher::_finalize(uint8_t* digest)
+{
+    // 输出节点: 初始为当前块的最后一个分组, 然后依次与栈中的子树合并
+    uint32_t cv[8];
+    uint8_t  block[64];
+    uint32_t block_len = _block_len;
+    uint32_t flags = detail::_blake3_chunk_end | (_blocks_compressed == 0 ? detail::_blake3_chunk_start : 0);
+    uint64_t counter = _chunk_counter;
+
+    std::memcpy(cv, _chunk_cv, sizeof(cv));
+    std::memcpy(block, _block, _block_len);
+    std::memset(block + _block_len, 0, 64 - _block_len);
+
+    uint32_t out[16];
+    for (uint32_t n = _cv_stack_len; n > 0; --n)
+    {
+        detail::_blake3_compress(cv, block, counter, block_len, flags, out);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            detail::_hash_store_le32(block + i * 4, _cv_stack[n - 1][i]);
+            detail::_hash_store_le32(block + 32 + i * 4, out[i]);
+        }
+
+        std::memcpy(cv, detail::_sha256_iv(), sizeof(cv));
+        block_len = 64;
+        flags = detail::_blake3_parent;
+        counter = 0;
+    }
+
+    detail::_blake3_compress(cv, block, counter, block_len, flags | detail::_blake3_root, out);
+
+    for (int i = 0; i < 8; ++i)
+        detail::_hash_store_le32(digest + i * 4, out[i]);
+}
+
+void blake3_hasher::_reset()
+{
+    std::memcpy(_chunk_cv, detail::_sha256_iv(), sizeof(_chunk_cv));
+    _chunk_counter = 0;
+    _block_len = 0;
+    _blocks_compressed = 0;
+    _cv_stack_len = 0;
+}
+
+/// factory
+
+std::unique_ptr<hasher> hasher_create(int algorithm)
+{
+    switch (algorithm)
+    {
+    case hash_md5:    return std::unique_ptr<hasher>(new md5_hasher());
+    case hash_sha1:   return std::unique_ptr<hasher>(new sha1_hasher());
+    case hash_sha256: return std::unique_ptr<hasher>(new sha256_hasher());
+    case hash_crc32c: return std::unique_ptr<hasher>(new crc32c_hasher());
+    case hash_blake3: return std::unique_ptr<hasher>(new blake3_hasher());
+    default:
+        return nullptr;
+    }
+}
+
+void sha256_digest_many(const void* const* datas, const size_t* sizes, size_t count, uint8_t* digests)
+{
+    const detail::_hash_backend& backend = detail::_sha256_backend();
+
+    auto finish = [&](uint32_t* state, uint64_t length, const uint8_t* data, size_t size, uint8_t* digest)
+    {
+        uint8_t buffer[64];
+        detail::_hash_md_update(backend.compress, state, buffer, length, data, size);
+        detail::_hash_md_finalize(backend.compress, state, buffer, length, true);
+
+        for (int i = 0; i < 8; ++i)
+            detail::_hash_store_be32(digest + i * 4, state[i]);
+    };
+
+    bool multi_buffer = false;
+#if defined(UTILITY_HASHER_X86)
+    // SHA-NI 的单路性能已高于AVX2 的8路
+    multi_buffer = count > 1 && backend.compress == detail::_sha256_compress_scalar && detail::_hash_cpu().has_avx2();
+#endif
+
+    if (!multi_buffer)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t state[8];
+            std::memcpy(state, detail::_sha256_iv(), sizeof(state));
+            finish(state, 0, static_cast<const uint8_t*>(datas[i]), sizes[i], digests + i * 32);
+        }
+        return;
+    }
+
+#if defined(UTILITY_HASHER_X86)
+    // 按长度排序, 使同组各路的公共块数尽可能多
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) { return sizes[l] < sizes[r]; });
+
+    for (size_t group = 0; group < count; group += 8)
+    {
+        size_t lanes = std::min<size_t>(8, count - group);
+
+        // 不足8路时, 以最后一路填充
+        const uint8_t* ptrs[8];
+        size_t blocks = sizes[order[group]] / 64;
+        for (size_t n = 0; n < 8; ++n)
+            ptrs[n] = static_cast<const uint8_t*>(datas[order[group + std::min(n, lanes - 1)]]);
+
+        uint32_t state[8][8];
+        for (int i = 0; i < 8; ++i)
+            std::fill(state[i], state[i] + 8, detail::_sha256_iv()[i]);
+
+        if (blocks > 0)
+            detail::_sha256_compress_x8_avx2(state, ptrs, blocks);
+
+        // 剩余部分逐路完成
+        for (size_t n = 0; n < lanes; ++n)
+        {
+            size_t   index = order[group + n];
+            uint32_t lane_state[8];
+            for (int i = 0; i < 8; ++i)
+                lane_state[i] = state[i][n];
+
+            finish(lane_state, blocks * 64, ptrs[n] + blocks * 64, sizes[index] - blocks * 64, digests + index * 32);
+        }
+    }
+#endif
+}
+
+} // util
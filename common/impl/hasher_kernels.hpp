@@ -0,0 +1,826 @@
+/*
+*   hasher_kernels.hpp
+*
+*   v0.1 2023-06 by GuoJH
+*/
+
+#ifndef hasher_kernels_h__
+#define hasher_kernels_h__
+
+#include <cstring>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <platform/cpu.h>
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#   if defined(COMPILER_MSVC)
+#       include <intrin.h>
+#   endif
+#   include <immintrin.h>
+#   define UTILITY_HASHER_X86 1
+#endif
+
+// ARMv8 的实现需要编译器启用对应的扩展(如: -march=armv8-a+crc+crypto), 运行时再通过 util::cpu 确认
+#if defined(ARCH_CPU_ARM_FAMILY)
+#   if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2)
+#       include <arm_neon.h>
+#       define UTILITY_HASHER_ARM_SHA 1
+#   endif
+#   if defined(__ARM_FEATURE_CRC32)
+#       include <arm_acle.h>
+#       define UTILITY_HASHER_ARM_CRC32 1
+#   endif
+#endif
+
+namespace util {
+namespace detail {
+
+inline uint32_t _hash_rotl32(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+inline uint32_t _hash_rotr32(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+inline uint32_t _hash_load_be32(const uint8_t* p)
+{
+    return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | uint32_t(p[3]);
+}
+
+inline uint32_t _hash_load_le32(const uint8_t* p)
+{
+    return uint32_t(p[3]) << 24 | uint32_t(p[2]) << 16 | uint32_t(p[1]) << 8 | uint32_t(p[0]);
+}
+
+inline void _hash_store_be32(uint8_t* p, uint32_t v)
+{
+    p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16); p[2] = uint8_t(v >> 8); p[3] = uint8_t(v);
+}
+
+inline void _hash_store_le32(uint8_t* p, uint32_t v)
+{
+    p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); p[2] = uint8_t(v >> 16); p[3] = uint8_t(v >> 24);
+}
+
+// 处理若干个完整的64字节块
+typedef void (*_hash_compress_func)(uint32_t* state, const uint8_t* blocks, size_t count);
+
+struct _hash_backend
+{
+    _hash_compress_func compress;
+    const char*         name;
+};
+
+// MD5/SHA-1/SHA-256 共用的Merkle–Damgård 缓冲逻辑
+inline void _hash_md_update(
+    _hash_compress_func compress,
+    uint32_t* state, uint8_t* buffer, uint64_t& length, const uint8_t* data, size_t size)
+{
+    size_t used = size_t(length & 63);
+    length += size;
+
+    if (used > 0)
+    {
+        size_t fill = 64 - used;
+        if (size < fill)
+        {
+            std::memcpy(buffer + used, data, size);
+            return;
+        }
+
+        std::memcpy(buffer + used, data, fill);
+        compress(state, buffer, 1);
+        data += fill;
+        size -= fill;
+    }
+
+    // 完整的块直接在输入上计算, 不复制
+    if (size >= 64)
+    {
+        compress(state, data, size / 64);
+        data += size & ~size_t(63);
+        size &= 63;
+    }
+
+    if (size > 0)
+        std::memcpy(buffer, data, size);
+}
+
+inline void _hash_md_finalize(
+    _hash_compress_func compress,
+    uint32_t* state, uint8_t* buffer, uint64_t length, bool big_endian)
+{
+    size_t used = size_t(length & 63);
+    buffer[used++] = 0x80;
+
+    if (used > 56)
+    {
+        std::memset(buffer + used, 0, 64 - used);
+        compress(state, buffer, 1);
+        used = 0;
+    }
+
+    std::memset(buffer + used, 0, 56 - used);
+
+    uint64_t bits = length * 8;
+    for (int i = 0; i < 8; ++i)
+        buffer[big_endian ? 63 - i : 56 + i] = uint8_t(bits >> (8 * i));
+
+    compress(state, buffer, 1);
+}
+
+/// MD5
+
+inline void _md5_compress_scalar(uint32_t* state, const uint8_t* blocks, size_t count)
+{
+    static const uint32_t k[64] = {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+        0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+        0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+        0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+        0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+        0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+        0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+        0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+    };
+    static const int s[4][4] = { { 7, 12, 17, 22 }, { 5, 9, 14, 20 }, { 4, 11, 16, 23 }, { 6, 10, 15, 21 } };
+
+    for (; count > 0; --count, blocks += 64)
+    {
+        uint32_t m[16];
+        for (int i = 0; i < 16; ++i)
+            m[i] = _hash_load_le32(blocks + i * 4);
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+
+#define UTILITY_MD5_STEP(f, g, i, r)                                    \
+        {                                                               \
+            uint32_t t = a + (f) + k[i] + m[g];                         \
+            a = d; d = c; c = b;                                        \
+            b = b + _hash_rotl32(t, s[r][i & 3]);                       \
+        }
+
+        for (int i = 0;  i < 16; ++i) UTILITY_MD5_STEP(d ^ (b & (c ^ d)), i, i, 0)
+        for (int i = 16; i < 32; ++i) UTILITY_MD5_STEP(c ^ (d & (b ^ c)), (5 * i + 1) & 15, i, 1)
+        for (int i = 32; i < 48; ++i) UTILITY_MD5_STEP(b ^ c ^ d, (3 * i + 5) & 15, i, 2)
+        for (int i = 48; i < 64; ++i) UTILITY_MD5_STEP(c ^ (b | ~d), (7 * i) & 15, i, 3)
+
+#undef UTILITY_MD5_STEP
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    }
+}
+
+/// SHA-1
+
+inline void _sha1_compress_scalar(uint32_t* state, const uint8_t* blocks, size_t count)
+{
+    for (; count > 0; --count, blocks += 64)
+    {
+        // 消息扩展在16个字的环形缓冲上进行
+        uint32_t w[16];
+        for (int i = 0; i < 16; ++i)
+            w[i] = _hash_load_be32(blocks + i * 4);
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+        // 通过轮换参数代替变量的交换
+#define UTILITY_SHA1_STEP(v, x, y, z, u, i, f, k)                                                       \
+        {                                                                                               \
+            if ((i) >= 16)                                                                              \
+                w[(i) & 15] = _hash_rotl32(w[((i) + 13) & 15] ^ w[((i) + 8) & 15] ^ w[((i) + 2) & 15] ^ w[(i) & 15], 1); \
+            u += _hash_rotl32(v, 5) + f(x, y, z) + (k) + w[(i) & 15];                                   \
+            x = _hash_rotl32(x, 30);                                                                    \
+        }
+
+#define UTILITY_SHA1_STEP5(i, f, k)                             \
+        UTILITY_SHA1_STEP(a, b, c, d, e, (i),     f, k)         \
+        UTILITY_SHA1_STEP(e, a, b, c, d, (i) + 1, f, k)         \
+        UTILITY_SHA1_STEP(d, e, a, b, c, (i) + 2, f, k)         \
+        UTILITY_SHA1_STEP(c, d, e, a, b, (i) + 3, f, k)         \
+        UTILITY_SHA1_STEP(b, c, d, e, a, (i) + 4, f, k)
+
+#define UTILITY_SHA1_CH(x, y, z)     ((z) ^ ((x) & ((y) ^ (z))))
+#define UTILITY_SHA1_PARITY(x, y, z) ((x) ^ (y) ^ (z))
+#define UTILITY_SHA1_MAJ(x, y, z)    (((x) & (y)) | ((z) & ((x) | (y))))
+
+        for (int i = 0;  i < 20; i += 5) { UTILITY_SHA1_STEP5(i, UTILITY_SHA1_CH,     0x5a827999) }
+        for (int i = 20; i < 40; i += 5) { UTILITY_SHA1_STEP5(i, UTILITY_SHA1_PARITY, 0x6ed9eba1) }
+        for (int i = 40; i < 60; i += 5) { UTILITY_SHA1_STEP5(i, UTILITY_SHA1_MAJ,    0x8f1bbcdc) }
+        for (int i = 60; i < 80; i += 5) { UTILITY_SHA1_STEP5(i, UTILITY_SHA1_PARITY, 0xca62c1d6) }
+
+#undef UTILITY_SHA1_MAJ
+#undef UTILITY_SHA1_PARITY
+#undef UTILITY_SHA1_CH
+#undef UTILITY_SHA1_STEP5
+#undef UTILITY_SHA1_STEP
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d; state[4] += e;
+    }
+}
+
+/// SHA-256
+
+inline const uint32_t* _sha256_k()
+{
+    static const uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+    };
+    return k;
+}
+
+inline const uint32_t* _sha256_iv()
+{
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    return iv;
+}
+
+inline void _sha256_compress_scalar(uint32_t* state, const uint8_t* blocks, size_t count)
+{
+    const uint32_t* k = _sha256_k();
+
+    for (; count > 0; --count, blocks += 64)
+    {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i)
+            w[i] = _hash_load_be32(blocks + i * 4);
+        for (int i = 16; i < 64; ++i)
+        {
+            uint32_t s0 = _hash_rotr32(w[i - 15], 7) ^ _hash_rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = _hash_rotr32(w[i - 2], 17) ^ _hash_rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int i = 0; i < 64; ++i)
+        {
+            uint32_t s1 = _hash_rotr32(e, 6) ^ _hash_rotr32(e, 11) ^ _hash_rotr32(e, 25);
+            uint32_t t1 = h + s1 + (g ^ (e & (f ^ g))) + k[i] + w[i];
+            uint32_t s0 = _hash_rotr32(a, 2) ^ _hash_rotr32(a, 13) ^ _hash_rotr32(a, 22);
+            uint32_t t2 = s0 + ((a & b) | (c & (a | b)));
+
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#if defined(UTILITY_HASHER_X86)
+
+// Intel SHA Extensions, 参考:
+// https://www.intel.com/content/www/us/en/developer/articles/technical/intel-sha-extensions.html
+ATTRIBUTE_TARGET("sha,sse4.1,ssse3")
+inline void _sha1_compress_shani(uint32_t* state, const uint8_t* blocks, size_t count)
+{
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0x1B);
+    __m128i e0   = _mm_set_epi32(int(state[4]), 0, 0, 0);
+    __m128i e1, msg0, msg1, msg2, msg3;
+
+    for (; count > 0; --count, blocks += 64)
+    {
+        __m128i abcd_save = abcd;
+        __m128i e0_save   = e0;
+
+        msg0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 0)),  mask);
+        msg1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 16)), mask);
+        msg2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 32)), mask);
+        msg3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 48)), mask);
+
+        // 每组4轮, g 为组号(0-19), cur 为本组的消息, 其后依次为 next, next2, prev
+#define UTILITY_SHA1NI_ROUNDS(g, cur, next, next2, prev, ein, eout)     \
+        if (g == 0) ein = _mm_add_epi32(ein, cur);                      \
+        else        ein = _mm_sha1nexte_epu32(ein, cur);                \
+        eout = abcd;                                                    \
+        if (g >= 3 && g <= 18) next = _mm_sha1msg2_epu32(next, cur);    \
+        abcd = _mm_sha1rnds4_epu32(abcd, ein, g / 5);                   \
+        if (g >= 1 && g <= 16) prev = _mm_sha1msg1_epu32(prev, cur);    \
+        if (g >= 2 && g <= 17) next2 = _mm_xor_si128(next2, cur);
+
+        UTILITY_SHA1NI_ROUNDS(0,  msg0, msg1, msg2, msg3, e0, e1)
+        UTILITY_SHA1NI_ROUNDS(1,  msg1, msg2, msg3, msg0, e1, e0)
+        UTILITY_SHA1NI_ROUNDS(2,  msg2, msg3, msg0, msg1, e0, e1)
+        UTILITY_SHA1NI_ROUNDS(3,  msg3, msg0, msg1, msg2, e1, e0)
+        UTILITY_SHA1NI_ROUNDS(4,  msg0, msg1, msg2, msg3, e0, e1)
+        UTILITY_SHA1NI_ROUNDS(5,  msg1, msg2, msg3, msg0, e1, e0)
+        UTILITY_SHA1NI_ROUNDS(6,  msg2, msg3, msg0, msg1, e0, e1)
+        UTILITY_SHA1NI_ROUNDS(7,  msg3, msg0, msg1, msg2, e1, e0)
+        UTILITY_SHA1NI_ROUNDS(8,  msg0, msg1, msg2, msg3, e0, e1)
+        UTILITY_SHA1NI_ROUNDS(9,  msg1, msg2, msg3, msg0, e1, e0)
+        UTILITY_SHA1NI_ROUNDS(10, msg2, msg3, msg0, msg1, e0, e1)
+        UTILITY_SHA1NI_ROUNDS(11, msg3, msg0, msg1, msg2, e1, e0)
+        UTILITY_SHA1NI_ROUNDS(12, msg0, msg1, msg2, msg3, e0, e1)
+        UTILITY_SHA1NI_ROUNDS(13, msg1, msg2, msg3, msg0, e1, e0)
+        UTILITY_SHA1NI_ROUNDS(14, msg2, msg3, msg0, msg1, e0, e1)
+        UTILITY_SHA1NI_ROUNDS(15, msg3, msg0, msg1, msg2, e1, e0)
+        UTILITY_SHA1NI_ROUNDS(16, msg0, msg1, msg2, msg3, e0, e1)
+        UTILITY_SHA1NI_ROUNDS(17, msg1, msg2, msg3, msg0, e1, e0)
+        UTILITY_SHA1NI_ROUNDS(18, msg2, msg3, msg0, msg1, e0, e1)
+        UTILITY_SHA1NI_ROUNDS(19, msg3, msg0, msg1, msg2, e1, e0)
+
+#undef UTILITY_SHA1NI_ROUNDS
+
+        e0   = _mm_sha1nexte_epu32(e0, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+
+    _mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = uint32_t(_mm_extract_epi32(e0, 3));
+}
+
+ATTRIBUTE_TARGET("sha,sse4.1,ssse3")
+inline void _sha256_compress_shani(uint32_t* state, const uint8_t* blocks, size_t count)
+{
+    const uint32_t* k = _sha256_k();
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // 指令要求的状态布局为 ABEF/CDGH
+    __m128i tmp    = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    __m128i msg, msg0, msg1, msg2, msg3;
+
+    for (; count > 0; --count, blocks += 64)
+    {
+        __m128i abef_save = state0;
+        __m128i cdgh_save = state1;
+
+        msg0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 0)),  mask);
+        msg1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 16)), mask);
+        msg2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 32)), mask);
+        msg3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 48)), mask);
+
+        // 每组4轮, g 为组号(0-15), cur 为本组的消息, next/prev 为其后/前一组的消息
+#define UTILITY_SHA256NI_ROUNDS(g, cur, next, prev)                                     \
+        msg = _mm_add_epi32(cur, _mm_loadu_si128((const __m128i*)&k[4 * g]));           \
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);                            \
+        if (g >= 3 && g <= 14)                                                          \
+        {                                                                               \
+            next = _mm_add_epi32(next, _mm_alignr_epi8(cur, prev, 4));                  \
+            next = _mm_sha256msg2_epu32(next, cur);                                     \
+        }                                                                               \
+        state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));   \
+        if (g >= 1 && g <= 12) prev = _mm_sha256msg1_epu32(prev, cur);
+
+        UTILITY_SHA256NI_ROUNDS(0,  msg0, msg1, msg3)
+        UTILITY_SHA256NI_ROUNDS(1,  msg1, msg2, msg0)
+        UTILITY_SHA256NI_ROUNDS(2,  msg2, msg3, msg1)
+        UTILITY_SHA256NI_ROUNDS(3,  msg3, msg0, msg2)
+        UTILITY_SHA256NI_ROUNDS(4,  msg0, msg1, msg3)
+        UTILITY_SHA256NI_ROUNDS(5,  msg1, msg2, msg0)
+        UTILITY_SHA256NI_ROUNDS(6,  msg2, msg3, msg1)
+        UTILITY_SHA256NI_ROUNDS(7,  msg3, msg0, msg2)
+        UTILITY_SHA256NI_ROUNDS(8,  msg0, msg1, msg3)
+        UTILITY_SHA256NI_ROUNDS(9,  msg1, msg2, msg0)
+        UTILITY_SHA256NI_ROUNDS(10, msg2, msg3, msg1)
+        UTILITY_SHA256NI_ROUNDS(11, msg3, msg0, msg2)
+        UTILITY_SHA256NI_ROUNDS(12, msg0, msg1, msg3)
+        UTILITY_SHA256NI_ROUNDS(13, msg1, msg2, msg0)
+        UTILITY_SHA256NI_ROUNDS(14, msg2, msg3, msg1)
+        UTILITY_SHA256NI_ROUNDS(15, msg3, msg0, msg2)
+
+#undef UTILITY_SHA256NI_ROUNDS
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    tmp    = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    _mm_storeu_si128((__m128i*)&state[0], _mm_blend_epi16(tmp, state1, 0xF0));
+    _mm_storeu_si128((__m128i*)&state[4], _mm_alignr_epi8(state1, tmp, 8));
+}
+
+// 同时计算8路数据的SHA-256, state[i][n] 为第n路的第i个状态字
+ATTRIBUTE_TARGET("avx2")
+inline void _sha256_compress_x8_avx2(uint32_t state[8][8], const uint8_t* const lanes[8], size_t count)
+{
+    const uint32_t* k = _sha256_k();
+    const __m256i bswap = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+    __m256i s[8];
+    for (int i = 0; i < 8; ++i)
+        s[i] = _mm256_loadu_si256((const __m256i*)state[i]);
+
+#define UTILITY_SHA256X8_ROTR(x, n) \
+    _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n))
+
+    for (size_t offset = 0; offset < count * 64; offset += 64)
+    {
+        __m256i w[16];
+
+        // 每路读取32字节后转置, 使 w[i] 为8路的第i个消息字
+        for (int half = 0; half < 2; ++half)
+        {
+            __m256i r[8], t[8], u[8];
+            for (int n = 0; n < 8; ++n)
+                r[n] = _mm256_loadu_si256((const __m256i*)(lanes[n] + offset + half * 32));
+
+            for (int n = 0; n < 8; n += 2)
+            {
+                t[n]     = _mm256_unpacklo_epi32(r[n], r[n + 1]);
+                t[n + 1] = _mm256_unpackhi_epi32(r[n], r[n + 1]);
+            }
+            for (int n = 0; n < 8; n += 4)
+            {
+                u[n]     = _mm256_unpacklo_epi64(t[n],     t[n + 2]);
+                u[n + 1] = _mm256_unpackhi_epi64(t[n],     t[n + 2]);
+                u[n + 2] = _mm256_unpacklo_epi64(t[n + 1], t[n + 3]);
+                u[n + 3] = _mm256_unpackhi_epi64(t[n + 1], t[n + 3]);
+            }
+            for (int n = 0; n < 4; ++n)
+            {
+                w[half * 8 + n]     = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u[n], u[n + 4], 0x20), bswap);
+                w[half * 8 + n + 4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u[n], u[n + 4], 0x31), bswap);
+            }
+        }
+
+        __m256i a = s[0], b = s[1], c = s[2], d = s[3];
+        __m256i e = s[4], f = s[5], g = s[6], h = s[7];
+
+        for (int i = 0; i < 64; ++i)
+        {
+            if (i >= 16)
+            {
+                __m256i w15 = w[(i - 15) & 15], w2 = w[(i - 2) & 15];
+                __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(
+                    UTILITY_SHA256X8_ROTR(w15, 7), UTILITY_SHA256X8_ROTR(w15, 18)), _mm256_srli_epi32(w15, 3));
+                __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(
+                    UTILITY_SHA256X8_ROTR(w2, 17), UTILITY_SHA256X8_ROTR(w2, 19)), _mm256_srli_epi32(w2, 10));
+                w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], s0), _mm256_add_epi32(w[(i - 7) & 15], s1));
+            }
+
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(
+                UTILITY_SHA256X8_ROTR(e, 6), UTILITY_SHA256X8_ROTR(e, 11)), UTILITY_SHA256X8_ROTR(e, 25));
+            __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+            __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1),
+                _mm256_add_epi32(_mm256_add_epi32(ch, _mm256_set1_epi32(int(k[i]))), w[i & 15]));
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(
+                UTILITY_SHA256X8_ROTR(a, 2), UTILITY_SHA256X8_ROTR(a, 13)), UTILITY_SHA256X8_ROTR(a, 22));
+            __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+            __m256i t2 = _mm256_add_epi32(s0, maj);
+
+            h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+            d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+        }
+
+        s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+        s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+        s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+        s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+    }
+
+#undef UTILITY_SHA256X8_ROTR
+
+    for (int i = 0; i < 8; ++i)
+        _mm256_storeu_si256((__m256i*)state[i], s[i]);
+}
+
+#endif // UTILITY_HASHER_X86
+
+#if defined(UTILITY_HASHER_ARM_SHA)
+
+inline void _sha1_compress_armv8(uint32_t* state, const uint8_t* blocks, size_t count)
+{
+    const uint32x4_t k[4] = {
+        vdupq_n_u32(0x5a827999), vdupq_n_u32(0x6ed9eba1), vdupq_n_u32(0x8f1bbcdc), vdupq_n_u32(0xca62c1d6)
+    };
+
+    uint32x4_t abcd = vld1q_u32(state);
+    uint32_t   e    = state[4];
+
+    for (; count > 0; --count, blocks += 64)
+    {
+        uint32x4_t abcd_save = abcd;
+        uint32_t   e_save    = e;
+
+        uint32x4_t msg[4];
+        for (int i = 0; i < 4; ++i)
+            msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + i * 16)));
+
+        for (int g = 0; g < 20; ++g)
+        {
+            uint32x4_t wk = vaddq_u32(msg[g & 3], k[g / 5]);
+            uint32_t   e_next = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+
+            if (g < 5)
+                abcd = vsha1cq_u32(abcd, e, wk);
+            else if (g >= 10 && g < 15)
+                abcd = vsha1mq_u32(abcd, e, wk);
+            else
+                abcd = vsha1pq_u32(abcd, e, wk);
+
+            e = e_next;
+
+            if (g < 16)
+            {
+                msg[g & 3] = vsha1su1q_u32(
+                    vsha1su0q_u32(msg[g & 3], msg[(g + 1) & 3], msg[(g + 2) & 3]), msg[(g + 3) & 3]);
+            }
+        }
+
+        abcd = vaddq_u32(abcd, abcd_save);
+        e += e_save;
+    }
+
+    vst1q_u32(state, abcd);
+    state[4] = e;
+}
+
+inline void _sha256_compress_armv8(uint32_t* state, const uint8_t* blocks, size_t count)
+{
+    const uint32_t* k = _sha256_k();
+
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+
+    for (; count > 0; --count, blocks += 64)
+    {
+        uint32x4_t abcd_save = state0;
+        uint32x4_t efgh_save = state1;
+
+        uint32x4_t msg[4];
+        for (int i = 0; i < 4; ++i)
+            msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + i * 16)));
+
+        for (int g = 0; g < 16; ++g)
+        {
+            uint32x4_t wk = vaddq_u32(msg[g & 3], vld1q_u32(&k[g * 4]));
+
+            if (g < 12)
+            {
+                msg[g & 3] = vsha256su1q_u32(
+                    vsha256su0q_u32(msg[g & 3], msg[(g + 1) & 3]), msg[(g + 2) & 3], msg[(g + 3) & 3]);
+            }
+
+            uint32x4_t tmp = state0;
+            state0 = vsha256hq_u32(state0, state1, wk);
+            state1 = vsha256h2q_u32(state1, tmp, wk);
+        }
+
+        state0 = vaddq_u32(state0, abcd_save);
+        state1 = vaddq_u32(state1, efgh_save);
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+
+#endif // UTILITY_HASHER_ARM_SHA
+
+inline const util::cpu& _hash_cpu()
+{
+    static const util::cpu cpu;
+    return cpu;
+}
+
+inline const _hash_backend& _sha1_backend()
+{
+    static const _hash_backend backend = []() -> _hash_backend
+    {
+#if defined(UTILITY_HASHER_X86)
+        if (_hash_cpu().has_sha() && _hash_cpu().has_sse41() && _hash_cpu().has_ssse3())
+            return { _sha1_compress_shani, "sha-ni" };
+#elif defined(UTILITY_HASHER_ARM_SHA)
+        if (_hash_cpu().has_arm_sha1())
+            return { _sha1_compress_armv8, "armv8" };
+#endif
+        return { _sha1_compress_scalar, "scalar" };
+    }();
+    return backend;
+}
+
+inline const _hash_backend& _sha256_backend()
+{
+    static const _hash_backend backend = []() -> _hash_backend
+    {
+#if defined(UTILITY_HASHER_X86)
+        if (_hash_cpu().has_sha() && _hash_cpu().has_sse41() && _hash_cpu().has_ssse3())
+            return { _sha256_compress_shani, "sha-ni" };
+#elif defined(UTILITY_HASHER_ARM_SHA)
+        if (_hash_cpu().has_arm_sha2())
+            return { _sha256_compress_armv8, "armv8" };
+#endif
+        return { _sha256_compress_scalar, "scalar" };
+    }();
+    return backend;
+}
+
+/// CRC-32C
+
+struct _crc32c_table
+{
+    uint32_t t[8][256];
+
+    _crc32c_table()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; ++j)
+                crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+            t[0][i] = crc;
+        }
+
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            for (int j = 1; j < 8; ++j)
+                t[j][i] = (t[j - 1][i] >> 8) ^ t[0][t[j - 1][i] & 0xFF];
+        }
+    }
+};
+
+typedef uint32_t (*_crc32c_func)(uint32_t crc, const uint8_t* data, size_t size);
+
+// slicing-by-8
+inline uint32_t _crc32c_scalar(uint32_t crc, const uint8_t* data, size_t size)
+{
+    static const _crc32c_table table;
+    const uint32_t (*t)[256] = table.t;
+
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        uint32_t lo = _hash_load_le32(data) ^ crc;
+        uint32_t hi = _hash_load_le32(data + 4);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+
+    for (; size > 0; --size, ++data)
+        crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+
+    return crc;
+}
+
+#if defined(UTILITY_HASHER_X86)
+
+ATTRIBUTE_TARGET("sse4.2")
+inline uint32_t _crc32c_sse42(uint32_t crc, const uint8_t* data, size_t size)
+{
+#if defined(ARCH_CPU_64_BITS)
+    uint64_t crc64 = crc;
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        uint64_t value;
+        std::memcpy(&value, data, 8);
+        crc64 = _mm_crc32_u64(crc64, value);
+    }
+    crc = uint32_t(crc64);
+#endif
+
+    for (; size >= 4; size -= 4, data += 4)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, 4);
+        crc = _mm_crc32_u32(crc, value);
+    }
+
+    for (; size > 0; --size, ++data)
+        crc = _mm_crc32_u8(crc, *data);
+
+    return crc;
+}
+
+#endif // UTILITY_HASHER_X86
+
+#if defined(UTILITY_HASHER_ARM_CRC32)
+
+inline uint32_t _crc32c_armv8(uint32_t crc, const uint8_t* data, size_t size)
+{
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        uint64_t value;
+        std::memcpy(&value, data, 8);
+        crc = __crc32cd(crc, value);
+    }
+
+    for (; size > 0; --size, ++data)
+        crc = __crc32cb(crc, *data);
+
+    return crc;
+}
+
+#endif // UTILITY_HASHER_ARM_CRC32
+
+struct _crc32c_backend
+{
+    _crc32c_func update;
+    const char*  name;
+};
+
+inline const _crc32c_backend& _crc32c_select()
+{
+    static const _crc32c_backend backend = []() -> _crc32c_backend
+    {
+#if defined(UTILITY_HASHER_X86)
+        if (_hash_cpu().has_sse42())
+            return { _crc32c_sse42, "sse4.2" };
+#elif defined(UTILITY_HASHER_ARM_CRC32)
+        if (_hash_cpu().has_arm_crc32())
+            return { _crc32c_armv8, "armv8" };
+#endif
+        return { _crc32c_scalar, "scalar" };
+    }();
+    return backend;
+}
+
+/// BLAKE3
+/// https://github.com/BLAKE3-team/BLAKE3-specs
+
+enum
+{
+    _blake3_chunk_start = 1 << 0,
+    _blake3_chunk_end   = 1 << 1,
+    _blake3_parent      = 1 << 2,
+    _blake3_root        = 1 << 3,
+};
+
+inline void _blake3_g(uint32_t* v, int a, int b, int c, int d, uint32_t x, uint32_t y)
+{
+    v[a] = v[a] + v[b] + x;  v[d] = _hash_rotr32(v[d] ^ v[a], 16);
+    v[c] = v[c] + v[d];      v[b] = _hash_rotr32(v[b] ^ v[c], 12);
+    v[a] = v[a] + v[b] + y;  v[d] = _hash_rotr32(v[d] ^ v[a], 8);
+    v[c] = v[c] + v[d];      v[b] = _hash_rotr32(v[b] ^ v[c], 7);
+}
+
+// 返回完整的16个字, 前8个字为新的链值
+inline void _blake3_compress(
+    const uint32_t cv[8], const uint8_t block[64],
+    uint64_t counter, uint32_t block_len, uint32_t flags, uint32_t out[16])
+{
+    static const uint8_t schedule[7][16] = {
+        { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+        { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+        { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+        { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+        { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+        { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+        { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 },
+    };
+    const uint32_t* iv = _sha256_iv();
+
+    uint32_t m[16];
+    for (int i = 0; i < 16; ++i)
+        m[i] = _hash_load_le32(block + i * 4);
+
+    uint32_t v[16] = {
+        cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+        iv[0], iv[1], iv[2], iv[3],
+        uint32_t(counter), uint32_t(counter >> 32), block_len, flags,
+    };
+
+    for (int r = 0; r < 7; ++r)
+    {
+        const uint8_t* s = schedule[r];
+        _blake3_g(v, 0, 4, 8,  12, m[s[0]],  m[s[1]]);
+        _blake3_g(v, 1, 5, 9,  13, m[s[2]],  m[s[3]]);
+        _blake3_g(v, 2, 6, 10, 14, m[s[4]],  m[s[5]]);
+        _blake3_g(v, 3, 7, 11, 15, m[s[6]],  m[s[7]]);
+        _blake3_g(v, 0, 5, 10, 15, m[s[8]],  m[s[9]]);
+        _blake3_g(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+        _blake3_g(v, 2, 7, 8,  13, m[s[12]], m[s[13]]);
+        _blake3_g(v, 3, 4, 9,  14, m[s[14]], m[s[15]]);
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        out[i]     = v[i] ^ v[i + 8];
+        out[i + 8] = v[i + 8] ^ cv[i];
+    }
+}
+
+inline void _blake3_parent_cv(
+    const uint32_t left[8], const uint32_t right[8], uint32_t flags, uint32_t out[8])
+{
+    uint8_t  block[64];
+    uint32_t words[16];
+    for (int i = 0; i < 8; ++i)
+    {
+        _hash_store_le32(block + i * 4, left[i]);
+        _hash_store_le32(block + 32 + i * 4, right[i]);
+    }
+
+    _blake3_compress(_sha256_iv(), block, 0, 64, _blake3_parent | flags, words);
+    std::memcpy(out, words, 32);
+}
+
+} // detail
+} // util
+
+#endif // hasher_kernels_h__
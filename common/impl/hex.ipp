@@ -0,0 +1,422 @@
+/*
+*   hex.ipp
+*
+*   v0.1 2023-06 by GuoJH
+*/
+
+#ifdef UTILITY_DISABLE_HEADONLY
+#   include "../hex.h"
+#endif
+
+#include <cstring>
+#include <algorithm>
+#include <platform/cpu.h>
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#   if defined(COMPILER_MSVC)
+#       include <intrin.h>
+#   endif
+#   include <immintrin.h>
+#   define UTILITY_HEX_X86 1
+#endif
+
+namespace util {
+namespace detail {
+
+inline const char* _hex_digits(bool upper)
+{
+    return upper ? "0123456789ABCDEF" : "0123456789abcdef";
+}
+
+// 每个字节对应的两个字符
+struct _hex_encode_table
+{
+    char pairs[512];
+
+    explicit _hex_encode_table(bool upper)
+    {
+        const char* digits = _hex_digits(upper);
+        for (int i = 0; i < 256; ++i)
+        {
+            pairs[i * 2]     = digits[i >> 4];
+            pairs[i * 2 + 1] = digits[i & 0x0F];
+        }
+    }
+};
+
+inline const char* _hex_pairs(bool upper)
+{
+    static const _hex_encode_table lower(false);
+    static const _hex_encode_table upper_(true);
+    return upper ? upper_.pairs : lower.pairs;
+}
+
+// 字符对应的值, 无效字符为0xFF
+struct _hex_decode_table
+{
+    uint8_t t[256];
+
+    _hex_decode_table()
+    {
+        std::memset(t, 0xFF, sizeof(t));
+        for (int i = 0; i < 10; ++i)
+            t['0' + i] = uint8_t(i);
+        for (int i = 0; i < 6; ++i)
+            t['a' + i] = t['A' + i] = uint8_t(10 + i);
+    }
+};
+
+inline const uint8_t* _hex_table()
+{
+    static const _hex_decode_table table;
+    return table.t;
+}
+
+// 向量化的实现: 尽可能多地处理完整的块, 返回已处理的输入长度; 解码遇到无效字符时提前返回
+typedef size_t (*_hex_encode_func)(char* out, const uint8_t* in, size_t size, bool upper);
+typedef size_t (*_hex_encode_sep_func)(char* out, const uint8_t* in, size_t size, char separator, bool upper);
+typedef size_t (*_hex_decode_func)(uint8_t* out, const char* in, size_t size);
+
+#if defined(UTILITY_HEX_X86)
+
+// 每16字节输出32个字符
+ATTRIBUTE_TARGET("ssse3")
+inline size_t _hex_encode_ssse3(char* out, const uint8_t* in, size_t size, bool upper)
+{
+    const __m128i lut  = _mm_loadu_si128((const __m128i*)_hex_digits(upper));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+
+    size_t done = 0;
+    for (; size - done >= 16; done += 16, out += 32)
+    {
+        __m128i v  = _mm_loadu_si128((const __m128i*)(in + done));
+        __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+
+        _mm_storeu_si128((__m128i*)out,        _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i*)(out + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+
+    return done;
+}
+
+// 每32字节输出64个字符
+ATTRIBUTE_TARGET("avx2")
+inline size_t _hex_encode_avx2(char* out, const uint8_t* in, size_t size, bool upper)
+{
+    const __m256i lut  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)_hex_digits(upper)));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+
+    size_t done = 0;
+    for (; size - done >= 32; done += 32, out += 64)
+    {
+        __m256i v  = _mm256_loadu_si256((const __m256i*)(in + done));
+        __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+
+        // unpack 在128位的通道内进行, 需要重新排列两个通道
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i*)out,        _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i*)(out + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+
+    return done;
+}
+
+// 每16字节输出48个字符, 格式为 "xx:xx:...:xx:", 因此要求块之后仍有数据
+ATTRIBUTE_TARGET("ssse3")
+inline size_t _hex_encode_sep_ssse3(char* out, const uint8_t* in, size_t size, char separator, bool upper)
+{
+    const __m128i lut  = _mm_loadu_si128((const __m128i*)_hex_digits(upper));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i sep  = _mm_set1_epi8(separator);
+
+    // 输出的第n个16字符分别来自前后32个十六进制字符中的哪个位置, -1 表示分隔符
+    const __m128i a0 = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+    const __m128i s0 = _mm_setr_epi8(0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0);
+    const __m128i a1 = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, -1, 2, 3, -1, 4, 5);
+    const __m128i s1 = _mm_setr_epi8(0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0);
+    const __m128i b2 = _mm_setr_epi8(-1, 6, 7, -1, 8, 9, -1, 10, 11, -1, 12, 13, -1, 14, 15, -1);
+    const __m128i s2 = _mm_setr_epi8(-1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1);
+
+    size_t done = 0;
+    for (; size - done > 16; done += 16, out += 48)
+    {
+        __m128i v  = _mm_loadu_si128((const __m128i*)(in + done));
+        __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+        __m128i x  = _mm_unpacklo_epi8(hi, lo);
+        __m128i y  = _mm_unpackhi_epi8(hi, lo);
+
+        _mm_storeu_si128((__m128i*)out, _mm_or_si128(
+            _mm_shuffle_epi8(x, a0), _mm_and_si128(sep, s0)));
+        _mm_storeu_si128((__m128i*)(out + 16), _mm_or_si128(
+            _mm_or_si128(_mm_shuffle_epi8(x, a1), _mm_shuffle_epi8(y, b1)), _mm_and_si128(sep, s1)));
+        _mm_storeu_si128((__m128i*)(out + 32), _mm_or_si128(
+            _mm_shuffle_epi8(y, b2), _mm_and_si128(sep, s2)));
+    }
+
+    return done;
+}
+
+// 将16个字符转换为4位的值, 并累积有效性
+ATTRIBUTE_TARGET("ssse3")
+inline __m128i _hex_nibbles_ssse3(__m128i c, __m128i& valid)
+{
+    __m128i digit  = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_digit  = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+    valid = _mm_and_si128(valid, _mm_or_si128(is_digit, is_letter));
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+// 每32个字符输出16字节
+ATTRIBUTE_TARGET("ssse3")
+inline size_t _hex_decode_ssse3(uint8_t* out, const char* in, size_t size)
+{
+    const __m128i weights = _mm_set1_epi16(0x0110);
+
+    size_t done = 0;
+    for (; size - done >= 32; done += 32, out += 16)
+    {
+        __m128i valid = _mm_set1_epi8(-1);
+        __m128i a = _hex_nibbles_ssse3(_mm_loadu_si128((const __m128i*)(in + done)), valid);
+        __m128i b = _hex_nibbles_ssse3(_mm_loadu_si128((const __m128i*)(in + done + 16)), valid);
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+            break;
+
+        // 相邻的两个值合并为 hi * 16 + lo
+        a = _mm_maddubs_epi16(a, weights);
+        b = _mm_maddubs_epi16(b, weights);
+        _mm_storeu_si128((__m128i*)out, _mm_packus_epi16(a, b));
+    }
+
+    return done;
+}
+
+ATTRIBUTE_TARGET("avx2")
+inline __m256i _hex_nibbles_avx2(__m256i c, __m256i& valid)
+{
+    __m256i digit  = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i is_digit  = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+
+    valid = _mm256_and_si256(valid, _mm256_or_si256(is_digit, is_letter));
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+        _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+// 每64个字符输出32字节
+ATTRIBUTE_TARGET("avx2")
+inline size_t _hex_decode_avx2(uint8_t* out, const char* in, size_t size)
+{
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+
+    size_t done = 0;
+    for (; size - done >= 64; done += 64, out += 32)
+    {
+        __m256i valid = _mm256_set1_epi8(-1);
+        __m256i a = _hex_nibbles_avx2(_mm256_loadu_si256((const __m256i*)(in + done)), valid);
+        __m256i b = _hex_nibbles_avx2(_mm256_loadu_si256((const __m256i*)(in + done + 32)), valid);
+        if (_mm256_movemask_epi8(valid) != -1)
+            break;
+
+        a = _mm256_maddubs_epi16(a, weights);
+        b = _mm256_maddubs_epi16(b, weights);
+
+        // packus 在128位的通道内进行, 需要重新排列
+        __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)out, v);
+    }
+
+    return done;
+}
+
+#endif // UTILITY_HEX_X86
+
+struct _hex_kernels
+{
+    _hex_encode_func     encode;
+    _hex_encode_sep_func encode_sep;
+    _hex_decode_func     decode;
+};
+
+inline const _hex_kernels& _hex_select()
+{
+    static const _hex_kernels kernels = []() -> _hex_kernels
+    {
+#if defined(UTILITY_HEX_X86)
+        util::cpu cpu;
+        if (cpu.has_avx2())
+            return { _hex_encode_avx2, _hex_encode_sep_ssse3, _hex_decode_avx2 };
+        if (cpu.has_ssse3())
+            return { _hex_encode_ssse3, _hex_encode_sep_ssse3, _hex_decode_ssse3 };
+#endif
+        return { nullptr, nullptr, nullptr };
+    }();
+    return kernels;
+}
+
+// 返回写入的字符数
+inline size_t _hex_encode_bytes(char* out, const uint8_t* in, size_t size, bool upper)
+{
+    size_t done = 0;
+
+    const _hex_kernels& kernels = _hex_select();
+    if (kernels.encode && size >= 16)
+        done = kernels.encode(out, in, size, upper);
+
+    const char* pairs = _hex_pairs(upper);
+    for (; done < size; ++done)
+        std::memcpy(out + done * 2, pairs + in[done] * 2, 2);
+
+    return size * 2;
+}
+
+// 解码偶数个字符, 失败时返回false, offset 为无效字符的位置
+inline bool _hex_decode_chars(uint8_t* out, const char* in, size_t size, size_t& offset)
+{
+    size_t done = 0;
+
+    const _hex_kernels& kernels = _hex_select();
+    if (kernels.decode && size >= 32)
+        done = kernels.decode(out, in, size);
+
+    const uint8_t* table = _hex_table();
+    for (; done + 1 < size; done += 2)
+    {
+        uint8_t hi = table[uint8_t(in[done])];
+        uint8_t lo = table[uint8_t(in[done + 1])];
+        if ((hi | lo) & 0xF0)
+        {
+            offset = (hi & 0xF0) ? done : done + 1;
+            return false;
+        }
+
+        out[done / 2] = uint8_t(hi << 4 | lo);
+    }
+
+    // 长度为奇数
+    offset = size;
+    return done == size;
+}
+
+} // detail
+
+size_t hex_encoded_size(size_t size, size_t separator_size/* = 0*/, size_t group/* = 1*/)
+{
+    size_t chars = size * 2;
+    if (separator_size > 0 && group > 0 && size > 0)
+        chars += (size - 1) / group * separator_size;
+
+    return chars;
+}
+
+size_t hex_encode(char* out, const void* data, size_t size, int flags/* = hex_lower*/)
+{
+    return detail::_hex_encode_bytes(out, static_cast<const uint8_t*>(data), size, (flags & hex_upper) != 0);
+}
+
+size_t hex_encode(
+    char* out, const void* data, size_t size, const std::string& separator, size_t group/* = 1*/, int flags/* = hex_lower*/)
+{
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    bool upper = (flags & hex_upper) != 0;
+
+    if (separator.empty() || group == 0 || size <= group)
+        return detail::_hex_encode_bytes(out, in, size, upper);
+
+    size_t done = 0;
+    char*  dest = out;
+
+    const detail::_hex_kernels& kernels = detail::_hex_select();
+    if (group == 1 && separator.size() == 1 && kernels.encode_sep)
+    {
+        done  = kernels.encode_sep(dest, in, size, separator[0], upper);
+        dest += done * 3;
+    }
+
+    while (done < size)
+    {
+        size_t count = std::min(group, size - done);
+        dest += detail::_hex_encode_bytes(dest, in + done, count, upper);
+        done += count;
+
+        if (done < size)
+        {
+            std::memcpy(dest, separator.data(), separator.size());
+            dest += separator.size();
+        }
+    }
+
+    return size_t(dest - out);
+}
+
+bool hex_decode(
+    void* out, size_t& out_size, const char* data, size_t size, size_t* error_offset/* = nullptr*/)
+{
+    size_t offset = 0;
+    bool result = detail::_hex_decode_chars(static_cast<uint8_t*>(out), data, size, offset);
+
+    out_size = offset / 2;
+    if (!result && error_offset)
+        *error_offset = offset;
+
+    return result;
+}
+
+bool hex_decode(
+    void* out, size_t& out_size, const char* data, size_t size,
+    const std::string& separator, size_t group/* = 1*/, size_t* error_offset/* = nullptr*/)
+{
+    if (separator.empty() || group == 0)
+        return hex_decode(out, out_size, data, size, error_offset);
+
+    uint8_t* dest   = static_cast<uint8_t*>(out);
+    size_t   offset = 0;
+    bool     result = true;
+
+    out_size = 0;
+    while (offset < size)
+    {
+        size_t chars = std::min(group * 2, size - offset);
+        size_t error = 0;
+
+        result = detail::_hex_decode_chars(dest + out_size, data + offset, chars, error);
+        out_size += error / 2;
+        if (!result)
+        {
+            offset += error;
+            break;
+        }
+
+        offset += chars;
+        if (offset == size)
+            break;
+
+        // 组之间必须为完整的分隔符, 且之后仍有数据
+        size_t matched = 0;
+        while (matched < separator.size() && offset + matched < size && data[offset + matched] == separator[matched])
+            ++matched;
+
+        offset += matched;
+        if (matched < separator.size() || offset == size)
+        {
+            result = false;
+            break;
+        }
+    }
+
+    if (!result && error_offset)
+        *error_offset = offset;
+
+    return result;
+}
+
+} // util
@@ -57,6 +57,11 @@
 #   define ARCH_CPU_ARMEL      1
 #   define ARCH_CPU_32_BITS    1
 #   define WCHAR_T_IS_UNSIGNED 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#   define ARCH_CPU_ARM_FAMILY 1
+#   define ARCH_CPU_ARM64      1
+#   define ARCH_CPU_64_BITS    1
+#   define WCHAR_T_IS_UNSIGNED 1
 #else
 #   error Please add support for your architecture in config.h
 #endif
@@ -95,7 +100,8 @@
     || defined(_M_ALPHA) || defined(__amd64) \
     || defined(__amd64__) || defined(_M_AMD64) \
     || defined(__x86_64) || defined(__x86_64__) \
-    || defined(_M_X64) || defined (__ARMEL__)
+    || defined(_M_X64) || defined (__ARMEL__) \
+    || defined(__AARCH64EL__) || defined(_M_ARM64)
 #   define CPU_LITTLE_ENDIAN    1
 #   define CPU_BYTE_ORDER       1234
 #else
@@ -146,6 +152,14 @@ char (&ArraySizeHelper(const T (&array)[N]))[N];
 
 #define arraysize(array) (sizeof(ArraySizeHelper(array)))
 
+// 为单个函数启用指定的指令集(如: "sse4.2", "avx2", "sha"), 而不需要为整个目标启用编译选项,
+// 调用方需要先通过util::cpu 确认处理器支持. MSVC 可以直接使用intrinsics, 故为空.
+#if defined(COMPILER_GCC)
+#   define ATTRIBUTE_TARGET(x) __attribute__((target(x)))
+#else
+#   define ATTRIBUTE_TARGET(x)
+#endif
+
 // MSVC 
 #if defined(COMPILER_MSVC)
 
@@ -0,0 +1,128 @@
+#ifndef aio_h__
+#define aio_h__
+
+/*
+*   aio.h
+*
+*   v0.1 2023-07 by GuoJH
+*/
+
+#include <memory>
+#include <future>
+#include <functional>
+#include <filesystem/file_util.h>
+
+namespace util {
+
+//! 读写与同步的完成回调, 参数为传输的字节数与错误
+typedef std::function<void(fsize, const ferror&)> aio_callback;
+
+//! 打开文件的完成回调, 回调可以取走文件的所有权, 否则文件将在回调返回后关闭.
+typedef std::function<void(ffile&, const ferror&)> aio_open_callback;
+
+//! 获取文件状态的完成回调
+typedef std::function<void(const fstatus&, const ferror&)> aio_stat_callback;
+
+//! 异步I/O的实现方式
+enum aio_backend
+{
+    aio_io_uring    = 0,    //!< Linux 5.6以上的io_uring, 不可用时退回到aio_thread_pool
+    aio_thread_pool = 1,    //!< 由线程池执行阻塞的调用, 适用于所有平台
+};
+
+namespace detail {
+    struct aio_request;
+    struct aio_engine;
+} // detail
+
+/*!
+ *  \brief 异步文件I/O
+ *
+ *  \note  1. 请求先加入批次, 调用submit()或批次已满时才真正提交, 多个请求通过一次系统调用提交;
+ *            返回future的请求同样需要submit(), 否则future将一直等待.
+ *         2. 回调在内部的完成线程(io_uring)或工作线程(线程池)中执行, 应尽快返回;
+ *            可以在回调中提交新的请求.
+ *         3. 读写的语义与file_pread()/file_pwrite()相同: 短读短写时继续传输剩余的部分,
+ *            到达文件末尾时出错. 在完成之前, 调用者需保证file与缓冲区有效.
+ *         4. 同时进行的请求数量不超过queue_depth的两倍, 超出时提交请求的线程将等待.
+ *         5. 析构时等待全部请求完成.
+ *
+ *  \code
+ *         util::aio io(256);
+ *         for (size_t i = 0; i < count; ++i)
+ *             io.read(file, buffers[i], block, i * block, [](util::fsize size, const util::ferror& ferr) { ... });
+ *         io.submit();
+ *         io.wait();
+ *  \endcode
+ */
+class aio
+{
+public:
+    /*!
+     *  \param queue_depth 提交队列的长度, 即单次系统调用最多提交的请求数量
+     *  \param backend     参见aio_backend, 实际使用的实现由backend()返回
+     */
+    explicit aio(unsigned queue_depth = 256, int backend = aio_io_uring);
+    ~aio();
+
+    //! 返回实际使用的实现, 参见aio_backend
+    int backend() const;
+
+    void read(const ffile& file, void* data_out, size_t size, fsize offset, const aio_callback& callback);
+    void write(ffile& file, const void* data, size_t size, fsize offset, const aio_callback& callback);
+
+    //! 同步文件, datasync为true时相当于fdatasync().
+    void fsync(ffile& file, bool datasync, const aio_callback& callback);
+
+    //! 打开文件, flags与file_open()相同
+    void open(const fpath& name, int flags, const aio_open_callback& callback);
+
+    //! 获取文件状态, 跟随符号链接
+    void stat(const fpath& name, const aio_stat_callback& callback);
+
+    //! 返回future的版本, 出错时future抛出ferror异常.
+    std::future<fsize>   read(const ffile& file, void* data_out, size_t size, fsize offset);
+    std::future<fsize>   write(ffile& file, const void* data, size_t size, fsize offset);
+    std::future<void>    fsync(ffile& file, bool datasync = false);
+    std::future<ffile>   open(const fpath& name, int flags);
+    std::future<fstatus> stat(const fpath& name);
+
+    /*!
+     *  \brief 注册固定的缓冲区, 内核只需映射一次, 之后通过read_fixed()/write_fixed()使用.
+     *
+     *  \note  1. 注册前应先注销已注册的缓冲区, 且没有进行中的read_fixed()/write_fixed().
+     *         2. 对于线程池, 仅记录缓冲区, 固定缓冲区的读写与普通读写相同.
+     */
+    void register_buffers(const fiovec* iov, int count);
+    void register_buffers(const fiovec* iov, int count, ferror& ferr) noexcept;
+    void unregister_buffers() noexcept;
+
+    //! 通过第index个注册的缓冲区读写, data必须位于该缓冲区内.
+    void read_fixed(const ffile& file, int index, void* data_out, size_t size, fsize offset, const aio_callback& callback);
+    void write_fixed(ffile& file, int index, const void* data, size_t size, fsize offset, const aio_callback& callback);
+
+    //! 提交批次中的全部请求, 返回提交的数量.
+    size_t submit();
+
+    //! 提交批次并等待全部请求完成, 不能在回调中调用.
+    void wait();
+
+    //! 返回尚未完成的请求数量, 包括尚未提交的.
+    size_t pending() const;
+
+protected:
+    aio(const aio&);
+    aio& operator=(const aio&);
+
+    void _enqueue(detail::aio_request* request);
+
+    std::unique_ptr<detail::aio_engine> _engine;
+};
+
+} // util
+
+#ifndef UTILITY_DISABLE_HEADONLY
+#   include "impl/aio.ipp"
+#endif
+
+#endif // aio_h__
@@ -0,0 +1,155 @@
+#ifndef file_stream_h__
+#define file_stream_h__
+
+/*
+*   file_stream.h
+*
+*   v0.1 2023-07 by GuoJH
+*/
+
+#include <memory>
+#include <string_view>
+#include <filesystem/file_util.h>
+#include <filesystem/record_scanner.h>
+
+namespace util {
+namespace detail {
+
+// 按页对齐的缓冲区
+struct stream_buffer_deleter
+{
+    void operator()(char* ptr) const noexcept;
+};
+
+typedef std::unique_ptr<char, stream_buffer_deleter> stream_buffer;
+
+} // detail
+
+/*!
+ *  \brief 带缓冲区的文件读取者
+ *
+ *  \note  1. 通过file_pread_some()从file_tell()返回的位置开始顺序读取, 不使用也不改变文件指针,
+ *            因此只适用于普通文件; 在使用期间file必须有效.
+ *         2. 缓冲区的大小按页对齐, 长度不小于缓冲区的read()将绕过缓冲区直接读入调用者的内存.
+ *         3. read_line()/read_record()/peek()返回的视图指向内部的缓冲区, 在下一次读取之前有效.
+ */
+class fstream_reader
+{
+public:
+    explicit fstream_reader(const ffile& file, size_t buffer_size = 0x40000);
+
+    /*!
+     *  \brief 读取最多size字节
+     *  \return 返回实际读取的字节数, 仅在到达文件末尾时少于size.
+     */
+    size_t read(void* data_out, size_t size);
+    size_t read(void* data_out, size_t size, ferror& ferr) noexcept;
+
+    /*!
+     *  \brief 读取一行, 不包括行尾的"\n"或"\r\n"
+     *
+     *  \return 到达文件末尾时返回false.
+     *  \note   行位于缓冲区内时不分配内存; 超过缓冲区的行将使缓冲区扩大.
+     */
+    bool read_line(std::string_view& line);
+    bool read_line(std::string_view& line, ferror& ferr) noexcept;
+
+    /*!
+     *  \brief 读取以delim分隔的一条记录, 不包括分隔符, 通过record_find()查找.
+     *  \return 到达文件末尾时返回false.
+     *  \note   与read_line()相同, 但不去除记录末尾的"\r".
+     */
+    bool read_record(std::string_view& record, char delim);
+    bool read_record(std::string_view& record, char delim, ferror& ferr) noexcept;
+
+    //! 返回下一个字节但不读取它, 到达文件末尾时返回-1.
+    int peek();
+
+    //! 返回接下来最多size字节但不读取它们, size不能超过缓冲区的大小.
+    std::string_view peek(size_t size);
+
+    //! 跳过size字节
+    void skip(size_t size);
+
+    //! 是否已读完文件
+    bool eof();
+
+    //! 返回下一个读取位置相对于文件开始位置的偏移量
+    fsize position() const;
+
+    //! 移动至文件的offset处, 丢弃缓冲区的内容
+    void seek(fsize offset);
+
+protected:
+    fstream_reader(const fstream_reader&);
+    fstream_reader& operator=(const fstream_reader&);
+
+    // 将未读的数据移至缓冲区的开始, 并读取一次文件, 返回读取的字节数.
+    size_t _fill(ferror& ferr) noexcept;
+
+    const ffile&          _file;
+    detail::stream_buffer _buffer;
+    size_t                _capacity;
+    size_t                _begin;       //!< 未读数据的开始
+    size_t                _end;         //!< 未读数据的结束
+    fsize                 _offset;      //!< _end 对应的文件偏移量
+    bool                  _eof;
+};
+
+/*!
+ *  \brief 带缓冲区的文件写入者
+ *
+ *  \note  1. 通过file_pwrite()/file_writev()从file_tell()返回的位置开始顺序写入, 不使用也不改变文件指针.
+ *         2. 缓冲区放不下的数据与缓冲区的内容一起通过一次file_writev()写入, 大块数据不经过缓冲区复制.
+ *         3. 析构时写入缓冲区的内容, 此时的错误将被忽略, 需要检查错误时应先调用flush().
+ */
+class fstream_writer
+{
+public:
+    explicit fstream_writer(ffile& file, size_t buffer_size = 0x40000);
+    ~fstream_writer();
+
+    void write(const void* data, size_t size);
+    void write(const void* data, size_t size, ferror& ferr) noexcept;
+
+    void write(std::string_view data) {
+        write(data.data(), data.size());
+    }
+
+    //! 写入一个字节
+    void put(char ch)
+    {
+        if (_size < _capacity)
+            _buffer.get()[_size++] = ch;
+        else
+            write(&ch, 1);
+    }
+
+    //! 写入一行, 并追加"\n"
+    void write_line(std::string_view line);
+
+    //! 将缓冲区的内容写入文件
+    void flush();
+    void flush(ferror& ferr) noexcept;
+
+    //! 返回下一个写入位置相对于文件开始位置的偏移量, 包括缓冲区中的内容.
+    fsize position() const;
+
+protected:
+    fstream_writer(const fstream_writer&);
+    fstream_writer& operator=(const fstream_writer&);
+
+    ffile&                _file;
+    detail::stream_buffer _buffer;
+    size_t                _capacity;
+    size_t                _size;        //!< 缓冲区中的字节数
+    fsize                 _offset;      //!< 缓冲区开始对应的文件偏移量
+};
+
+} // util
+
+#ifndef UTILITY_DISABLE_HEADONLY
+#   include "impl/file_stream.ipp"
+#endif
+
+#endif // file_stream_h__
@@ -11,6 +11,10 @@
 
 #include <stdio.h>
 #include <fcntl.h>
+#include <memory>
+#include <vector>
+#include <iterator>
+#include <functional>
 #include <string/tstring.h>
 #include <platform/platform_error.h>
 #include <filesystem/filesystem_cfg.h>
@@ -22,6 +26,9 @@ typedef uint64_t             fsize;
 typedef util::tstring        fpath;
 typedef util::platform_error ferror;
 
+//! 进度回调, 参数为已处理的字节数与总字节数, 返回false将取消操作.
+typedef std::function<bool(fsize, fsize)> fprogress;
+
 /*!
  *  \brief 文件时间
  * 
@@ -37,6 +44,30 @@ struct ftime
     int64_t change_time;   //!< 改变时间, 仅类unix平台有效, 否则为-1.
 };
 
+//! 文件(目录项)类型
+enum fentry_type
+{
+    entry_unknown   = 0,    //!< 未知, 且无法通过lstat()确定
+    entry_file      = 1,    //!< 普通文件
+    entry_directory = 2,    //!< 目录
+    entry_symlink   = 3,    //!< 符号链接, 不会解析其指向的内容
+    entry_other     = 4,    //!< 设备, 管道, 套接字等
+};
+
+/*!
+ *  \brief 文件状态, 通过一次系统调用获取.
+ */
+struct fstatus
+{
+    int      type;          //!< fentry_type
+    uint32_t mode;          //!< POSIX中为st_mode, Windows中为文件属性(FILE_ATTRIBUTE_*).
+    fsize    size;          //!< 文件大小
+    ftime    time;          //!< 文件时间, 在Linux中通过statx()获取创建时间, 文件系统不支持时为-1.
+    uint64_t inode;         //!< POSIX中为st_ino, Windows中为文件索引(nFileIndex).
+    uint64_t device;        //!< POSIX中为st_dev, Windows中为卷序列号.
+    uint32_t nlink;         //!< 硬链接数量
+};
+
 /*!
  *  \brief 文件描述符的包装对象
  *  
@@ -89,6 +120,90 @@ protected:
     native_type _native_id;
 };
 
+/*!
+ *  \brief 文件映射视图的访问模式
+ */
+enum fmap_mode
+{
+    map_read  = 0x01,   //!< 只读映射, 文件需以O_RDONLY或O_RDWR打开.
+    map_write = 0x02,   //!< 读写映射, 对视图的修改将写回文件, 文件需以O_RDWR打开.
+};
+
+/*!
+ *  \brief 文件映射视图的访问建议, 可以组合使用.
+ *
+ *  \note  仅作为对系统的提示, 平台不支持的建议将被忽略.
+ */
+enum fmap_advice
+{
+    advise_normal     = 0x00,   //!< 无特别建议
+    advise_sequential = 0x01,   //!< 将顺序访问, 系统可加大预读并尽早回收已访问的页面.
+    advise_random     = 0x02,   //!< 将随机访问, 系统可关闭预读.
+    advise_willneed   = 0x04,   //!< 即将访问, 系统可提前将内容读入页缓存.
+    advise_hugepage   = 0x08,   //!< 尝试使用大页, 仅Linux有效.
+};
+
+/*!
+ *  \brief 文件映射视图的包装对象
+ *
+ *  \note  1. 与ffile相同, fmapping 赋值后转移对视图的所有权, 原对象将被设置为无效.
+ *         2. 视图与创建它的ffile相互独立, 关闭文件后视图仍然有效, 直到视图被关闭.
+ *         3. 映射空文件或长度为0的范围时, 返回的视图无效且size()为0, 但这不被视为错误.
+ */
+class fmapping
+{
+public:
+    fmapping();
+    explicit fmapping(void* address, fsize length, fsize delta, fsize offset, int mode, intptr_t native_map = -1);
+
+    //! 从其他实例构造, other 将丧失对视图的所有权.
+    fmapping(fmapping& other);
+    ~fmapping();
+
+    //! C++ 11 移动构造支持
+#if __cplusplus >= 201103L || _MSVC_LANG >= 201103L
+    fmapping(fmapping&& right);
+    fmapping& operator=(fmapping&& right);
+#endif
+
+    //! 赋值后, right 将丧失对视图的所有权.
+    fmapping& operator=(fmapping& right);
+
+    bool vaild() const;
+    void close(); // Different implementations
+
+    //! 返回视图的首地址, 即文件中offset()处的内容.
+    char* data();
+    const char* data() const;
+
+    //! 返回视图的长度
+    fsize size() const;
+
+    //! 返回视图在文件中的偏移量
+    fsize offset() const;
+
+    //! 返回映射时的访问模式
+    int mode() const;
+
+    char* begin();
+    char* end();
+    const char* begin() const;
+    const char* end() const;
+
+    //! 与vaild()相同
+    operator bool() const;
+
+protected:
+    void     _swap(fmapping& other);
+
+    void*    _address;      //!< 系统返回的视图地址, 按分配粒度对齐.
+    fsize    _length;       //!< 从_address开始映射的长度
+    fsize    _delta;        //!< 视图在_address中的偏移, 即offset()与对齐后的偏移量之差.
+    fsize    _offset;       //!< 视图在文件中的偏移量
+    int      _mode;         //!< fmap_mode
+    intptr_t _native_map;   //!< Windows文件映射对象的句柄, 其他平台为-1.
+};
+
 /*!
  *  /brief  判断文件或目录是否存在.
  * 
@@ -124,6 +239,19 @@ UTILITY_FUNCT_DECL void file_remove(const fpath& name, ferror& ferr) noexcept;
 UTILITY_FUNCT_DECL void file_copy(const fpath& from, const fpath& to);
 UTILITY_FUNCT_DECL void file_copy(const fpath& from, const fpath& to, ferror& ferr) noexcept;
 
+/*!
+ *  \brief 拷贝文件, 并通过progress报告进度
+ *
+ *  \param progress 进度回调, 若返回false将取消拷贝并删除目标文件, 此时ferr为ECANCELED(Windows: ERROR_REQUEST_ABORTED).
+ *
+ *  \note  1. 行为与file_copy(from, to)相同.
+ *         2. 对于Linux, 拷贝依次尝试: FICLONE(reflink, 共享数据块), copy_file_range(), sendfile(), 
+ *            最后回退到用户态的缓冲区读写; 源文件中的空洞(SEEK_DATA/SEEK_HOLE)将被保留.
+ *         3. 对于Windows, 通过CopyFileEx()实现.
+ */
+UTILITY_FUNCT_DECL void file_copy(const fpath& from, const fpath& to, const fprogress& progress);
+UTILITY_FUNCT_DECL void file_copy(const fpath& from, const fpath& to, const fprogress& progress, ferror& ferr) noexcept;
+
 /*!
  *  \brief 移动文件
  * 
@@ -150,6 +278,15 @@ UTILITY_FUNCT_DECL fsize file_size(const fpath& name, ferror& ferr)  noexcept;
 UTILITY_FUNCT_DECL ftime file_time(const fpath& name);
 UTILITY_FUNCT_DECL ftime file_time(const fpath& name, ferror& ferr)  noexcept;
 
+/*!
+ *  \brief 返回文件状态, 包括类型, 大小, 时间, inode等, 可以代替分别调用file_size(), file_time()等.
+ *  
+ *  \param follow_symlink 如果name指向一个符号链接, 为true时解析指向的内容, 否则返回符号链接自身的状态.
+ *  \note  对于Linux, 通过statx()获取(包括创建时间), 在不支持的内核中回退至fstatat().
+ */
+UTILITY_FUNCT_DECL fstatus file_status(const fpath& name, bool follow_symlink = true);
+UTILITY_FUNCT_DECL fstatus file_status(const fpath& name, bool follow_symlink, ferror& ferr) noexcept;
+
 /*!
  *  \brief 设置文件时间
  *  \param name 将改变时间的文件
@@ -197,17 +334,206 @@ UTILITY_FUNCT_DECL void file_close(ffile& file) noexcept;
  *  
  *  \note  1. 若文件实际内容小于读取内容将出错, 但缓存区仍然会被填充.
  *         2. 对于Unix-Like, 若系统调用因信号中断会继续尝试, 直到成功为止.
+ *         3. 支持2GB以上的长度, 内部按块读取, 发生短读时将继续读取剩余的部分.
  */
-UTILITY_FUNCT_DECL void file_read(const ffile& file, void* data_out, int size);
-UTILITY_FUNCT_DECL void file_read(const ffile& file, void* data_out, int size, ferror& ferr) noexcept;
+UTILITY_FUNCT_DECL void file_read(const ffile& file, void* data_out, fsize size);
+UTILITY_FUNCT_DECL void file_read(const ffile& file, void* data_out, fsize size, ferror& ferr) noexcept;
 
 /*!
  *  \brief 将内容写入文件
  *
  *  \note  1. 对于Unix-Like, 若系统调用因信号中断会继续尝试, 直到成功为止.
+ *         2. 支持2GB以上的长度, 内部按块写入, 发生短写时将继续写入剩余的部分.
  */
-UTILITY_FUNCT_DECL void file_write(ffile& file, const void *data, int size);
-UTILITY_FUNCT_DECL void file_write(ffile& file, const void *data, int size, ferror& ferr) noexcept;
+UTILITY_FUNCT_DECL void file_write(ffile& file, const void *data, fsize size);
+UTILITY_FUNCT_DECL void file_write(ffile& file, const void *data, fsize size, ferror& ferr) noexcept;
+
+//! 流式读写的选项
+enum fstream_flag
+{
+    fstream_default = 0,    //!< 通过页缓存读写
+    fstream_nocache = 1,    //!< 处理完每块数据后丢弃其页缓存, 适合只读写一次的大文件, 不会挤占其他文件的缓存
+    fstream_direct  = 2,    //!< 以O_DIRECT打开文件绕过页缓存, 文件系统不支持时退回到fstream_nocache
+};
+
+//! 流式读取的数据接收者, 参数为数据与长度, 返回false将停止读取.
+typedef std::function<bool(const void*, size_t)> fsink;
+
+//! 流式写入的数据来源, 向缓冲区填充最多size字节并返回填充的字节数, 返回0表示数据结束.
+typedef std::function<size_t(void*, size_t)> fsource;
+
+/*!
+ *  \brief 按块读取文件的指定范围, 并依次交给sink处理, 文件内容无需全部驻留内存
+ *
+ *  \param offset 读取位置相对于文件开始位置的偏移量
+ *  \param length 读取的长度, fsize(-1)表示读到文件末尾
+ *  \param flags  fstream_flag的组合
+ *  \return 返回交给sink的字节数.
+ *
+ *  \note  1. 块的大小为4MB, 缓冲区按页对齐; 除最后一块外, sink收到的每块数据都是满的.
+ *         2. 指定了length但文件长度不足时将出错, 此时已读取的数据仍然会交给sink.
+ *         3. 对于Unix-Like, fstream_nocache通过posix_fadvise(POSIX_FADV_DONTNEED)实现;
+ *            对于Windows, 由系统的缓存管理器决定, 两个选项均被忽略.
+ */
+UTILITY_FUNCT_DECL fsize file_read_stream(
+    const fpath& name, const fsink& sink, fsize offset = 0, fsize length = fsize(-1), int flags = fstream_default);
+UTILITY_FUNCT_DECL fsize file_read_stream(
+    const fpath& name, const fsink& sink, fsize offset, fsize length, int flags, ferror& ferr) noexcept;
+
+/*!
+ *  \brief 创建或截断文件, 并按块写入source提供的全部数据
+ *
+ *  \return 返回写入的字节数.
+ *
+ *  \note  1. 每块数据在写入前会尽量填满, 因此source可以每次只提供少量数据.
+ *         2. 对于Linux, fstream_nocache在写入后通过sync_file_range()启动回写,
+ *            并在下一块写入后等待上一块回写完成, 再丢弃其页缓存, 以免脏页堆积.
+ *  \see   file_read_stream()
+ */
+UTILITY_FUNCT_DECL fsize file_write_stream(
+    const fpath& name, const fsource& source, int flags = fstream_default);
+UTILITY_FUNCT_DECL fsize file_write_stream(
+    const fpath& name, const fsource& source, int flags, ferror& ferr) noexcept;
+
+//! 写入后的同步策略
+enum fsync_policy
+{
+    fsync_none = 0,     //!< 不同步, 仍然是原子替换, 但掉电后可能丢失最近的写入
+    fsync_data = 1,     //!< 仅同步数据及读取数据所需的元数据, 即fdatasync()
+    fsync_full = 2,     //!< 同步数据及全部元数据, 即fsync()
+};
+
+/*!
+ *  \brief 原子地替换文件的内容, 崩溃或掉电后文件要么是旧的内容, 要么是新的内容
+ *
+ *  \param policy 同步策略, 参见fsync_policy
+ *
+ *  \note  1. 先写入同一目录下的临时文件, 按policy同步后重命名为name, 再同步所在的目录;
+ *            若name已存在, 新文件将沿用其权限.
+ *         2. 对于Linux, 临时文件通过O_TMPFILE创建, 链接到目录前对其他进程不可见,
+ *            写入过程中崩溃也不会遗留临时文件; 不支持时退回到带有唯一后缀的普通文件.
+ *         3. 对于Windows, 通过MoveFileEx(MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)替换,
+ *            目录无法单独同步.
+ *         4. 所在目录必须已经存在.
+ */
+UTILITY_FUNCT_DECL void file_write_atomic(const fpath& name, const void* data, fsize size, int policy = fsync_data);
+UTILITY_FUNCT_DECL void file_write_atomic(const fpath& name, const void* data, fsize size, int policy, ferror& ferr) noexcept;
+
+/*!
+ *  \brief 批量原子替换文件(组提交), 多个文件共享一次同步屏障
+ *
+ *  \note  1. write()仅写入临时文件, commit()时统一同步, 然后依次重命名, 最后对每个涉及的目录同步一次;
+ *            对于Linux, write()时即通过sync_file_range()启动回写, commit()时逐个同步的等待时间较短.
+ *         2. 每个文件的替换是原子的, 但整个批次不是: commit()出错时, 已重命名的文件保持新的内容,
+ *            其余的临时文件将被删除.
+ *         3. 析构或调用rollback()时, 删除尚未提交的临时文件.
+ *
+ *  \code
+ *         util::fatomic_batch batch(util::fsync_data);
+ *         for (auto& item : items)
+ *             batch.write(item.name, item.data.data(), item.data.size());
+ *         batch.commit();
+ *  \endcode
+ */
+class fatomic_batch
+{
+public:
+    explicit fatomic_batch(int policy = fsync_data);
+    ~fatomic_batch();
+
+    //! 写入name的新内容, 在commit()之前name保持原来的内容.
+    void write(const fpath& name, const void* data, fsize size);
+    void write(const fpath& name, const void* data, fsize size, ferror& ferr) noexcept;
+
+    //! 同步并替换全部文件
+    void commit();
+    void commit(ferror& ferr) noexcept;
+
+    //! 放弃尚未提交的写入
+    void rollback() noexcept;
+
+    //! 返回尚未提交的文件数量
+    size_t size() const;
+
+protected:
+    fatomic_batch(const fatomic_batch&);
+    fatomic_batch& operator=(const fatomic_batch&);
+
+    struct entry
+    {
+        fpath name;     //!< 目标文件
+        fpath temp;     //!< 已写入的临时文件
+    };
+
+    int                _policy;
+    std::vector<entry> _entries;
+};
+
+/*!
+ *  \brief 分散/聚集I/O的缓冲区描述, 与POSIX的struct iovec布局相同.
+ */
+struct fiovec
+{
+    void*  base;    //!< 缓冲区首地址
+    size_t size;    //!< 缓冲区长度
+};
+
+/*!
+ *  \brief 从文件的指定位置读取内容
+ *
+ *  \param offset 读取位置相对于文件开始位置的偏移量, 支持4GB以上大文件.
+ *  \return 返回实际读取的字节数.
+ *
+ *  \note  1. 对于Unix-Like, 通过pread()实现, 不使用也不改变文件指针, 多个线程可以通过同一个ffile并发读取;
+ *            对于Windows, 通过OVERLAPPED指定偏移量, 同步句柄的文件指针将被移动到读取结束的位置.
+ *         2. 发生短读时将继续读取, 直到读满size或到达文件末尾; 若到达文件末尾将出错, 但缓存区仍然会被填充.
+ *         3. 对于Unix-Like, 若系统调用因信号中断会继续尝试, 直到成功为止.
+ */
+UTILITY_FUNCT_DECL fsize file_pread(const ffile& file, void* data_out, fsize size, fsize offset);
+UTILITY_FUNCT_DECL fsize file_pread(const ffile& file, void* data_out, fsize size, fsize offset, ferror& ferr) noexcept;
+
+/*!
+ *  \brief 从文件的指定位置读取最多size字节, 只进行一次读取
+ *
+ *  \return 返回实际读取的字节数, 到达文件末尾时返回0, 不视为错误.
+ *  \note   适用于自行管理缓冲区的读取者, 如fstream_reader.
+ *  \see    file_pread()
+ */
+UTILITY_FUNCT_DECL fsize file_pread_some(const ffile& file, void* data_out, fsize size, fsize offset);
+UTILITY_FUNCT_DECL fsize file_pread_some(const ffile& file, void* data_out, fsize size, fsize offset, ferror& ferr) noexcept;
+
+/*!
+ *  \brief 将内容写入文件的指定位置
+ *
+ *  \return 返回实际写入的字节数.
+ *  \note  1. 发生短写时将继续写入, 直到全部写入或出错为止.
+ *         2. 对于Linux, 以O_APPEND打开的文件, pwrite()将忽略offset并追加至文件末尾.
+ *  \see   file_pread()
+ */
+UTILITY_FUNCT_DECL fsize file_pwrite(ffile& file, const void* data, fsize size, fsize offset);
+UTILITY_FUNCT_DECL fsize file_pwrite(ffile& file, const void* data, fsize size, fsize offset, ferror& ferr) noexcept;
+
+/*!
+ *  \brief 从文件的指定位置依次读取内容至多个缓冲区(分散读)
+ *
+ *  \param iov   缓冲区数组, 按顺序填充.
+ *  \param count 缓冲区的数量
+ *  \return 返回实际读取的字节数.
+ *
+ *  \note  1. 对于Unix-Like, 通过preadv()实现, 单次系统调用可填充多个缓冲区; 对于Windows, 逐个缓冲区调用file_pread().
+ *         2. 短读, 文件末尾以及文件指针的处理与file_pread()相同.
+ */
+UTILITY_FUNCT_DECL fsize file_readv(const ffile& file, const fiovec* iov, int count, fsize offset);
+UTILITY_FUNCT_DECL fsize file_readv(const ffile& file, const fiovec* iov, int count, fsize offset, ferror& ferr) noexcept;
+
+/*!
+ *  \brief 将多个缓冲区的内容依次写入文件的指定位置(聚集写)
+ *
+ *  \note  例如: 记录头与记录内容可以通过一次系统调用写入, 而无需先拼接到一个缓冲区.
+ *  \see   file_readv(), file_pwrite()
+ */
+UTILITY_FUNCT_DECL fsize file_writev(ffile& file, const fiovec* iov, int count, fsize offset);
+UTILITY_FUNCT_DECL fsize file_writev(ffile& file, const fiovec* iov, int count, fsize offset, ferror& ferr) noexcept;
 
 /*!
  *  \brief 设置文件指针
@@ -238,6 +564,31 @@ UTILITY_FUNCT_DECL fsize file_size(const ffile& file, ferror& ferr) noexcept;
 UTILITY_FUNCT_DECL ftime file_time(const ffile& file);
 UTILITY_FUNCT_DECL ftime file_time(const ffile& file, ferror& ferr) noexcept;
 
+/*!
+ *  \brief 返回文件状态
+ * 
+ *  \see   file_status(const fpath& name, bool follow_symlink).
+ */
+UTILITY_FUNCT_DECL fstatus file_status(const ffile& file);
+UTILITY_FUNCT_DECL fstatus file_status(const ffile& file, ferror& ferr) noexcept;
+
+/*!
+ *  \brief 批量获取文件状态
+ * 
+ *  \param dir         names中的相对路径相对于该目录, 为空时相对于当前工作目录.
+ *                     对于POSIX, dir仅被打开一次, 各项相对于其描述符获取, 不会重复解析dir.
+ *  \param names       文件名称或路径, 不解析最后一级的符号链接.
+ *  \param status      输出与names一一对应的状态.
+ *  \param errors      输出与names一一对应的错误码, 0表示成功.
+ *  \param concurrency 并发的线程数量, 为0时取决于处理器数量, 为1时仅在调用线程中获取.
+ * 
+ *  \note  某一项失败时将继续获取其余项, ferr为第一个失败项的错误.
+ */
+UTILITY_FUNCT_DECL void file_status_batch(
+    const fpath& dir, const std::vector<fpath>& names, std::vector<fstatus>& status, std::vector<int>& errors, int concurrency = 1);
+UTILITY_FUNCT_DECL void file_status_batch(
+    const fpath& dir, const std::vector<fpath>& names, std::vector<fstatus>& status, std::vector<int>& errors, int concurrency, ferror& ferr) noexcept;
+
 /*!
  *  \brief 设置文件时间
  * 
@@ -246,6 +597,38 @@ UTILITY_FUNCT_DECL ftime file_time(const ffile& file, ferror& ferr) noexcept;
 UTILITY_FUNCT_DECL void file_set_time(const ffile& file, const ftime& time);
 UTILITY_FUNCT_DECL void file_set_time(const ffile& file, const ftime& time, ferror& ferr) noexcept;
 
+/*!
+ *  \brief 将文件的整体或一部分映射到内存
+ *
+ *  \param file   文件句柄, 其打开模式需要与mode相匹配.
+ *  \param mode   fmap_mode, map_read 或 map_write.
+ *  \param offset 映射范围在文件中的起始位置, 无需按页对齐.
+ *  \param length 映射范围的长度, fsize(-1)表示直到文件末尾.
+ *
+ *  \note  1. 对于POSIX平台, 通过mmap(MAP_SHARED)实现; 对于Windows平台, 通过MapViewOfFile()实现.
+ *         2. 映射范围超出文件末尾将出错, map_write模式不会扩展文件, 需要时请先扩展文件大小.
+ *         3. 访问视图时若文件被其他进程截断, 在POSIX平台将收到SIGBUS信号.
+ */
+UTILITY_FUNCT_DECL fmapping file_map(const ffile& file, int mode = map_read, fsize offset = 0, fsize length = fsize(-1));
+UTILITY_FUNCT_DECL fmapping file_map(const ffile& file, int mode, fsize offset, fsize length, ferror& ferr) noexcept;
+
+/*!
+ *  \brief 对映射视图给出访问建议
+ *
+ *  \param advice fmap_advice的组合.
+ *  \note  对于Windows平台, 仅advise_willneed有效(需要Windows 8及以上), 其他建议将被忽略.
+ */
+UTILITY_FUNCT_DECL void file_map_advise(const fmapping& mapping, int advice);
+UTILITY_FUNCT_DECL void file_map_advise(const fmapping& mapping, int advice, ferror& ferr) noexcept;
+
+/*!
+ *  \brief 将map_write视图中被修改的内容写回文件
+ *
+ *  \param wait 若为true, 则等待写入完成(msync(MS_SYNC)); 否则仅发起写入.
+ */
+UTILITY_FUNCT_DECL void file_map_flush(fmapping& mapping, bool wait = true);
+UTILITY_FUNCT_DECL void file_map_flush(fmapping& mapping, bool wait, ferror& ferr) noexcept;
+
 /*!
  *  \brief 返回当前进程对name指向的文件是否可写
  * 
@@ -262,6 +645,19 @@ UTILITY_FUNCT_DECL bool file_is_writable(const fpath& name, ferror& ferr) noexce
 UTILITY_FUNCT_DECL void directories_remove(const fpath& path);
 UTILITY_FUNCT_DECL void directories_remove(const fpath& path, ferror& ferr) noexcept;
 
+/*!
+ *  \brief 递归删除目录及其内容, 并返回删除失败的路径
+ *
+ *  \param concurrency 并发删除的线程数量, 为0时取决于处理器数量, 为1时仅在调用线程中删除.
+ *  \return 删除失败的文件或目录, 不为空时ferr为第一个失败的错误.
+ * 
+ *  \note  1. 遇到删除失败的文件时将跳过它继续删除, 其所在的各级目录也将因非空而删除失败.
+ *         2. 对于POSIX, 通过openat()/unlinkat()/fdopendir()相对于父目录的描述符删除, 
+ *            不会重复解析完整路径, 也不会跟随符号链接.
+ *         3. 对于Windows, 忽略concurrency.
+ */
+UTILITY_FUNCT_DECL std::vector<fpath> directories_remove(const fpath& path, int concurrency, ferror& ferr) noexcept;
+
 /*!
  *  \brief 递归创建目录
  *  
@@ -270,6 +666,155 @@ UTILITY_FUNCT_DECL void directories_remove(const fpath& path, ferror& ferr) noex
 UTILITY_FUNCT_DECL void directories_create(const fpath& path);
 UTILITY_FUNCT_DECL void directories_create(const fpath& path, ferror& ferr) noexcept;
 
+//! 目录遍历标志位
+enum fwalk_flag
+{
+    walk_default     = 0x00,
+    walk_recursive   = 0x01,    //!< 递归遍历子目录, 不进入指向目录的符号链接
+    walk_skip_hidden = 0x02,    //!< 跳过隐藏项, POSIX中以'.'开头的项, Windows中具有FILE_ATTRIBUTE_HIDDEN属性的项
+    walk_files_only  = 0x04,    //!< 仅报告非目录项, 递归时仍然进入子目录
+};
+
+//! 目录遍历选项
+struct fwalk_options
+{
+    int                flags;       //!< fwalk_flag 的组合
+    int                max_depth;   //!< 递归的最大深度, 0 表示不进入子目录, -1 表示不限制
+    std::vector<fpath> extensions;  //!< 仅报告具有这些扩展名的非目录项, 为空时不过滤.
+                                    //!< 与path_find_extension()的结果比较, 即小写且不包含'.', 如: "txt", "gz"
+
+    fwalk_options(int flags = walk_default, int max_depth = -1)
+        : flags(flags)
+        , max_depth(max_depth)
+    {}
+};
+
+namespace detail {
+    struct walk_state;
+} // detail
+
+/*!
+ *  \brief 目录项, 由directory_iterator 持有, 在迭代器递增后失效.
+ *
+ *  \note  1. 类型来自目录项本身(POSIX: d_type, Windows: dwFileAttributes), 不需要对每一项调用stat();
+ *            仅当文件系统没有提供类型, 或者访问size()/time()/status()时, 才相对于所在目录获取, 
+ *            且结果将被缓存. 对于Windows, 这些信息均来自目录项本身, 其中inode, device 与nlink 为0.
+ *         2. 对于符号链接, size()与time()返回符号链接自身的信息.
+ */
+class directory_entry
+{
+public:
+    directory_entry();
+
+    //! 返回完整路径, 即遍历的根路径与各级目录名称的拼接.
+    const fpath& path() const;
+
+    //! 返回名称, 不包含路径.
+    const fpath::element_type* name() const;
+
+    //! 返回所处的深度, 根路径的直接子项为0.
+    int depth() const;
+
+    //! 返回类型, 参见fentry_type.
+    int type() const;
+
+    bool is_file() const;
+    bool is_directory() const;
+    bool is_symlink() const;
+
+    //! 返回文件大小, 对于目录其值取决于操作系统.
+    fsize size() const;
+    fsize size(ferror& ferr) const noexcept;
+
+    //! 返回文件时间, 参见file_time().
+    ftime time() const;
+    ftime time(ferror& ferr) const noexcept;
+
+    //! 返回文件状态, 参见file_status().
+    fstatus status() const;
+    fstatus status(ferror& ferr) const noexcept;
+
+protected:
+    friend struct detail::walk_state;
+
+    void     _stat(ferror& ferr) const noexcept; // Different implementations
+    bool     _match(const fwalk_options& options) const;
+
+    fpath    _path;             //!< 完整路径, 在遍历过程中复用同一缓冲区
+    size_t   _name_offset;      //!< 名称在_path中的偏移
+    int      _depth;
+    intptr_t _dirfd;            //!< 所在目录的描述符, 用于fstatat(), Windows中为-1.
+    mutable int     _type;          //!< fentry_type
+    mutable int     _stat_state;    //!< 0 尚未获取, 1 已获取, -1 获取失败, 错误码为_stat_error.
+    mutable int     _stat_error;
+    mutable fstatus _status;
+};
+
+/*!
+ *  \brief 目录迭代器
+ *
+ *  \note  1. 迭代器之间共享遍历的状态, 与std::filesystem::directory_iterator 相同, 属于输入迭代器.
+ *         2. 对于Linux, 通过getdents64()批量读取目录项(每次64KB), 在遍历过程中不会为每一项分配内存.
+ *            对于Windows, 通过FindFirstFileEx()(FindExInfoBasic, FIND_FIRST_EX_LARGE_FETCH)实现.
+ *         3. 递归遍历时, 先报告目录项自身, 然后在递增时进入该目录(除非调用了skip());
+ *            无法打开的子目录将被跳过, 通过next(ferr)可以获取该错误, 而operator++()将忽略该错误.
+ *         4. 不保证目录项的顺序, 且不包含"."与"..".
+ */
+class directory_iterator
+{
+public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef directory_entry         value_type;
+    typedef std::ptrdiff_t          difference_type;
+    typedef const directory_entry*  pointer;
+    typedef const directory_entry&  reference;
+
+    //! 构造结束迭代器
+    directory_iterator();
+    explicit directory_iterator(const fpath& path, const fwalk_options& options = fwalk_options());
+    directory_iterator(const fpath& path, const fwalk_options& options, ferror& ferr) noexcept;
+
+    bool vaild() const;
+
+    //! 返回当前目录项, 迭代器必须有效.
+    const directory_entry& entry() const;
+
+    //! 移动至下一个目录项, 若没有更多的目录项, 迭代器将变为无效.
+    void next();
+    void next(ferror& ferr) noexcept;
+
+    //! 递归遍历时, 不进入当前的目录项.
+    void skip();
+
+    const directory_entry& operator*() const;
+    const directory_entry* operator->() const;
+    directory_iterator& operator++();
+
+    bool operator==(const directory_iterator& right) const;
+    bool operator!=(const directory_iterator& right) const;
+
+    //! 与vaild()相同
+    operator bool() const;
+
+protected:
+    std::shared_ptr<detail::walk_state> _state;
+};
+
+//! 支持基于范围的for循环
+inline directory_iterator begin(directory_iterator iter) { return iter; }
+inline directory_iterator end(const directory_iterator&) { return directory_iterator(); }
+
+/*!
+ *  \brief 遍历目录, 对每一个目录项调用callback, 若callback返回false则停止遍历.
+ *
+ *  \note  无法打开的子目录将被跳过并继续遍历, 遍历结束后ferr为遇到的第一个错误.
+ *  \see   directory_iterator
+ */
+UTILITY_FUNCT_DECL void directory_walk(
+    const fpath& path, const std::function<bool(const directory_entry&)>& callback, const fwalk_options& options = fwalk_options());
+UTILITY_FUNCT_DECL void directory_walk(
+    const fpath& path, const std::function<bool(const directory_entry&)>& callback, const fwalk_options& options, ferror& ferr) noexcept;
+
 } // util
 
 //!
@@ -0,0 +1,925 @@
+/*
+*   aio.ipp
+*
+*   v0.1 2023-07 by GuoJH
+*/
+
+#ifdef UTILITY_DISABLE_HEADONLY
+#   include "../aio.h"
+#endif
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <condition_variable>
+#include <platform/platform_util.h>
+
+#if OS_LINUX
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <sys/uio.h>
+#   include <sys/syscall.h>
+#   include <sys/sysmacros.h>
+#   include <linux/io_uring.h>
+#endif
+
+#if OS_WIN
+#   include <windows.h>
+#endif
+
+namespace util {
+namespace detail {
+
+enum aio_op
+{
+    aio_op_read,
+    aio_op_write,
+    aio_op_fsync,
+    aio_op_open,
+    aio_op_stat,
+};
+
+struct aio_request
+{
+    int         op;
+    ffile*      file;
+    char*       buffer;
+    size_t      size;
+    fsize       offset;
+    int         flags;          // 打开文件的标志, 或fsync()是否为datasync
+    int         index;          // 注册的缓冲区索引, -1表示普通的读写
+    fpath       path;
+    fsize       transferred;    // 读写已传输的字节数
+    ferror      error;
+    ffile       opened;
+    fstatus     status;
+#if OS_LINUX
+    struct statx stx;
+#endif
+    std::function<void(aio_request&)> complete;
+
+    aio_request(int op, ffile* file = nullptr)
+        : op(op), file(file), buffer(nullptr), size(0), offset(0), flags(0), index(-1), transferred(0)
+    {
+        status = { entry_unknown, 0, 0, { -1, -1, -1, -1 }, 0, 0, 0 };
+    }
+};
+
+// 当前线程是否为引擎内部的线程(完成线程或工作线程), 这些线程提交请求时不等待空位
+inline bool& aio_engine_thread()
+{
+    static thread_local bool value = false;
+    return value;
+}
+
+struct aio_engine
+{
+    explicit aio_engine(size_t limit)
+        : limit(limit), inflight(0)
+    {}
+
+    virtual ~aio_engine() {}
+
+    virtual int    backend() const = 0;
+    virtual void   enqueue(aio_request* request) = 0;
+    virtual size_t submit() = 0;
+    virtual void   register_buffers(const fiovec* iov, int count, ferror& ferr) noexcept = 0;
+    virtual void   unregister_buffers() noexcept = 0;
+
+    // 占用一个请求的位置, 已满时先提交批次, 然后等待其他请求完成
+    void acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (inflight >= limit && !aio_engine_thread())
+        {
+            lock.unlock();
+            submit();
+            lock.lock();
+
+            if (inflight >= limit)
+                changed.wait(lock);
+        }
+
+        ++inflight;
+    }
+
+    // 执行回调并释放请求
+    void finish(aio_request* request) noexcept
+    {
+        try
+        {
+            request->complete(*request);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "The aio callback threw an exception: " << e.what() << std::endl;
+        }
+        catch (...)
+        {
+            std::cerr << "The aio callback threw an unknown exception." << std::endl;
+        }
+
+        delete request;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        --inflight;
+        changed.notify_all();
+    }
+
+    void wait()
+    {
+        submit();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return inflight == 0; });
+    }
+
+    size_t pending()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return inflight;
+    }
+
+    const size_t            limit;
+    size_t                  inflight;
+    std::mutex              mutex;
+    std::condition_variable changed;
+};
+
+/*!
+ *  由线程池执行阻塞的调用
+ */
+struct aio_pool_engine : aio_engine
+{
+    explicit aio_pool_engine(unsigned queue_depth)
+        : aio_engine(queue_depth * 2), stopping(false)
+    {
+        // I/O 密集的任务, 线程数量多于处理器数量
+        unsigned count = std::max(4u, std::thread::hardware_concurrency() * 2);
+        count = std::min(count, std::max(1u, queue_depth));
+
+        for (unsigned i = 0; i < count; ++i)
+            workers.emplace_back([this] { run(); });
+    }
+
+    ~aio_pool_engine()
+    {
+        wait();
+
+        {
+            std::lock_guard<std::mutex> lock(work_mutex);
+            stopping = true;
+        }
+
+        work_ready.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    int backend() const override
+    {
+        return aio_thread_pool;
+    }
+
+    void enqueue(aio_request* request) override
+    {
+        std::lock_guard<std::mutex> lock(work_mutex);
+        batch.push_back(request);
+    }
+
+    size_t submit() override
+    {
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(work_mutex);
+            count = batch.size();
+            work.insert(work.end(), batch.begin(), batch.end());
+            batch.clear();
+        }
+
+        if (count > 0)
+            work_ready.notify_all();
+
+        return count;
+    }
+
+    void register_buffers(const fiovec*, int, ferror& ferr) noexcept override
+    {
+        ferr.clear();
+    }
+
+    void unregister_buffers() noexcept override
+    {}
+
+    void run()
+    {
+        aio_engine_thread() = true;
+
+        for (;;)
+        {
+            aio_request* request = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(work_mutex);
+                work_ready.wait(lock, [this] { return stopping || !work.empty(); });
+
+                if (work.empty())
+                    break;
+
+                request = work.front();
+                work.pop_front();
+            }
+
+            execute(*request);
+            finish(request);
+        }
+    }
+
+    static void execute(aio_request& request) noexcept
+    {
+        if (request.error)
+            return;
+
+        switch (request.op)
+        {
+        case aio_op_read:
+            request.transferred = file_pread(*request.file, request.buffer, request.size, request.offset, request.error);
+            break;
+
+        case aio_op_write:
+            request.transferred = file_pwrite(*request.file, request.buffer, request.size, request.offset, request.error);
+            break;
+
+        case aio_op_fsync:
+#if OS_WIN
+            if (!::FlushFileBuffers(reinterpret_cast<HANDLE>(request.file->native_id())))
+                request.error = ferror(::GetLastError(), "Can't sync the file, FlushFileBuffers() failed.");
+#else
+            if ((request.flags ? ::fdatasync(*request.file) : ::fsync(*request.file)) == -1)
+                request.error = ferror(errno, "Can't sync the file, fsync() failed.");
+#endif
+            break;
+
+        case aio_op_open:
+            request.opened = file_open(request.path, request.flags, request.error);
+            break;
+
+        case aio_op_stat:
+            request.status = file_status(request.path, true, request.error);
+            break;
+        }
+    }
+
+    bool                      stopping;
+    std::vector<aio_request*> batch;
+    std::deque<aio_request*>  work;
+    std::mutex                work_mutex;
+    std::condition_variable   work_ready;
+    std::vector<std::thread>  workers;
+};
+
+#if OS_LINUX && defined(IORING_FEAT_RW_CUR_POS)
+
+/*!
+ *  通过io_uring 提交请求, 由一个完成线程收割完成队列并执行回调.
+ *  直接使用系统调用与共享的环形缓冲区, 不依赖liburing.
+ *  https://kernel.dk/io_uring.pdf
+ */
+struct aio_uring_engine : aio_engine
+{
+    explicit aio_uring_engine(unsigned queue_depth)
+        : aio_engine(queue_depth * 2)
+        , ring_fd(-1), sq_ring(MAP_FAILED), cq_ring(MAP_FAILED), sqes(nullptr)
+        , sq_ring_size(0), cq_ring_size(0), sqes_size(0), to_submit(0), buffers(0), stopping(false)
+    {}
+
+    ~aio_uring_engine()
+    {
+        if (reaper.joinable())
+        {
+            wait();
+
+            // 以user_data为0的空操作唤醒完成线程
+            stopping = true;
+            {
+                std::lock_guard<std::mutex> lock(sq_mutex);
+                io_uring_sqe* sqe = next_sqe();
+                sqe->opcode = IORING_OP_NOP;
+                enter(to_submit, 0, 0);
+                to_submit = 0;
+            }
+
+            reaper.join();
+        }
+
+        if (sqes)
+            ::munmap(sqes, sqes_size);
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+            ::munmap(cq_ring, cq_ring_size);
+        if (sq_ring != MAP_FAILED)
+            ::munmap(sq_ring, sq_ring_size);
+        if (ring_fd != -1)
+            ::close(ring_fd);
+    }
+
+    // 创建环形缓冲区, 内核不支持所需的操作时返回false.
+    bool init(unsigned queue_depth) noexcept
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, queue_depth, &params));
+        if (ring_fd == -1)
+            return false;
+
+        if (!probe())
+            return false;
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single)
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+        sq_ring = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        if (sq_ring == MAP_FAILED)
+            return false;
+
+        cq_ring = single ? sq_ring :
+            ::mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED)
+            return false;
+
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* ptr = ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        if (ptr == MAP_FAILED)
+            return false;
+
+        sqes       = static_cast<io_uring_sqe*>(ptr);
+        sq_entries = params.sq_entries;
+
+        char* sq   = static_cast<char*>(sq_ring);
+        sq_head    = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail    = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask    = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array   = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        char* cq   = static_cast<char*>(cq_ring);
+        cq_head    = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail    = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask    = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes       = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        reaper = std::thread([this] { run(); });
+        return true;
+    }
+
+    // 检查内核是否支持所需的操作
+    bool probe() noexcept
+    {
+        const size_t count = 256;
+        std::vector<char> buffer(sizeof(io_uring_probe) + count * sizeof(io_uring_probe_op), 0);
+        io_uring_probe* result = reinterpret_cast<io_uring_probe*>(buffer.data());
+
+        if (::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, result, count) < 0)
+            return false;
+
+        const int required[] = {
+            IORING_OP_NOP, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED,
+            IORING_OP_FSYNC, IORING_OP_OPENAT, IORING_OP_STATX,
+        };
+
+        for (int op : required)
+        {
+            if (op > result->last_op || !(result->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+
+        return true;
+    }
+
+    int backend() const override
+    {
+        return aio_io_uring;
+    }
+
+    int enter(unsigned submit, unsigned min_complete, unsigned flags) noexcept
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, submit, min_complete, flags, nullptr, 0));
+    }
+
+    // 提交批次中的请求, 调用者需持有sq_mutex
+    void flush() noexcept
+    {
+        while (to_submit > 0)
+        {
+            int result = enter(to_submit, 0, 0);
+            if (result >= 0)
+            {
+                to_submit -= std::min<unsigned>(to_submit, static_cast<unsigned>(result));
+                continue;
+            }
+
+            // 不可重试的错误, 撤回未提交的请求; 否则(如完成队列溢出时)等待完成线程收割
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                revoke(errno);
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    // 从提交队列中撤回未被内核接收的请求, 放入revoked 中等待调用者在释放sq_mutex 后完成,
+    // 避免回调中再次提交请求时死锁. 调用者需持有sq_mutex
+    void revoke(int code) noexcept
+    {
+        unsigned tail = *sq_tail;
+        for (unsigned i = tail - to_submit; i != tail; ++i)
+        {
+            aio_request* request = reinterpret_cast<aio_request*>(sqes[sq_array[i & sq_mask]].user_data);
+            if (!request)
+                continue;
+
+            if (!request->error)
+                request->error = ferror(code, "Can't submit the request, io_uring_enter() failed.");
+
+            revoked.push_back(request);
+        }
+
+        __atomic_store_n(sq_tail, tail - to_submit, __ATOMIC_RELEASE);
+        to_submit = 0;
+    }
+
+    // 以错误完成被撤回的请求, 调用者不能持有sq_mutex
+    void finish_revoked() noexcept
+    {
+        std::vector<aio_request*> requests;
+        {
+            std::lock_guard<std::mutex> lock(sq_mutex);
+            requests.swap(revoked);
+        }
+
+        for (aio_request* request : requests)
+            finish(request);
+    }
+
+    // 返回下一个可用的提交项, 提交队列已满时先提交批次, 调用者需持有sq_mutex
+    io_uring_sqe* next_sqe() noexcept
+    {
+        // 提交失败时未提交的请求被撤回, 队尾随之回退, 故每次重新读取
+        while (*sq_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries)
+            flush();
+
+        unsigned tail = *sq_tail;
+
+        unsigned index = tail & sq_mask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        ++to_submit;
+
+        return sqe;
+    }
+
+    void prepare(aio_request* request) noexcept
+    {
+        std::lock_guard<std::mutex> lock(sq_mutex);
+        io_uring_sqe* sqe = next_sqe();
+        sqe->user_data = reinterpret_cast<uint64_t>(request);
+
+        if (request->error)
+        {
+            sqe->opcode = IORING_OP_NOP;
+            return;
+        }
+
+        switch (request->op)
+        {
+        case aio_op_read:
+        case aio_op_write:
+        {
+            // 单次最多传输max_io_chunk 字节, 剩余的部分在完成后继续提交
+            bool fixed = request->index >= 0;
+            sqe->opcode = request->op == aio_op_read ?
+                (fixed ? IORING_OP_READ_FIXED : IORING_OP_READ) : (fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE);
+            sqe->fd     = request->file->native_id();
+            sqe->addr   = reinterpret_cast<uint64_t>(request->buffer + request->transferred);
+            sqe->len    = static_cast<uint32_t>(std::min<fsize>(request->size - request->transferred, max_io_chunk));
+            sqe->off    = request->offset + request->transferred;
+            if (fixed)
+                sqe->buf_index = static_cast<uint16_t>(request->index);
+            break;
+        }
+
+        case aio_op_fsync:
+            sqe->opcode      = IORING_OP_FSYNC;
+            sqe->fd          = request->file->native_id();
+            sqe->fsync_flags = request->flags ? IORING_FSYNC_DATASYNC : 0;
+            break;
+
+        case aio_op_open:
+            sqe->opcode     = IORING_OP_OPENAT;
+            sqe->fd         = AT_FDCWD;
+            sqe->addr       = reinterpret_cast<uint64_t>(request->path.c_str());
+            sqe->len        = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH;
+            sqe->open_flags = static_cast<uint32_t>(request->flags);
+            break;
+
+        case aio_op_stat:
+            sqe->opcode      = IORING_OP_STATX;
+            sqe->fd          = AT_FDCWD;
+            sqe->addr        = reinterpret_cast<uint64_t>(request->path.c_str());
+            sqe->len         = STATX_BASIC_STATS | STATX_BTIME;
+            sqe->off         = reinterpret_cast<uint64_t>(&request->stx);
+            sqe->statx_flags = 0;
+            break;
+        }
+    }
+
+    void enqueue(aio_request* request) override
+    {
+        prepare(request);
+        finish_revoked();
+    }
+
+    size_t submit() override
+    {
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(sq_mutex);
+            count = to_submit;
+            flush();
+        }
+
+        finish_revoked();
+        return count;
+    }
+
+    void register_buffers(const fiovec* iov, int count, ferror& ferr) noexcept override
+    {
+        ferr.clear();
+
+        // fiovec 与struct iovec 的布局相同
+        if (::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, iov, count) < 0)
+        {
+            ferr = ferror(errno, "Can't register the buffers, io_uring_register() failed.");
+            return;
+        }
+
+        buffers = count;
+    }
+
+    void unregister_buffers() noexcept override
+    {
+        if (buffers > 0)
+            ::syscall(__NR_io_uring_register, ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+
+        buffers = 0;
+    }
+
+    // 处理一个完成项, 返回false表示请求需要继续传输
+    bool complete(aio_request* request, int result) noexcept
+    {
+        if (request->error)
+            return true;
+
+        if (result < 0)
+        {
+            const char* message = "The io_uring request failed.";
+            switch (request->op)
+            {
+            case aio_op_read:  message = "Can't read file data, io_uring read failed."; break;
+            case aio_op_write: message = "File write failed, io_uring write failed."; break;
+            case aio_op_fsync: message = "Can't sync the file, io_uring fsync failed."; break;
+            case aio_op_open:  message = "Can't open file"; break;
+            case aio_op_stat:  message = "Can't get file status, statx() failed."; break;
+            }
+
+            request->error = ferror(-result, message);
+            return true;
+        }
+
+        switch (request->op)
+        {
+        case aio_op_read:
+        case aio_op_write:
+            if (result == 0)
+            {
+                request->error = request->op == aio_op_read ?
+                    ferror(-1, "The file was read successfully, but it was too short") :
+                    ferror(-1, "File write failed, io_uring write wrote nothing.");
+                return true;
+            }
+
+            request->transferred += static_cast<fsize>(result);
+            return request->transferred >= request->size;
+
+        case aio_op_open:
+            request->opened = ffile(result, request->flags);
+            return true;
+
+        case aio_op_stat:
+        {
+            const struct statx& stx = request->stx;
+            request->status.type   = status_type_from_mode(stx.stx_mode);
+            request->status.mode   = stx.stx_mode;
+            request->status.size   = stx.stx_size;
+            request->status.inode  = stx.stx_ino;
+            request->status.device = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+            request->status.nlink  = stx.stx_nlink;
+            request->status.time.create_time = (stx.stx_mask & STATX_BTIME) ? stx.stx_btime.tv_sec : -1;
+            request->status.time.access_time = stx.stx_atime.tv_sec;
+            request->status.time.modify_time = stx.stx_mtime.tv_sec;
+            request->status.time.change_time = stx.stx_ctime.tv_sec;
+            return true;
+        }
+
+        default:
+            return true;
+        }
+    }
+
+    void run()
+    {
+        aio_engine_thread() = true;
+
+        for (;;)
+        {
+            if (enter(0, 1, IORING_ENTER_GETEVENTS) == -1 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                std::cerr << "Failed to wait io_uring completions: " << format_error(errno) << std::endl;
+                std::this_thread::yield();
+            }
+
+            bool     stop = false;
+            unsigned head = *cq_head;
+            while (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+            {
+                const io_uring_cqe& cqe = cqes[head & cq_mask];
+                aio_request* request = reinterpret_cast<aio_request*>(cqe.user_data);
+                int result = cqe.res;
+
+                __atomic_store_n(cq_head, ++head, __ATOMIC_RELEASE);
+
+                if (!request)
+                {
+                    stop = stopping;
+                    continue;
+                }
+
+                if (complete(request, result))
+                    finish(request);
+                else
+                {
+                    prepare(request);
+                    submit();
+                }
+            }
+
+            if (stop)
+                break;
+        }
+    }
+
+    int             ring_fd;
+    void*           sq_ring;
+    void*           cq_ring;
+    io_uring_sqe*   sqes;
+    size_t          sq_ring_size;
+    size_t          cq_ring_size;
+    size_t          sqes_size;
+    unsigned        sq_entries;
+    unsigned*       sq_head;
+    unsigned*       sq_tail;
+    unsigned        sq_mask;
+    unsigned*       sq_array;
+    unsigned*       cq_head;
+    unsigned*       cq_tail;
+    unsigned        cq_mask;
+    io_uring_cqe*   cqes;
+    unsigned        to_submit;
+    int             buffers;
+    std::vector<aio_request*> revoked;
+    std::mutex      sq_mutex;
+    std::thread     reaper;
+    std::atomic<bool> stopping;
+};
+
+#endif // IORING_FEAT_RW_CUR_POS, Linux 5.6
+
+// 将future 版本的请求转换为回调
+template<class _Type>
+inline void _aio_set_promise(std::promise<_Type>& promise, _Type&& value, const ferror& ferr)
+{
+    if (ferr)
+        promise.set_exception(std::make_exception_ptr(ferr));
+    else
+        promise.set_value(std::move(value));
+}
+
+} // detail
+
+aio::aio(unsigned queue_depth/* = 256*/, int backend/* = aio_io_uring*/)
+{
+    queue_depth = std::max(1u, queue_depth);
+
+#if OS_LINUX && defined(IORING_FEAT_RW_CUR_POS)
+    // io_uring 可能因内核版本过低, 或被seccomp 等安全策略禁止而不可用
+    if (backend == aio_io_uring)
+    {
+        std::unique_ptr<detail::aio_uring_engine> engine(new detail::aio_uring_engine(queue_depth));
+        if (engine->init(queue_depth))
+            _engine = std::move(engine);
+    }
+#endif
+
+    if (!_engine)
+        _engine.reset(new detail::aio_pool_engine(queue_depth));
+}
+
+aio::~aio()
+{
+    _engine.reset();
+}
+
+int aio::backend() const
+{
+    return _engine->backend();
+}
+
+void aio::_enqueue(detail::aio_request* request)
+{
+    _engine->acquire();
+    _engine->enqueue(request);
+}
+
+void aio::read(const ffile& file, void* data_out, size_t size, fsize offset, const aio_callback& callback)
+{
+    read_fixed(file, -1, data_out, size, offset, callback);
+}
+
+void aio::write(ffile& file, const void* data, size_t size, fsize offset, const aio_callback& callback)
+{
+    write_fixed(file, -1, data, size, offset, callback);
+}
+
+void aio::read_fixed(const ffile& file, int index, void* data_out, size_t size, fsize offset, const aio_callback& callback)
+{
+    detail::aio_request* request = new detail::aio_request(detail::aio_op_read, const_cast<ffile*>(&file));
+    request->buffer   = static_cast<char*>(data_out);
+    request->size     = size;
+    request->offset   = offset;
+    request->index    = index;
+    request->complete = [callback](detail::aio_request& r) { callback(r.transferred, r.error); };
+
+    if (!file.vaild())
+        request->error = ferror(-1, "Invalid file handle");
+
+    _enqueue(request);
+}
+
+void aio::write_fixed(ffile& file, int index, const void* data, size_t size, fsize offset, const aio_callback& callback)
+{
+    detail::aio_request* request = new detail::aio_request(detail::aio_op_write, &file);
+    request->buffer   = static_cast<char*>(const_cast<void*>(data));
+    request->size     = size;
+    request->offset   = offset;
+    request->index    = index;
+    request->complete = [callback](detail::aio_request& r) { callback(r.transferred, r.error); };
+
+    if (!file.vaild())
+        request->error = ferror(-1, "Invalid file handle");
+
+    _enqueue(request);
+}
+
+void aio::fsync(ffile& file, bool datasync, const aio_callback& callback)
+{
+    detail::aio_request* request = new detail::aio_request(detail::aio_op_fsync, &file);
+    request->flags    = datasync ? 1 : 0;
+    request->complete = [callback](detail::aio_request& r) { callback(0, r.error); };
+
+    if (!file.vaild())
+        request->error = ferror(-1, "Invalid file handle");
+
+    _enqueue(request);
+}
+
+void aio::open(const fpath& name, int flags, const aio_open_callback& callback)
+{
+    detail::aio_request* request = new detail::aio_request(detail::aio_op_open);
+    request->path     = name;
+    request->flags    = flags;
+    request->complete = [callback](detail::aio_request& r) { callback(r.opened, r.error); };
+
+    _enqueue(request);
+}
+
+void aio::stat(const fpath& name, const aio_stat_callback& callback)
+{
+    detail::aio_request* request = new detail::aio_request(detail::aio_op_stat);
+    request->path     = name;
+    request->complete = [callback](detail::aio_request& r) { callback(r.status, r.error); };
+
+    _enqueue(request);
+}
+
+std::future<fsize> aio::read(const ffile& file, void* data_out, size_t size, fsize offset)
+{
+    auto promise = std::make_shared<std::promise<fsize>>();
+    read(file, data_out, size, offset, [promise](fsize result, const ferror& ferr) {
+        detail::_aio_set_promise(*promise, std::move(result), ferr);
+    });
+
+    return promise->get_future();
+}
+
+std::future<fsize> aio::write(ffile& file, const void* data, size_t size, fsize offset)
+{
+    auto promise = std::make_shared<std::promise<fsize>>();
+    write(file, data, size, offset, [promise](fsize result, const ferror& ferr) {
+        detail::_aio_set_promise(*promise, std::move(result), ferr);
+    });
+
+    return promise->get_future();
+}
+
+std::future<void> aio::fsync(ffile& file, bool datasync/* = false*/)
+{
+    auto promise = std::make_shared<std::promise<void>>();
+    fsync(file, datasync, [promise](fsize, const ferror& ferr) {
+        if (ferr)
+            promise->set_exception(std::make_exception_ptr(ferr));
+        else
+            promise->set_value();
+    });
+
+    return promise->get_future();
+}
+
+std::future<ffile> aio::open(const fpath& name, int flags)
+{
+    auto promise = std::make_shared<std::promise<ffile>>();
+    open(name, flags, [promise](ffile& file, const ferror& ferr) {
+        detail::_aio_set_promise(*promise, std::move(file), ferr);
+    });
+
+    return promise->get_future();
+}
+
+std::future<fstatus> aio::stat(const fpath& name)
+{
+    auto promise = std::make_shared<std::promise<fstatus>>();
+    stat(name, [promise](const fstatus& status, const ferror& ferr) {
+        detail::_aio_set_promise(*promise, fstatus(status), ferr);
+    });
+
+    return promise->get_future();
+}
+
+void aio::register_buffers(const fiovec* iov, int count)
+{
+    ferror ferr;
+    register_buffers(iov, count, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void aio::register_buffers(const fiovec* iov, int count, ferror& ferr) noexcept
+{
+    _engine->register_buffers(iov, count, ferr);
+}
+
+void aio::unregister_buffers() noexcept
+{
+    _engine->unregister_buffers();
+}
+
+size_t aio::submit()
+{
+    return _engine->submit();
+}
+
+void aio::wait()
+{
+    _engine->wait();
+}
+
+size_t aio::pending() const
+{
+    return _engine->pending();
+}
+
+} // util
@@ -0,0 +1,404 @@
+/*
+*   file_stream.ipp
+*
+*   v0.1 2023-07 by GuoJH
+*/
+
+#ifdef UTILITY_DISABLE_HEADONLY
+#   include "../file_stream.h"
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+#if OS_WIN
+#   include <malloc.h>
+#endif
+
+namespace util {
+namespace detail {
+
+const size_t stream_page_size = 0x1000;
+
+void stream_buffer_deleter::operator()(char* ptr) const noexcept
+{
+#if OS_WIN
+    ::_aligned_free(ptr);
+#else
+    ::free(ptr);
+#endif
+}
+
+// 分配按页对齐的缓冲区, size将被调整为页大小的整数倍
+inline stream_buffer make_stream_buffer(size_t& size)
+{
+    size = std::max(stream_page_size, (size + stream_page_size - 1) / stream_page_size * stream_page_size);
+
+    void* ptr = nullptr;
+#if OS_WIN
+    ptr = ::_aligned_malloc(size, stream_page_size);
+#else
+    if (::posix_memalign(&ptr, stream_page_size, size) != 0)
+        ptr = nullptr;
+#endif
+    if (!ptr)
+        throw std::bad_alloc();
+
+    return stream_buffer(static_cast<char*>(ptr));
+}
+
+// 返回文件指针的位置, 失败时为0
+inline fsize stream_start(const ffile& file)
+{
+    ferror ferr;
+    fsize offset = file_tell(file, ferr);
+    return ferr ? 0 : offset;
+}
+
+} // detail
+
+fstream_reader::fstream_reader(const ffile& file, size_t buffer_size/* = 0x40000*/)
+    : _file(file)
+    , _capacity(buffer_size)
+    , _begin(0)
+    , _end(0)
+    , _offset(detail::stream_start(file))
+    , _eof(false)
+{
+    _buffer = detail::make_stream_buffer(_capacity);
+}
+
+size_t fstream_reader::_fill(ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (_eof)
+        return 0;
+
+    if (_begin > 0)
+    {
+        std::memmove(_buffer.get(), _buffer.get() + _begin, _end - _begin);
+        _end  -= _begin;
+        _begin = 0;
+    }
+
+    fsize result = file_pread_some(_file, _buffer.get() + _end, _capacity - _end, _offset, ferr);
+    if (ferr)
+        return 0;
+
+    if (result == 0)
+        _eof = true;
+
+    _end    += static_cast<size_t>(result);
+    _offset += result;
+    return static_cast<size_t>(result);
+}
+
+size_t fstream_reader::read(void* data_out, size_t size)
+{
+    ferror ferr;
+    size_t result = read(data_out, size, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+size_t fstream_reader::read(void* data_out, size_t size, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    char*  out    = static_cast<char*>(data_out);
+    size_t copied = std::min(size, _end - _begin);
+
+    std::memcpy(out, _buffer.get() + _begin, copied);
+    _begin += copied;
+
+    while (copied < size && !_eof)
+    {
+        size_t rest = size - copied;
+        if (rest >= _capacity)
+        {
+            // 大块数据直接读入调用者的内存
+            fsize result = file_pread_some(_file, out + copied, rest, _offset, ferr);
+            if (ferr)
+                break;
+
+            if (result == 0)
+                _eof = true;
+
+            copied  += static_cast<size_t>(result);
+            _offset += result;
+            continue;
+        }
+
+        if (_fill(ferr) == 0)
+            break;
+
+        size_t count = std::min(rest, _end - _begin);
+        std::memcpy(out + copied, _buffer.get() + _begin, count);
+        _begin += count;
+        copied += count;
+    }
+
+    return copied;
+}
+
+bool fstream_reader::read_line(std::string_view& line)
+{
+    ferror ferr;
+    bool result = read_line(line, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+bool fstream_reader::read_line(std::string_view& line, ferror& ferr) noexcept
+{
+    if (!read_record(line, '\n', ferr))
+        return false;
+
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+
+    return true;
+}
+
+bool fstream_reader::read_record(std::string_view& record, char delim)
+{
+    ferror ferr;
+    bool result = read_record(record, delim, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+bool fstream_reader::read_record(std::string_view& record, char delim, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    // 已查找过的位置相对于_begin 的偏移, 填充后不重复查找
+    size_t scanned = 0;
+    for (;;)
+    {
+        const char* start = _buffer.get() + _begin;
+        const char* last  = _buffer.get() + _end;
+        const char* found = record_find(start + scanned, last, delim);
+
+        if (found != last)
+        {
+            size_t length = static_cast<size_t>(found - start);
+            _begin += length + 1;
+
+            record = std::string_view(start, length);
+            return true;
+        }
+
+        scanned = _end - _begin;
+
+        if (_eof)
+        {
+            if (scanned == 0)
+            {
+                record = std::string_view();
+                return false;
+            }
+
+            // 最后一条记录没有分隔符
+            record = std::string_view(start, scanned);
+            _begin = _end;
+            return true;
+        }
+
+        // 记录超过了缓冲区, 扩大一倍
+        if (_begin == 0 && _end == _capacity)
+        {
+            size_t capacity = _capacity * 2;
+            try
+            {
+                detail::stream_buffer buffer = detail::make_stream_buffer(capacity);
+                std::memcpy(buffer.get(), _buffer.get(), _end);
+                _buffer.swap(buffer);
+                _capacity = capacity;
+            }
+            catch (const std::bad_alloc&)
+            {
+                ferr = ferror(ENOMEM, "The record is too long to fit in the buffer.");
+                return false;
+            }
+        }
+
+        _fill(ferr);
+        if (ferr)
+            return false;
+    }
+}
+
+int fstream_reader::peek()
+{
+    if (_begin == _end)
+    {
+        ferror ferr;
+        _fill(ferr);
+
+        if (ferr)
+            throw ferr;
+    }
+
+    return _begin == _end ? -1 : static_cast<unsigned char>(_buffer.get()[_begin]);
+}
+
+std::string_view fstream_reader::peek(size_t size)
+{
+    if (size > _capacity)
+        throw std::runtime_error("The peek size is larger than the buffer.");
+
+    while (_end - _begin < size && !_eof)
+    {
+        ferror ferr;
+        _fill(ferr);
+
+        if (ferr)
+            throw ferr;
+    }
+
+    return std::string_view(_buffer.get() + _begin, std::min(size, _end - _begin));
+}
+
+void fstream_reader::skip(size_t size)
+{
+    size_t buffered = std::min(size, _end - _begin);
+    _begin += buffered;
+
+    if (buffered < size)
+        seek(position() + (size - buffered));
+}
+
+bool fstream_reader::eof()
+{
+    return peek() == -1;
+}
+
+fsize fstream_reader::position() const
+{
+    return _offset - (_end - _begin);
+}
+
+void fstream_reader::seek(fsize offset)
+{
+    _begin  = 0;
+    _end    = 0;
+    _offset = offset;
+    _eof    = false;
+}
+
+fstream_writer::fstream_writer(ffile& file, size_t buffer_size/* = 0x40000*/)
+    : _file(file)
+    , _capacity(buffer_size)
+    , _size(0)
+    , _offset(detail::stream_start(file))
+{
+    _buffer = detail::make_stream_buffer(_capacity);
+}
+
+fstream_writer::~fstream_writer()
+{
+    ferror ferr;
+    flush(ferr);
+
+    if (ferr)
+        std::cerr << "Failed to flush the file stream: " << ferr.what() << std::endl;
+}
+
+void fstream_writer::write(const void* data, size_t size)
+{
+    ferror ferr;
+    write(data, size, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void fstream_writer::write(const void* data, size_t size, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (size <= _capacity - _size)
+    {
+        std::memcpy(_buffer.get() + _size, data, size);
+        _size += size;
+        return;
+    }
+
+    // 缓冲区的内容与放不下的数据通过一次系统调用写入
+    fiovec iov[2] = {
+        { _buffer.get(), _size },
+        { const_cast<void*>(data), size },
+    };
+
+    fsize written = file_writev(_file, iov + (_size == 0), _size == 0 ? 1 : 2, _offset, ferr);
+    if (ferr)
+    {
+        // 保留尚未写入的缓冲区内容
+        size_t consumed = static_cast<size_t>(std::min<fsize>(written, _size));
+        std::memmove(_buffer.get(), _buffer.get() + consumed, _size - consumed);
+        _size   -= consumed;
+        _offset += consumed;
+        return;
+    }
+
+    _offset += written;
+    _size = 0;
+}
+
+void fstream_writer::write_line(std::string_view line)
+{
+    if (line.size() < _capacity - _size)
+    {
+        std::memcpy(_buffer.get() + _size, line.data(), line.size());
+        _size += line.size();
+        _buffer.get()[_size++] = '\n';
+        return;
+    }
+
+    write(line.data(), line.size());
+    put('\n');
+}
+
+void fstream_writer::flush()
+{
+    ferror ferr;
+    flush(ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void fstream_writer::flush(ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (_size == 0)
+        return;
+
+    fsize written = file_pwrite(_file, _buffer.get(), _size, _offset, ferr);
+    size_t consumed = static_cast<size_t>(std::min<fsize>(written, _size));
+
+    std::memmove(_buffer.get(), _buffer.get() + consumed, _size - consumed);
+    _size   -= consumed;
+    _offset += consumed;
+}
+
+fsize fstream_writer::position() const
+{
+    return _offset + _size;
+}
+
+} // util
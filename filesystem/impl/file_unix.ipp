@@ -10,13 +10,31 @@
 
 #include <ftw.h>
 #include <fcntl.h>
+#include <dirent.h>
 #include <stdio.h>
 #include <utime.h>
 #include <unistd.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 
+#if OS_LINUX
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <sys/sendfile.h>
+#   include <sys/sysmacros.h>
+#   include <linux/fs.h>
+#endif
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include <condition_variable>
 #include <iostream>
 #include <boost/filesystem.hpp>
 #include <platform/platform_util.h>
@@ -41,6 +59,27 @@ void ffile::close()
     _open_flags = 0;
 }
 
+void fmapping::close()
+{
+    if (vaild())
+    {
+        // 
+        // https://linux.die.net/man/2/munmap
+
+        if (::munmap(_address, static_cast<size_t>(_length)) == -1)
+        {
+            std::string message = format_error(errno);
+            std::cerr << "Failed to unmap file view: " << message << std::endl;
+        }
+    }
+
+    _address = nullptr;
+    _length  = 0;
+    _delta   = 0;
+    _offset  = 0;
+    _mode    = 0;
+}
+
 bool file_exist(const fpath& name)
 {
     ferror ferr;
@@ -116,18 +155,351 @@ void file_copy(const fpath& from, const fpath& to)
 }
 
 void file_copy(const fpath& from, const fpath& to, ferror& ferr) noexcept
+{
+    file_copy(from, to, fprogress(), ferr);
+}
+
+void file_copy(const fpath& from, const fpath& to, const fprogress& progress)
+{
+    ferror ferr;
+    file_copy(from, to, progress, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+namespace detail {
+
+    // 拷贝数据的方式, 按优先级排列, 当前方式不被支持时降级至下一种方式.
+    enum copy_method
+    {
+        copy_with_range    = 0,     // copy_file_range(), 在内核中拷贝, 支持时可由文件系统完成服务端拷贝或reflink.
+        copy_with_sendfile = 1,     // sendfile(), 在内核中拷贝.
+        copy_with_buffer   = 2,     // 用户态缓冲区读写.
+    };
+
+    // 单次拷贝的最大字节数, 同时也是报告进度的粒度.
+    const fsize copy_chunk_size  = 64 * 1024 * 1024;
+    const size_t copy_buffer_size = 1024 * 1024;
+
+    // 判断内核拷贝是否因为不被支持而失败, 此时应降级拷贝方式.
+    inline bool copy_is_unsupported(int ecode) noexcept
+    {
+        return ecode == ENOSYS || ecode == EXDEV      || ecode == EINVAL || 
+               ecode == EPERM  || ecode == EOPNOTSUPP || ecode == ENOTSUP;
+    }
+
+    struct copy_context
+    {
+        int              in;
+        int              out;
+        fsize            size;
+        int              method;
+        char*            buffer;
+        const fprogress& progress;
+    };
+
+    // 在用户态通过缓冲区拷贝一段数据, 返回拷贝的字节数, 返回-1表示出错且已设置ferr.
+    inline ssize_t copy_by_buffer(
+        copy_context& context, fsize offset, fsize length, ferror& ferr) noexcept
+    {
+        if (!context.buffer)
+        {
+            // 按页对齐的缓冲区, 兼容以O_DIRECT打开的文件.
+            void* buffer = nullptr;
+            if (::posix_memalign(&buffer, 4096, copy_buffer_size) != 0)
+            {
+                ferr = ferror(ENOMEM, "Can't copy file, allocate buffer failed.");
+                return -1;
+            }
+
+            context.buffer = static_cast<char*>(buffer);
+        }
+
+        size_t  chunk = static_cast<size_t>(std::min<fsize>(length, copy_buffer_size));
+        ssize_t bytesRead = 0;
+
+        do
+        {
+            bytesRead = ::pread(context.in, context.buffer, chunk, static_cast<off_t>(offset));
+        } 
+        while (bytesRead == -1 && errno == EINTR);
+
+        if (bytesRead == -1)
+        {
+            ferr = ferror(errno, "Can't copy file, pread() failed.");
+            return -1;
+        }
+
+        for (ssize_t written = 0; written < bytesRead; )
+        {
+            ssize_t result = ::pwrite(
+                context.out, context.buffer + written, bytesRead - written, static_cast<off_t>(offset + written));
+
+            if (result == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                ferr = ferror(errno, "Can't copy file, pwrite() failed.");
+                return -1;
+            }
+
+            written += result;
+        }
+
+        return bytesRead;
+    }
+
+    // 通过内核拷贝一段数据, 返回拷贝的字节数, 返回-1表示出错且已设置ferr.
+    // 若当前方式不被支持将自动降级, 最终降级为copy_by_buffer().
+    inline ssize_t copy_by_kernel(
+        copy_context& context, fsize offset, fsize length, ferror& ferr) noexcept
+    {
+        size_t chunk = static_cast<size_t>(std::min<fsize>(length, copy_chunk_size));
+
+#if OS_LINUX && defined(__NR_copy_file_range)
+        if (context.method == copy_with_range)
+        {
+            // 
+            // https://man7.org/linux/man-pages/man2/copy_file_range.2.html
+            // 在Linux 5.3之前不支持跨文件系统拷贝(EXDEV).
+
+            loff_t in_off  = static_cast<loff_t>(offset);
+            loff_t out_off = static_cast<loff_t>(offset);
+
+            ssize_t result = ::syscall(
+                __NR_copy_file_range, context.in, &in_off, context.out, &out_off, chunk, 0);
+
+            if (result > 0)
+                return result;
+
+            // 某些伪文件系统将返回0, 此时同样需要降级.
+            if (result == -1 && errno == EINTR)
+                return 0;
+
+            if (result == -1 && !copy_is_unsupported(errno))
+            {
+                ferr = ferror(errno, "Can't copy file, copy_file_range() failed.");
+                return -1;
+            }
+
+            context.method = copy_with_sendfile;
+        }
+#endif
+
+#if OS_LINUX
+        if (context.method == copy_with_sendfile)
+        {
+            // sendfile() 写入至out的当前文件指针, 需要先将其移动到目标位置.
+            // https://man7.org/linux/man-pages/man2/sendfile.2.html
+
+            off_t in_off = static_cast<off_t>(offset);
+
+            if (::lseek(context.out, static_cast<off_t>(offset), SEEK_SET) == -1)
+            {
+                ferr = ferror(errno, "Can't copy file, lseek() failed.");
+                return -1;
+            }
+
+            ssize_t result = ::sendfile(context.out, context.in, &in_off, chunk);
+
+            if (result > 0)
+                return result;
+
+            if (result == -1 && errno == EINTR)
+                return 0;
+
+            if (result == -1 && !copy_is_unsupported(errno))
+            {
+                ferr = ferror(errno, "Can't copy file, sendfile() failed.");
+                return -1;
+            }
+
+            context.method = copy_with_buffer;
+        }
+#endif
+
+        context.method = copy_with_buffer;
+        return copy_by_buffer(context, offset, length, ferr);
+    }
+
+    // 拷贝[offset, offset + length)范围内的数据
+    inline void copy_extent(
+        copy_context& context, fsize offset, fsize length, ferror& ferr) noexcept
+    {
+        fsize end = offset + length;
+
+        while (offset < end)
+        {
+            ssize_t result = copy_by_kernel(context, offset, end - offset, ferr);
+
+            if (result == -1)
+                return;
+
+            // 源文件在拷贝过程中被截断
+            if (result == 0 && context.method == copy_with_buffer)
+            {
+                ferr = ferror(EIO, "Can't copy file, the source file was truncated.");
+                return;
+            }
+
+            offset += static_cast<fsize>(result);
+
+            if (context.progress && !context.progress(offset, context.size))
+            {
+                ferr = ferror(ECANCELED, "The file copy was canceled.");
+                return;
+            }
+        }
+    }
+
+    // 在源文件上依次查找数据区段并拷贝, 跳过空洞.
+    inline void copy_extents(copy_context& context, ferror& ferr) noexcept
+    {
+        fsize offset = 0;
+
+        while (offset < context.size)
+        {
+            fsize data = offset;
+            fsize hole = context.size;
+
+#ifdef SEEK_DATA
+            // 
+            // https://man7.org/linux/man-pages/man2/lseek.2.html
+            // 不支持的文件系统将整个文件视为一个数据区段, 文件末尾之后没有数据区段时返回ENXIO.
+
+            off_t result = ::lseek(context.in, static_cast<off_t>(offset), SEEK_DATA);
+
+            if (result == -1)
+            {
+                if (errno == ENXIO)
+                    break;
+            }
+            else
+            {
+                data = static_cast<fsize>(result);
+                result = ::lseek(context.in, result, SEEK_HOLE);
+
+                if (result != -1)
+                    hole = std::min<fsize>(static_cast<fsize>(result), context.size);
+            }
+#endif
+
+            if (data >= context.size)
+                break;
+
+            copy_extent(context, data, hole - data, ferr);
+            if (ferr)
+                return;
+
+            offset = hole;
+        }
+    }
+
+} // detail
+
+void file_copy(const fpath& from, const fpath& to, const fprogress& progress, ferror& ferr) noexcept
 {
     ferr.clear();
 
-    boost::system::error_code ecode;
-    boost::filesystem::copy_file(
-        boost::filesystem::path(from), 
-        boost::filesystem::path(to),
-        boost::filesystem::copy_option::overwrite_if_exists, ecode);
+    ffile in(::open(from.c_str(), O_RDONLY | O_CLOEXEC), O_RDONLY);
+
+    if (!in.vaild())
+    {
+        ferr = ferror(errno, "Can't copy file, open source file failed.");
+        return;
+    }
+
+    struct stat instat = { 0 };
+
+    if (::fstat(in, &instat) == -1)
+    {
+        ferr = ferror(errno, "Can't copy file, fstat() failed.");
+        return;
+    }
+
+    if (!S_ISREG(instat.st_mode))
+    {
+        ferr = ferror(S_ISDIR(instat.st_mode) ? EISDIR : EINVAL, "Can't copy file, the source is not a regular file.");
+        return;
+    }
+
+    // 目标为符号链接时失败(O_NOFOLLOW), 截断前需确认目标与源文件不是同一个文件.
+    ffile out(::open(to.c_str(), O_WRONLY | O_CREAT | O_NOFOLLOW | O_CLOEXEC, instat.st_mode & 0777), O_WRONLY);
+
+    if (!out.vaild())
+    {
+        ferr = ferror(errno, "Can't copy file, open destination file failed.");
+        return;
+    }
+
+    struct stat outstat = { 0 };
+
+    if (::fstat(out, &outstat) == -1)
+    {
+        ferr = ferror(errno, "Can't copy file, fstat() failed.");
+        return;
+    }
+
+    if (instat.st_dev == outstat.st_dev && instat.st_ino == outstat.st_ino)
+    {
+        ferr = ferror(EINVAL, "Can't copy file, the source and destination are the same file.");
+        return;
+    }
+
+    if (::ftruncate(out, 0) == -1)
+    {
+        ferr = ferror(errno, "Can't copy file, ftruncate() failed.");
+        return;
+    }
+
+    // 保持与源文件相同的权限, 对于已经存在的目标文件, 若不是文件所有者则忽略.
+    ::fchmod(out, instat.st_mode & 07777);
+
+    fsize size = static_cast<fsize>(instat.st_size);
+
+#if OS_LINUX && defined(FICLONE)
+    // 
+    // 支持reflink的文件系统(Btrfs, XFS等)上, 目标文件与源文件共享数据块, 不需要拷贝数据.
+    // https://man7.org/linux/man-pages/man2/ioctl_ficlone.2.html
+
+    if (::ioctl(out, FICLONE, static_cast<int>(in)) == 0)
+    {
+        if (progress && !progress(size, size))
+        {
+            ferr = ferror(ECANCELED, "The file copy was canceled.");
+            out.close();
+            ::unlink(to.c_str());
+        }
+
+        return;
+    }
+#endif
+
+    detail::copy_context context = {
+        in, out, size, detail::copy_with_range, nullptr, progress
+    };
+
+    detail::copy_extents(context, ferr);
+
+    ::free(context.buffer);
+
+    // 扩展至源文件大小, 以保留末尾的空洞.
+    if (!ferr && ::ftruncate(out, static_cast<off_t>(size)) == -1)
+    {
+        ferr = ferror(errno, "Can't copy file, ftruncate() failed.");
+    }
+
+    if (!ferr && progress && !progress(size, size))
+    {
+        ferr = ferror(ECANCELED, "The file copy was canceled.");
+    }
 
-    if (ecode)
+    if (ferr)
     {
-        ferr = ferror(ecode.value(), "Can't copy file, copy_file() failed.");
+        out.close();
+        ::unlink(to.c_str());
     }
 }
 
@@ -173,6 +545,77 @@ void file_move(const fpath& from, const fpath& to, ferror& ferr) noexcept
     }
 }
 
+namespace detail {
+
+    inline int status_type_from_mode(mode_t mode) noexcept
+    {
+        if (S_ISREG(mode)) return entry_file;
+        if (S_ISDIR(mode)) return entry_directory;
+        if (S_ISLNK(mode)) return entry_symlink;
+        return entry_other;
+    }
+
+    // 
+    // 获取文件状态, 成功返回0, 否则返回错误码.
+    // name为nullptr时获取dirfd自身的状态, 否则获取相对于dirfd的name的状态, flags 为AT_SYMLINK_NOFOLLOW 或 0.
+    inline int status_at(int dirfd, const char* name, int flags, fstatus& status) noexcept
+    {
+#if OS_LINUX && defined(STATX_BTIME)
+        // 
+        // statx() 可以获取文件的创建时间, 在Linux 4.11之前的内核中不被支持, 此时回退至fstatat().
+        // https://man7.org/linux/man-pages/man2/statx.2.html
+        static std::atomic<bool> unsupported(false);
+
+        if (!unsupported.load(std::memory_order_relaxed))
+        {
+            struct statx stx;
+
+            if (::statx(dirfd, name ? name : "", name ? flags : AT_EMPTY_PATH, STATX_BASIC_STATS | STATX_BTIME, &stx) == 0)
+            {
+                status.type   = status_type_from_mode(stx.stx_mode);
+                status.mode   = stx.stx_mode;
+                status.size   = stx.stx_size;
+                status.inode  = stx.stx_ino;
+                status.device = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+                status.nlink  = stx.stx_nlink;
+                status.time.create_time = (stx.stx_mask & STATX_BTIME) ? stx.stx_btime.tv_sec : -1;
+                status.time.access_time = stx.stx_atime.tv_sec;
+                status.time.modify_time = stx.stx_mtime.tv_sec;
+                status.time.change_time = stx.stx_ctime.tv_sec;
+                return 0;
+            }
+
+            if (errno != ENOSYS)
+                return errno;
+
+            unsupported.store(true, std::memory_order_relaxed);
+        }
+#endif
+
+        struct stat st;
+
+        if ((name ? ::fstatat(dirfd, name, &st, flags) : ::fstat(dirfd, &st)) == -1)
+            return errno;
+
+        status.type   = status_type_from_mode(st.st_mode);
+        status.mode   = st.st_mode;
+        status.size   = st.st_size;
+        status.inode  = st.st_ino;
+        status.device = st.st_dev;
+        status.nlink  = static_cast<uint32_t>(st.st_nlink);
+#ifdef HAVE_ST_BIRTHTIME
+        status.time.create_time = st.st_birthtime;
+#else
+        status.time.create_time = -1;
+#endif
+        status.time.access_time = st.st_atime;
+        status.time.modify_time = st.st_mtime;
+        status.time.change_time = st.st_ctime;
+        return 0;
+    }
+
+} // detail
+
 fsize file_size(const fpath& name)
 {
     ferror ferr;
@@ -215,33 +658,33 @@ ftime file_time(const fpath& name)
 
 ftime file_time(const fpath& name, ferror& ferr) noexcept
 {
-    ferr.clear();
+    return file_status(name, true, ferr).time;
+}
 
-    struct stat statbuf = { 0 };
+fstatus file_status(const fpath& name, bool follow_symlink/* = true*/)
+{
+    ferror ferr;
+    fstatus result = file_status(name, follow_symlink, ferr);
 
-    int ecode = 0;
-    int status = ::stat(name.c_str(), &statbuf);
+    if (ferr)
+        throw ferr;
 
-    if (status == -1)
-    {
-        ferr = ferror(ecode, "Can't get file time, stat() failed.");
+    return result;
+}
 
-        ftime ft = { -1, -1, -1, -1};
-        return ft;
-    }
+fstatus file_status(const fpath& name, bool follow_symlink, ferror& ferr) noexcept
+{
+    ferr.clear();
 
-    ftime ft = { 
-#ifdef HAVE_ST_BIRTHTIME
-        statbuf.st_birthtime,
-#else
-        -1,
-#endif
-        statbuf.st_atime,
-        statbuf.st_mtime,
-        statbuf.st_ctime,
-    };
+    fstatus status = { entry_unknown, 0, 0, { -1, -1, -1, -1 }, 0, 0, 0 };
 
-    return ft;
+    int ecode = detail::status_at(AT_FDCWD, name.c_str(), follow_symlink ? 0 : AT_SYMLINK_NOFOLLOW, status);
+    if (ecode != 0)
+    {
+        ferr = ferror(ecode, "Can't get file status, statx() failed.");
+    }
+
+    return status;
 }
 
 void file_set_time(const fpath& name, const ftime& time)
@@ -335,99 +778,170 @@ void file_close(ffile& file) noexcept
     file.close();
 }
 
-void file_read(const ffile& file, void* data_out, int size)
-{
-    ferror ferr;
-    file_read(file, data_out, size, ferr);
-
-    if (ferr)
-        throw ferr;
-}
+namespace detail {
 
-void file_read(const ffile& file, void* data_out, int size, ferror& ferr) noexcept
-{
-    ferr.clear();
+    // 单次系统调用传输的最大字节数, Linux 单次读写最多传输 0x7ffff000 字节.
+    const fsize max_io_chunk = 0x40000000;
 
-    if (!file.vaild())
+    // 根据已传输的字节数, 调整iovec数组的起始位置及首个缓冲区
+    inline void advance_iovec(std::vector<struct iovec>& vecs, size_t& first, size_t transferred) noexcept
     {
-        ferr = ferror(-1, "Invalid file handle");
-        return;
+        while (transferred > 0 && first < vecs.size())
+        {
+            if (transferred >= vecs[first].iov_len)
+            {
+                transferred -= vecs[first].iov_len;
+                vecs[first].iov_len = 0;
+                ++first;
+            }
+            else
+            {
+                vecs[first].iov_base = static_cast<char*>(vecs[first].iov_base) + transferred;
+                vecs[first].iov_len -= transferred;
+                transferred = 0;
+            }
+        }
+
+        while (first < vecs.size() && vecs[first].iov_len == 0)
+            ++first;
     }
 
-    // 系统调用被信号中断后继续尝试之
-    // https://linux.die.net/man/2/read
-    // 
+    // 流式读写的块大小, 及O_DIRECT要求的缓冲区与偏移量的对齐
+    const size_t stream_chunk = 0x400000;
+    const size_t stream_align = 0x1000;
 
-    int bytesRead = 0;
-    do
+    struct aligned_deleter
     {
-        bytesRead = ::read(file, data_out, static_cast<size_t>(size));
+        void operator()(void* ptr) const noexcept { ::free(ptr); }
+    };
 
-        if(bytesRead >= 0)
-            break;
-    } 
-    while (errno == EINTR);
-    
-    if (bytesRead == -1)
+    typedef std::unique_ptr<char, aligned_deleter> aligned_buffer;
+
+    inline aligned_buffer make_aligned_buffer(size_t size) noexcept
     {
-        ferr = ferror(errno, "Can't read file data, read() failed.");
-        return;
+        void* ptr = nullptr;
+        if (::posix_memalign(&ptr, stream_align, size) != 0)
+            return aligned_buffer();
+
+        return aligned_buffer(static_cast<char*>(ptr));
     }
 
-    if (static_cast<int>(bytesRead) != size)
+    // 取消O_DIRECT标志, 用于文件系统拒绝直接I/O或数据未对齐时
+    inline void disable_direct(int fd) noexcept
     {
-        ferr = ferror(-1, "The file was read successfully, but it was too short");
+#if defined(O_DIRECT)
+        int status = ::fcntl(fd, F_GETFL);
+        if (status != -1)
+            ::fcntl(fd, F_SETFL, status & ~O_DIRECT);
+#endif
     }
-}
-
-void file_write(ffile& file, const void *data, int size)
-{
-    ferror ferr;
-    file_write(file, data, size, ferr);
-
-    if (ferr)
-        throw ferr;
-}
-
-void file_write(ffile& file, const void *data, int size, ferror& ferr) noexcept
-{
-    ferr.clear();
 
-    if (!file.vaild())
+    // 丢弃[offset, offset + length)的页缓存, 仅为建议, 失败时忽略.
+    inline void drop_cache(int fd, fsize offset, fsize length) noexcept
     {
-        ferr = ferror(-1, "Invalid file handle");
-        return;
+#if defined(POSIX_FADV_DONTNEED)
+        ::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+#endif
     }
 
-    // 
-    // https://linux.die.net/man/2/write
-    //
-
-    int bytesWritten = 0;
-    do
+    // 打开流式读写的文件, 要求O_DIRECT但文件系统不支持(如tmpfs)时不带O_DIRECT重试.
+    inline int open_stream(const fpath& name, int oflag, int flags, bool& direct) noexcept
     {
-        bytesWritten = ::write(file, data, static_cast<size_t>(size));
-
-        if (bytesWritten >= 0)
-            break;
-    } while (errno == EINTR);
+        direct = false;
+#if defined(O_DIRECT)
+        if (flags & fstream_direct)
+        {
+            int fd = ::open(name.c_str(), oflag | O_DIRECT, 0666);
+            if (fd != -1 || errno != EINVAL)
+            {
+                direct = fd != -1;
+                return fd;
+            }
+        }
+#endif
+        return ::open(name.c_str(), oflag, 0666);
+    }
 
-    if (bytesWritten == -1 || bytesWritten != size)
+    // 将块设备或文件的内容读满size字节, 返回读取的字节数, 仅在到达文件末尾时少于size.
+    inline ssize_t read_full(int fd, char* buffer, size_t size, fsize offset, bool& direct) noexcept
     {
-        ferr = ferror(errno, "File write failed, write() failed.");
+        size_t bytesRead = 0;
+        while (bytesRead < size)
+        {
+            ssize_t result = ::pread(fd, buffer + bytesRead, size - bytesRead, static_cast<off_t>(offset + bytesRead));
+            if (result == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                // 部分文件系统在打开时接受O_DIRECT, 读取时才拒绝
+                if (errno == EINVAL && direct)
+                {
+                    direct = false;
+                    disable_direct(fd);
+                    continue;
+                }
+
+                return -1;
+            }
+
+            if (result == 0)
+                break;
+
+            bytesRead += static_cast<size_t>(result);
+
+            // 直接I/O的短读之后偏移量不再对齐
+            if (direct && (bytesRead % stream_align) != 0)
+            {
+                direct = false;
+                disable_direct(fd);
+            }
+        }
+
+        return static_cast<ssize_t>(bytesRead);
     }
-}
 
-void file_seek(ffile& file, fsize offset, int whence/* = SEEK_SET*/)
+    // 从source读满size字节, 返回读取的字节数, 仅在数据结束时少于size.
+    inline size_t fill_full(const fsource& source, char* buffer, size_t size)
+    {
+        size_t filled = 0;
+        while (filled < size)
+        {
+            size_t result = source(buffer + filled, size - filled);
+            if (result == 0)
+                break;
+
+            filled += std::min(result, size - filled);
+        }
+
+        return filled;
+    }
+
+    inline std::vector<struct iovec> make_iovec(const fiovec* iov, int count)
+    {
+        std::vector<struct iovec> vecs(count > 0 ? count : 0);
+
+        for (int i = 0; i < count; ++i)
+        {
+            vecs[i].iov_base = iov[i].base;
+            vecs[i].iov_len  = iov[i].size;
+        }
+
+        return vecs;
+    }
+
+} // detail
+
+void file_read(const ffile& file, void* data_out, fsize size)
 {
     ferror ferr;
-    file_seek(file, offset, whence, ferr);
+    file_read(file, data_out, size, ferr);
 
     if (ferr)
         throw ferr;
 }
 
-void file_seek(ffile& file, fsize offset, int whence, ferror& ferr) noexcept
+void file_read(const ffile& file, void* data_out, fsize size, ferror& ferr) noexcept
 {
     ferr.clear();
 
@@ -437,51 +951,87 @@ void file_seek(ffile& file, fsize offset, int whence, ferror& ferr) noexcept
         return;
     }
 
+    // 系统调用被信号中断后继续尝试之, 发生短读时继续读取剩余的部分.
+    // https://linux.die.net/man/2/read
     // 
-    // https://linux.die.net/man/2/lseek
-
-    fsize pos = static_cast<long long>(lseek(file, offset, whence));
 
-    if (pos == -1)
+    fsize bytesRead = 0;
+    while (bytesRead < size)
     {
-        ferr = ferror(errno, "Cannot move file pointer, lseek() failed.");
+        size_t  chunk  = static_cast<size_t>(std::min<fsize>(size - bytesRead, detail::max_io_chunk));
+        ssize_t result = ::read(file, static_cast<char*>(data_out) + bytesRead, chunk);
+
+        if (result == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            ferr = ferror(errno, "Can't read file data, read() failed.");
+            return;
+        }
+
+        if (result == 0)
+        {
+            ferr = ferror(-1, "The file was read successfully, but it was too short");
+            return;
+        }
+
+        bytesRead += static_cast<fsize>(result);
     }
 }
 
-fsize file_tell(const ffile& file)
+void file_write(ffile& file, const void *data, fsize size)
 {
     ferror ferr;
-    int64_t result = file_tell(file, ferr);
+    file_write(file, data, size, ferr);
 
     if (ferr)
         throw ferr;
-
-    return result;
 }
 
-fsize file_tell(const ffile& file, ferror& ferr) noexcept
+void file_write(ffile& file, const void *data, fsize size, ferror& ferr) noexcept
 {
     ferr.clear();
+
     if (!file.vaild())
     {
         ferr = ferror(-1, "Invalid file handle");
-        return 0;
+        return;
     }
 
-    fsize pos = static_cast<long long>(lseek(file, 0, SEEK_CUR));
+    // 
+    // https://linux.die.net/man/2/write
+    //
 
-    if (pos == -1)
+    fsize bytesWritten = 0;
+    while (bytesWritten < size)
     {
-        ferr = ferror(errno, "Cannot get file pointer, lseek() failed.");
-    }
+        size_t  chunk  = static_cast<size_t>(std::min<fsize>(size - bytesWritten, detail::max_io_chunk));
+        ssize_t result = ::write(file, static_cast<const char*>(data) + bytesWritten, chunk);
 
-    return pos;
+        if (result == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            ferr = ferror(errno, "File write failed, write() failed.");
+            return;
+        }
+
+        if (result == 0)
+        {
+            ferr = ferror(-1, "File write failed, write() wrote nothing.");
+            return;
+        }
+
+        bytesWritten += static_cast<fsize>(result);
+    }
 }
 
-fsize file_size(const ffile& file)
+fsize file_read_stream(const fpath& name, const fsink& sink, fsize offset/* = 0*/, fsize length/* = fsize(-1)*/, int flags/* = fstream_default*/)
 {
     ferror ferr;
-    fsize result = file_size(file, ferr);
+    fsize result = file_read_stream(name, sink, offset, length, flags, ferr);
 
     if (ferr)
         throw ferr;
@@ -489,49 +1039,87 @@ fsize file_size(const ffile& file)
     return result;
 }
 
-fsize file_size(const ffile& file, ferror& ferr) noexcept
+fsize file_read_stream(const fpath& name, const fsink& sink, fsize offset, fsize length, int flags, ferror& ferr) noexcept
 {
     ferr.clear();
+
+    bool direct = false;
+    ffile file(detail::open_stream(name, O_RDONLY, flags, direct), O_RDONLY);
     if (!file.vaild())
     {
-        ferr = ferror(-1, "Invalid file handle");
+        ferr = ferror(errno, "Can't open file");
         return 0;
     }
 
-    //
-    // https://linux.die.net/man/2/lseek
-
-    fsize curr = 0, size = 0;
-    do
+    detail::aligned_buffer buffer = detail::make_aligned_buffer(detail::stream_chunk);
+    if (!buffer)
     {
-        curr = static_cast<long long>(lseek(file, 0, SEEK_CUR));
-        if (curr == -1)
-            break;
+        ferr = ferror(ENOMEM, "Can't allocate the read buffer.");
+        return 0;
+    }
 
-        size = static_cast<long long>(lseek(file, 0, SEEK_END));
-        if (size == -1)
-            break;
+    bool nocache = (flags & (fstream_nocache | fstream_direct)) != 0;
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(file, static_cast<off_t>(offset), 0, POSIX_FADV_SEQUENTIAL);
+#endif
 
-        if (lseek(file, curr, SEEK_SET) == -1)
+    // 直接I/O要求偏移量对齐, 从对齐的位置开始读取并跳过多余的前缀
+    fsize  position = direct ? offset - offset % detail::stream_align : offset;
+    size_t skip     = static_cast<size_t>(offset - position);
+    fsize  consumed = 0;
+
+    try
+    {
+        while (consumed < length)
         {
-            ferr = ferror(errno, "Cannot restore file pointer, lseek() failed.");
-            return size;
+            ssize_t result = detail::read_full(file, buffer.get(), detail::stream_chunk, position, direct);
+            if (result == -1)
+            {
+                ferr = ferror(errno, "Can't read file data, pread() failed.");
+                break;
+            }
+
+            if (nocache && result > 0)
+                detail::drop_cache(file, position, static_cast<fsize>(result));
+
+            position += static_cast<fsize>(result);
+            if (static_cast<size_t>(result) <= skip)
+            {
+                if (length != fsize(-1))
+                    ferr = ferror(-1, "The file was read successfully, but it was too short");
+                break;
+            }
+
+            size_t size = static_cast<size_t>(std::min<fsize>(result - skip, length - consumed));
+            bool   more = sink(buffer.get() + skip, size);
+
+            consumed += size;
+            skip = 0;
+
+            if (!more || static_cast<size_t>(result) < detail::stream_chunk)
+            {
+                if (more && consumed < length && length != fsize(-1))
+                    ferr = ferror(-1, "The file was read successfully, but it was too short");
+                break;
+            }
         }
-    } 
-    while (0);
-
-    if (curr == -1 || size == -1)
+    }
+    catch (const std::exception& e)
     {
-        ferr = ferror(errno, "Cannot get file size, lseek() failed.");
+        ferr = ferror(-1, e.what());
+    }
+    catch (...)
+    {
+        ferr = ferror(-1, "An unknown exception was thrown by the callback.");
     }
 
-    return size;
+    return consumed;
 }
 
-ftime file_time(const ffile& file)
+fsize file_write_stream(const fpath& name, const fsource& source, int flags/* = fstream_default*/)
 {
     ferror ferr;
-    ftime result = file_time(file, ferr);
+    fsize result = file_write_stream(name, source, flags, ferr);
 
     if (ferr)
         throw ferr;
@@ -539,168 +1127,1706 @@ ftime file_time(const ffile& file)
     return result;
 }
 
-ftime file_time(const ffile& file, ferror& ferr) noexcept
+fsize file_write_stream(const fpath& name, const fsource& source, int flags, ferror& ferr) noexcept
 {
     ferr.clear();
-    ftime ft = { -1, -1, -1, -1 };
 
+    bool direct = false;
+    ffile file(detail::open_stream(name, O_WRONLY | O_CREAT | O_TRUNC, flags, direct), O_WRONLY);
     if (!file.vaild())
     {
-        ferr = ferror(-1, "Invalid file handle");
-        return ft;
+        ferr = ferror(errno, "Can't open file");
+        return 0;
     }
 
-    // 
-    // https://linux.die.net/man/2/fstat
+    detail::aligned_buffer buffer = detail::make_aligned_buffer(detail::stream_chunk);
+    if (!buffer)
+    {
+        ferr = ferror(ENOMEM, "Can't allocate the write buffer.");
+        return 0;
+    }
 
-    struct stat statbuf = { 0 };
+    bool  nocache  = (flags & (fstream_nocache | fstream_direct)) != 0;
+    fsize position = 0;
+    fsize previous = 0;
 
-    if (::fstat(file, &statbuf) == -1)
+    try
+    {
+        for (;;)
+        {
+            size_t size = detail::fill_full(source, buffer.get(), detail::stream_chunk);
+            if (size == 0)
+                break;
+
+            // 最后一块的长度通常不满足直接I/O的对齐要求
+            if (direct && (size % detail::stream_align) != 0)
+            {
+                direct = false;
+                detail::disable_direct(file);
+            }
+
+            fsize written = file_pwrite(file, buffer.get(), size, position, ferr);
+            if (ferr && direct && ferr.code() == EINVAL)
+            {
+                direct = false;
+                detail::disable_direct(file);
+                written += file_pwrite(file, buffer.get() + written, size - written, position + written, ferr);
+            }
+
+            if (ferr)
+                break;
+
+            if (nocache && !direct)
+            {
+#if OS_LINUX
+                // 启动本块的回写, 等待上一块回写完成后丢弃其页缓存
+                ::sync_file_range(file, static_cast<off_t>(position), static_cast<off_t>(size), SYNC_FILE_RANGE_WRITE);
+                if (position > previous)
+                {
+                    ::sync_file_range(file, static_cast<off_t>(previous), static_cast<off_t>(position - previous), 
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+                    detail::drop_cache(file, previous, position - previous);
+                    previous = position;
+                }
+#endif
+            }
+
+            position += size;
+            if (size < detail::stream_chunk)
+                break;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        ferr = ferror(-1, e.what());
+    }
+    catch (...)
     {
-        ferr = ferror(errno, "Can't get file time, fstat() failed.");
-        return ft;
+        ferr = ferror(-1, "An unknown exception was thrown by the callback.");
     }
 
-    ft.access_time = statbuf.st_atime;
-    ft.modify_time = statbuf.st_mtime;
-    ft.change_time = statbuf.st_ctime;
+    if (!ferr && nocache && !direct)
+    {
+        ::fdatasync(file);
+        detail::drop_cache(file, previous, position - previous);
+    }
 
-#ifdef HAVE_ST_BIRTHTIME
-    ft.create_time = statbuf.st_birthtime;
+    return position;
+}
+
+
+namespace detail {
+
+    // 返回name所在的目录
+    inline fpath atomic_parent(const fpath& name)
+    {
+        std::string::size_type pos = name.find_last_of('/');
+        if (pos == std::string::npos)
+            return fpath(".");
+
+        return fpath(pos == 0 ? std::string("/") : name.substr(0, pos));
+    }
+
+    // 同一目录下唯一的临时文件名, 如: name.1234.5.tmp
+    inline fpath atomic_temp_name(const fpath& name)
+    {
+        static std::atomic<unsigned> counter(0);
+
+        char suffix[64];
+        ::snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", static_cast<int>(::getpid()), counter++);
+        return fpath(name + suffix);
+    }
+
+    inline int sync_fd(int fd, int policy) noexcept
+    {
+        int result = 0;
+        do
+        {
+            result = policy == fsync_full ? ::fsync(fd) : ::fdatasync(fd);
+        }
+        while (result == -1 && errno == EINTR);
+
+        return result;
+    }
+
+    inline void sync_directory(const fpath& dir, ferror& ferr) noexcept
+    {
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd == -1)
+        {
+            ferr = ferror(errno, "Can't open the directory, open() failed.");
+            return;
+        }
+
+        // 部分文件系统不支持同步目录
+        if (sync_fd(fd, fsync_full) == -1 && errno != EINVAL)
+            ferr = ferror(errno, "Can't sync the directory, fsync() failed.");
+
+        ::close(fd);
+    }
+
+    // 创建临时文件并写入data, anonymous 表示通过O_TMPFILE创建
+    inline ffile atomic_create_temp(
+        const fpath& name, const void* data, fsize size, const fpath& temp, bool anonymous, ferror& ferr) noexcept
+    {
+        int fd = -1;
+#if defined(O_TMPFILE)
+        if (anonymous)
+        {
+            fd = ::open(atomic_parent(name).c_str(), O_TMPFILE | O_WRONLY | O_CLOEXEC, 0666);
+            if (fd == -1)
+                return ffile();
+        }
 #endif
+        if (!anonymous)
+        {
+            fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+            if (fd == -1)
+            {
+                ferr = ferror(errno, "Can't create the temporary file.");
+                return ffile();
+            }
+        }
 
-    return ft;
-}
+        ffile file(fd, O_WRONLY);
 
-void file_set_time(const ffile& file, const ftime& time)
+        // 替换已存在的文件时沿用其权限
+        struct stat target;
+        if (::stat(name.c_str(), &target) == 0)
+            ::fchmod(fd, target.st_mode & 07777);
+
+        file_write(file, data, size, ferr);
+
+        if (!ferr && anonymous)
+        {
+            // 链接到目录后才能通过rename()替换目标文件, 链接失败时退回到普通的临时文件
+            char proc[64];
+            ::snprintf(proc, sizeof(proc), "/proc/self/fd/%d", fd);
+            if (::linkat(AT_FDCWD, proc, AT_FDCWD, temp.c_str(), AT_SYMLINK_FOLLOW) == -1)
+                return ffile();
+        }
+
+        if (ferr)
+        {
+            file.close();
+            if (!anonymous)
+                ::unlink(temp.c_str());
+
+            return ffile();
+        }
+
+        return file;
+    }
+
+    // 在name所在的目录创建临时文件temp并写入data, 返回打开的临时文件
+    inline ffile atomic_write_temp(const fpath& name, const void* data, fsize size, fpath& temp, ferror& ferr) noexcept
+    {
+        temp = atomic_temp_name(name);
+
+        ffile file = atomic_create_temp(name, data, size, temp, true, ferr);
+        if (file.vaild() || ferr)
+            return file;
+
+        return atomic_create_temp(name, data, size, temp, false, ferr);
+    }
+
+} // detail
+
+void file_write_atomic(const fpath& name, const void* data, fsize size, int policy/* = fsync_data*/)
 {
     ferror ferr;
-    file_set_time(file, time, ferr);
+    file_write_atomic(name, data, size, policy, ferr);
 
     if (ferr)
         throw ferr;
 }
 
-void file_set_time(const ffile& file, const ftime& time, ferror& ferr) noexcept
+void file_write_atomic(const fpath& name, const void* data, fsize size, int policy, ferror& ferr) noexcept
 {
     ferr.clear();
-    if (!file.vaild())
-    {
-        ferr = ferror(-1, "Invalid file handle");
-        return;
-    }
 
-    struct timespec times[2] = { 0 };
+    fpath temp;
+    ffile file = detail::atomic_write_temp(name, data, size, temp, ferr);
+    if (ferr)
+        return;
 
-    if (time.access_time == -1)
-        times[0].tv_sec = time.access_time;
-    else
-        times[0].tv_nsec = UTIME_OMIT;
+    if (policy != fsync_none && detail::sync_fd(file, policy) == -1)
+        ferr = ferror(errno, "Can't sync the temporary file.");
 
-    if (time.modify_time == -1)
-        times[1].tv_sec = time.modify_time;
-    else
-        times[1].tv_nsec = UTIME_OMIT;
+    file.close();
 
-    if (time.change_time != -1)
-        std::cerr << "The change_time field is discarded on the target platform" << std::endl;
+    if (!ferr && ::rename(temp.c_str(), name.c_str()) == -1)
+        ferr = ferror(errno, "Can't replace the file, rename() failed.");
 
-    if (time.create_time != -1)
-        std::cerr << "The create_time field is discarded on the target platform" << std::endl;
+    if (ferr)
+    {
+        ::unlink(temp.c_str());
+        return;
+    }
 
-    // 
-    // https://linux.die.net/man/2/utimensat
+    // 同步目录项, 否则掉电后重命名可能丢失
+    if (policy != fsync_none)
+        detail::sync_directory(detail::atomic_parent(name), ferr);
+}
 
+fatomic_batch::fatomic_batch(int policy/* = fsync_data*/)
+    : _policy(policy)
+{}
 
-    if (::futimens(file, times) == -1)
-    {
-        ferr = ferror(errno, "Can't set file time, futimens() failed.");
-    }
+fatomic_batch::~fatomic_batch()
+{
+    rollback();
 }
 
-bool file_is_writable(const fpath& name)
+void fatomic_batch::write(const fpath& name, const void* data, fsize size)
 {
     ferror ferr;
-    bool result = file_is_writable(name, ferr);
+    write(name, data, size, ferr);
 
     if (ferr)
         throw ferr;
-
-    return result;
 }
 
-bool file_is_writable(const fpath& name, ferror& ferr) noexcept
+void fatomic_batch::write(const fpath& name, const void* data, fsize size, ferror& ferr) noexcept
 {
     ferr.clear();
-    if (!file_exist(name, ferr))
-        return path_is_writable(name, ferr);
 
-    bool result = !!file_open(name, O_WRONLY, ferr);
+    entry item;
+    item.name = name;
 
+    ffile file = detail::atomic_write_temp(name, data, size, item.temp, ferr);
     if (ferr)
-    {
-        if (ferr.code() == EACCES)
-            ferr.clear();
-    }
-        
-    return result;
+        return;
+
+#if OS_LINUX
+    // 尽早启动回写, commit()时只需等待其完成
+    if (_policy != fsync_none)
+        ::sync_file_range(file, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+
+    file.close();
+    _entries.push_back(item);
 }
 
-void directories_remove(const fpath& path)
+void fatomic_batch::commit()
 {
     ferror ferr;
-    directories_remove(path, ferr);
+    commit(ferr);
 
     if (ferr)
         throw ferr;
 }
 
-#if 0
-namespace detail {
+void fatomic_batch::commit(ferror& ferr) noexcept
+{
+    ferr.clear();
 
-    inline bool remove_file(
-        const char* fpath, const struct stat* sb, int typeflag, struct FTW* ftwbuf) noexcept
+    std::vector<fpath> dirs;
+    for (auto& item : _entries)
     {
-        // 
-        // https://linux.die.net/man/3/remove
-        // 
-        return ::remove(path);
+        fpath dir = detail::atomic_parent(item.name);
+        if (std::find(dirs.begin(), dirs.end(), dir) == dirs.end())
+            dirs.push_back(dir);
     }
 
-} // deatil
-#endif
-
-void directories_remove(const fpath& path, ferror& ferr) noexcept
-{
-    ferr.clear();
+    if (_policy != fsync_none)
+    {
+        // 对于Linux, write()中已通过sync_file_range()启动回写, 这里只需等待各临时文件落盘
+        for (size_t i = 0; i < _entries.size() && !ferr; ++i)
+        {
+            int fd = ::open(_entries[i].temp.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1 || detail::sync_fd(fd, _policy) == -1)
+                ferr = ferror(errno, "Can't sync the temporary file.");
 
-#if 0
-    // 
-    // https://linux.die.net/man/3/nftw
-    // 
-    // 如果fn()返回非零值，则树遍历结束，并且fn()返回的值作为ftw()或nftw()的结果返回。
-    //
-    // FTW_DEPTH 如果设置, 则执行一个后序遍历，即在处理目录及其子目录的内容之后，对目录本身调用fn()。
-    //           (默认情况下，每个目录在其内容之前处理)
-    // FTW_PHYS  如果设置, 则不解析符号链接. 默认会解析符号链接, 但不会调用两次fn().
+            if (fd != -1)
+                ::close(fd);
+        }
+    }
 
-    if (::nftw(path.c_str(), detail::remove_file, 64, FTW_DEPTH | FTW_PHYS) != 0)
+    size_t renamed = 0;
+    for (; renamed < _entries.size() && !ferr; ++renamed)
     {
-        ferr = ferror(errno, "Can't remove the directories");
+        entry& item = _entries[renamed];
+        if (::rename(item.temp.c_str(), item.name.c_str()) == -1)
+        {
+            ferr = ferror(errno, "Can't replace the file, rename() failed.");
+            break;
+        }
+
+        item.temp.clear();
     }
-#endif
 
+    rollback();
 
-    // 
-    // 暂时使用boost的实现, 后面如有需要在行实现.
-    // remove_all() 返回出的文件数量
-    boost::system::error_code ecode;
-    boost::filesystem::remove_all(path, ecode);
+    // 同步已重命名的目录项, 保留首个错误
+    if (_policy != fsync_none && renamed > 0)
+    {
+        for (auto& dir : dirs)
+        {
+            ferror derr;
+            detail::sync_directory(dir, derr);
+            if (derr && !ferr)
+                ferr = derr;
+        }
+    }
+}
 
-    if (ecode)
+void fatomic_batch::rollback() noexcept
+{
+    for (auto& item : _entries)
     {
-        ferr = ferror(ecode.value(), "Can't remove the directories, remove_all() falied");
+        if (!item.temp.empty())
+            ::unlink(item.temp.c_str());
     }
+
+    _entries.clear();
+}
+
+size_t fatomic_batch::size() const
+{
+    return _entries.size();
+}
+
+fsize file_pread(const ffile& file, void* data_out, fsize size, fsize offset)
+{
+    ferror ferr;
+    fsize result = file_pread(file, data_out, size, offset, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_pread(const ffile& file, void* data_out, fsize size, fsize offset, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    // 
+    // https://linux.die.net/man/2/pread
+
+    fsize bytesRead = 0;
+    while (bytesRead < size)
+    {
+        size_t  chunk  = static_cast<size_t>(std::min<fsize>(size - bytesRead, detail::max_io_chunk));
+        ssize_t result = ::pread(
+            file, static_cast<char*>(data_out) + bytesRead, chunk, static_cast<off_t>(offset + bytesRead));
+
+        if (result == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            ferr = ferror(errno, "Can't read file data, pread() failed.");
+            break;
+        }
+
+        if (result == 0)
+        {
+            ferr = ferror(-1, "The file was read successfully, but it was too short");
+            break;
+        }
+
+        bytesRead += static_cast<fsize>(result);
+    }
+
+    return bytesRead;
+}
+
+fsize file_pread_some(const ffile& file, void* data_out, fsize size, fsize offset)
+{
+    ferror ferr;
+    fsize result = file_pread_some(file, data_out, size, offset, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_pread_some(const ffile& file, void* data_out, fsize size, fsize offset, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    size_t  chunk  = static_cast<size_t>(std::min<fsize>(size, detail::max_io_chunk));
+    ssize_t result = -1;
+    do
+    {
+        result = ::pread(file, data_out, chunk, static_cast<off_t>(offset));
+    }
+    while (result == -1 && errno == EINTR);
+
+    if (result == -1)
+    {
+        ferr = ferror(errno, "Can't read file data, pread() failed.");
+        return 0;
+    }
+
+    return static_cast<fsize>(result);
+}
+
+fsize file_pwrite(ffile& file, const void* data, fsize size, fsize offset)
+{
+    ferror ferr;
+    fsize result = file_pwrite(file, data, size, offset, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_pwrite(ffile& file, const void* data, fsize size, fsize offset, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    // 
+    // https://linux.die.net/man/2/pwrite
+
+    fsize bytesWritten = 0;
+    while (bytesWritten < size)
+    {
+        size_t  chunk  = static_cast<size_t>(std::min<fsize>(size - bytesWritten, detail::max_io_chunk));
+        ssize_t result = ::pwrite(
+            file, static_cast<const char*>(data) + bytesWritten, chunk, static_cast<off_t>(offset + bytesWritten));
+
+        if (result == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            ferr = ferror(errno, "File write failed, pwrite() failed.");
+            break;
+        }
+
+        if (result == 0)
+        {
+            ferr = ferror(-1, "File write failed, pwrite() wrote nothing.");
+            break;
+        }
+
+        bytesWritten += static_cast<fsize>(result);
+    }
+
+    return bytesWritten;
+}
+
+fsize file_readv(const ffile& file, const fiovec* iov, int count, fsize offset)
+{
+    ferror ferr;
+    fsize result = file_readv(file, iov, count, offset, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_readv(const ffile& file, const fiovec* iov, int count, fsize offset, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    // 
+    // https://linux.die.net/man/2/preadv
+    // 单次调用的缓冲区数量不能超过IOV_MAX, 超出部分将在后续调用中读取.
+
+    std::vector<struct iovec> vecs = detail::make_iovec(iov, count);
+
+    size_t first = 0;
+    fsize  bytesRead = 0;
+
+    detail::advance_iovec(vecs, first, 0);
+
+    while (first < vecs.size())
+    {
+        int     number = static_cast<int>(std::min<size_t>(vecs.size() - first, IOV_MAX));
+        ssize_t result = ::preadv(file, &vecs[first], number, static_cast<off_t>(offset + bytesRead));
+
+        if (result == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            ferr = ferror(errno, "Can't read file data, preadv() failed.");
+            break;
+        }
+
+        if (result == 0)
+        {
+            ferr = ferror(-1, "The file was read successfully, but it was too short");
+            break;
+        }
+
+        bytesRead += static_cast<fsize>(result);
+        detail::advance_iovec(vecs, first, static_cast<size_t>(result));
+    }
+
+    return bytesRead;
+}
+
+fsize file_writev(ffile& file, const fiovec* iov, int count, fsize offset)
+{
+    ferror ferr;
+    fsize result = file_writev(file, iov, count, offset, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_writev(ffile& file, const fiovec* iov, int count, fsize offset, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    // 
+    // https://linux.die.net/man/2/pwritev
+
+    std::vector<struct iovec> vecs = detail::make_iovec(iov, count);
+
+    size_t first = 0;
+    fsize  bytesWritten = 0;
+
+    detail::advance_iovec(vecs, first, 0);
+
+    while (first < vecs.size())
+    {
+        int     number = static_cast<int>(std::min<size_t>(vecs.size() - first, IOV_MAX));
+        ssize_t result = ::pwritev(file, &vecs[first], number, static_cast<off_t>(offset + bytesWritten));
+
+        if (result == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            ferr = ferror(errno, "File write failed, pwritev() failed.");
+            break;
+        }
+
+        if (result == 0)
+        {
+            ferr = ferror(-1, "File write failed, pwritev() wrote nothing.");
+            break;
+        }
+
+        bytesWritten += static_cast<fsize>(result);
+        detail::advance_iovec(vecs, first, static_cast<size_t>(result));
+    }
+
+    return bytesWritten;
+}
+
+void file_seek(ffile& file, fsize offset, int whence/* = SEEK_SET*/)
+{
+    ferror ferr;
+    file_seek(file, offset, whence, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void file_seek(ffile& file, fsize offset, int whence, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return;
+    }
+
+    // 
+    // https://linux.die.net/man/2/lseek
+
+    fsize pos = static_cast<long long>(lseek(file, offset, whence));
+
+    if (pos == -1)
+    {
+        ferr = ferror(errno, "Cannot move file pointer, lseek() failed.");
+    }
+}
+
+fsize file_tell(const ffile& file)
+{
+    ferror ferr;
+    int64_t result = file_tell(file, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_tell(const ffile& file, ferror& ferr) noexcept
+{
+    ferr.clear();
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    fsize pos = static_cast<long long>(lseek(file, 0, SEEK_CUR));
+
+    if (pos == -1)
+    {
+        ferr = ferror(errno, "Cannot get file pointer, lseek() failed.");
+    }
+
+    return pos;
+}
+
+fsize file_size(const ffile& file)
+{
+    ferror ferr;
+    fsize result = file_size(file, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_size(const ffile& file, ferror& ferr) noexcept
+{
+    ferr.clear();
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    //
+    // https://linux.die.net/man/2/lseek
+
+    fsize curr = 0, size = 0;
+    do
+    {
+        curr = static_cast<long long>(lseek(file, 0, SEEK_CUR));
+        if (curr == -1)
+            break;
+
+        size = static_cast<long long>(lseek(file, 0, SEEK_END));
+        if (size == -1)
+            break;
+
+        if (lseek(file, curr, SEEK_SET) == -1)
+        {
+            ferr = ferror(errno, "Cannot restore file pointer, lseek() failed.");
+            return size;
+        }
+    } 
+    while (0);
+
+    if (curr == -1 || size == -1)
+    {
+        ferr = ferror(errno, "Cannot get file size, lseek() failed.");
+    }
+
+    return size;
+}
+
+ftime file_time(const ffile& file)
+{
+    ferror ferr;
+    ftime result = file_time(file, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+ftime file_time(const ffile& file, ferror& ferr) noexcept
+{
+    return file_status(file, ferr).time;
+}
+
+fstatus file_status(const ffile& file)
+{
+    ferror ferr;
+    fstatus result = file_status(file, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fstatus file_status(const ffile& file, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    fstatus status = { entry_unknown, 0, 0, { -1, -1, -1, -1 }, 0, 0, 0 };
+
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return status;
+    }
+
+    int ecode = detail::status_at(file, nullptr, 0, status);
+    if (ecode != 0)
+    {
+        ferr = ferror(ecode, "Can't get file status, statx() failed.");
+    }
+
+    return status;
+}
+
+void file_status_batch(
+    const fpath& dir, 
+    const std::vector<fpath>& names, 
+    std::vector<fstatus>& status, 
+    std::vector<int>& errors, 
+    int concurrency/* = 1*/)
+{
+    ferror ferr;
+    file_status_batch(dir, names, status, errors, concurrency, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void file_status_batch(
+    const fpath& dir, 
+    const std::vector<fpath>& names, 
+    std::vector<fstatus>& status, 
+    std::vector<int>& errors, 
+    int concurrency, 
+    ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    fstatus none = { entry_unknown, 0, 0, { -1, -1, -1, -1 }, 0, 0, 0 };
+    status.assign(names.size(), none);
+    errors.assign(names.size(), 0);
+
+    // 仅打开一次目录, 各项相对于其描述符获取
+    ffile dirfile;
+    int   dirfd = AT_FDCWD;
+
+    if (!dir.empty())
+    {
+        dirfile = ffile(::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC), O_RDONLY);
+
+        if (!dirfile.vaild())
+        {
+            ferr = ferror(errno, "Can't get file status, open directory failed.");
+            errors.assign(names.size(), ferr.code());
+            return;
+        }
+
+        dirfd = dirfile;
+    }
+
+    // 每次领取一组, 减少线程之间的竞争
+    const size_t group = 64;
+    std::atomic<size_t> next(0);
+
+    auto work = [&]() {
+        for (size_t first; (first = next.fetch_add(group)) < names.size(); )
+        {
+            size_t last = std::min(first + group, names.size());
+
+            for (size_t i = first; i < last; ++i)
+                errors[i] = detail::status_at(dirfd, names[i].c_str(), AT_SYMLINK_NOFOLLOW, status[i]);
+        }
+    };
+
+    if (concurrency <= 0)
+        concurrency = std::max<int>(1, std::thread::hardware_concurrency());
+
+    concurrency = static_cast<int>(std::min<size_t>(concurrency, (names.size() + group - 1) / group));
+
+    std::vector<std::thread> workers;
+
+    for (int i = 1; i < concurrency; ++i)
+    {
+        try
+        {
+            workers.emplace_back(work);
+        }
+        catch (const std::system_error&)
+        {
+            break;  // 无法创建更多的线程, 以现有的线程继续
+        }
+    }
+
+    work();
+
+    for (auto& worker : workers)
+        worker.join();
+
+    auto failed = std::find_if(errors.begin(), errors.end(), [](int code) { return code != 0; });
+    if (failed != errors.end())
+    {
+        ferr = ferror(*failed, "Can't get file status, some files failed.");
+    }
+}
+
+void file_set_time(const ffile& file, const ftime& time)
+{
+    ferror ferr;
+    file_set_time(file, time, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void file_set_time(const ffile& file, const ftime& time, ferror& ferr) noexcept
+{
+    ferr.clear();
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return;
+    }
+
+    struct timespec times[2] = { 0 };
+
+    if (time.access_time == -1)
+        times[0].tv_sec = time.access_time;
+    else
+        times[0].tv_nsec = UTIME_OMIT;
+
+    if (time.modify_time == -1)
+        times[1].tv_sec = time.modify_time;
+    else
+        times[1].tv_nsec = UTIME_OMIT;
+
+    if (time.change_time != -1)
+        std::cerr << "The change_time field is discarded on the target platform" << std::endl;
+
+    if (time.create_time != -1)
+        std::cerr << "The create_time field is discarded on the target platform" << std::endl;
+
+    // 
+    // https://linux.die.net/man/2/utimensat
+
+
+    if (::futimens(file, times) == -1)
+    {
+        ferr = ferror(errno, "Can't set file time, futimens() failed.");
+    }
+}
+
+namespace detail {
+
+    // 返回视图所在的按页对齐的内存范围
+    inline void mapping_page_range(const fmapping& mapping, void*& address, size_t& length) noexcept
+    {
+        static const uintptr_t page_size = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+
+        uintptr_t first = reinterpret_cast<uintptr_t>(mapping.data());
+        uintptr_t base  = first & ~(page_size - 1);
+
+        address = reinterpret_cast<void*>(base);
+        length  = static_cast<size_t>(mapping.size()) + static_cast<size_t>(first - base);
+    }
+
+} // detail
+
+fmapping file_map(const ffile& file, int mode/* = map_read*/, fsize offset/* = 0*/, fsize length/* = fsize(-1)*/)
+{
+    ferror ferr;
+    fmapping result = file_map(file, mode, offset, length, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fmapping file_map(const ffile& file, int mode, fsize offset, fsize length, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return fmapping();
+    }
+
+    struct stat statbuf = { 0 };
+
+    if (::fstat(file, &statbuf) == -1)
+    {
+        ferr = ferror(errno, "Can't get file size, fstat() failed.");
+        return fmapping();
+    }
+
+    fsize size = static_cast<fsize>(statbuf.st_size);
+
+    if (offset > size)
+    {
+        ferr = ferror(EINVAL, "The mapping offset is beyond the end of the file.");
+        return fmapping();
+    }
+
+    if (length == fsize(-1))
+        length = size - offset;
+
+    if (length > size - offset)
+    {
+        ferr = ferror(EINVAL, "The mapping range is beyond the end of the file.");
+        return fmapping();
+    }
+
+    // 空文件或空范围, mmap()将返回EINVAL, 这里返回一个空视图.
+    if (length == 0)
+        return fmapping();
+
+    // mmap() 要求offset是页大小的整数倍
+    // https://linux.die.net/man/2/mmap
+
+    static const fsize page_size = static_cast<fsize>(::sysconf(_SC_PAGESIZE));
+
+    fsize delta   = offset % page_size;
+    fsize aligned = offset - delta;
+
+    if (length + delta > static_cast<fsize>(SIZE_MAX))
+    {
+        ferr = ferror(ENOMEM, "The mapping range exceeds the address space.");
+        return fmapping();
+    }
+
+    int prot = PROT_READ;
+    if (mode & map_write)
+        prot |= PROT_WRITE;
+
+    void* address = ::mmap(
+        nullptr, 
+        static_cast<size_t>(length + delta), 
+        prot, 
+        MAP_SHARED, 
+        file, 
+        static_cast<off_t>(aligned));
+
+    if (address == MAP_FAILED)
+    {
+        ferr = ferror(errno, "Can't map file, mmap() failed.");
+        return fmapping();
+    }
+
+    return fmapping(address, length + delta, delta, offset, mode);
+}
+
+void file_map_advise(const fmapping& mapping, int advice)
+{
+    ferror ferr;
+    file_map_advise(mapping, advice, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void file_map_advise(const fmapping& mapping, int advice, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!mapping.vaild())
+        return;
+
+    // madvise() 要求地址按页对齐, 视图首地址向下对齐后即为映射区域的首地址.
+    // https://linux.die.net/man/2/madvise
+
+    void*  address = nullptr;
+    size_t length  = 0;
+    detail::mapping_page_range(mapping, address, length);
+
+    struct advice_pair
+    {
+        int flag;
+        int native;
+    }
+    advices[] = {
+        { advise_sequential, MADV_SEQUENTIAL },
+        { advise_random,     MADV_RANDOM     },
+        { advise_willneed,   MADV_WILLNEED   },
+#ifdef MADV_HUGEPAGE
+        { advise_hugepage,   MADV_HUGEPAGE   },
+#endif
+    };
+
+    if (advice == advise_normal)
+    {
+        if (::madvise(address, length, MADV_NORMAL) == -1)
+            ferr = ferror(errno, "Can't advise file mapping, madvise() failed.");
+        return;
+    }
+
+    for (size_t i = 0; i < sizeof(advices) / sizeof(advices[0]); ++i)
+    {
+        if (!(advice & advices[i].flag))
+            continue;
+
+        if (::madvise(address, length, advices[i].native) == -1)
+        {
+            // 文件映射的透明大页依赖于内核配置(CONFIG_READ_ONLY_THP_FOR_FS), 不支持时忽略.
+            if (advices[i].flag == advise_hugepage && errno == EINVAL)
+                continue;
+
+            ferr = ferror(errno, "Can't advise file mapping, madvise() failed.");
+            return;
+        }
+    }
+}
+
+void file_map_flush(fmapping& mapping, bool wait/* = true*/)
+{
+    ferror ferr;
+    file_map_flush(mapping, wait, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void file_map_flush(fmapping& mapping, bool wait, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!mapping.vaild() || !(mapping.mode() & map_write))
+        return;
+
+    // 
+    // https://linux.die.net/man/2/msync
+
+    void*  address = nullptr;
+    size_t length  = 0;
+    detail::mapping_page_range(mapping, address, length);
+
+    if (::msync(address, length, wait ? MS_SYNC : MS_ASYNC) == -1)
+    {
+        ferr = ferror(errno, "Can't flush file mapping, msync() failed.");
+    }
+}
+
+bool file_is_writable(const fpath& name)
+{
+    ferror ferr;
+    bool result = file_is_writable(name, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+bool file_is_writable(const fpath& name, ferror& ferr) noexcept
+{
+    ferr.clear();
+    if (!file_exist(name, ferr))
+        return path_is_writable(name, ferr);
+
+    bool result = !!file_open(name, O_WRONLY, ferr);
+
+    if (ferr)
+    {
+        if (ferr.code() == EACCES)
+            ferr.clear();
+    }
+        
+    return result;
+}
+
+void directories_remove(const fpath& path)
+{
+    ferror ferr;
+    directories_remove(path, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+namespace detail {
+
+    // 待删除的目录, 在其内容以及所有子目录都删除后, 通过父目录的描述符删除自身.
+    struct remove_node
+    {
+        remove_node*     parent;
+        std::string      name;          // 相对于父目录的名称, 根目录为完整路径
+        DIR*             dir;
+        std::atomic<int> pending;       // 未删除的子目录数量 + 1(自身的扫描)
+
+        remove_node(remove_node* parent, const char* name)
+            : parent(parent), name(name), dir(nullptr), pending(1)
+        {}
+    };
+
+    // 
+    // 多个线程共享一个待扫描目录的栈, 后进先出使得遍历趋向于深度优先, 
+    // 从而限制同时打开的目录描述符的数量.
+    class directory_remover
+    {
+    public:
+        directory_remover()
+            : _outstanding(0)
+            , _ecode(0)
+        {}
+
+        void run(const fpath& path, int concurrency)
+        {
+            push(new remove_node(nullptr, path.c_str()));
+
+            std::vector<std::thread> workers;
+
+            for (int i = 1; i < concurrency; ++i)
+            {
+                try
+                {
+                    workers.emplace_back(&directory_remover::work, this);
+                }
+                catch (const std::system_error&)
+                {
+                    break;  // 无法创建更多的线程, 以现有的线程继续
+                }
+            }
+
+            work();
+
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        int ecode() const
+        {
+            return _ecode;
+        }
+
+        std::vector<fpath>& failed()
+        {
+            return _failed;
+        }
+
+    private:
+        void work()
+        {
+            remove_node* node = nullptr;
+
+            while (pop(node))
+            {
+                scan(node);
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (--_outstanding == 0)
+                    _condition.notify_all();
+            }
+        }
+
+        void push(remove_node* node)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stack.push_back(node);
+            ++_outstanding;
+            _condition.notify_one();
+        }
+
+        bool pop(remove_node*& node)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() {
+                return !_stack.empty() || _outstanding == 0;
+            });
+
+            if (_stack.empty())
+                return false;
+
+            node = _stack.back();
+            _stack.pop_back();
+            return true;
+        }
+
+        void scan(remove_node* node)
+        {
+            int parentfd = node->parent ? ::dirfd(node->parent->dir) : AT_FDCWD;
+            int fd = ::openat(parentfd, node->name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+            if (fd == -1 || (node->dir = ::fdopendir(fd)) == nullptr)
+            {
+                report(node, nullptr, errno);
+
+                if (fd != -1)
+                    ::close(fd);
+
+                release(node);
+                return;
+            }
+
+            for (;;)
+            {
+                errno = 0;
+                struct dirent* entry = ::readdir(node->dir);
+
+                if (entry == nullptr)
+                {
+                    if (errno != 0)
+                        report(node, nullptr, errno);
+                    break;
+                }
+
+                const char* name = entry->d_name;
+                if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+                    continue;
+
+                bool isdir = entry->d_type == DT_DIR;
+
+                // 某些文件系统不提供d_type
+                if (entry->d_type == DT_UNKNOWN)
+                {
+                    struct stat st;
+                    if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+                        isdir = S_ISDIR(st.st_mode);
+                }
+
+                if (isdir)
+                {
+                    ++node->pending;
+                    push(new remove_node(node, name));
+                }
+                else if (::unlinkat(fd, name, 0) == -1 && errno != ENOENT)
+                {
+                    report(node, name, errno);
+                }
+            }
+
+            release(node);
+        }
+
+        // 完成一个子目录或自身的扫描, 若均已完成则删除目录, 并继续向上释放父目录.
+        void release(remove_node* node)
+        {
+            while (node && --node->pending == 0)
+            {
+                remove_node* parent = node->parent;
+
+                if (node->dir)
+                {
+                    ::closedir(node->dir);
+
+                    int parentfd = parent ? ::dirfd(parent->dir) : AT_FDCWD;
+                    if (::unlinkat(parentfd, node->name.c_str(), AT_REMOVEDIR) == -1 && errno != ENOENT)
+                        report(node, nullptr, errno);
+                }
+
+                delete node;
+                node = parent;
+            }
+        }
+
+        void report(const remove_node* node, const char* name, int code)
+        {
+            std::string path = name ? name : "";
+
+            for (; node; node = node->parent)
+            {
+                if (path.empty())
+                    path = node->name;
+                else if (node->name.back() == '/')
+                    path = node->name + path;
+                else
+                    path = node->name + "/" + path;
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_failed.empty())
+                _ecode = code;
+
+            _failed.push_back(path);
+        }
+
+    private:
+        std::mutex                  _mutex;
+        std::condition_variable     _condition;
+        std::vector<remove_node*>   _stack;
+        size_t                      _outstanding;   // 已入栈但尚未扫描完成的目录数量
+        std::vector<fpath>          _failed;
+        int                         _ecode;
+    };
+
+} // detail
+
+void directories_remove(const fpath& path, ferror& ferr) noexcept
+{
+    directories_remove(path, 1, ferr);
+}
+
+std::vector<fpath> directories_remove(const fpath& path, int concurrency, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    std::vector<fpath> failed;
+
+    if (path.empty())
+    {
+        ferr = ferror(EINVAL, "Invalid parameter. An empty path cannot be deleted.");
+        return failed;
+    }
+
+    // 与remove_all()一致, 不存在时不视为错误, 若不是目录则仅删除它自身.
+    struct stat st;
+    if (::lstat(path.c_str(), &st) == -1)
+    {
+        if (errno != ENOENT)
+        {
+            ferr = ferror(errno, "Can't remove the directories, lstat() failed.");
+            failed.push_back(path);
+        }
+
+        return failed;
+    }
+
+    if (!S_ISDIR(st.st_mode))
+    {
+        if (::unlink(path.c_str()) == -1)
+        {
+            ferr = ferror(errno, "Can't remove the directories, unlink() failed.");
+            failed.push_back(path);
+        }
+
+        return failed;
+    }
+
+    if (concurrency <= 0)
+        concurrency = std::max<int>(1, std::thread::hardware_concurrency());
+
+    detail::directory_remover remover;
+    remover.run(path, concurrency);
+
+    if (!remover.failed().empty())
+    {
+        ferr = ferror(remover.ecode(), "Can't remove the directories, some files failed to remove.");
+        failed.swap(remover.failed());
+    }
+
+    return failed;
+}
+
+namespace detail {
+
+#if OS_LINUX
+    // 
+    // getdents64() 返回的目录项
+    // https://man7.org/linux/man-pages/man2/getdents.2.html
+    struct linux_dirent64
+    {
+        uint64_t       d_ino;
+        int64_t        d_off;
+        unsigned short d_reclen;
+        unsigned char  d_type;
+        char           d_name[1];
+    };
+
+    // 每次getdents64()读取的字节数, 通常可以容纳上千个目录项.
+    const size_t walk_buffer_size = 64 * 1024;
+#endif
+
+    inline int walk_entry_type(unsigned char d_type) noexcept
+    {
+        switch (d_type)
+        {
+        case DT_REG: return entry_file;
+        case DT_DIR: return entry_directory;
+        case DT_LNK: return entry_symlink;
+        case DT_UNKNOWN: return entry_unknown;
+        default:     return entry_other;
+        }
+    }
+
+    struct walk_dir
+    {
+        int     fd;
+        int     depth;
+        size_t  prefix;         // 该目录中的目录项名称在entry._path中的偏移
+#if OS_LINUX
+        char*   buffer;
+        int     offset;
+        int     length;
+#else
+        DIR*    dir;
+#endif
+    };
+
+    struct walk_state
+    {
+        fwalk_options           options;
+        directory_entry         entry;
+        std::vector<walk_dir>   stack;
+        bool                    descend;    // 在下一次next()时进入当前目录项
+#if OS_LINUX
+        std::vector<std::unique_ptr<char[]>> buffers;  // 按深度复用的读取缓冲区
+#endif
+
+        walk_state(const fpath& path, const fwalk_options& options)
+            : options(options)
+            , descend(false)
+        {
+            entry._path = path;
+        }
+
+        ~walk_state()
+        {
+            while (!stack.empty())
+                pop();
+        }
+
+        // 打开相对于parentfd的目录name, 并将其压入栈中, 此时entry._path 为该目录的完整路径.
+        bool push(int parentfd, const char* name, int depth, ferror& ferr) noexcept
+        {
+            int fd = ::openat(parentfd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC | (depth > 0 ? O_NOFOLLOW : 0));
+
+            if (fd == -1)
+            {
+                ferr = ferror(errno, "Can't open the directory, openat() failed.");
+                return false;
+            }
+
+            walk_dir dir = { 0 };
+            dir.fd    = fd;
+            dir.depth = depth;
+
+#if OS_LINUX
+            if (buffers.size() < stack.size() + 1)
+            {
+                char* buffer = new (std::nothrow) char[walk_buffer_size];
+                if (buffer == nullptr)
+                {
+                    ::close(fd);
+                    ferr = ferror(ENOMEM, "Can't open the directory, allocate buffer failed.");
+                    return false;
+                }
+
+                buffers.emplace_back(buffer);
+            }
+
+            dir.buffer = buffers[stack.size()].get();
+#else
+            if ((dir.dir = ::fdopendir(fd)) == nullptr)
+            {
+                ::close(fd);
+                ferr = ferror(errno, "Can't open the directory, fdopendir() failed.");
+                return false;
+            }
+#endif
+
+            if (entry._path.empty() || entry._path.back() != '/')
+                entry._path.push_back('/');
+
+            dir.prefix = entry._path.size();
+            stack.push_back(dir);
+            return true;
+        }
+
+        void pop() noexcept
+        {
+#if OS_LINUX
+            ::close(stack.back().fd);
+#else
+            ::closedir(stack.back().dir);
+#endif
+            stack.pop_back();
+        }
+
+        // 读取下一个目录项的名称与类型, 跳过"."与"..", 没有更多的目录项时返回false.
+        bool read(walk_dir& dir, const char*& name, unsigned char& type, ferror& ferr) noexcept
+        {
+            for (;;)
+            {
+#if OS_LINUX
+                if (dir.offset >= dir.length)
+                {
+                    long bytes = 0;
+
+                    do
+                    {
+                        bytes = ::syscall(SYS_getdents64, dir.fd, dir.buffer, walk_buffer_size);
+                    } 
+                    while (bytes == -1 && errno == EINTR);
+
+                    if (bytes == -1)
+                    {
+                        ferr = ferror(errno, "Can't read the directory, getdents64() failed.");
+                        return false;
+                    }
+
+                    if (bytes == 0)
+                        return false;
+
+                    dir.offset = 0;
+                    dir.length = static_cast<int>(bytes);
+                }
+
+                auto record = reinterpret_cast<linux_dirent64*>(dir.buffer + dir.offset);
+                dir.offset += record->d_reclen;
+
+                name = record->d_name;
+                type = record->d_type;
+#else
+                errno = 0;
+                struct dirent* record = ::readdir(dir.dir);
+
+                if (record == nullptr)
+                {
+                    if (errno != 0)
+                        ferr = ferror(errno, "Can't read the directory, readdir() failed.");
+                    return false;
+                }
+
+                name = record->d_name;
+                type = record->d_type;
+#endif
+                if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+                    continue;
+
+                return true;
+            }
+        }
+
+        bool next(ferror& ferr) noexcept
+        {
+            for (;;)
+            {
+                if (descend)
+                {
+                    descend = false;
+
+                    // 无法打开的子目录将被跳过
+                    ferror ecode;
+                    if (!push(static_cast<int>(entry._dirfd), entry.name(), entry._depth + 1, ecode) && !ferr)
+                        ferr = ecode;
+                }
+
+                if (stack.empty())
+                    return false;
+
+                walk_dir& dir = stack.back();
+
+                const char*   name = nullptr;
+                unsigned char type = DT_UNKNOWN;
+
+                ferror ecode;
+                if (!read(dir, name, type, ecode))
+                {
+                    if (ecode && !ferr)
+                        ferr = ecode;
+
+                    pop();
+                    continue;
+                }
+
+                if ((options.flags & walk_skip_hidden) && name[0] == '.')
+                    continue;
+
+                entry._path.resize(dir.prefix);
+                entry._path.append(name);
+                entry._name_offset = dir.prefix;
+                entry._depth       = dir.depth;
+                entry._dirfd       = dir.fd;
+                entry._type        = walk_entry_type(type);
+                entry._stat_state  = 0;
+
+                if ((options.flags & walk_recursive) && 
+                    (options.max_depth < 0 || dir.depth < options.max_depth))
+                {
+                    descend = entry.type() == entry_directory;
+                }
+
+                if (entry._match(options))
+                    return true;
+            }
+        }
+    };
+
+} // detail
+
+void directory_entry::_stat(ferror& ferr) const noexcept
+{
+    int ecode = detail::status_at(static_cast<int>(_dirfd), name(), AT_SYMLINK_NOFOLLOW, _status);
+
+    if (ecode != 0)
+    {
+        _stat_state = -1;
+        _stat_error = ecode;
+        ferr = ferror(ecode, "Can't get the status of the directory entry, statx() failed.");
+        return;
+    }
+
+    _stat_state = 1;
+
+    if (_type == entry_unknown)
+        _type = _status.type;
+}
+
+directory_iterator::directory_iterator(const fpath& path, const fwalk_options& options, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    std::shared_ptr<detail::walk_state> state;
+
+    try
+    {
+        state = std::make_shared<detail::walk_state>(path, options);
+    }
+    catch (const std::bad_alloc&)
+    {
+        ferr = ferror(ENOMEM, "Can't open the directory, out of memory.");
+        return;
+    }
+
+    if (!state->push(AT_FDCWD, path.c_str(), 0, ferr))
+        return;
+
+    if (state->next(ferr))
+        _state = state;
+}
+
+const directory_entry& directory_iterator::entry() const
+{
+    return _state->entry;
+}
+
+void directory_iterator::next(ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (_state && !_state->next(ferr))
+        _state.reset();
+}
+
+void directory_iterator::skip()
+{
+    if (_state)
+        _state->descend = false;
 }
 
 void directories_create(const fpath& path)
@@ -719,9 +2845,10 @@ void directories_create(const fpath& path, ferror& ferr) noexcept
     if (file_exist(path, ferr) || path_is_root(path))
         return;
 
-    fpath pdir = path;
+    fpath pdir = path_find_parent(path);
 
-    if (!file_exist(pdir = path_find_parent(pdir), ferr))
+    // 对于相对路径, 如"./parent", 父目录可能无法继续向上查找.
+    if (!pdir.empty() && pdir != path && !file_exist(pdir, ferr))
     {
         directories_create(pdir, ferr);
         if (ferr) 
@@ -2,6 +2,9 @@
 #   include "../file_util.h"
 #endif
 
+#include <algorithm>
+#include <filesystem/path_util.h>
+
 namespace util {
 
 ffile::ffile(native_type fid)
@@ -89,4 +92,361 @@ ffile::operator native_type() const
     return native_id();
 }
 
+fmapping::fmapping()
+    : _address(nullptr)
+    , _length(0)
+    , _delta(0)
+    , _offset(0)
+    , _mode(0)
+    , _native_map(-1)
+{}
+
+fmapping::fmapping(void* address, fsize length, fsize delta, fsize offset, int mode, intptr_t native_map/* = -1*/)
+    : _address(address)
+    , _length(length)
+    , _delta(delta)
+    , _offset(offset)
+    , _mode(mode)
+    , _native_map(native_map)
+{}
+
+fmapping::fmapping(fmapping& other)
+    : _address(nullptr)
+    , _length(0)
+    , _delta(0)
+    , _offset(0)
+    , _mode(0)
+    , _native_map(-1)
+{
+    _swap(other);
+}
+
+fmapping::~fmapping()
+{
+    close();
+}
+
+fmapping& fmapping::operator=(fmapping& right)
+{
+    if (this != &right)
+    {
+        close();
+        _swap(right);
+    }
+
+    return *this;
+}
+
+#if __cplusplus >= 201103L || _MSVC_LANG >= 201103L
+
+fmapping::fmapping(fmapping&& other)
+    : _address(nullptr)
+    , _length(0)
+    , _delta(0)
+    , _offset(0)
+    , _mode(0)
+    , _native_map(-1)
+{
+    _swap(other);
+}
+
+fmapping& fmapping::operator=(fmapping&& right)
+{
+    if (this != &right)
+    {
+        close();
+        _swap(right);
+    }
+
+    return *this;
+}
+
+#endif // C++ 11
+
+void fmapping::_swap(fmapping& other)
+{
+    std::swap(_address,    other._address);
+    std::swap(_length,     other._length);
+    std::swap(_delta,      other._delta);
+    std::swap(_offset,     other._offset);
+    std::swap(_mode,       other._mode);
+    std::swap(_native_map, other._native_map);
+}
+
+bool fmapping::vaild() const
+{
+    return _address != nullptr;
+}
+
+char* fmapping::data()
+{
+    return vaild() ? static_cast<char*>(_address) + _delta : nullptr;
+}
+
+const char* fmapping::data() const
+{
+    return vaild() ? static_cast<const char*>(_address) + _delta : nullptr;
+}
+
+fsize fmapping::size() const
+{
+    return vaild() ? _length - _delta : 0;
+}
+
+fsize fmapping::offset() const
+{
+    return _offset;
+}
+
+int fmapping::mode() const
+{
+    return _mode;
+}
+
+char* fmapping::begin()
+{
+    return data();
+}
+
+char* fmapping::end()
+{
+    return data() + size();
+}
+
+const char* fmapping::begin() const
+{
+    return data();
+}
+
+const char* fmapping::end() const
+{
+    return data() + size();
+}
+
+fmapping::operator bool() const
+{
+    return vaild();
+}
+
+directory_entry::directory_entry()
+    : _name_offset(0)
+    , _depth(0)
+    , _dirfd(-1)
+    , _type(entry_unknown)
+    , _stat_state(0)
+    , _stat_error(0)
+{
+    fstatus status = { entry_unknown, 0, 0, { -1, -1, -1, -1 }, 0, 0, 0 };
+    _status = status;
+}
+
+const fpath& directory_entry::path() const
+{
+    return _path;
+}
+
+const fpath::element_type* directory_entry::name() const
+{
+    return _path.c_str() + _name_offset;
+}
+
+int directory_entry::depth() const
+{
+    return _depth;
+}
+
+int directory_entry::type() const
+{
+    // 目录项本身没有提供类型时, 通过_stat()确定
+    if (_type == entry_unknown && _stat_state == 0)
+    {
+        ferror ferr;
+        _stat(ferr);
+    }
+
+    return _type;
+}
+
+bool directory_entry::is_file() const
+{
+    return type() == entry_file;
+}
+
+bool directory_entry::is_directory() const
+{
+    return type() == entry_directory;
+}
+
+bool directory_entry::is_symlink() const
+{
+    return type() == entry_symlink;
+}
+
+fsize directory_entry::size() const
+{
+    ferror ferr;
+    fsize result = size(ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize directory_entry::size(ferror& ferr) const noexcept
+{
+    return status(ferr).size;
+}
+
+ftime directory_entry::time() const
+{
+    ferror ferr;
+    ftime result = time(ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+ftime directory_entry::time(ferror& ferr) const noexcept
+{
+    return status(ferr).time;
+}
+
+fstatus directory_entry::status() const
+{
+    ferror ferr;
+    fstatus result = status(ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fstatus directory_entry::status(ferror& ferr) const noexcept
+{
+    ferr.clear();
+
+    if (_stat_state == 0)
+        _stat(ferr);
+    else if (_stat_state < 0)
+        ferr = ferror(_stat_error, "Can't get the status of the directory entry.");
+
+    return _status;
+}
+
+bool directory_entry::_match(const fwalk_options& options) const
+{
+    if (!(options.flags & walk_files_only) && options.extensions.empty())
+        return true;
+
+    if (is_directory())
+        return !(options.flags & walk_files_only);
+
+    if (options.extensions.empty())
+        return true;
+
+    auto extension = path_find_extension(name());
+
+    for (auto& item : options.extensions)
+    {
+        if (item.compare(extension) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+directory_iterator::directory_iterator()
+{}
+
+directory_iterator::directory_iterator(const fpath& path, const fwalk_options& options/* = fwalk_options()*/)
+{
+    ferror ferr;
+    _state = directory_iterator(path, options, ferr)._state;
+
+    if (ferr)
+        throw ferr;
+}
+
+bool directory_iterator::vaild() const
+{
+    return _state != nullptr;
+}
+
+void directory_iterator::next()
+{
+    ferror ferr;
+    next(ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+const directory_entry& directory_iterator::operator*() const
+{
+    return entry();
+}
+
+const directory_entry* directory_iterator::operator->() const
+{
+    return &entry();
+}
+
+directory_iterator& directory_iterator::operator++()
+{
+    ferror ferr;
+    next(ferr);
+    return *this;
+}
+
+bool directory_iterator::operator==(const directory_iterator& right) const
+{
+    return _state == right._state;
+}
+
+bool directory_iterator::operator!=(const directory_iterator& right) const
+{
+    return _state != right._state;
+}
+
+directory_iterator::operator bool() const
+{
+    return vaild();
+}
+
+void directory_walk(
+    const fpath& path, 
+    const std::function<bool(const directory_entry&)>& callback, 
+    const fwalk_options& options/* = fwalk_options()*/)
+{
+    ferror ferr;
+    directory_walk(path, callback, options, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void directory_walk(
+    const fpath& path, 
+    const std::function<bool(const directory_entry&)>& callback, 
+    const fwalk_options& options, 
+    ferror& ferr) noexcept
+{
+    directory_iterator iter(path, options, ferr);
+
+    for (ferror ecode; iter.vaild(); )
+    {
+        if (!callback(iter.entry()))
+            break;
+
+        // 跳过无法打开的子目录, 保留第一个错误
+        iter.next(ecode);
+        if (ecode && !ferr)
+            ferr = ecode;
+    }
+}
+
 } // util
\ No newline at end of file
@@ -11,6 +11,9 @@
 #endif
 
 #include <list>
+#include <atomic>
+#include <thread>
+#include <algorithm>
 #include <cctype>
 #include <cwctype>
 #include <aclapi.h>
@@ -45,6 +48,29 @@ void ffile::close()
     _open_flags = 0;
 }
 
+void fmapping::close()
+{
+    if (vaild())
+    {
+        //
+        // https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-unmapviewoffile
+
+        ::UnmapViewOfFile(_address);
+    }
+
+    if (_native_map != -1 && _native_map != 0)
+    {
+        ::CloseHandle(reinterpret_cast<HANDLE>(_native_map));
+    }
+
+    _address    = nullptr;
+    _length     = 0;
+    _delta      = 0;
+    _offset     = 0;
+    _mode       = 0;
+    _native_map = -1;
+}
+
 bool file_exist(const fpath& name)
 {
     ferror ferr;
@@ -176,6 +202,70 @@ void file_copy(const fpath& from, const fpath& to, ferror& ferr) noexcept
     }
 }
 
+void file_copy(const fpath& from, const fpath& to, const fprogress& progress)
+{
+    ferror ferr;
+    file_copy(from, to, progress, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+namespace detail {
+
+    // 
+    // https://docs.microsoft.com/en-us/windows/win32/api/winbase/nc-winbase-lpprogress_routine
+    inline DWORD CALLBACK copy_progress_routine(
+        LARGE_INTEGER TotalFileSize,
+        LARGE_INTEGER TotalBytesTransferred,
+        LARGE_INTEGER /*StreamSize*/,
+        LARGE_INTEGER /*StreamBytesTransferred*/,
+        DWORD /*dwStreamNumber*/,
+        DWORD /*dwCallbackReason*/,
+        HANDLE /*hSourceFile*/,
+        HANDLE /*hDestinationFile*/,
+        LPVOID lpData)
+    {
+        const fprogress& progress = *static_cast<const fprogress*>(lpData);
+
+        if (!progress(TotalBytesTransferred.QuadPart, TotalFileSize.QuadPart))
+            return PROGRESS_CANCEL;
+
+        return PROGRESS_CONTINUE;
+    }
+
+} // detail
+
+void file_copy(const fpath& from, const fpath& to, const fprogress& progress, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    // CopyFileEx() 会解析目标文件的符号链接, 与file_copy(from, to)保持一致, 此时操作失败.
+    DWORD attributes = ::GetFileAttributesW(to.c_str());
+    if (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_REPARSE_POINT))
+    {
+        ferr = ferror(ERROR_CANT_ACCESS_FILE, "Can't copy file, the destination is a symbolic link.");
+        return;
+    }
+
+    // 取消时, CopyFileEx() 将删除目标文件, 并返回ERROR_REQUEST_ABORTED.
+    if (::CopyFileExW(
+            from.c_str(), 
+            to.c_str(), 
+            progress ? detail::copy_progress_routine : NULL, 
+            progress ? const_cast<fprogress*>(&progress) : NULL,
+            NULL, 
+            0) == 0)
+    {
+        DWORD code = ::GetLastError();
+
+        if (code == ERROR_REQUEST_ABORTED)
+            ferr = ferror(code, "The file copy was canceled.");
+        else
+            ferr = ferror(code, "Can't copy file, CopyFileEx() failed.");
+    }
+}
+
 void file_move(const fpath& from, const fpath& to)
 {
     ferror ferr;
@@ -221,6 +311,67 @@ void file_move(const fpath& from, const fpath& to, ferror& ferr) noexcept
     }
 }
 
+namespace detail {
+
+    // 参见file_time(const ffile& file, ferror& ferr)
+    inline int64_t filetime_to_time(const FILETIME& time) noexcept
+    {
+        int64_t value = (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+        return (value - 0x019DB1DED53E8000) / 10000000;
+    }
+
+    // 获取文件状态, 成功返回ERROR_SUCCESS, 否则返回错误码.
+    inline DWORD status_from_handle(HANDLE handle, bool reparse, fstatus& status) noexcept
+    {
+        // 
+        // https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-getfileinformationbyhandle
+        BY_HANDLE_FILE_INFORMATION info;
+
+        if (::GetFileInformationByHandle(handle, &info) == 0)
+            return ::GetLastError();
+
+        if (reparse && (info.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+            status.type = entry_symlink;
+        else if (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            status.type = entry_directory;
+        else if (info.dwFileAttributes & FILE_ATTRIBUTE_DEVICE)
+            status.type = entry_other;
+        else
+            status.type = entry_file;
+
+        status.mode   = info.dwFileAttributes;
+        status.size   = (static_cast<fsize>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+        status.inode  = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+        status.device = info.dwVolumeSerialNumber;
+        status.nlink  = info.nNumberOfLinks;
+        status.time.create_time = filetime_to_time(info.ftCreationTime);
+        status.time.access_time = filetime_to_time(info.ftLastAccessTime);
+        status.time.modify_time = filetime_to_time(info.ftLastWriteTime);
+        status.time.change_time = -1;
+        return ERROR_SUCCESS;
+    }
+
+    inline DWORD status_from_path(const wchar_t* name, bool follow_symlink, fstatus& status) noexcept
+    {
+        HANDLE handle = ::CreateFileW(
+            name,                                                   // lpFileName
+            FILE_READ_ATTRIBUTES,                                   // dwDesiredAccess
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, // dwShareMode
+            NULL,                                                   // lpSecurityAttributes
+            OPEN_EXISTING,                                          // dwCreationDisposition
+            FILE_FLAG_BACKUP_SEMANTICS | (follow_symlink ? 0 : FILE_FLAG_OPEN_REPARSE_POINT),
+            NULL);                                                  // hTemplateFile
+
+        if (handle == INVALID_HANDLE_VALUE)
+            return ::GetLastError();
+
+        DWORD ecode = status_from_handle(handle, !follow_symlink, status);
+        ::CloseHandle(handle);
+        return ecode;
+    }
+
+} // detail
+
 fsize file_size(const fpath& name)
 {
     ferror ferr;
@@ -290,6 +441,32 @@ ftime file_time(const fpath& name, ferror& ferr) noexcept
     return file_time(file, ferr);
 }
 
+fstatus file_status(const fpath& name, bool follow_symlink/* = true*/)
+{
+    ferror ferr;
+    fstatus result = file_status(name, follow_symlink, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fstatus file_status(const fpath& name, bool follow_symlink, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    fstatus status = { entry_unknown, 0, 0, { -1, -1, -1, -1 }, 0, 0, 0 };
+
+    DWORD ecode = detail::status_from_path(name.c_str(), follow_symlink, status);
+    if (ecode != ERROR_SUCCESS)
+    {
+        ferr = ferror(ecode, "Can't get file status");
+    }
+
+    return status;
+}
+
 void file_set_time(const fpath& name, const ftime& time)
 {
     ferror ferr;
@@ -443,7 +620,7 @@ void file_close(ffile& file) noexcept
     file.close();
 }
 
-void file_read(const ffile& file, void* data_out, int size)
+void file_read(const ffile& file, void* data_out, fsize size)
 {
     ferror ferr;
     file_read(file, data_out, size, ferr);
@@ -452,7 +629,7 @@ void file_read(const ffile& file, void* data_out, int size)
         throw ferr;
 }
 
-void file_read(const ffile& file, void* data_out, int size, ferror& ferr) noexcept
+void file_read(const ffile& file, void* data_out, fsize size, ferror& ferr) noexcept
 {
     ferr.clear();
     if (!file.vaild())
@@ -461,20 +638,30 @@ void file_read(const ffile& file, void* data_out, int size, ferror& ferr) noexce
         return;
     }
 
-    DWORD read = 0;
-    if (!::ReadFile(reinterpret_cast<void*>(file.native_id()), data_out, (DWORD)size, &read, NULL))
+    // ReadFile() 的长度为DWORD, 这里按块读取, 发生短读时继续读取剩余的部分.
+    fsize bytesRead = 0;
+    while (bytesRead < size)
     {
-        ferr = ferror(::GetLastError(), "File read failed");
-        return;
-    }
+        DWORD chunk = static_cast<DWORD>(std::min<fsize>(size - bytesRead, 0x40000000));
+        DWORD read  = 0;
+        if (!::ReadFile(reinterpret_cast<void*>(file.native_id()), 
+            static_cast<char*>(data_out) + bytesRead, chunk, &read, NULL))
+        {
+            ferr = ferror(::GetLastError(), "File read failed");
+            return;
+        }
 
-    if (static_cast<int>(read) != size)
-    {
-        ferr = ferror(-1, "The file was read successfully, but it was too short");
+        if (read == 0)
+        {
+            ferr = ferror(-1, "The file was read successfully, but it was too short");
+            return;
+        }
+
+        bytesRead += read;
     }
 }
 
-void file_write(ffile& file, const void *data, int size)
+void file_write(ffile& file, const void *data, fsize size)
 {
     ferror ferr;
     file_write(file, data, size, ferr);
@@ -483,7 +670,7 @@ void file_write(ffile& file, const void *data, int size)
         throw ferr;
 }
 
-void file_write(ffile& file, const void *data, int size, ferror& ferr) noexcept
+void file_write(ffile& file, const void *data, fsize size, ferror& ferr) noexcept
 {
     ferr.clear();
     if (!file.vaild())
@@ -501,48 +688,111 @@ void file_write(ffile& file, const void *data, int size, ferror& ferr) noexcept
             file_seek(file, 0, FILE_END, ferr);
     }
 
-    DWORD written = 0;
-    if (!::WriteFile(
-        reinterpret_cast<void*>(file.native_id()), 
-        data, 
-        (DWORD)size, 
-        &written, 
-        NULL) && static_cast<int>(written) != size)
+    fsize bytesWritten = 0;
+    while (bytesWritten < size)
     {
-        ferr = ferror(::GetLastError(), "File write failed");
+        DWORD chunk   = static_cast<DWORD>(std::min<fsize>(size - bytesWritten, 0x40000000));
+        DWORD written = 0;
+        if (!::WriteFile(
+            reinterpret_cast<void*>(file.native_id()), 
+            static_cast<const char*>(data) + bytesWritten, 
+            chunk, 
+            &written, 
+            NULL))
+        {
+            ferr = ferror(::GetLastError(), "File write failed");
+            return;
+        }
+
+        if (written == 0)
+        {
+            ferr = ferror(-1, "File write failed, WriteFile() wrote nothing.");
+            return;
+        }
+
+        bytesWritten += written;
     }
 }
 
-void file_seek(ffile& file, fsize offset, int whence/* = SEEK_SET*/)
+namespace detail {
+
+    // 流式读写的块大小
+    const size_t stream_chunk = 0x400000;
+
+} // detail
+
+fsize file_read_stream(const fpath& name, const fsink& sink, fsize offset/* = 0*/, fsize length/* = fsize(-1)*/, int flags/* = fstream_default*/)
 {
     ferror ferr;
-    file_seek(file, offset, whence, ferr);
+    fsize result = file_read_stream(name, sink, offset, length, flags, ferr);
 
     if (ferr)
         throw ferr;
+
+    return result;
 }
 
-void file_seek(ffile& file, fsize offset, int whence, ferror& ferr) noexcept
+fsize file_read_stream(const fpath& name, const fsink& sink, fsize offset, fsize length, int flags, ferror& ferr) noexcept
 {
     ferr.clear();
-    if (!file.vaild())
+
+    // FILE_FLAG_NO_BUFFERING 要求按扇区对齐的偏移量与长度, 而file_open() 没有提供该选项, 
+    // 这里忽略flags, 由缓存管理器处理顺序读取的缓存.
+    (void)flags;
+
+    ffile file = file_open(name, O_RDONLY, ferr);
+    if (ferr)
+        return 0;
+
+    fsize size = file_size(file, ferr);
+    if (ferr)
+        return 0;
+
+    if (offset > size)
+        offset = size;
+
+    fsize available = size - offset;
+    if (length != fsize(-1) && length > available)
+        ferr = ferror(-1, "The file was read successfully, but it was too short");
+
+    fsize total    = std::min(length, available);
+    fsize consumed = 0;
+
+    try
     {
-        ferr = ferror(-1, "Invalid file handle");
-        return;
-    }
+        std::unique_ptr<char[]> buffer(new char[detail::stream_chunk]);
+        while (consumed < total)
+        {
+            ferror rerr;
+            size_t chunk = static_cast<size_t>(std::min<fsize>(total - consumed, detail::stream_chunk));
+            file_pread(file, buffer.get(), chunk, offset + consumed, rerr);
+            if (rerr)
+            {
+                ferr = rerr;
+                break;
+            }
 
-    LARGE_INTEGER distance = {0};
-    distance.QuadPart = offset;
-    if (::SetFilePointerEx(reinterpret_cast<void*>(file.native_id()), distance, NULL, whence) == 0)
+            consumed += chunk;
+            if (!sink(buffer.get(), chunk))
+                break;
+        }
+    }
+    catch (const std::exception& e)
     {
-        ferr = ferror(::GetLastError(), "Can't set file pointer");
+        ferr = ferror(-1, e.what());
+    }
+    catch (...)
+    {
+        ferr = ferror(-1, "An unknown exception was thrown by the callback.");
     }
+
+    return consumed;
 }
 
-fsize file_tell(const ffile& file)
+fsize file_write_stream(const fpath& name, const fsource& source, int flags/* = fstream_default*/)
 {
     ferror ferr;
-    int64_t result = file_tell(file, ferr);
+    fsize result = file_write_stream(name, source, flags, ferr);
 
     if (ferr)
         throw ferr;
@@ -550,121 +800,645 @@ fsize file_tell(const ffile& file)
     return result;
 }
 
-fsize file_tell(const ffile& file, ferror& ferr) noexcept
+fsize file_write_stream(const fpath& name, const fsource& source, int flags, ferror& ferr) noexcept
 {
     ferr.clear();
-    if (!file.vaild())
-    {
-        ferr = ferror(-1, "Invalid file handle");
+    (void)flags;
+
+    ffile file = file_open(name, O_WRONLY | O_CREAT | O_TRUNC, ferr);
+    if (ferr)
         return 0;
-    }
 
-    LARGE_INTEGER distance = {0};
-    if (::SetFilePointerEx(reinterpret_cast<void*>(file.native_id()), distance, &distance, FILE_CURRENT) == 0)
+    fsize position = 0;
+
+    try
     {
-        ferr = ferror(::GetLastError(), "Can't query file pointer");
+        std::unique_ptr<char[]> buffer(new char[detail::stream_chunk]);
+        for (;;)
+        {
+            size_t size = source(buffer.get(), detail::stream_chunk);
+            if (size == 0)
+                break;
+
+            size = std::min(size, detail::stream_chunk);
+            position += file_pwrite(file, buffer.get(), size, position, ferr);
+            if (ferr)
+                break;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        ferr = ferror(-1, e.what());
+    }
+    catch (...)
+    {
+        ferr = ferror(-1, "An unknown exception was thrown by the callback.");
     }
 
-    return distance.QuadPart;
+    return position;
 }
 
-fsize file_size(const ffile& file)
+namespace detail {
+
+    // 同一目录下唯一的临时文件名, 如: name.1234.5.tmp
+    inline fpath atomic_temp_name(const fpath& name)
+    {
+        static std::atomic<unsigned> counter(0);
+
+        wchar_t suffix[64];
+        ::swprintf_s(suffix, L".%lu.%u.tmp", ::GetCurrentProcessId(), counter++);
+        return fpath(name + suffix);
+    }
+
+    // 在name所在的目录创建临时文件temp并写入data, ffile::close() 将刷新文件缓冲区
+    inline void atomic_write_temp(const fpath& name, const void* data, fsize size, fpath& temp, ferror& ferr) noexcept
+    {
+        temp = atomic_temp_name(name);
+
+        ffile file = file_open(temp, O_WRONLY | O_CREAT | O_EXCL, ferr);
+        if (ferr)
+            return;
+
+        file_write(file, data, size, ferr);
+        file.close();
+
+        if (ferr)
+            ::DeleteFileW(temp.c_str());
+    }
+
+    inline bool atomic_replace(const fpath& temp, const fpath& name, int policy) noexcept
+    {
+        DWORD flags = MOVEFILE_REPLACE_EXISTING;
+        if (policy != fsync_none)
+            flags |= MOVEFILE_WRITE_THROUGH;
+
+        return ::MoveFileExW(temp.c_str(), name.c_str(), flags) != FALSE;
+    }
+
+} // detail
+
+void file_write_atomic(const fpath& name, const void* data, fsize size, int policy/* = fsync_data*/)
 {
     ferror ferr;
-    fsize result = file_size(file, ferr);
+    file_write_atomic(name, data, size, policy, ferr);
 
     if (ferr)
         throw ferr;
-
-    return result;
 }
 
-fsize file_size(const ffile& file, ferror& ferr) noexcept
+void file_write_atomic(const fpath& name, const void* data, fsize size, int policy, ferror& ferr) noexcept
 {
     ferr.clear();
-    if (!file.vaild())
+
+    fpath temp;
+    detail::atomic_write_temp(name, data, size, temp, ferr);
+    if (ferr)
+        return;
+
+    if (!detail::atomic_replace(temp, name, policy))
     {
-        ferr = ferror(-1, "Invalid file handle");
-        return 0;
+        ferr = ferror(::GetLastError(), "Can't replace the file, MoveFileEx() failed.");
+        ::DeleteFileW(temp.c_str());
     }
+}
 
-    LARGE_INTEGER large;
-    if (::GetFileSizeEx(reinterpret_cast<void*>(file.native_id()), &large) != 0)
-        return large.QuadPart;
-    else
-        ferr = ferror(::GetLastError(), "Can't get file size");
+fatomic_batch::fatomic_batch(int policy/* = fsync_data*/)
+    : _policy(policy)
+{}
 
-    return 0;
+fatomic_batch::~fatomic_batch()
+{
+    rollback();
 }
 
-ftime file_time(const ffile& file)
+void fatomic_batch::write(const fpath& name, const void* data, fsize size)
 {
     ferror ferr;
-    ftime result = file_time(file, ferr);
+    write(name, data, size, ferr);
 
     if (ferr)
         throw ferr;
+}
 
-    return result;
+void fatomic_batch::write(const fpath& name, const void* data, fsize size, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    entry item;
+    item.name = name;
+
+    detail::atomic_write_temp(name, data, size, item.temp, ferr);
+    if (!ferr)
+        _entries.push_back(item);
 }
 
-ftime file_time(const ffile& file, ferror& ferr) noexcept
+void fatomic_batch::commit()
+{
+    ferror ferr;
+    commit(ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void fatomic_batch::commit(ferror& ferr) noexcept
 {
     ferr.clear();
-    ftime ft = { -1, -1, -1, -1 };
 
-    if (!file.vaild())
+    // 临时文件在写入时已经刷新, 这里只需依次替换
+    for (auto& item : _entries)
     {
-        ferr = ferror(-1, "Invalid file handle");
-        return ft;
+        if (!detail::atomic_replace(item.temp, item.name, _policy))
+        {
+            ferr = ferror(::GetLastError(), "Can't replace the file, MoveFileEx() failed.");
+            break;
+        }
+
+        item.temp.clear();
     }
 
-    if (::GetFileTime(
-        reinterpret_cast<void*>(file.native_id()),
-        (LPFILETIME)&ft.create_time,
-        (LPFILETIME)&ft.access_time,
-        (LPFILETIME)&ft.modify_time) == 0)
+    rollback();
+}
+
+void fatomic_batch::rollback() noexcept
+{
+    for (auto& item : _entries)
     {
-        ferr = ferror(::GetLastError(), "Can't get file time");
-        return ft;
+        if (!item.temp.empty())
+            ::DeleteFileW(item.temp.c_str());
     }
 
-    /*
-    *   FILETIME structure
-    *   Contains a 64-bit value representing the number of 100-nanosecond intervals since January 1, 1601 (UTC).
-    *    UNIX epoch (1970-01-01 00:00:00) expressed in Windows NT FILETIME: 0x019DB1DED53E8000
-    */
-    ft.create_time = (ft.create_time - 0x019DB1DED53E8000) / 10000000;
-    ft.access_time = (ft.access_time - 0x019DB1DED53E8000) / 10000000;
-    ft.modify_time = (ft.modify_time - 0x019DB1DED53E8000) / 10000000;
+    _entries.clear();
+}
 
-    return ft;
+size_t fatomic_batch::size() const
+{
+    return _entries.size();
 }
 
-void file_set_time(const ffile& file, const ftime& time)
+fsize file_pread(const ffile& file, void* data_out, fsize size, fsize offset)
 {
     ferror ferr;
-    file_set_time(file, time, ferr);
+    fsize result = file_pread(file, data_out, size, offset, ferr);
 
     if (ferr)
         throw ferr;
+
+    return result;
 }
 
-void file_set_time(const ffile& file, const ftime& time, ferror& ferr) noexcept
+fsize file_pread(const ffile& file, void* data_out, fsize size, fsize offset, ferror& ferr) noexcept
 {
     ferr.clear();
     if (!file.vaild())
     {
         ferr = ferror(-1, "Invalid file handle");
-        return;
+        return 0;
     }
 
-    ftime ft = time;
-    if (ft.create_time != -1)
-        ft.create_time = ft.create_time * 10000000 + 0x019DB1DED53E8000;
-    if (ft.access_time != -1)
-        ft.access_time = ft.access_time * 10000000 + 0x019DB1DED53E8000;
-    if (ft.modify_time != -1)
+    // 通过OVERLAPPED指定读取位置, 对于同步句柄, 函数在读取完成后返回.
+    // https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-readfile
+
+    fsize bytesRead = 0;
+    while (bytesRead < size)
+    {
+        DWORD      chunk = static_cast<DWORD>(std::min<fsize>(size - bytesRead, 0x40000000));
+        DWORD      read  = 0;
+        OVERLAPPED overlapped = { 0 };
+        overlapped.Offset     = static_cast<DWORD>((offset + bytesRead) & 0xffffffff);
+        overlapped.OffsetHigh = static_cast<DWORD>((offset + bytesRead) >> 32);
+
+        if (!::ReadFile(reinterpret_cast<HANDLE>(file.native_id()), 
+            static_cast<char*>(data_out) + bytesRead, chunk, &read, &overlapped))
+        {
+            DWORD ecode = ::GetLastError();
+            if (ecode != ERROR_HANDLE_EOF)
+            {
+                ferr = ferror(ecode, "File read failed");
+                break;
+            }
+        }
+
+        if (read == 0)
+        {
+            ferr = ferror(-1, "The file was read successfully, but it was too short");
+            break;
+        }
+
+        bytesRead += read;
+    }
+
+    return bytesRead;
+}
+
+fsize file_pread_some(const ffile& file, void* data_out, fsize size, fsize offset)
+{
+    ferror ferr;
+    fsize result = file_pread_some(file, data_out, size, offset, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_pread_some(const ffile& file, void* data_out, fsize size, fsize offset, ferror& ferr) noexcept
+{
+    ferr.clear();
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    DWORD      chunk = static_cast<DWORD>(std::min<fsize>(size, 0x40000000));
+    DWORD      read  = 0;
+    OVERLAPPED overlapped = { 0 };
+    overlapped.Offset     = static_cast<DWORD>(offset & 0xffffffff);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+    if (!::ReadFile(reinterpret_cast<HANDLE>(file.native_id()), data_out, chunk, &read, &overlapped))
+    {
+        DWORD ecode = ::GetLastError();
+        if (ecode != ERROR_HANDLE_EOF)
+            ferr = ferror(ecode, "File read failed");
+    }
+
+    return read;
+}
+
+fsize file_pwrite(ffile& file, const void* data, fsize size, fsize offset)
+{
+    ferror ferr;
+    fsize result = file_pwrite(file, data, size, offset, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_pwrite(ffile& file, const void* data, fsize size, fsize offset, ferror& ferr) noexcept
+{
+    ferr.clear();
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    // https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-writefile
+
+    fsize bytesWritten = 0;
+    while (bytesWritten < size)
+    {
+        DWORD      chunk   = static_cast<DWORD>(std::min<fsize>(size - bytesWritten, 0x40000000));
+        DWORD      written = 0;
+        OVERLAPPED overlapped = { 0 };
+        overlapped.Offset     = static_cast<DWORD>((offset + bytesWritten) & 0xffffffff);
+        overlapped.OffsetHigh = static_cast<DWORD>((offset + bytesWritten) >> 32);
+
+        if (!::WriteFile(reinterpret_cast<HANDLE>(file.native_id()), 
+            static_cast<const char*>(data) + bytesWritten, chunk, &written, &overlapped))
+        {
+            ferr = ferror(::GetLastError(), "File write failed");
+            break;
+        }
+
+        if (written == 0)
+        {
+            ferr = ferror(-1, "File write failed, WriteFile() wrote nothing.");
+            break;
+        }
+
+        bytesWritten += written;
+    }
+
+    return bytesWritten;
+}
+
+fsize file_readv(const ffile& file, const fiovec* iov, int count, fsize offset)
+{
+    ferror ferr;
+    fsize result = file_readv(file, iov, count, offset, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_readv(const ffile& file, const fiovec* iov, int count, fsize offset, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    // ReadFileScatter() 要求无缓冲的异步句柄以及按页对齐的缓冲区, 这里逐个缓冲区读取.
+    fsize bytesRead = 0;
+    for (int i = 0; i < count && !ferr; ++i)
+    {
+        bytesRead += file_pread(file, iov[i].base, iov[i].size, offset + bytesRead, ferr);
+    }
+
+    return bytesRead;
+}
+
+fsize file_writev(ffile& file, const fiovec* iov, int count, fsize offset)
+{
+    ferror ferr;
+    fsize result = file_writev(file, iov, count, offset, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_writev(ffile& file, const fiovec* iov, int count, fsize offset, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    // WriteFileGather() 的限制与ReadFileScatter()相同, 这里逐个缓冲区写入.
+    fsize bytesWritten = 0;
+    for (int i = 0; i < count && !ferr; ++i)
+    {
+        bytesWritten += file_pwrite(file, iov[i].base, iov[i].size, offset + bytesWritten, ferr);
+    }
+
+    return bytesWritten;
+}
+
+void file_seek(ffile& file, fsize offset, int whence/* = SEEK_SET*/)
+{
+    ferror ferr;
+    file_seek(file, offset, whence, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void file_seek(ffile& file, fsize offset, int whence, ferror& ferr) noexcept
+{
+    ferr.clear();
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return;
+    }
+
+    LARGE_INTEGER distance = {0};
+    distance.QuadPart = offset;
+    if (::SetFilePointerEx(reinterpret_cast<void*>(file.native_id()), distance, NULL, whence) == 0)
+    {
+        ferr = ferror(::GetLastError(), "Can't set file pointer");
+    }
+}
+
+fsize file_tell(const ffile& file)
+{
+    ferror ferr;
+    int64_t result = file_tell(file, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_tell(const ffile& file, ferror& ferr) noexcept
+{
+    ferr.clear();
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    LARGE_INTEGER distance = {0};
+    if (::SetFilePointerEx(reinterpret_cast<void*>(file.native_id()), distance, &distance, FILE_CURRENT) == 0)
+    {
+        ferr = ferror(::GetLastError(), "Can't query file pointer");
+    }
+
+    return distance.QuadPart;
+}
+
+fsize file_size(const ffile& file)
+{
+    ferror ferr;
+    fsize result = file_size(file, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fsize file_size(const ffile& file, ferror& ferr) noexcept
+{
+    ferr.clear();
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return 0;
+    }
+
+    LARGE_INTEGER large;
+    if (::GetFileSizeEx(reinterpret_cast<void*>(file.native_id()), &large) != 0)
+        return large.QuadPart;
+    else
+        ferr = ferror(::GetLastError(), "Can't get file size");
+
+    return 0;
+}
+
+ftime file_time(const ffile& file)
+{
+    ferror ferr;
+    ftime result = file_time(file, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+ftime file_time(const ffile& file, ferror& ferr) noexcept
+{
+    ferr.clear();
+    ftime ft = { -1, -1, -1, -1 };
+
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return ft;
+    }
+
+    if (::GetFileTime(
+        reinterpret_cast<void*>(file.native_id()),
+        (LPFILETIME)&ft.create_time,
+        (LPFILETIME)&ft.access_time,
+        (LPFILETIME)&ft.modify_time) == 0)
+    {
+        ferr = ferror(::GetLastError(), "Can't get file time");
+        return ft;
+    }
+
+    /*
+    *   FILETIME structure
+    *   Contains a 64-bit value representing the number of 100-nanosecond intervals since January 1, 1601 (UTC).
+    *    UNIX epoch (1970-01-01 00:00:00) expressed in Windows NT FILETIME: 0x019DB1DED53E8000
+    */
+    ft.create_time = (ft.create_time - 0x019DB1DED53E8000) / 10000000;
+    ft.access_time = (ft.access_time - 0x019DB1DED53E8000) / 10000000;
+    ft.modify_time = (ft.modify_time - 0x019DB1DED53E8000) / 10000000;
+
+    return ft;
+}
+
+fstatus file_status(const ffile& file)
+{
+    ferror ferr;
+    fstatus result = file_status(file, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fstatus file_status(const ffile& file, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    fstatus status = { entry_unknown, 0, 0, { -1, -1, -1, -1 }, 0, 0, 0 };
+
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return status;
+    }
+
+    DWORD ecode = detail::status_from_handle(reinterpret_cast<HANDLE>(file.native_id()), false, status);
+    if (ecode != ERROR_SUCCESS)
+    {
+        ferr = ferror(ecode, "Can't get file status");
+    }
+
+    return status;
+}
+
+void file_status_batch(
+    const fpath& dir, 
+    const std::vector<fpath>& names, 
+    std::vector<fstatus>& status, 
+    std::vector<int>& errors, 
+    int concurrency/* = 1*/)
+{
+    ferror ferr;
+    file_status_batch(dir, names, status, errors, concurrency, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void file_status_batch(
+    const fpath& dir, 
+    const std::vector<fpath>& names, 
+    std::vector<fstatus>& status, 
+    std::vector<int>& errors, 
+    int concurrency, 
+    ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    fstatus none = { entry_unknown, 0, 0, { -1, -1, -1, -1 }, 0, 0, 0 };
+    status.assign(names.size(), none);
+    errors.assign(names.size(), 0);
+
+    // Windows 中没有相对于目录句柄的查询, 此处拼接为完整路径.
+    std::wstring prefix = dir;
+    if (!prefix.empty() && prefix.back() != L'\\' && prefix.back() != L'/')
+        prefix.push_back(L'\\');
+
+    // 每次领取一组, 减少线程之间的竞争
+    const size_t group = 64;
+    std::atomic<size_t> next(0);
+
+    auto work = [&]() {
+        std::wstring path;
+
+        for (size_t first; (first = next.fetch_add(group)) < names.size(); )
+        {
+            size_t last = std::min(first + group, names.size());
+
+            for (size_t i = first; i < last; ++i)
+            {
+                const fpath& name = names[i];
+                bool absolute = path_is_win_style(name) || path_is_unc_style(name);
+
+                path.assign(absolute ? L"" : prefix);
+                path.append(name);
+
+                errors[i] = static_cast<int>(detail::status_from_path(path.c_str(), false, status[i]));
+            }
+        }
+    };
+
+    if (concurrency <= 0)
+        concurrency = std::max<int>(1, std::thread::hardware_concurrency());
+
+    concurrency = static_cast<int>(std::min<size_t>(concurrency, (names.size() + group - 1) / group));
+
+    std::vector<std::thread> workers;
+
+    for (int i = 1; i < concurrency; ++i)
+    {
+        try
+        {
+            workers.emplace_back(work);
+        }
+        catch (const std::system_error&)
+        {
+            break;  // 无法创建更多的线程, 以现有的线程继续
+        }
+    }
+
+    work();
+
+    for (auto& worker : workers)
+        worker.join();
+
+    auto failed = std::find_if(errors.begin(), errors.end(), [](int code) { return code != 0; });
+    if (failed != errors.end())
+    {
+        ferr = ferror(*failed, "Can't get file status, some files failed.");
+    }
+}
+
+void file_set_time(const ffile& file, const ftime& time)
+{
+    ferror ferr;
+    file_set_time(file, time, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void file_set_time(const ffile& file, const ftime& time, ferror& ferr) noexcept
+{
+    ferr.clear();
+    if (!file.vaild())
+    {
+        ferr = ferror(-1, "Invalid file handle");
+        return;
+    }
+
+    ftime ft = time;
+    if (ft.create_time != -1)
+        ft.create_time = ft.create_time * 10000000 + 0x019DB1DED53E8000;
+    if (ft.access_time != -1)
+        ft.access_time = ft.access_time * 10000000 + 0x019DB1DED53E8000;
+    if (ft.modify_time != -1)
         ft.modify_time = ft.modify_time * 10000000 + 0x019DB1DED53E8000;
 
     // If the function succeeds, the return value is nonzero.
@@ -680,6 +1454,168 @@ void file_set_time(const ffile& file, const ftime& time, ferror& ferr) noexcept
     }
 }
 
+fmapping file_map(const ffile& file, int mode/* = map_read*/, fsize offset/* = 0*/, fsize length/* = fsize(-1)*/)
+{
+    ferror ferr;
+    fmapping result = file_map(file, mode, offset, length, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return result;
+}
+
+fmapping file_map(const ffile& file, int mode, fsize offset, fsize length, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    fsize size = file_size(file, ferr);
+    if (ferr)
+        return fmapping();
+
+    if (offset > size)
+    {
+        ferr = ferror(ERROR_INVALID_PARAMETER, "The mapping offset is beyond the end of the file.");
+        return fmapping();
+    }
+
+    if (length == fsize(-1))
+        length = size - offset;
+
+    if (length > size - offset)
+    {
+        ferr = ferror(ERROR_INVALID_PARAMETER, "The mapping range is beyond the end of the file.");
+        return fmapping();
+    }
+
+    // 不能为空文件创建文件映射对象, 这里返回一个空视图.
+    if (length == 0)
+        return fmapping();
+
+    // MapViewOfFile() 要求offset是系统分配粒度的整数倍
+    // https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-mapviewoffile
+
+    SYSTEM_INFO info = { 0 };
+    ::GetSystemInfo(&info);
+
+    fsize delta   = offset % info.dwAllocationGranularity;
+    fsize aligned = offset - delta;
+
+    if (length + delta > static_cast<fsize>(SIZE_MAX))
+    {
+        ferr = ferror(ERROR_NOT_ENOUGH_MEMORY, "The mapping range exceeds the address space.");
+        return fmapping();
+    }
+
+    //
+    // https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-createfilemappingw
+
+    HANDLE native_map = ::CreateFileMappingW(
+        reinterpret_cast<HANDLE>(file.native_id()),
+        NULL,
+        (mode & map_write) ? PAGE_READWRITE : PAGE_READONLY,
+        0, 
+        0, 
+        NULL);
+
+    if (native_map == NULL)
+    {
+        ferr = ferror(::GetLastError(), "Can't create file mapping, CreateFileMapping() failed.");
+        return fmapping();
+    }
+
+    void* address = ::MapViewOfFile(
+        native_map,
+        (mode & map_write) ? FILE_MAP_WRITE : FILE_MAP_READ,
+        static_cast<DWORD>(aligned >> 32),
+        static_cast<DWORD>(aligned & 0xffffffff),
+        static_cast<SIZE_T>(length + delta));
+
+    if (address == NULL)
+    {
+        ferr = ferror(::GetLastError(), "Can't map view of file, MapViewOfFile() failed.");
+        ::CloseHandle(native_map);
+        return fmapping();
+    }
+
+    return fmapping(address, length + delta, delta, offset, mode, reinterpret_cast<intptr_t>(native_map));
+}
+
+void file_map_advise(const fmapping& mapping, int advice)
+{
+    ferror ferr;
+    file_map_advise(mapping, advice, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void file_map_advise(const fmapping& mapping, int advice, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!mapping.vaild())
+        return;
+
+    // Windows 没有对应顺序/随机访问的建议, 仅支持预读.
+    // PrefetchVirtualMemory() 需要 Windows 8 及以上, 这里动态获取以兼容 Windows 7.
+    // 
+    // https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-prefetchvirtualmemory
+
+    if (advice & advise_willneed)
+    {
+        struct memory_range_entry
+        {
+            PVOID  VirtualAddress;
+            SIZE_T NumberOfBytes;
+        };
+
+        typedef BOOL(WINAPI* prefetch_virtual_memory_t)(HANDLE, ULONG_PTR, memory_range_entry*, ULONG);
+
+        static prefetch_virtual_memory_t prefetch = reinterpret_cast<prefetch_virtual_memory_t>(
+            ::GetProcAddress(::GetModuleHandleW(L"kernel32.dll"), "PrefetchVirtualMemory"));
+
+        if (prefetch)
+        {
+            memory_range_entry entry = {
+                const_cast<char*>(mapping.data()),
+                static_cast<SIZE_T>(mapping.size())
+            };
+
+            if (!prefetch(::GetCurrentProcess(), 1, &entry, 0))
+                ferr = ferror(::GetLastError(), "Can't prefetch file mapping, PrefetchVirtualMemory() failed.");
+        }
+    }
+}
+
+void file_map_flush(fmapping& mapping, bool wait/* = true*/)
+{
+    ferror ferr;
+    file_map_flush(mapping, wait, ferr);
+
+    if (ferr)
+        throw ferr;
+}
+
+void file_map_flush(fmapping& mapping, bool wait, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (!mapping.vaild() || !(mapping.mode() & map_write))
+        return;
+
+    //
+    // https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-flushviewoffile
+
+    if (!::FlushViewOfFile(mapping.data(), static_cast<SIZE_T>(mapping.size())))
+    {
+        ferr = ferror(::GetLastError(), "Can't flush file mapping, FlushViewOfFile() failed.");
+    }
+
+    // FlushViewOfFile() 不等待元数据及磁盘缓存写入, 需要时由调用者通过文件句柄调用FlushFileBuffers().
+    (void)wait;
+}
+
 bool file_is_writable(const fpath& name)
 {
     ferror ferr;
@@ -729,55 +1665,321 @@ void directories_remove(const fpath& path)
         throw ferr;
 }
 
+namespace detail {
+
+    // 递归删除目录, 跳过删除失败的文件并记录至failed, 返回第一个失败的错误码.
+    inline DWORD remove_directories(const fpath& path, std::vector<fpath>& failed)
+    {
+        DWORD ecode = ERROR_SUCCESS;
+        auto report = [&](const fpath& name, DWORD code) {
+            if (failed.empty())
+                ecode = code;
+            failed.push_back(name);
+        };
+
+        WIN32_FIND_DATAW file_data;
+        HANDLE fd = ::FindFirstFileW((path + L"\\*").c_str(), &file_data);
+
+        if (fd == INVALID_HANDLE_VALUE)
+        {
+            report(path, ::GetLastError());
+            return ecode;
+        }
+
+        while (fd != INVALID_HANDLE_VALUE)
+        {
+            const wchar_t* name = file_data.cFileName;
+
+            // 仅跳过"."与"..", 而不是所有以'.'开头的文件
+            if (!(name[0] == L'.' && (name[1] == 0 || (name[1] == L'.' && name[2] == 0))))
+            {
+                fpath subpath = path + L"\\" + name;
+
+                //
+                //  若当前枚举到的是一个目录, 那么将其递归处理
+                //  否则是一个文件, 这里将其删除
+                //
+                if (file_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                {
+                    DWORD code = remove_directories(subpath, failed);
+                    if (code != ERROR_SUCCESS && ecode == ERROR_SUCCESS)
+                        ecode = code;
+                }
+                else
+                {
+                    ferror ferr;
+                    file_remove(subpath, ferr);
+
+                    if (ferr)
+                        report(subpath, ferr.code());
+                }
+            }
+
+            if (::FindNextFileW(fd, &file_data) == FALSE)
+                break;
+        }
+        ::FindClose(fd);
+
+        // And then delete the directory
+        if (::RemoveDirectoryW(path.c_str()) == 0)
+        {
+            report(path, ::GetLastError());
+        }
+
+        return ecode;
+    }
+
+} // detail
+
 void directories_remove(const fpath& path, ferror& ferr) noexcept
+{
+    directories_remove(path, 1, ferr);
+}
+
+std::vector<fpath> directories_remove(const fpath& path, int /*concurrency*/, ferror& ferr) noexcept
 {
     ferr.clear();
 
+    std::vector<fpath> failed;
+
     if (path.empty())
     {
         ferr = ferror(-1, "Invalid parameter. An empty file cannot be deleted.");
-        return;
+        return failed;
     }
 
-    WIN32_FIND_DATAW file_data;
-    HANDLE fd = ::FindFirstFileW((path + L"\\*").c_str(), &file_data);
+    DWORD ecode = detail::remove_directories(path, failed);
 
-    if (fd == INVALID_HANDLE_VALUE)
+    if (ecode != ERROR_SUCCESS)
     {
-        ferr = ferror(::GetLastError(), "Can't remove the directories");
-        return;
+        ferr = ferror(ecode, "Can't remove the directories");
     }
 
-    while (fd != INVALID_HANDLE_VALUE)
+    return failed;
+}
+
+namespace detail {
+
+    struct walk_dir
     {
-        if (file_data.cFileName[0] != L'.')
+        HANDLE           find;
+        int              depth;
+        size_t           prefix;    // 该目录中的目录项名称在entry._path中的偏移
+        bool             first;     // data中为FindFirstFileEx()返回的第一个目录项
+        WIN32_FIND_DATAW data;
+    };
+
+    struct walk_state
+    {
+        fwalk_options           options;
+        directory_entry         entry;
+        std::vector<walk_dir>   stack;
+        bool                    descend;    // 在下一次next()时进入当前目录项
+
+        walk_state(const fpath& path, const fwalk_options& options)
+            : options(options)
+            , descend(false)
         {
-            fpath subpath = path + L"\\" + file_data.cFileName;
+            entry._path = path;
+        }
 
-            //
-            //  若当前枚举到的是一个目录, 那么将其递归处理
-            //  否则是一个文件, 这里将其删除
-            //
-            if (file_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        ~walk_state()
+        {
+            while (!stack.empty())
+                pop();
+        }
+
+        // 打开目录, 并将其压入栈中, 此时entry._path 为该目录的完整路径.
+        bool push(int depth, ferror& ferr) noexcept
+        {
+            if (entry._path.empty() || (entry._path.back() != L'\\' && entry._path.back() != L'/'))
+                entry._path.push_back(L'\\');
+
+            size_t prefix = entry._path.size();
+            entry._path.push_back(L'*');
+
+            walk_dir dir;
+            dir.depth  = depth;
+            dir.prefix = prefix;
+            dir.first  = true;
+
+            // 
+            // FindExInfoBasic 不查询短文件名, FIND_FIRST_EX_LARGE_FETCH 使用更大的缓冲区批量查询.
+            // https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-findfirstfileexw
+#if _WIN32_WINNT >= 0x0601
+            dir.find = ::FindFirstFileExW(
+                entry._path.c_str(), FindExInfoBasic, &dir.data, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+#else
+            dir.find = ::FindFirstFileExW(
+                entry._path.c_str(), FindExInfoStandard, &dir.data, FindExSearchNameMatch, NULL, 0);
+#endif
+            entry._path.resize(prefix);
+
+            if (dir.find == INVALID_HANDLE_VALUE)
             {
-                directories_remove(subpath, ferr);
+                ferr = ferror(::GetLastError(), "Can't open the directory, FindFirstFileEx() failed.");
+                return false;
             }
-            else
+
+            stack.push_back(dir);
+            return true;
+        }
+
+        void pop() noexcept
+        {
+            ::FindClose(stack.back().find);
+            stack.pop_back();
+        }
+
+        // 读取下一个目录项, 跳过"."与"..", 没有更多的目录项时返回false.
+        bool read(walk_dir& dir, ferror& ferr) noexcept
+        {
+            for (;;)
             {
-                file_remove(subpath, ferr);
+                if (dir.first)
+                {
+                    dir.first = false;
+                }
+                else if (::FindNextFileW(dir.find, &dir.data) == FALSE)
+                {
+                    DWORD code = ::GetLastError();
+                    if (code != ERROR_NO_MORE_FILES)
+                        ferr = ferror(code, "Can't read the directory, FindNextFile() failed.");
+                    return false;
+                }
+
+                const wchar_t* name = dir.data.cFileName;
+                if (name[0] == L'.' && (name[1] == 0 || (name[1] == L'.' && name[2] == 0)))
+                    continue;
+
+                return true;
             }
         }
 
-        if (::FindNextFileW(fd, &file_data) == FALSE)
-            break;
-    }
-    ::FindClose(fd);
+        bool next(ferror& ferr) noexcept
+        {
+            for (;;)
+            {
+                if (descend)
+                {
+                    descend = false;
+
+                    // 无法打开的子目录将被跳过
+                    ferror ecode;
+                    if (!push(entry._depth + 1, ecode) && !ferr)
+                        ferr = ecode;
+                }
+
+                if (stack.empty())
+                    return false;
+
+                walk_dir& dir = stack.back();
+
+                ferror ecode;
+                if (!read(dir, ecode))
+                {
+                    if (ecode && !ferr)
+                        ferr = ecode;
+
+                    pop();
+                    continue;
+                }
+
+                const WIN32_FIND_DATAW& data = dir.data;
+
+                if ((options.flags & walk_skip_hidden) && (data.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN))
+                    continue;
+
+                entry._path.resize(dir.prefix);
+                entry._path.append(data.cFileName);
+                entry._name_offset = dir.prefix;
+                entry._depth       = dir.depth;
+                entry._stat_state  = 1;
+
+                // 符号链接与目录联接均视为符号链接, 递归时不会进入.
+                if ((data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) && 
+                    (data.dwReserved0 == IO_REPARSE_TAG_SYMLINK || data.dwReserved0 == IO_REPARSE_TAG_MOUNT_POINT))
+                    entry._type = entry_symlink;
+                else if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                    entry._type = entry_directory;
+                else if (data.dwFileAttributes & FILE_ATTRIBUTE_DEVICE)
+                    entry._type = entry_other;
+                else
+                    entry._type = entry_file;
+
+                // 目录项中没有inode, device 与nlink, 将其设置为0.
+                fstatus& status = entry._status;
+                status.type   = entry._type;
+                status.mode   = data.dwFileAttributes;
+                status.size   = (static_cast<fsize>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+                status.inode  = 0;
+                status.device = 0;
+                status.nlink  = 0;
+                status.time.create_time = filetime_to_time(data.ftCreationTime);
+                status.time.access_time = filetime_to_time(data.ftLastAccessTime);
+                status.time.modify_time = filetime_to_time(data.ftLastWriteTime);
+                status.time.change_time = -1;
+
+                if ((options.flags & walk_recursive) && 
+                    (options.max_depth < 0 || dir.depth < options.max_depth))
+                {
+                    descend = entry._type == entry_directory;
+                }
+
+                if (entry._match(options))
+                    return true;
+            }
+        }
+    };
+
+} // detail
+
+void directory_entry::_stat(ferror& ferr) const noexcept
+{
+    // 所有信息均来自目录项本身
+    ferr.clear();
+}
+
+directory_iterator::directory_iterator(const fpath& path, const fwalk_options& options, ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    std::shared_ptr<detail::walk_state> state;
 
-    // And then delete the directory
-    if (!ferr && ::RemoveDirectoryW(path.c_str()) == 0)
+    try
     {
-        ferr = ferror(::GetLastError(), "Can't remove the directories");
+        state = std::make_shared<detail::walk_state>(path, options);
     }
+    catch (const std::bad_alloc&)
+    {
+        ferr = ferror(ERROR_NOT_ENOUGH_MEMORY, "Can't open the directory, out of memory.");
+        return;
+    }
+
+    if (!state->push(0, ferr))
+        return;
+
+    if (state->next(ferr))
+        _state = state;
+}
+
+const directory_entry& directory_iterator::entry() const
+{
+    return _state->entry;
+}
+
+void directory_iterator::next(ferror& ferr) noexcept
+{
+    ferr.clear();
+
+    if (_state && !_state->next(ferr))
+        _state.reset();
+}
+
+void directory_iterator::skip()
+{
+    if (_state)
+        _state->descend = false;
 }
 
 void directories_create(const fpath& path)
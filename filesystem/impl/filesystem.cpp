@@ -7,3 +7,7 @@
 #elif OS_POSIX
 #   include "file_unix.ipp"
 #endif
+
+#include "aio.ipp"
+#include "record_scanner.ipp"
+#include "file_stream.ipp"
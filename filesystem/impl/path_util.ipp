@@ -254,10 +254,14 @@ namespace detail {
             if (!(flags & find_with_dot))
                 ++pos;
 
+            // 扩展名通常较短, 就地转换时不需要再分配内存
+            std::basic_string<_TChar> extension = path.substr(pos);
             if (flags & find_upper_case)
-                return to_upper(path.substr(pos));
+                to_upper_inplace(extension);
             else
-                return to_lower(path.substr(pos));
+                to_lower_inplace(extension);
+
+            return extension;
         }
 
         return std::basic_string<_TChar>();
@@ -0,0 +1,234 @@
+/*
+*   record_scanner.ipp
+*
+*   v0.1 2023-07 by GuoJH
+*/
+
+#ifdef UTILITY_DISABLE_HEADONLY
+#   include "../record_scanner.h"
+#endif
+
+#include <cstring>
+#include <algorithm>
+#include <platform/cpu.h>
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#   include <immintrin.h>
+#   define UTILITY_RECORD_X86 1
+#endif
+
+namespace util {
+namespace detail {
+
+inline unsigned _record_popcount(uint64_t mask)
+{
+#if defined(COMPILER_GCC)
+    return static_cast<unsigned>(__builtin_popcountll(mask));
+#else
+    mask = mask - ((mask >> 1) & 0x5555555555555555ull);
+    mask = (mask & 0x3333333333333333ull) + ((mask >> 2) & 0x3333333333333333ull);
+    mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return static_cast<unsigned>((mask * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+#if defined(UTILITY_RECORD_X86)
+
+ATTRIBUTE_TARGET("sse2")
+inline uint64_t _record_mask_sse2(const char* block, char delim)
+{
+    const __m128i d = _mm_set1_epi8(delim);
+
+    uint64_t m0 = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)block), d)));
+    uint64_t m1 = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(block + 16)), d)));
+    uint64_t m2 = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(block + 32)), d)));
+    uint64_t m3 = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(block + 48)), d)));
+
+    return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+}
+
+ATTRIBUTE_TARGET("avx2")
+inline uint64_t _record_mask_avx2(const char* block, char delim)
+{
+    const __m256i d = _mm256_set1_epi8(delim);
+
+    uint64_t lo = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)block), d)));
+    uint64_t hi = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(block + 32)), d)));
+
+    return lo | (hi << 32);
+}
+
+#endif // UTILITY_RECORD_X86
+
+inline record_mask_func _record_kernel()
+{
+    static const record_mask_func kernel = []() -> record_mask_func
+    {
+#if defined(UTILITY_RECORD_X86)
+        util::cpu cpu;
+        if (cpu.has_avx2())
+            return _record_mask_avx2;
+        if (cpu.has_sse2())
+            return _record_mask_sse2;
+#endif
+        return nullptr;
+    }();
+    return kernel;
+}
+
+} // detail
+
+const char* record_find(const char* first, const char* last, char delim) noexcept
+{
+    detail::record_mask_func kernel = detail::_record_kernel();
+    if (kernel)
+    {
+        for (; last - first >= 64; first += 64)
+        {
+            uint64_t mask = kernel(first, delim);
+            if (mask != 0)
+                return first + detail::record_ctz(mask);
+        }
+    }
+
+    const void* found = std::memchr(first, delim, static_cast<size_t>(last - first));
+    return found ? static_cast<const char*>(found) : last;
+}
+
+size_t record_count(std::string_view data, char delim) noexcept
+{
+    const char* first = data.data();
+    const char* last  = first + data.size();
+    size_t      count = 0;
+
+    detail::record_mask_func kernel = detail::_record_kernel();
+    if (kernel)
+    {
+        for (; last - first >= 64; first += 64)
+            count += detail::_record_popcount(kernel(first, delim));
+    }
+
+    return count + static_cast<size_t>(std::count(first, last, delim));
+}
+
+std::vector<std::string_view> record_split(std::string_view data, size_t parts, char delim)
+{
+    std::vector<std::string_view> ranges;
+    if (data.empty())
+        return ranges;
+
+    parts = std::max<size_t>(parts, 1);
+    ranges.reserve(parts);
+
+    const char* base  = data.data();
+    size_t      begin = 0;
+    for (size_t i = 1; i <= parts && begin < data.size(); ++i)
+    {
+        size_t end = data.size();
+        if (i < parts)
+        {
+            // 均分的位置所在的记录归入当前的范围, 每个范围至少包括一条记录.
+            size_t target = static_cast<size_t>(uint64_t(data.size()) * i / parts);
+            size_t from   = std::max(begin, target > 0 ? target - 1 : 0);
+
+            const char* found = record_find(base + from, base + data.size(), delim);
+            if (found != base + data.size())
+                end = static_cast<size_t>(found - base) + 1;
+        }
+
+        ranges.push_back(data.substr(begin, end - begin));
+        begin = end;
+    }
+
+    return ranges;
+}
+
+fmapping record_map(const fpath& name, int advice)
+{
+    ferror ferr;
+    fmapping mapping = record_map(name, advice, ferr);
+
+    if (ferr)
+        throw ferr;
+
+    return mapping;
+}
+
+fmapping record_map(const fpath& name, int advice, ferror& ferr) noexcept
+{
+    ffile file = file_open(name, O_RDONLY, ferr);
+    if (ferr)
+        return fmapping();
+
+    fmapping mapping = file_map(file, map_read, 0, fsize(-1), ferr);
+    if (ferr || !mapping)
+        return mapping;
+
+    // 建议仅作为提示, 不支持时忽略
+    if (advice != advise_normal)
+    {
+        ferror ignored;
+        file_map_advise(mapping, advice, ignored);
+    }
+
+    return mapping;
+}
+
+record_scanner::record_scanner(std::string_view data, char delim)
+    : _data(data)
+    , _delim(delim)
+    , _pos(0)
+    , _block(0)
+    , _scanned(0)
+    , _mask(0)
+    , _kernel(detail::_record_kernel())
+{
+}
+
+record_scanner::record_scanner(const fmapping& mapping, char delim)
+    : record_scanner(mapping ? std::string_view(mapping.data(), static_cast<size_t>(mapping.size())) : std::string_view(), delim)
+{
+}
+
+bool record_scanner::_next(std::string_view& record)
+{
+    const size_t size = _data.size();
+    if (_pos >= size)
+        return false;
+
+    if (_kernel)
+    {
+        while (size - _scanned >= 64)
+        {
+            _block    = _scanned;
+            _mask     = _kernel(_data.data() + _block, _delim);
+            _scanned += 64;
+
+            if (_mask != 0)
+            {
+                size_t found = _block + detail::record_ctz(_mask);
+                _mask &= _mask - 1;
+                record = _take(found);
+                return true;
+            }
+        }
+    }
+
+    // 不足64字节的尾部, 或没有向量化的实现; 此时_scanned 不小于_pos
+    const char* base  = _data.data();
+    const char* found = record_find(base + _scanned, base + size, _delim);
+    if (found != base + size)
+    {
+        _scanned = static_cast<size_t>(found - base) + 1;
+        record = _take(_scanned - 1);
+        return true;
+    }
+
+    // 最后一条记录没有分隔符
+    _scanned = size;
+    record = _take(size);
+    _pos = size;
+    return true;
+}
+
+} // util
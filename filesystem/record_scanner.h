@@ -0,0 +1,163 @@
+#ifndef record_scanner_h__
+#define record_scanner_h__
+
+/*
+*   record_scanner.h
+*
+*   v0.1 2023-07 by GuoJH
+*/
+
+#include <vector>
+#include <string_view>
+#include <filesystem/file_util.h>
+
+#if defined(COMPILER_MSVC)
+#   include <intrin.h>
+#endif
+
+namespace util {
+namespace detail {
+
+// 返回64字节的块中等于delim的字节的位掩码, 第i位对应第i个字节.
+typedef uint64_t (*record_mask_func)(const char* block, char delim);
+
+// 返回mask最低的置位的位置, mask不能为0.
+inline unsigned record_ctz(uint64_t mask)
+{
+#if defined(COMPILER_GCC)
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#elif defined(COMPILER_MSVC) && defined(ARCH_CPU_64_BITS)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    unsigned index = 0;
+    for (; (mask & 1) == 0; mask >>= 1)
+        ++index;
+    return index;
+#endif
+}
+
+} // detail
+
+/*!
+ *  \brief 在[first, last)中查找delim, 行为与memchr()相同.
+ *
+ *  \return 返回第一个delim的位置, 没有找到时返回last.
+ *  \note   处理器支持时通过AVX2/SSE2每次比较32/16字节.
+ */
+UTILITY_FUNCT_DECL const char* record_find(const char* first, const char* last, char delim) noexcept;
+
+//! 返回data中delim的数量, 可用于预先分配记录的容器.
+UTILITY_FUNCT_DECL size_t record_count(std::string_view data, char delim = '\n') noexcept;
+
+/*!
+ *  \brief 将data划分为最多parts个连续的范围, 每个范围都以完整的记录结束, 以便并行地解析.
+ *
+ *  \return 返回按顺序排列的范围, 它们覆盖整个data; 除最后一个外, 每个范围都以delim结束.
+ *  \note   1. 划分点为按长度均分的位置之后的第一个delim, 因此范围的长度不一定相等;
+ *             记录的数量少于parts时, 返回的范围也将少于parts.
+ *          2. data为空时返回空的容器.
+ */
+UTILITY_FUNCT_DECL std::vector<std::string_view> record_split(std::string_view data, size_t parts, char delim = '\n');
+
+/*!
+ *  \brief 以只读方式映射整个文件, 用于record_scanner/record_split().
+ *
+ *  \param advice fmap_advice的组合, 默认为顺序访问.
+ *  \note  空文件返回无效的视图, 其size()为0, 这不被视为错误.
+ */
+UTILITY_FUNCT_DECL fmapping record_map(const fpath& name, int advice = advise_sequential);
+UTILITY_FUNCT_DECL fmapping record_map(const fpath& name, int advice, ferror& ferr) noexcept;
+
+/*!
+ *  \brief 按单字节的分隔符切分内存中的记录, 返回指向原数据的视图, 不复制数据.
+ *
+ *  \note  1. 每次比较64字节并得到分隔符的位掩码, 之后的记录直接从掩码中取出,
+ *            因此对于较短的记录远快于逐条调用memchr().
+ *         2. 分隔符为'\n'时, 将同时去除记录末尾的'\r'.
+ *         3. 最后一条记录可以没有分隔符; data以分隔符结束时, 不产生末尾的空记录.
+ *         4. 返回的视图在data有效期间有效.
+ *
+ *  \code
+ *         util::fmapping mapping = util::record_map(name);
+ *         util::record_scanner scanner(mapping);
+ *         for (std::string_view record; scanner.next(record); )
+ *             parse(record);
+ *  \endcode
+ */
+class record_scanner
+{
+public:
+    explicit record_scanner(std::string_view data, char delim = '\n');
+    explicit record_scanner(const fmapping& mapping, char delim = '\n');
+
+    /*!
+     *  \brief 读取下一条记录, 不包括分隔符.
+     *  \return 没有更多记录时返回false.
+     */
+    bool next(std::string_view& record)
+    {
+        if (_mask != 0)
+        {
+            size_t found = _block + detail::record_ctz(_mask);
+            _mask &= _mask - 1;
+            record = _take(found);
+            return true;
+        }
+
+        return _next(record);
+    }
+
+    //! 依次以每条记录调用fn, 返回记录的数量.
+    template<class _Fn>
+    size_t for_each(_Fn&& fn)
+    {
+        size_t count = 0;
+        for (std::string_view record; next(record); ++count)
+            fn(record);
+
+        return count;
+    }
+
+    //! 返回下一条记录相对于data的偏移量
+    size_t position() const { return _pos; }
+
+    //! 是否已读取全部的记录
+    bool eof() const { return _pos >= _data.size(); }
+
+    //! 返回正在切分的数据
+    std::string_view data() const { return _data; }
+
+protected:
+    // 返回[_pos, found)的记录, 并移至found之后
+    std::string_view _take(size_t found)
+    {
+        size_t length = found - _pos;
+        if (_delim == '\n' && length > 0 && _data[found - 1] == '\r')
+            --length;
+
+        std::string_view record = _data.substr(_pos, length);
+        _pos = found + 1;
+        return record;
+    }
+
+    // 当前的掩码已用完时, 扫描之后的块
+    bool _next(std::string_view& record);
+
+    std::string_view         _data;
+    char                     _delim;
+    size_t                   _pos;      //!< 下一条记录的开始
+    size_t                   _block;    //!< _mask 对应的块的开始
+    size_t                   _scanned;  //!< 已扫描的长度
+    uint64_t                 _mask;     //!< 当前块中尚未取出的分隔符
+    detail::record_mask_func _kernel;   //!< 处理器不支持时为nullptr, 退回到record_find()
+};
+
+} // util
+
+#ifndef UTILITY_DISABLE_HEADONLY
+#   include "impl/record_scanner.ipp"
+#endif
+
+#endif // record_scanner_h__
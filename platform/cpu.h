@@ -33,6 +33,13 @@ public:
         , _has_ssse3 (false)
         , _has_sse41 (false)
         , _has_sse42 (false)
+        , _has_avx   (false)
+        , _has_avx2  (false)
+        , _has_sha   (false)
+        , _has_neon  (false)
+        , _has_arm_crc32(false)
+        , _has_arm_sha1 (false)
+        , _has_arm_sha2 (false)
         , _cpu_id    (0)
         , _cpu_vendor("unknown")
     {
@@ -53,6 +60,15 @@ public:
     UTILITY_MEMBER_DECL int has_ssse3() const { return _has_ssse3; }
     UTILITY_MEMBER_DECL int has_sse41() const { return _has_sse41; }
     UTILITY_MEMBER_DECL int has_sse42() const { return _has_sse42; }
+    UTILITY_MEMBER_DECL int has_avx()   const { return _has_avx; }
+    UTILITY_MEMBER_DECL int has_avx2()  const { return _has_avx2; }
+    UTILITY_MEMBER_DECL int has_sha()   const { return _has_sha; }  // Intel SHA Extensions (SHA-NI)
+
+    // ARMv8 的扩展, 仅在ARM平台有效.
+    UTILITY_MEMBER_DECL int has_neon()      const { return _has_neon; }
+    UTILITY_MEMBER_DECL int has_arm_crc32() const { return _has_arm_crc32; }
+    UTILITY_MEMBER_DECL int has_arm_sha1()  const { return _has_arm_sha1; }
+    UTILITY_MEMBER_DECL int has_arm_sha2()  const { return _has_arm_sha2; }
     UTILITY_MEMBER_DECL int extended_model()  const { return _ext_model; }
     UTILITY_MEMBER_DECL int extended_family() const { return _ext_family; }
     UTILITY_MEMBER_DECL const std::string& vendor_name() const { return _cpu_vendor; }
@@ -83,6 +99,13 @@ private:
     bool _has_ssse3;         //SSSE3
     bool _has_sse41;         //SSE4.1
     bool _has_sse42;         //SSE4.2
+    bool _has_avx;           //AVX, 且操作系统支持保存YMM寄存器
+    bool _has_avx2;          //AVX2
+    bool _has_sha;           //SHA-NI
+    bool _has_neon;          //NEON(ASIMD)
+    bool _has_arm_crc32;     //ARMv8 CRC32
+    bool _has_arm_sha1;      //ARMv8 SHA1
+    bool _has_arm_sha2;      //ARMv8 SHA2
     uint64_t _cpu_id;        //CPU Id
     std::string _cpu_vendor;
 };
@@ -13,7 +13,10 @@
 #if defined(ARCH_CPU_X86_FAMILY)
 #   if defined(COMPILER_MSVC)
 #       include <intrin.h>
+#       include <immintrin.h>
 #   endif
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(OS_LINUX)
+#   include <sys/auxv.h>
 #endif
 
 namespace util {
@@ -63,6 +66,22 @@ void __cpuidex(int cpu_info[4], int info_type, int info_index)
 }
 #endif
 #endif  // COMPILER_MSVC
+
+namespace detail {
+
+    // 读取扩展控制寄存器XCR0, 以确定操作系统是否会保存AVX寄存器.
+    inline uint64_t xgetbv(uint32_t index)
+    {
+#if defined(COMPILER_MSVC)
+        return _xgetbv(index);
+#else
+        uint32_t eax, edx;
+        __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+        return (uint64_t(edx) << 32) | eax;
+#endif
+    }
+
+} // detail
 #endif  // ARCH_CPU_X86_FAMILY
 
 void cpu::initialize()
@@ -105,7 +124,50 @@ void cpu::initialize()
         _has_sse42  = (cpu_info[2] & 0x00100000) != 0;
 
         _cpu_id     = uint64_t(cpu_info[3]) << 32 | uint64_t(cpu_info[0]);
+
+        // AVX 需要操作系统通过XSAVE保存XMM与YMM寄存器(XCR0的第1,2位)
+        bool has_osxsave = (cpu_info[2] & 0x08000000) != 0;
+        _has_avx = (cpu_info[2] & 0x10000000) != 0 && has_osxsave && (detail::xgetbv(0) & 6) == 6;
+    }
+
+    // Structured Extended Feature Flags
+    if (num_ids >= 7)
+    {
+        __cpuidex(cpu_info, 7, 0);
+        _has_avx2   = _has_avx && (cpu_info[1] & 0x00000020) != 0;
+        _has_sha    = (cpu_info[1] & 0x20000000) != 0;
     }
+#elif defined(ARCH_CPU_ARM_FAMILY)
+#   if defined(OS_LINUX)
+    //
+    // https://www.kernel.org/doc/html/latest/arm64/elf_hwcaps.html
+#       if defined(ARCH_CPU_ARM64)
+    unsigned long hwcap = ::getauxval(AT_HWCAP);
+    _has_neon       = (hwcap & (1 << 1)) != 0;  // HWCAP_ASIMD
+    _has_arm_sha1   = (hwcap & (1 << 5)) != 0;  // HWCAP_SHA1
+    _has_arm_sha2   = (hwcap & (1 << 6)) != 0;  // HWCAP_SHA2
+    _has_arm_crc32  = (hwcap & (1 << 7)) != 0;  // HWCAP_CRC32
+#       else
+    unsigned long hwcap  = ::getauxval(AT_HWCAP);
+    unsigned long hwcap2 = ::getauxval(AT_HWCAP2);
+    _has_neon       = (hwcap  & (1 << 12)) != 0; // HWCAP_NEON
+    _has_arm_sha1   = (hwcap2 & (1 << 2))  != 0; // HWCAP2_SHA1
+    _has_arm_sha2   = (hwcap2 & (1 << 3))  != 0; // HWCAP2_SHA2
+    _has_arm_crc32  = (hwcap2 & (1 << 4))  != 0; // HWCAP2_CRC32
+#       endif
+#   else
+    // 其他平台根据编译选项确定
+#       if defined(__ARM_NEON) || defined(ARCH_CPU_ARM64)
+    _has_neon       = true;
+#       endif
+#       if defined(__ARM_FEATURE_CRC32)
+    _has_arm_crc32  = true;
+#       endif
+#       if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2)
+    _has_arm_sha1   = true;
+    _has_arm_sha2   = true;
+#       endif
+#   endif
 #endif
 }
 
@@ -2,8 +2,8 @@
 #   include "../platform_error.h"
 #endif
 
-#include <string/tstring.h>
-#include <string/string_util.h>
+#include <cstdint>
+#include <string/format.h>
 #include <platform/platform_util.h>
 
 namespace util {
@@ -15,11 +15,8 @@ platform_error::msgs_type platform_error::error_message() const
 
 platform_error::msgs_type platform_error::message() const
 { 
-    msgs_type msgs = util::tstring("{1}({2},{3})")
-        % error_description()
-        % util::sformat("0x%08x", code())
-        % error_message();
-    return msgs;
+    return util::format("{}(0x{:08x},{})",
+        error_description(), static_cast<uint32_t>(code()), error_message());
 }
 
 platform_error::msgs_type platform_error::print() const
@@ -8,6 +8,7 @@
 #include <string.h>
 #include <string>
 #include <iostream>
+#include <string/string_util.h>
 #include <string/string_conv_easy.hpp>
 
 namespace util {
@@ -89,37 +90,14 @@ std::wstring wformat_error(int error_code)
 
 void output_debug_string(const char* format, ...)
 {
-#if OS_WIN
-    va_list list = nullptr;
-    va_start(list, format);
-
-    std::string message(_vscprintf(format, list) + 1, 0);
-    vsprintf_s(&message[0], message.capacity(), format, list);
-
-    if (message[message.size() - 1] == '\0')
-        message.erase(message.begin() + (message.size() - 1));
-
-    ::OutputDebugStringA((message + "\r\n").c_str());
-
-    std::cout << message << std::endl;
-
-    va_end(list);
-#else
     va_list list;
     va_start(list, format);
 
-    std::string message(vsnprintf(nullptr, 0, format, list) + 1, 0);
-
-    // These functions do not call the va_end macro. 
-    // Because they invoke the va_arg macro, the value of ap is 
-    // undefined after the call.
-    // https://linux.die.net/man/3/vsnprintf
-    va_start(list, format);
+    std::string message = util::vsformat(format, list);
 
-    size_t size = vsnprintf(&message[0], message.size(), format, list);
+    va_end(list);
 
-    std::cout << message << std::endl;
-#endif
+    output_debug_string(message);
 }
 
 void output_debug_string(const std::string& message)
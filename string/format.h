@@ -0,0 +1,628 @@
+#ifndef format_h__
+#define format_h__
+
+/*
+*   format.h
+*
+*   v0.1 2023-08 by GuoJH
+*/
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <string>
+#include <ostream>
+#include <sstream>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include <string/string_cfg.h>
+
+namespace util {
+
+/*!
+ *  \brief 格式化输出的缓冲区
+ *
+ *  \note  1. _grow() 由派生类实现; 固定大小的缓冲区在空间不足时截断输出, 但size()仍然统计完整的长度.
+ *         2. 不能通过基类的指针销毁.
+ */
+template<class _Char>
+class format_buffer
+{
+public:
+    typedef _Char value_type;
+
+    format_buffer(const format_buffer&) = delete;
+    format_buffer& operator=(const format_buffer&) = delete;
+
+    _Char* data() { return _data; }
+    const _Char* data() const { return _data; }
+
+    //! 返回完整输出所需的长度, 对于固定大小的缓冲区可能大于capacity().
+    size_t size() const { return _size; }
+    size_t capacity() const { return _capacity; }
+
+    void clear() { _size = 0; }
+
+    //! 预先扩大容量, 固定大小的缓冲区忽略此请求.
+    void reserve(size_t capacity)
+    {
+        if (capacity > _capacity)
+            _grow(capacity);
+    }
+
+    void push_back(_Char ch)
+    {
+        if (_size >= _capacity)
+            _grow(_size + 1);
+        if (_size < _capacity)
+            _data[_size] = ch;
+        ++_size;
+    }
+
+    void append(const _Char* first, size_t count)
+    {
+        if (_size + count > _capacity)
+            _grow(_size + count);
+        if (_size < _capacity)
+            std::char_traits<_Char>::copy(_data + _size, first, std::min(count, _capacity - _size));
+        _size += count;
+    }
+
+    void append(std::basic_string_view<_Char> text) {
+        append(text.data(), text.size());
+    }
+
+    void fill(size_t count, _Char ch)
+    {
+        if (_size + count > _capacity)
+            _grow(_size + count);
+        if (_size < _capacity)
+            std::char_traits<_Char>::assign(_data + _size, std::min(count, _capacity - _size), ch);
+        _size += count;
+    }
+
+protected:
+    format_buffer(_Char* data, size_t capacity) noexcept
+        : _data(data), _size(0), _capacity(capacity) {}
+    ~format_buffer() = default;
+
+    //! 将容量扩大至不小于capacity, 固定大小的缓冲区不扩大.
+    virtual void _grow(size_t capacity) = 0;
+
+    _Char* _data;
+    size_t _size;
+    size_t _capacity;
+};
+
+/*!
+ *  \brief 前_Inline 个字符位于对象内部的缓冲区, 作为局部变量时短的输出不需要分配内存.
+ */
+template<class _Char, size_t _Inline = 500>
+class basic_memory_buffer : public format_buffer<_Char>
+{
+public:
+    basic_memory_buffer() noexcept
+        : format_buffer<_Char>(_store, _Inline) {}
+
+    std::basic_string_view<_Char> view() const {
+        return std::basic_string_view<_Char>(this->_data, this->_size);
+    }
+
+    std::basic_string<_Char> str() const {
+        return std::basic_string<_Char>(this->_data, this->_size);
+    }
+
+protected:
+    void _grow(size_t capacity) override
+    {
+        capacity = std::max(capacity, this->_capacity + this->_capacity / 2);
+
+        std::unique_ptr<_Char[]> heap(new _Char[capacity]);
+        std::char_traits<_Char>::copy(heap.get(), this->_data, this->_size);
+
+        _heap.swap(heap);
+        this->_data     = _heap.get();
+        this->_capacity = capacity;
+    }
+
+    _Char                    _store[_Inline];
+    std::unique_ptr<_Char[]> _heap;
+};
+
+typedef basic_memory_buffer<char>    memory_buffer;
+typedef basic_memory_buffer<wchar_t> wmemory_buffer;
+
+namespace detail {
+
+// 写入调用者提供的内存, 超出的部分被丢弃
+template<class _Char>
+class fixed_format_buffer : public format_buffer<_Char>
+{
+public:
+    fixed_format_buffer(_Char* data, size_t capacity) noexcept
+        : format_buffer<_Char>(data, capacity) {}
+
+protected:
+    void _grow(size_t) override {}
+};
+
+// 追加到std::basic_string 的末尾, 结束时调用finish()截去多余的部分
+template<class _Char>
+class string_format_buffer : public format_buffer<_Char>
+{
+public:
+    explicit string_format_buffer(std::basic_string<_Char>& target)
+        : format_buffer<_Char>(nullptr, 0)
+        , _target(target)
+        , _start(target.size())
+    {
+        _grow(std::max<size_t>(target.capacity() - _start, 64));
+    }
+
+    void finish() {
+        _target.resize(_start + this->_size);
+    }
+
+protected:
+    void _grow(size_t capacity) override
+    {
+        capacity = std::max(capacity, this->_capacity * 2);
+        _target.resize(_start + capacity);
+
+        this->_data     = &_target[_start];
+        this->_capacity = capacity;
+    }
+
+    std::basic_string<_Char>& _target;
+    size_t                    _start;
+};
+
+enum format_arg_type
+{
+    arg_int,
+    arg_uint,
+    arg_bool,
+    arg_char,
+    arg_double,
+    arg_long_double,
+    arg_string,
+    arg_pointer,
+    arg_custom,
+};
+
+// 类型擦除后的参数, 格式化的实现不需要为每种参数组合实例化.
+template<class _Char>
+struct format_arg
+{
+    typedef void (*custom_func)(format_buffer<_Char>& out, const void* value);
+
+    int type;
+    union
+    {
+        long long          i;
+        unsigned long long u;
+        bool               b;
+        _Char              c;
+        double             d;
+        long double        ld;
+        const void*        p;
+        struct { const _Char* data; size_t size; } s;
+        struct { const void* value; custom_func func; } custom;
+    };
+};
+
+template<class _Char>
+struct _format_view
+{
+    typedef std::basic_string_view<_Char> type;
+};
+
+template<class _Type, class _Char, class = void>
+struct _has_ostream : std::false_type {};
+
+template<class _Type, class _Char>
+struct _has_ostream<_Type, _Char, decltype(
+    std::declval<std::basic_ostream<_Char>&>() << std::declval<const _Type&>(), void())> : std::true_type {};
+
+template<class _Type>
+struct _dependent_false : std::false_type {};
+
+// 其他类型通过operator<< 输出
+template<class _Char, class _Type>
+inline void _format_custom(format_buffer<_Char>& out, const void* value)
+{
+    std::basic_ostringstream<_Char> stream;
+    stream << *static_cast<const _Type*>(value);
+
+    const std::basic_string<_Char>& text = stream.str();
+    out.append(text.data(), text.size());
+}
+
+template<class _Char, class _Type>
+inline format_arg<_Char> make_format_arg(const _Type& value)
+{
+    format_arg<_Char> arg;
+
+    if constexpr (std::is_same<_Type, bool>::value)
+    {
+        arg.type = arg_bool;
+        arg.b    = value;
+    }
+    else if constexpr (std::is_same<_Type, _Char>::value || std::is_same<_Type, char>::value)
+    {
+        arg.type = arg_char;
+        arg.c    = static_cast<_Char>(value);
+    }
+    else if constexpr (std::is_integral<_Type>::value && std::is_signed<_Type>::value)
+    {
+        arg.type = arg_int;
+        arg.i    = value;
+    }
+    else if constexpr (std::is_integral<_Type>::value)
+    {
+        arg.type = arg_uint;
+        arg.u    = value;
+    }
+    else if constexpr (std::is_enum<_Type>::value)
+    {
+        return make_format_arg<_Char>(static_cast<typename std::underlying_type<_Type>::type>(value));
+    }
+    else if constexpr (std::is_same<_Type, long double>::value)
+    {
+        arg.type = arg_long_double;
+        arg.ld   = value;
+    }
+    else if constexpr (std::is_floating_point<_Type>::value)
+    {
+        arg.type = arg_double;
+        arg.d    = value;
+    }
+    else if constexpr (std::is_same<_Type, const _Char*>::value || std::is_same<_Type, _Char*>::value)
+    {
+        arg.type   = arg_string;
+        arg.s.data = value;
+        arg.s.size = value ? std::char_traits<_Char>::length(value) : 0;
+    }
+    else if constexpr (std::is_pointer<_Type>::value || std::is_null_pointer<_Type>::value)
+    {
+        arg.type = arg_pointer;
+        arg.p    = static_cast<const void*>(value);
+    }
+    else if constexpr (std::is_convertible<const _Type&, std::basic_string_view<_Char>>::value)
+    {
+        std::basic_string_view<_Char> view = value;
+
+        arg.type   = arg_string;
+        arg.s.data = view.data();
+        arg.s.size = view.size();
+    }
+    else if constexpr (_has_ostream<_Type, _Char>::value)
+    {
+        arg.type         = arg_custom;
+        arg.custom.value = &value;
+        arg.custom.func  = &_format_custom<_Char, _Type>;
+    }
+    else
+    {
+        static_assert(_dependent_false<_Type>::value,
+            "The type can not be formatted, it should provide operator<<.");
+    }
+
+    return arg;
+}
+
+template<class _Char, class... _Args>
+inline std::array<format_arg<_Char>, sizeof...(_Args)> make_format_args(const _Args&... args)
+{
+    return std::array<format_arg<_Char>, sizeof...(_Args)>{ { make_format_arg<_Char>(args)... } };
+}
+
+// 编译时检查格式字符串: 花括号是否配对, 参数索引是否越界, 是否混用自动与手动索引.
+template<class _Char>
+constexpr bool check_format(std::basic_string_view<_Char> text, size_t count)
+{
+    size_t next = 0;
+    int    mode = 0;    // 1: 自动索引, 2: 手动索引
+
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '}')
+        {
+            if (i + 1 < text.size() && text[i + 1] == '}')
+            {
+                ++i;
+                continue;
+            }
+            return false;
+        }
+
+        if (text[i] != '{')
+            continue;
+
+        if (++i >= text.size())
+            return false;
+        if (text[i] == '{')
+            continue;
+
+        size_t index = 0;
+        if (text[i] >= '0' && text[i] <= '9')
+        {
+            if (mode == 1)
+                return false;
+
+            mode = 2;
+            for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+                index = index * 10 + size_t(text[i] - '0');
+        }
+        else
+        {
+            if (mode == 2)
+                return false;
+
+            mode  = 1;
+            index = next++;
+        }
+
+        if (index >= count || i >= text.size() || (text[i] != ':' && text[i] != '}'))
+            return false;
+
+        for (; i < text.size() && text[i] != '}'; ++i)
+        {
+            if (text[i] == '{')
+                return false;
+        }
+
+        if (i >= text.size())
+            return false;
+    }
+
+    return true;
+}
+
+// UTILITY_FORMAT() 产生的类型的基类
+struct compile_string {};
+
+template<class _Type>
+struct _is_compile_string : std::is_base_of<compile_string, _Type> {};
+
+} // detail
+
+/*!
+ *  \brief 按格式字符串将参数写入out, 是其他格式化函数的实现.
+ *
+ *  \note  格式字符串无效或参数索引越界时抛出std::runtime_error 异常.
+ */
+UTILITY_FUNCT_DECL void vformat_to(
+    format_buffer<char>& out, std::string_view format, const detail::format_arg<char>* args, size_t count);
+UTILITY_FUNCT_DECL void vformat_to(
+    format_buffer<wchar_t>& out, std::wstring_view format, const detail::format_arg<wchar_t>* args, size_t count);
+
+/*!
+ *  \brief 类型安全的格式化, 语法与std::format/fmt 相同:
+ *
+ *         {[index][:[[fill]align][sign][#][0][width][.precision][type]]}
+ *
+ *         align: '<' 左对齐, '>' 右对齐, '^' 居中; sign: '+', '-', ' ';
+ *         type : 整数 d/x/X/o/b/B/c, 浮点数 f/F/e/E/g/G/a/A/%, 字符串 s, 指针 p.
+ *
+ *  \note  1. 先写入栈上的缓冲区, 再按精确的长度构造结果, 只分配一次内存.
+ *         2. 整数与浮点数通过std::to_chars()转换, 与区域设置无关; 未指定精度的浮点数输出最短的可还原的表示.
+ *         3. 其他类型通过operator<< 输出.
+ *         4. 格式字符串无效或参数索引越界时抛出std::runtime_error 异常;
+ *            通过UTILITY_FORMAT()传入的格式字符串在编译时检查.
+ *
+ *  \code
+ *         util::format("{} + {} = {:.2f}", 1, 2, 3.0);         // "1 + 2 = 3.00"
+ *         util::format("{1}-{0}, {0:>6}, {:#x}", "a", "b");      // 错误: 混用自动与手动索引
+ *         util::format(UTILITY_FORMAT("{:08.3f}"), 3.14159);     // "0003.142"
+ *  \endcode
+ */
+template<class... _Args>
+inline std::string format(std::string_view format, const _Args&... args)
+{
+    memory_buffer buffer;
+    auto list = detail::make_format_args<char>(args...);
+    vformat_to(buffer, format, list.data(), list.size());
+
+    return buffer.str();
+}
+
+template<class... _Args>
+inline std::wstring format(std::wstring_view format, const _Args&... args)
+{
+    wmemory_buffer buffer;
+    auto list = detail::make_format_args<wchar_t>(args...);
+    vformat_to(buffer, format, list.data(), list.size());
+
+    return buffer.str();
+}
+
+template<class _Format, class... _Args,
+    class = typename std::enable_if<detail::_is_compile_string<_Format>::value>::type>
+inline auto format(const _Format&, const _Args&... args)
+{
+    static_assert(detail::check_format(_Format::data(), sizeof...(_Args)),
+        "Invalid format string or argument count.");
+
+    return format(_Format::data(), args...);
+}
+
+//! 追加到out 的末尾, 返回out.
+template<class _Char, class... _Args>
+inline format_buffer<_Char>& format_to(
+    format_buffer<_Char>& out, typename detail::_format_view<_Char>::type format, const _Args&... args)
+{
+    auto list = detail::make_format_args<_Char>(args...);
+    vformat_to(out, format, list.data(), list.size());
+
+    return out;
+}
+
+template<class _Char, class... _Args>
+inline std::basic_string<_Char>& format_to(
+    std::basic_string<_Char>& out, typename detail::_format_view<_Char>::type format, const _Args&... args)
+{
+    detail::string_format_buffer<_Char> buffer(out);
+
+    auto list = detail::make_format_args<_Char>(args...);
+    vformat_to(buffer, format, list.data(), list.size());
+
+    buffer.finish();
+    return out;
+}
+
+/*!
+ *  \brief 写入out 指向的size 个字符, 超出的部分被截断, 不写入结尾的'\0'.
+ *  \return 返回完整输出所需的长度, 大于size 时说明结果被截断.
+ */
+template<class... _Args>
+inline size_t format_to(char* out, size_t size, std::string_view format, const _Args&... args)
+{
+    detail::fixed_format_buffer<char> buffer(out, size);
+    return format_to(buffer, format, args...).size();
+}
+
+template<class... _Args>
+inline size_t format_to(wchar_t* out, size_t size, std::wstring_view format, const _Args&... args)
+{
+    detail::fixed_format_buffer<wchar_t> buffer(out, size);
+    return format_to(buffer, format, args...).size();
+}
+
+//! 返回格式化结果的长度, 不分配内存.
+template<class... _Args>
+inline size_t formatted_size(std::string_view format, const _Args&... args) {
+    return format_to(static_cast<char*>(nullptr), 0, format, args...);
+}
+
+template<class... _Args>
+inline size_t formatted_size(std::wstring_view format, const _Args&... args) {
+    return format_to(static_cast<wchar_t*>(nullptr), 0, format, args...);
+}
+
+template<class _Char>
+class basic_tformat;
+
+//! 输出basic_tformat, 是basic_tformat::render_to() 的实现.
+UTILITY_FUNCT_DECL void vtformat_to(
+    format_buffer<char>& out, const basic_tformat<char>& format, const detail::format_arg<char>* args, size_t count);
+UTILITY_FUNCT_DECL void vtformat_to(
+    format_buffer<wchar_t>& out, const basic_tformat<wchar_t>& format, const detail::format_arg<wchar_t>* args, size_t count);
+
+/*!
+ *  \brief 预先解析的模板, 占位符与tstring::operator% 相同, 为"{1}", "{2}"...
+ *
+ *  \note  1. 构造时解析一次占位符的位置, 之后可以反复使用, 适合缓存后多次输出的模板.
+ *         2. 一次扫描输出全部的参数, 结果只分配一次内存; 数字通过std::to_chars()转换,
+ *            未指定精度的浮点数输出最短的可还原的表示, 其他类型通过operator<< 输出.
+ *         3. 同一个占位符可以出现多次; 没有对应参数的占位符原样保留, 其他花括号不需要转义.
+ *         4. 构造后不再改变, 可以在多个线程中同时使用.
+ *
+ *  \code
+ *         static const util::tformat report("{1}: {2} items, {3}%");
+ *         util::tstring text = report("disk", 42, 87.5);   // "disk: 42 items, 87.5%"
+ *  \endcode
+ */
+template<class _Char>
+class basic_tformat
+{
+public:
+    typedef std::basic_string<_Char> string_type;
+
+    struct segment
+    {
+        size_t offset;      //!< 文本在模板中的位置
+        size_t size;        //!< 文本的长度
+        size_t index;       //!< 文本之后的占位符的索引, 从1开始, 0表示没有占位符
+    };
+
+    explicit basic_tformat(std::basic_string_view<_Char> pattern)
+        : _pattern(pattern)
+        , _literal(0)
+        , _arity(0)
+    {
+        size_t begin = 0;
+        for (size_t i = 0; i < _pattern.size(); ++i)
+        {
+            if (_pattern[i] != '{')
+                continue;
+
+            size_t last  = i + 1;
+            size_t index = 0;
+            for (; last < _pattern.size() && _pattern[last] >= '0' && _pattern[last] <= '9' && index < 0x1000000; ++last)
+                index = index * 10 + size_t(_pattern[last] - '0');
+
+            if (index == 0 || last >= _pattern.size() || _pattern[last] != '}')
+                continue;
+
+            _segments.push_back(segment{ begin, i - begin, index });
+            _literal += i - begin;
+            _arity    = std::max(_arity, index);
+
+            begin = last + 1;
+            i     = last;
+        }
+
+        _segments.push_back(segment{ begin, _pattern.size() - begin, 0 });
+        _literal += _pattern.size() - begin;
+    }
+
+    //! 以args 依次替换"{1}", "{2}"..., 返回结果.
+    template<class... _Args>
+    string_type operator()(const _Args&... args) const
+    {
+        basic_memory_buffer<_Char> buffer;
+        render_to(buffer, args...);
+
+        return buffer.str();
+    }
+
+    //! 追加到out 的末尾, 返回out.
+    template<class... _Args>
+    format_buffer<_Char>& render_to(format_buffer<_Char>& out, const _Args&... args) const
+    {
+        auto list = detail::make_format_args<_Char>(args...);
+        vtformat_to(out, *this, list.data(), list.size());
+
+        return out;
+    }
+
+    const string_type& pattern() const { return _pattern; }
+
+    //! 文本与占位符交替的片段, 最后一个片段没有占位符.
+    const std::vector<segment>& segments() const { return _segments; }
+
+    //! 返回除占位符外的文本的长度
+    size_t literal_size() const { return _literal; }
+
+    //! 返回占位符的最大索引
+    size_t arity() const { return _arity; }
+
+private:
+    string_type          _pattern;
+    std::vector<segment> _segments;
+    size_t               _literal;
+    size_t               _arity;
+};
+
+} // util
+
+/*!
+ *  \brief 在编译时检查格式字符串, 用于util::format().
+ */
+#define UTILITY_FORMAT(s)                                                                   \
+    [] {                                                                                    \
+        struct _utility_format_string : util::detail::compile_string                        \
+        {                                                                                   \
+            typedef std::remove_cv_t<std::remove_reference_t<decltype(*s)>> char_type;      \
+            static constexpr std::basic_string_view<char_type> data() { return s; }         \
+        };                                                                                  \
+        return _utility_format_string();                                                    \
+    }()
+
+#ifndef UTILITY_DISABLE_HEADONLY
+#   include "impl/format.ipp"
+#endif
+
+#endif // format_h__
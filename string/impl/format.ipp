@@ -0,0 +1,586 @@
+/*
+*   format.ipp
+*
+*   v0.1 2023-08 by GuoJH
+*/
+
+#ifdef UTILITY_DISABLE_HEADONLY
+#   include "../format.h"
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <charconv>
+#include <stdexcept>
+
+namespace util {
+namespace detail {
+
+template<class _Char>
+struct _format_spec
+{
+    _Char  fill      = ' ';
+    char   align     = 0;       // '<', '>', '^'
+    char   sign      = 0;       // '+', ' '
+    bool   alternate = false;
+    bool   zero      = false;
+    size_t width     = 0;
+    int    precision = -1;
+    char   type      = 0;
+};
+
+inline void _format_throw(const char* what)
+{
+    throw std::runtime_error(what);
+}
+
+template<class _Char>
+inline bool _format_digit(_Char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+template<class _Char>
+inline size_t _format_parse_number(const _Char*& it, const _Char* end)
+{
+    size_t value = 0;
+    for (; it != end && _format_digit(*it); ++it)
+    {
+        value = value * 10 + size_t(*it - '0');
+        if (value > 0x7FFFFFFF)
+            _format_throw("Number is too big in format string.");
+    }
+
+    return value;
+}
+
+template<class _Char>
+inline bool _format_is_align(_Char ch)
+{
+    return ch == '<' || ch == '>' || ch == '^';
+}
+
+// 解析':'之后的格式说明, 返回后it 指向'}'
+template<class _Char>
+inline void _format_parse_spec(const _Char*& it, const _Char* end, _format_spec<_Char>& spec)
+{
+    if (end - it >= 2 && _format_is_align(it[1]) && it[0] != '}')
+    {
+        spec.fill  = it[0];
+        spec.align = static_cast<char>(it[1]);
+        it += 2;
+    }
+    else if (it != end && _format_is_align(*it))
+    {
+        spec.align = static_cast<char>(*it++);
+    }
+
+    if (it != end && (*it == '+' || *it == '-' || *it == ' '))
+    {
+        spec.sign = *it == '-' ? 0 : static_cast<char>(*it);
+        ++it;
+    }
+
+    if (it != end && *it == '#')
+    {
+        spec.alternate = true;
+        ++it;
+    }
+
+    if (it != end && *it == '0')
+    {
+        spec.zero = true;
+        ++it;
+    }
+
+    spec.width = _format_parse_number(it, end);
+
+    if (it != end && *it == '.')
+    {
+        if (++it == end || !_format_digit(*it))
+            _format_throw("Missing precision in format string.");
+
+        spec.precision = static_cast<int>(_format_parse_number(it, end));
+    }
+
+    if (it != end && *it != '}')
+    {
+        if (*it > 0x7F || !std::strchr("bBcdoxXaAeEfFgGps%", static_cast<char>(*it)))
+            _format_throw("Invalid type in format string.");
+
+        spec.type = static_cast<char>(*it++);
+    }
+
+    if (it == end || *it != '}')
+        _format_throw("Invalid format string.");
+}
+
+// 按宽度与对齐方式写入text
+template<class _Char, class _Text>
+inline void _format_write(
+    format_buffer<_Char>& out, const _format_spec<_Char>& spec, const _Text* text, size_t size, char align)
+{
+    size_t padding = spec.width > size ? spec.width - size : 0;
+    size_t left    = 0;
+
+    if (spec.align)
+        align = spec.align;
+    if (align == '>')
+        left = padding;
+    else if (align == '^')
+        left = padding / 2;
+
+    if (left)
+        out.fill(left, spec.fill);
+
+    if constexpr (std::is_same<_Char, _Text>::value)
+    {
+        out.append(text, size);
+    }
+    else
+    {
+        // 数字等ASCII 字符
+        for (size_t i = 0; i < size; ++i)
+            out.push_back(static_cast<_Char>(text[i]));
+    }
+
+    if (padding - left)
+        out.fill(padding - left, spec.fill);
+}
+
+// prefix 为符号与进制前缀, 指定'0'时在前缀与数字之间补零
+template<class _Char>
+inline void _format_write_number(
+    format_buffer<_Char>& out, const _format_spec<_Char>& spec,
+    const char* prefix, size_t prefix_size, const char* digits, size_t digits_size)
+{
+    if (spec.zero && !spec.align)
+    {
+        size_t size = prefix_size + digits_size;
+        for (size_t i = 0; i < prefix_size; ++i)
+            out.push_back(static_cast<_Char>(prefix[i]));
+        if (spec.width > size)
+            out.fill(spec.width - size, static_cast<_Char>('0'));
+        for (size_t i = 0; i < digits_size; ++i)
+            out.push_back(static_cast<_Char>(digits[i]));
+        return;
+    }
+
+    char   buffer[160];
+    size_t size = prefix_size + digits_size;
+    if (size <= sizeof(buffer))
+    {
+        std::memcpy(buffer, prefix, prefix_size);
+        std::memcpy(buffer + prefix_size, digits, digits_size);
+        _format_write(out, spec, buffer, size, '>');
+        return;
+    }
+
+    std::string joined(prefix, prefix_size);
+    joined.append(digits, digits_size);
+    _format_write(out, spec, joined.data(), joined.size(), '>');
+}
+
+inline void _format_upper(char* first, char* last)
+{
+    for (; first != last; ++first)
+    {
+        if (*first >= 'a' && *first <= 'z')
+            *first = static_cast<char>(*first - 'a' + 'A');
+    }
+}
+
+template<class _Char>
+inline void _format_int(
+    format_buffer<_Char>& out, const _format_spec<_Char>& spec, unsigned long long value, bool negative)
+{
+    if (spec.type == 'c')
+    {
+        _Char ch = static_cast<_Char>(value);
+        _format_write(out, spec, &ch, 1, '<');
+        return;
+    }
+
+    int         base   = 10;
+    const char* prefix = "";
+    switch (spec.type)
+    {
+    case 'x': base = 16; prefix = "0x"; break;
+    case 'X': base = 16; prefix = "0X"; break;
+    case 'b': base = 2;  prefix = "0b"; break;
+    case 'B': base = 2;  prefix = "0B"; break;
+    case 'o': base = 8;  prefix = value != 0 ? "0" : ""; break;
+    case 0:
+    case 'd': break;
+    default:
+        _format_throw("Invalid type for integer in format string.");
+    }
+
+    char   digits[64];
+    char*  last = std::to_chars(digits, digits + sizeof(digits), value, base).ptr;
+    if (spec.type == 'X')
+        _format_upper(digits, last);
+
+    char   head[4];
+    size_t head_size = 0;
+    if (negative)
+        head[head_size++] = '-';
+    else if (spec.sign)
+        head[head_size++] = spec.sign;
+
+    if (spec.alternate)
+    {
+        for (; *prefix; ++prefix)
+            head[head_size++] = *prefix;
+    }
+
+    _format_write_number(out, spec, head, head_size, digits, size_t(last - digits));
+}
+
+#if !defined(__cpp_lib_to_chars)
+
+// 没有浮点数的std::to_chars() 时, 通过snprintf() 实现
+template<class _Float>
+inline int _format_float_printf(char* first, size_t size, _Float value, char type, int precision)
+{
+    char format[8] = { '%', '.', '*', 'L', type, 0 };
+
+    if (type == 0)
+    {
+        // 找到能够还原的最短的表示
+        for (int digits = 1; digits < 40; ++digits)
+        {
+            format[4] = 'g';
+            int length = std::snprintf(first, size, format, digits, static_cast<long double>(value));
+            if (length < 0 || size_t(length) >= size || static_cast<_Float>(std::strtold(first, nullptr)) == value)
+                return length;
+        }
+    }
+
+    return std::snprintf(first, size, format, precision, static_cast<long double>(value));
+}
+
+#endif
+
+template<class _Char, class _Float>
+inline void _format_float(format_buffer<_Char>& out, const _format_spec<_Char>& spec, _Float value)
+{
+    char type      = spec.type;
+    int  precision = spec.precision;
+
+    if (type == '%')
+        value *= 100;
+
+    std::string large;
+    char        small[160];
+    char*       first = small;
+    size_t      size  = sizeof(small);
+    char*       last  = nullptr;
+
+    for (;;)
+    {
+        // 保留一个字符用于'%'
+        char* limit = first + size - 1;
+
+#if defined(__cpp_lib_to_chars)
+        std::to_chars_result result;
+        switch (type)
+        {
+        case 0:
+            result = precision < 0
+                ? std::to_chars(first, limit, value)
+                : std::to_chars(first, limit, value, std::chars_format::general, precision);
+            break;
+        case 'e': case 'E':
+            result = std::to_chars(first, limit, value, std::chars_format::scientific, precision < 0 ? 6 : precision);
+            break;
+        case 'f': case 'F': case '%':
+            result = std::to_chars(first, limit, value, std::chars_format::fixed, precision < 0 ? 6 : precision);
+            break;
+        case 'g': case 'G':
+            result = std::to_chars(first, limit, value, std::chars_format::general, precision < 0 ? 6 : precision);
+            break;
+        case 'a': case 'A':
+            result = precision < 0
+                ? std::to_chars(first, limit, value, std::chars_format::hex)
+                : std::to_chars(first, limit, value, std::chars_format::hex, precision);
+            break;
+        default:
+            _format_throw("Invalid type for floating-point in format string.");
+        }
+
+        if (result.ec == std::errc())
+        {
+            last = result.ptr;
+            break;
+        }
+#else
+        char kind = type;
+        if (kind == 'F' || kind == '%')
+            kind = 'f';
+        else if (kind == 0 && precision >= 0)
+            kind = 'g';
+        else if (kind && !std::strchr("eEfgGaA", kind))
+            _format_throw("Invalid type for floating-point in format string.");
+
+        int length = _format_float_printf(first, size, value, kind, precision < 0 ? 6 : precision);
+        if (length < 0)
+            _format_throw("Failed to format floating-point.");
+        if (first + length < limit)
+        {
+            last = first + length;
+            break;
+        }
+#endif
+        // 很大的数以'f'输出, 或者精度很大
+        size  = size * 4 + static_cast<size_t>(precision < 0 ? 0 : precision);
+        large.resize(size);
+        first = &large[0];
+    }
+
+    if (type == 'E' || type == 'G' || type == 'A' || type == 'F')
+        _format_upper(first, last);
+
+    char   head[4];
+    size_t head_size = 0;
+    if (*first == '-')
+    {
+        head[head_size++] = '-';
+        ++first;
+    }
+    else if (spec.sign)
+    {
+        head[head_size++] = spec.sign;
+    }
+
+#if defined(__cpp_lib_to_chars)
+    // std::to_chars() 输出的十六进制没有前缀
+    if ((type == 'a' || type == 'A') && std::isfinite(value))
+    {
+        head[head_size++] = '0';
+        head[head_size++] = type == 'A' ? 'X' : 'x';
+    }
+#endif
+
+    if (type == '%')
+        *last++ = '%';
+
+    if (std::isfinite(value))
+    {
+        _format_write_number(out, spec, head, head_size, first, size_t(last - first));
+    }
+    else
+    {
+        // 无穷大与NaN 不补零
+        _format_spec<_Char> padded = spec;
+        padded.zero = false;
+        _format_write_number(out, padded, head, head_size, first, size_t(last - first));
+    }
+}
+
+template<class _Char>
+inline void _format_arg(format_buffer<_Char>& out, const format_arg<_Char>& arg, const _format_spec<_Char>& spec)
+{
+    switch (arg.type)
+    {
+    case arg_int:
+        _format_int(out, spec, arg.i < 0 ? 0 - static_cast<unsigned long long>(arg.i) : arg.i, arg.i < 0);
+        break;
+
+    case arg_uint:
+        _format_int(out, spec, arg.u, false);
+        break;
+
+    case arg_bool:
+        if (spec.type == 0 || spec.type == 's')
+            _format_write(out, spec, arg.b ? "true" : "false", arg.b ? 4 : 5, '<');
+        else
+            _format_int(out, spec, arg.b ? 1 : 0, false);
+        break;
+
+    case arg_char:
+        if (spec.type == 0 || spec.type == 'c')
+            _format_write(out, spec, &arg.c, 1, '<');
+        else
+            _format_int(out, spec, static_cast<typename std::make_unsigned<_Char>::type>(arg.c), false);
+        break;
+
+    case arg_double:
+        _format_float(out, spec, arg.d);
+        break;
+
+    case arg_long_double:
+        _format_float(out, spec, arg.ld);
+        break;
+
+    case arg_string:
+        if (spec.type != 0 && spec.type != 's')
+            _format_throw("Invalid type for string in format string.");
+
+        _format_write(out, spec, arg.s.data,
+            spec.precision >= 0 ? std::min(arg.s.size, size_t(spec.precision)) : arg.s.size, '<');
+        break;
+
+    case arg_pointer:
+    {
+        if (spec.type != 0 && spec.type != 'p')
+            _format_throw("Invalid type for pointer in format string.");
+
+        char  digits[2 + sizeof(void*) * 2] = { '0', 'x' };
+        char* last = std::to_chars(digits + 2, digits + sizeof(digits), reinterpret_cast<uintptr_t>(arg.p), 16).ptr;
+        _format_write(out, spec, digits, size_t(last - digits), '>');
+        break;
+    }
+
+    case arg_custom:
+        if (spec.width == 0 && spec.precision < 0)
+        {
+            arg.custom.func(out, arg.custom.value);
+        }
+        else
+        {
+            basic_memory_buffer<_Char> buffer;
+            arg.custom.func(buffer, arg.custom.value);
+
+            size_t size = buffer.size();
+            if (spec.precision >= 0)
+                size = std::min(size, size_t(spec.precision));
+            _format_write(out, spec, buffer.data(), size, '<');
+        }
+        break;
+    }
+}
+
+template<class _Char>
+inline void _vformat_to(
+    format_buffer<_Char>& out, std::basic_string_view<_Char> format, const format_arg<_Char>* args, size_t count)
+{
+    const _Char* it   = format.data();
+    const _Char* end  = it + format.size();
+    size_t       next = 0;
+    int          mode = 0;  // 1: 自动索引, 2: 手动索引
+
+    while (it != end)
+    {
+        const _Char* text = it;
+        while (it != end && *it != '{' && *it != '}')
+            ++it;
+
+        if (it != text)
+            out.append(text, size_t(it - text));
+        if (it == end)
+            break;
+
+        if (*it++ == '}')
+        {
+            if (it == end || *it != '}')
+                _format_throw("Unmatched '}' in format string.");
+
+            out.push_back('}');
+            ++it;
+            continue;
+        }
+
+        if (it == end)
+            _format_throw("Unmatched '{' in format string.");
+
+        if (*it == '{')
+        {
+            out.push_back('{');
+            ++it;
+            continue;
+        }
+
+        size_t index = 0;
+        if (_format_digit(*it))
+        {
+            if (mode == 1)
+                _format_throw("Cannot switch from automatic to manual argument indexing.");
+
+            mode  = 2;
+            index = _format_parse_number(it, end);
+        }
+        else
+        {
+            if (mode == 2)
+                _format_throw("Cannot switch from manual to automatic argument indexing.");
+
+            mode  = 1;
+            index = next++;
+        }
+
+        if (index >= count)
+            _format_throw("Argument index out of range in format string.");
+
+        _format_spec<_Char> spec;
+        if (it != end && *it == ':')
+            _format_parse_spec(++it, end, spec);
+
+        if (it == end || *it != '}')
+            _format_throw("Invalid format string.");
+
+        ++it;
+        _format_arg(out, args[index], spec);
+    }
+}
+
+template<class _Char>
+inline void _vtformat_to(
+    format_buffer<_Char>& out, const basic_tformat<_Char>& format, const format_arg<_Char>* args, size_t count)
+{
+    typedef typename basic_tformat<_Char>::segment segment;
+
+    const _Char*                pattern  = format.pattern().data();
+    const std::vector<segment>& segments = format.segments();
+    const _format_spec<_Char>   spec;
+
+    // 文本的长度是确定的, 参数按每个16个字符估计
+    out.reserve(out.size() + format.literal_size() + (segments.size() - 1) * 16);
+
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        const segment& text = segments[i];
+        out.append(pattern + text.offset, text.size);
+
+        if (text.index == 0)
+            continue;
+
+        if (text.index <= count)
+        {
+            _format_arg(out, args[text.index - 1], spec);
+        }
+        else
+        {
+            // 保留没有参数的占位符
+            size_t first = text.offset + text.size;
+            out.append(pattern + first, segments[i + 1].offset - first);
+        }
+    }
+}
+
+} // detail
+
+void vformat_to(format_buffer<char>& out, std::string_view format, const detail::format_arg<char>* args, size_t count)
+{
+    detail::_vformat_to(out, format, args, count);
+}
+
+void vformat_to(format_buffer<wchar_t>& out, std::wstring_view format, const detail::format_arg<wchar_t>* args, size_t count)
+{
+    detail::_vformat_to(out, format, args, count);
+}
+
+void vtformat_to(format_buffer<char>& out, const basic_tformat<char>& format, const detail::format_arg<char>* args, size_t count)
+{
+    detail::_vtformat_to(out, format, args, count);
+}
+
+void vtformat_to(format_buffer<wchar_t>& out, const basic_tformat<wchar_t>& format, const detail::format_arg<wchar_t>* args, size_t count)
+{
+    detail::_vtformat_to(out, format, args, count);
+}
+
+} // util
@@ -1,4 +1,5 @@
 #include "utility.hpp"
 #include "tstring.ipp"
 #include "string_conv.ipp"
-#include "string_util.ipp"
\ No newline at end of file
+#include "string_util.ipp"
+#include "format.ipp"
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <utility.hpp>
+#include <algorithm>
 #ifdef UTILITY_DISABLE_HEADONLY
 #   include "../string_conv.h"
 #endif
@@ -7,4 +8,80 @@
 #   include "string_conv_win.ipp"
 #else
 #   include "string_conv_unix.ipp"
-#endif
\ No newline at end of file
+#endif
+
+#include "string_conv_utf.hpp"
+
+namespace util {
+namespace conv {
+
+std::wstring& utf8_to_wstring(
+    const std::string& input, std::wstring& output, utf_policy policy)
+{
+    // UTF-8 的每个字节至多产生一个宽字符
+    output.resize(input.size());
+
+    size_t size = detail::utf8_to_wide(input.data(), input.size(), &output[0], policy == utf_replace);
+    if (size == std::string::npos)
+    {
+        output.clear();
+        throw std::runtime_error("invalid or incomplete multibyte or wide character");
+    }
+
+    output.resize(size);
+    return output;
+}
+
+std::string& wstring_to_utf8(
+    const std::wstring& input, std::string& output, utf_policy policy)
+{
+    output.resize(detail::wide_to_utf8_length(input.data(), input.size()));
+
+    size_t size = detail::wide_to_utf8(input.data(), input.size(), &output[0], policy == utf_replace);
+    if (size == std::string::npos)
+    {
+        output.clear();
+        throw std::runtime_error("invalid or incomplete multibyte or wide character");
+    }
+
+    return output;
+}
+
+bool utf8_is_valid(
+    const std::string& input)
+{
+    return detail::utf8_valid(input.data(), input.size());
+}
+
+size_t utf8_invalid_count(
+    const std::string& input)
+{
+    return detail::utf8_invalid_count(input.data(), input.size());
+}
+
+std::string& utf8_sanitize(
+    const std::string& input, std::string& output)
+{
+    if (detail::utf8_valid(input.data(), input.size()))
+        return output = input;
+
+    // 每个无效的字节至多产生3个字节
+    std::string buffer(input.size() * 3, 0);
+    buffer.resize(detail::utf8_sanitize(input.data(), input.size(), &buffer[0]));
+
+    output.swap(buffer);
+    return output;
+}
+
+float wstring_replacement_character_persents(
+    const std::wstring& wide)
+{
+    if (wide.empty())
+        return 0;
+
+    float count = (float)std::count(wide.begin(), wide.end(), wchar_t(0xfffd));
+    return count / wide.size() * 100;
+}
+
+} // conv
+} // util
\ No newline at end of file
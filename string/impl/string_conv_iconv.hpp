@@ -12,72 +12,122 @@
 #include <iconv.h>
 #include <string.h>
 #include <string>
+#include <vector>
 #include <stdexcept>
 
 namespace util {
 namespace conv {
 
-template<class InString, class OutString>
-OutString& convert_with_iconv(
-    const    InString& input,
-            OutString& output,
-    const std::string& in_encode,
-    const std::string& out_encode,
-    const         bool ignore_error = false)
+namespace detail {
+
+// ÿ̻߳Ѵ򿪵ת, ÿתiconv_open()/iconv_close().
+class iconv_cache
 {
-    // 1. both GLIBC and libgnuiconv will use the locale's encoding 
-    //    if ininbuf or outbuf is an empty string.
-    // 2. In case of error, it sets errno and returns (iconv_t) -1.
-    iconv_t conv = ::iconv_open(out_encode.c_str(), in_encode.c_str());
+public:
+    ~iconv_cache()
+    {
+        for (auto& entry : _entries)
+            ::iconv_close(entry.conv);
+    }
 
-    if (conv == (iconv_t)-1)
+    static iconv_cache& instance()
     {
-        if (errno == EINVAL)
+        static thread_local iconv_cache cache;
+        return cache;
+    }
+
+    iconv_t get(const std::string& in_encode, const std::string& out_encode)
+    {
+        for (auto& entry : _entries)
         {
-            throw std::runtime_error(
-                "not supported from " + in_encode + " to " + out_encode);
+            if (entry.in_encode == in_encode && entry.out_encode == out_encode)
+            {
+                // ָʼת״̬
+                ::iconv(entry.conv, nullptr, nullptr, nullptr, nullptr);
+                return entry.conv;
+            }
         }
-        else
+
+        // 1. both GLIBC and libgnuiconv will use the locale's encoding 
+        //    if ininbuf or outbuf is an empty string.
+        // 2. In case of error, it sets errno and returns (iconv_t) -1.
+        iconv_t conv = ::iconv_open(out_encode.c_str(), in_encode.c_str());
+
+        if (conv == (iconv_t)-1)
         {
-            int error = errno;
-            throw std::runtime_error(
-                "iconv_open() failed: " + std::to_string(error) + ", " + strerror(error));
+            if (errno == EINVAL)
+            {
+                throw std::runtime_error(
+                    "not supported from " + in_encode + " to " + out_encode);
+            }
+            else
+            {
+                int error = errno;
+                throw std::runtime_error(
+                    "iconv_open() failed: " + std::to_string(error) + ", " + strerror(error));
+            }
         }
+
+        _entries.push_back(entry{ in_encode, out_encode, conv });
+        return conv;
     }
 
-    struct guard
+private:
+    iconv_cache() = default;
+    iconv_cache(const iconv_cache&) = delete;
+    iconv_cache& operator=(const iconv_cache&) = delete;
+
+    struct entry
     {
-        iconv_t _conv;
+        std::string in_encode;
+        std::string out_encode;
+        iconv_t     conv;
+    };
 
-        guard(iconv_t conv)
-            : _conv(conv) {}
-        ~guard() { ::iconv_close(_conv); }
-    }
-    _guard(conv);
+    std::vector<entry> _entries;
+};
 
-    // copy the string to a buffer as iconv function requires a non-const char pointer.
-    std::string in_buf(
-        reinterpret_cast<const char*>(&input[0]), 
-        input.size() * sizeof(typename InString::value_type));
+} // detail
 
-    char * src_ptr  = &in_buf[0];
-    size_t src_size = in_buf.size();
+template<class InString, class OutString>
+OutString& convert_with_iconv(
+    const    InString& input,
+            OutString& output,
+    const std::string& in_encode,
+    const std::string& out_encode,
+    const         bool ignore_error = false)
+{
+    typedef typename OutString::value_type out_type;
+
+    iconv_t conv = detail::iconv_cache::instance().get(in_encode, out_encode);
 
-    std::string       buf(1024, 0);
-    std::string       dst;
+    // iconv() does not modify the input, the parameter is non-const only for historical reasons,
+    // so the string is no longer copied to a buffer.
+    char * src_ptr  = const_cast<char*>(reinterpret_cast<const char*>(input.data()));
+    size_t src_size = input.size() * sizeof(typename InString::value_type);
+
+    // ֱдַ, ռ䲻ʱ, ȥĲ;
+    // ΪͬһʱҪĻ.
+    OutString  buffer;
+    OutString& dst  = static_cast<const void*>(&input) == static_cast<const void*>(&output) ? buffer : output;
+    size_t     used = 0;
+
+    dst.resize(input.size() + input.size() / 2 + 16);
 
     while (0 < src_size)
     {
-        char * dst_ptr  = &buf[0];
-        size_t dst_size = buf.size();
+        char * dst_ptr  = reinterpret_cast<char*>(&dst[0]) + used;
+        size_t dst_size = dst.size() * sizeof(out_type) - used;
 
         size_t res = ::iconv(conv, &src_ptr, &src_size, &dst_ptr, &dst_size);
 
+        used = dst.size() * sizeof(out_type) - dst_size;
+
         if (res == (size_t)-1)
         {
             if (errno == E2BIG) // ûиĿռһתַ
             {
-                // ignore this error
+                dst.resize(dst.size() * 2);
             }
             else if (ignore_error)
             {
@@ -102,12 +152,12 @@ OutString& convert_with_iconv(
                 }
             }
         }
-        dst.append(&buf[0], buf.size() - dst_size);
     }
 
-    output.assign(
-        reinterpret_cast<typename OutString::value_type*>(&dst[0]),
-        dst.size() / sizeof(typename OutString::value_type));
+    dst.resize(used / sizeof(out_type));
+
+    if (&dst != &output)
+        output.swap(dst);
 
     return output;
 }
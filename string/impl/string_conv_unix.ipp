@@ -1,13 +1,15 @@
 #include <assert.h>
 #include "string_conv_iconv.hpp"
+#include "string_conv_utf.hpp"
 
 namespace util {
 namespace conv {
 
+// wchar_t 为UTF-32, 不经过iconv 直接转换, 无效的序列抛出异常
 std::wstring& utf8_to_wstring(
     const std::string& input, std::wstring& output)
 {
-    return convert_with_iconv(input, output, "UTF-8", "WCHAR_T", false);
+    return utf8_to_wstring(input, output, utf_strict);
 }
 
 std::wstring& string_to_wstring(
@@ -19,7 +21,7 @@ std::wstring& string_to_wstring(
 std::string& wstring_to_utf8(
     const std::wstring& input, std::string& output)
 {
-    return convert_with_iconv(input, output, "WCHAR_T", "UTF-8", false);
+    return wstring_to_utf8(input, output, utf_strict);
 }
 
 std::string& wstring_to_string(
@@ -0,0 +1,688 @@
+/*
+*   string_conv_utf.hpp
+*
+*   v0.1  2023-08 By GuoJH
+*/
+
+#ifndef string_conv_utf_h__
+#define string_conv_utf_h__
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <stdexcept>
+
+#if defined(COMPILER_MSVC)
+#   include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   include <tmmintrin.h>
+#   define UTILITY_CONV_SSE2 1
+#endif
+
+namespace util {
+namespace conv {
+namespace detail {
+
+//
+// UTF-8 与 UTF-16/UTF-32 之间的转换, 宽字符的编码由其大小决定.
+// 每次检查16个字节或字符, 全部为ASCII 时直接扩展或压缩, 否则逐个字符转换.
+//
+
+enum { utf_replacement = 0xFFFD };
+
+// 返回mask最低的置位的位置, mask不能为0.
+inline unsigned _utf_lowest_bit(uint32_t mask)
+{
+#if defined(COMPILER_GCC)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#elif defined(COMPILER_MSVC)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    unsigned index = 0;
+    for (; (mask & 1) == 0; mask >>= 1)
+        ++index;
+    return index;
+#endif
+}
+
+/*
+ *  解码一个非ASCII 字符.
+ *  成功时写入code 并返回序列的长度; 失败时返回无效的最长子序列的长度的相反数(至少为1),
+ *  即Unicode 推荐的"maximal subpart", 每个无效的子序列替换为一个U+FFFD.
+ */
+inline int _utf8_decode(const unsigned char* input, size_t size, uint32_t& code)
+{
+    const unsigned char lead = input[0];
+
+    int length = 0;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+        code   = lead & 0x1F;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        code   = lead & 0x0F;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        code   = lead & 0x07;
+    }
+    else
+    {
+        return -1;
+    }
+
+    // 第二个字节的范围受第一个字节约束, 以排除过长的编码, 代理区与超出U+10FFFF 的值
+    unsigned char low = 0x80, high = 0xBF;
+    if (lead == 0xE0)
+        low = 0xA0;
+    else if (lead == 0xED)
+        high = 0x9F;
+    else if (lead == 0xF0)
+        low = 0x90;
+    else if (lead == 0xF4)
+        high = 0x8F;
+
+    for (int i = 1; i < length; ++i)
+    {
+        if (size_t(i) >= size)
+            return -i;
+
+        const unsigned char trail = input[i];
+        if (i == 1 ? (trail < low || trail > high) : (trail & 0xC0) != 0x80)
+            return -i;
+
+        code = (code << 6) | (trail & 0x3F);
+    }
+
+    return length;
+}
+
+// 返回code 的UTF-8 编码的长度, code 必须有效.
+inline size_t _utf8_length(uint32_t code)
+{
+    return code < 0x80 ? 1 : code < 0x800 ? 2 : code < 0x10000 ? 3 : 4;
+}
+
+inline char* _utf8_encode(uint32_t code, char* output)
+{
+    if (code < 0x80)
+    {
+        *output++ = static_cast<char>(code);
+    }
+    else if (code < 0x800)
+    {
+        *output++ = static_cast<char>(0xC0 | (code >> 6));
+        *output++ = static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else if (code < 0x10000)
+    {
+        *output++ = static_cast<char>(0xE0 | (code >> 12));
+        *output++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        *output++ = static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else
+    {
+        *output++ = static_cast<char>(0xF0 | (code >> 18));
+        *output++ = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        *output++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        *output++ = static_cast<char>(0x80 | (code & 0x3F));
+    }
+
+    return output;
+}
+
+/*
+ *  读取一个宽字符表示的码点, 返回占用的宽字符数量; 代理对不完整或码点无效时返回0.
+ */
+template<class _Wide>
+inline size_t _wide_decode(const _Wide* input, size_t size, uint32_t& code)
+{
+    if (sizeof(_Wide) == 2)
+    {
+        code = static_cast<uint16_t>(input[0]);
+        if (code < 0xD800 || code > 0xDFFF)
+            return 1;
+
+        if (code > 0xDBFF || size < 2)
+            return 0;
+
+        uint32_t low = static_cast<uint16_t>(input[1]);
+        if (low < 0xDC00 || low > 0xDFFF)
+            return 0;
+
+        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        return 2;
+    }
+    else
+    {
+        code = static_cast<uint32_t>(input[0]);
+        return (code < 0xD800 || (code > 0xDFFF && code <= 0x10FFFF)) ? 1 : 0;
+    }
+}
+
+template<class _Wide>
+inline _Wide* _wide_encode(uint32_t code, _Wide* output)
+{
+    if (sizeof(_Wide) == 2 && code >= 0x10000)
+    {
+        code -= 0x10000;
+        *output++ = static_cast<_Wide>(0xD800 + (code >> 10));
+        *output++ = static_cast<_Wide>(0xDC00 + (code & 0x3FF));
+    }
+    else
+    {
+        *output++ = static_cast<_Wide>(code);
+    }
+
+    return output;
+}
+
+/*
+ *  将UTF-8 转换为UTF-16/UTF-32, output 至少可以容纳size 个宽字符.
+ *  返回写入的宽字符数量; 遇到无效的序列时, lossy 为false 则返回npos, 否则写入U+FFFD.
+ */
+template<class _Wide>
+inline size_t utf8_to_wide(const char* input, size_t size, _Wide* output, bool lossy)
+{
+    static_assert(sizeof(_Wide) == 2 || sizeof(_Wide) == 4, "UTF-16 or UTF-32 only.");
+
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(input);
+    const unsigned char* last  = first + size;
+    _Wide*               out   = output;
+
+    while (first < last)
+    {
+        // 逐个字符转换的范围, 向量化的检查失败时为之后的16个字节
+        const unsigned char* stop = first + 1;
+
+#if defined(UTILITY_CONV_SSE2)
+        if (last - first >= 16)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(chunk));
+
+            if (mask == 0)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i lo   = _mm_unpacklo_epi8(chunk, zero);
+                const __m128i hi   = _mm_unpackhi_epi8(chunk, zero);
+
+                if (sizeof(_Wide) == 2)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),     lo);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), hi);
+                }
+                else
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),      _mm_unpacklo_epi16(lo, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4),  _mm_unpackhi_epi16(lo, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8),  _mm_unpacklo_epi16(hi, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi16(hi, zero));
+                }
+
+                first += 16;
+                out   += 16;
+                continue;
+            }
+
+            // 第一个非ASCII 字符之前的部分
+            stop = first + 16;
+            for (unsigned count = _utf_lowest_bit(mask); count > 0; --count)
+                *out++ = static_cast<_Wide>(*first++);
+        }
+#endif
+        while (first < stop)
+        {
+            if (*first < 0x80)
+            {
+                *out++ = static_cast<_Wide>(*first++);
+                continue;
+            }
+
+            // 常见的双字节与三字节的字符不经过完整的检查
+            if (last - first >= 3 && (first[1] & 0xC0) == 0x80)
+            {
+                if ((*first & 0xE0) == 0xC0 && *first >= 0xC2)
+                {
+                    *out++ = static_cast<_Wide>(((first[0] & 0x1F) << 6) | (first[1] & 0x3F));
+                    first += 2;
+                    continue;
+                }
+
+                if ((*first & 0xF0) == 0xE0 && (first[2] & 0xC0) == 0x80)
+                {
+                    uint32_t code = ((first[0] & 0x0F) << 12) | ((first[1] & 0x3F) << 6) | (first[2] & 0x3F);
+                    if (code >= 0x800 && (code < 0xD800 || code > 0xDFFF))
+                    {
+                        *out++ = static_cast<_Wide>(code);
+                        first += 3;
+                        continue;
+                    }
+                }
+            }
+
+            uint32_t code   = 0;
+            int      length = _utf8_decode(first, size_t(last - first), code);
+            if (length > 0)
+            {
+                out    = _wide_encode(code, out);
+                first += length;
+            }
+            else
+            {
+                if (!lossy)
+                    return std::string::npos;
+
+                *out++ = static_cast<_Wide>(utf_replacement);
+                first -= length;
+            }
+        }
+    }
+
+    return size_t(out - output);
+}
+
+//! 返回转换为UTF-8 所需的长度, 无效的字符按U+FFFD 计算.
+template<class _Wide>
+inline size_t wide_to_utf8_length(const _Wide* input, size_t size)
+{
+    size_t length = 0;
+    size_t i      = 0;
+
+#if defined(UTILITY_CONV_SSE2)
+    if (sizeof(_Wide) == 4)
+    {
+        // 长度为字符数加上不小于0x80, 0x800, 0x10000 的字符数; 代理区的长度与U+FFFD 相同.
+        // 按有符号数比较, 因此先翻转最高位; 遇到超出U+10FFFF 的值时交给逐个字符的计算.
+        const __m128i sign  = _mm_set1_epi32(int(0x80000000));
+        const __m128i x80   = _mm_set1_epi32(int(0x80000080 - 1));
+        const __m128i x800  = _mm_set1_epi32(int(0x80000800 - 1));
+        const __m128i x10000 = _mm_set1_epi32(int(0x80010000 - 1));
+        const __m128i xmax  = _mm_set1_epi32(int(0x8010FFFF));
+
+        __m128i sum     = _mm_setzero_si128();
+        __m128i invalid = _mm_setzero_si128();
+
+        for (; i + 4 <= size; i += 4)
+        {
+            const __m128i code = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)), sign);
+
+            sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(code, x80));
+            sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(code, x800));
+            sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(code, x10000));
+            invalid = _mm_or_si128(invalid, _mm_cmpgt_epi32(code, xmax));
+        }
+
+        if (_mm_movemask_epi8(invalid) == 0)
+        {
+            uint32_t lanes[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+
+            length = i + size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        }
+        else
+        {
+            i = 0;
+        }
+    }
+#endif
+
+    for (; i < size; )
+    {
+        uint32_t code  = 0;
+        size_t   count = _wide_decode(input + i, size - i, code);
+
+        length += count ? _utf8_length(code) : 3;
+        i      += count ? count : 1;
+    }
+
+    return length;
+}
+
+/*
+ *  将UTF-16/UTF-32 转换为UTF-8, output 的大小由wide_to_utf8_length() 得到.
+ *  返回写入的字节数; 遇到无效的字符时, lossy 为false 则返回npos, 否则写入U+FFFD.
+ */
+template<class _Wide>
+inline size_t wide_to_utf8(const _Wide* input, size_t size, char* output, bool lossy)
+{
+    static_assert(sizeof(_Wide) == 2 || sizeof(_Wide) == 4, "UTF-16 or UTF-32 only.");
+
+    const _Wide* first = input;
+    const _Wide* last  = input + size;
+    char*        out   = output;
+
+    while (first < last)
+    {
+        // 逐个字符转换的范围, 向量化的检查失败时为之后的16个字符
+        const _Wide* stop = first + 1;
+
+#if defined(UTILITY_CONV_SSE2)
+        if (last - first >= 16)
+        {
+            const __m128i* chunk = reinterpret_cast<const __m128i*>(first);
+            __m128i        bytes;
+            bool           ascii;
+
+            if (sizeof(_Wide) == 2)
+            {
+                const __m128i a = _mm_loadu_si128(chunk);
+                const __m128i b = _mm_loadu_si128(chunk + 1);
+                const __m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xFF80)));
+
+                ascii = _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) == 0xFFFF;
+                bytes = _mm_packus_epi16(a, b);
+            }
+            else
+            {
+                const __m128i a = _mm_loadu_si128(chunk);
+                const __m128i b = _mm_loadu_si128(chunk + 1);
+                const __m128i c = _mm_loadu_si128(chunk + 2);
+                const __m128i d = _mm_loadu_si128(chunk + 3);
+                const __m128i high = _mm_and_si128(
+                    _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), _mm_set1_epi32(~0x7F));
+
+                ascii = _mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) == 0xFFFF;
+                bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+            }
+
+            if (ascii)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+                first += 16;
+                out   += 16;
+                continue;
+            }
+
+            stop = first + 16;
+        }
+#endif
+        while (first < stop)
+        {
+            uint32_t code  = 0;
+            size_t   count = _wide_decode(first, size_t(last - first), code);
+            if (count == 0)
+            {
+                if (!lossy)
+                    return std::string::npos;
+
+                code  = utf_replacement;
+                count = 1;
+            }
+
+            out    = _utf8_encode(code, out);
+            first += count;
+        }
+    }
+
+    return size_t(out - output);
+}
+
+//
+// UTF-8 的验证, 处理器支持SSSE3 时使用simdjson 的查表算法:
+// 以每个字节与前一个字节的高低4位查表, 三张表的与运算得到双字节组合的错误,
+// 再检查三字节与四字节序列的后续字节, 每次处理16个字节且没有分支.
+// https://arxiv.org/abs/2010.03090
+//
+
+// 逐个字符检查, 返回无效的最长子序列的数量; first_only 为true 时遇到第一个即返回.
+inline size_t _utf8_invalid_scalar(const unsigned char* first, const unsigned char* last, bool first_only)
+{
+    size_t count = 0;
+    while (first < last)
+    {
+#if defined(UTILITY_CONV_SSE2)
+        if (last - first >= 16)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            if (_mm_movemask_epi8(chunk) == 0)
+            {
+                first += 16;
+                continue;
+            }
+        }
+#endif
+        if (*first < 0x80)
+        {
+            ++first;
+            continue;
+        }
+
+        uint32_t code   = 0;
+        int      length = _utf8_decode(first, size_t(last - first), code);
+        if (length < 0)
+        {
+            if (first_only)
+                return 1;
+
+            ++count;
+            length = -length;
+        }
+
+        first += length;
+    }
+
+    return count;
+}
+
+#if defined(UTILITY_CONV_SSE2)
+
+inline bool _utf8_has_ssse3()
+{
+#if defined(COMPILER_GCC)
+    static const bool supported = __builtin_cpu_supports("ssse3") != 0;
+#elif defined(COMPILER_MSVC)
+    static const bool supported = []
+    {
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+    }();
+#else
+    static const bool supported = false;
+#endif
+    return supported;
+}
+
+ATTRIBUTE_TARGET("ssse3")
+inline bool _utf8_valid_ssse3(const unsigned char* input, size_t size)
+{
+    enum : uint8_t
+    {
+        too_short   = 1 << 0,   // 11______ 0_______, 11______ 11______
+        too_long    = 1 << 1,   // 0_______ 10______
+        overlong_3  = 1 << 2,   // 11100000 100_____
+        too_large   = 1 << 3,   // 11110100 1001____, 11110100 101_____, 11110101 1001____ ...
+        surrogate   = 1 << 4,   // 11101101 101_____
+        overlong_2  = 1 << 5,   // 1100000_ 10______
+        too_large_2 = 1 << 6,   // 11110101 1000____, 1111011_ 1000____, 11111___ 1000____
+        overlong_4  = 1 << 6,   // 11110000 1000____
+        two_conts   = 1 << 7,   // 10______ 10______
+        carry       = too_short | too_long | two_conts,
+    };
+
+    const __m128i byte_1_high = _mm_setr_epi8(
+        too_long, too_long, too_long, too_long,
+        too_long, too_long, too_long, too_long,
+        char(two_conts), char(two_conts), char(two_conts), char(two_conts),
+        too_short | overlong_2,
+        too_short,
+        too_short | overlong_3 | surrogate,
+        too_short | too_large | too_large_2 | overlong_4);
+
+    const __m128i byte_1_low = _mm_setr_epi8(
+        char(carry | overlong_3 | overlong_2 | overlong_4),
+        char(carry | overlong_2),
+        char(carry),
+        char(carry),
+        char(carry | too_large),
+        char(carry | too_large | too_large_2),
+        char(carry | too_large | too_large_2),
+        char(carry | too_large | too_large_2),
+        char(carry | too_large | too_large_2),
+        char(carry | too_large | too_large_2),
+        char(carry | too_large | too_large_2),
+        char(carry | too_large | too_large_2),
+        char(carry | too_large | too_large_2),
+        char(carry | too_large | too_large_2 | surrogate),
+        char(carry | too_large | too_large_2),
+        char(carry | too_large | too_large_2));
+
+    const __m128i byte_2_high = _mm_setr_epi8(
+        too_short, too_short, too_short, too_short,
+        too_short, too_short, too_short, too_short,
+        char(too_long | overlong_2 | two_conts | overlong_3 | too_large_2 | overlong_4),
+        char(too_long | overlong_2 | two_conts | overlong_3 | too_large),
+        char(too_long | overlong_2 | two_conts | surrogate  | too_large),
+        char(too_long | overlong_2 | two_conts | surrogate  | too_large),
+        too_short, too_short, too_short, too_short);
+
+    // 块的最后三个字节不能是需要更多后续字节的首字节
+    const __m128i incomplete_max = _mm_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1));
+
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+
+    __m128i error      = _mm_setzero_si128();
+    __m128i previous   = _mm_setzero_si128();
+    __m128i incomplete = _mm_setzero_si128();
+
+    for (size_t i = 0; i < size; i += 16)
+    {
+        __m128i block;
+        if (i + 16 <= size)
+            block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        else
+        {
+            // 不足16字节的尾部以ASCII 的0补齐
+            alignas(16) unsigned char tail[16] = { 0 };
+            memcpy(tail, input + i, size - i);
+            block = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+        }
+
+        if (_mm_movemask_epi8(block) == 0)
+        {
+            // ASCII 的块, 只需要前一个块是完整的
+            error      = _mm_or_si128(error, incomplete);
+            incomplete = _mm_setzero_si128();
+            previous   = block;
+            continue;
+        }
+
+        const __m128i prev1 = _mm_alignr_epi8(block, previous, 15);
+        const __m128i prev2 = _mm_alignr_epi8(block, previous, 14);
+        const __m128i prev3 = _mm_alignr_epi8(block, previous, 13);
+
+        __m128i special = _mm_and_si128(
+            _mm_and_si128(
+                _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble)),
+                _mm_shuffle_epi8(byte_1_low,  _mm_and_si128(prev1, low_nibble))),
+            _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(block, 4), low_nibble)));
+
+        // 三字节与四字节序列的第三, 四个字节必须是后续字节, 此时special 的two_conts 位应为1
+        const __m128i must_23 = _mm_or_si128(
+            _mm_subs_epu8(prev2, _mm_set1_epi8(char(0xE0 - 0x80))),
+            _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xF0 - 0x80))));
+
+        special    = _mm_xor_si128(special, _mm_and_si128(must_23, _mm_set1_epi8(char(0x80))));
+        error      = _mm_or_si128(error, special);
+        incomplete = _mm_subs_epu8(block, incomplete_max);
+        previous   = block;
+    }
+
+    error = _mm_or_si128(error, incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#endif // UTILITY_CONV_SSE2
+
+//! 返回[input, input + size)是否为有效的UTF-8.
+inline bool utf8_valid(const char* input, size_t size)
+{
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(input);
+
+#if defined(UTILITY_CONV_SSE2)
+    if (_utf8_has_ssse3())
+        return _utf8_valid_ssse3(first, size);
+#endif
+
+    return _utf8_invalid_scalar(first, first + size, true) == 0;
+}
+
+//! 返回无效的最长子序列的数量, 即替换时产生的U+FFFD 的数量.
+inline size_t utf8_invalid_count(const char* input, size_t size)
+{
+    if (utf8_valid(input, size))
+        return 0;
+
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(input);
+    return _utf8_invalid_scalar(first, first + size, false);
+}
+
+/*
+ *  将无效的最长子序列替换为U+FFFD 并写入output, output 至少可以容纳3 * size 个字节.
+ *  返回写入的字节数; 有效的部分直接复制.
+ */
+inline size_t utf8_sanitize(const char* input, size_t size, char* output)
+{
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(input);
+    const unsigned char* last  = first + size;
+    const unsigned char* valid = first;     // 尚未复制的有效部分的开始
+    char*                out   = output;
+
+    while (first < last)
+    {
+#if defined(UTILITY_CONV_SSE2)
+        if (last - first >= 16)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            if (_mm_movemask_epi8(chunk) == 0)
+            {
+                first += 16;
+                continue;
+            }
+        }
+#endif
+        if (*first < 0x80)
+        {
+            ++first;
+            continue;
+        }
+
+        uint32_t code   = 0;
+        int      length = _utf8_decode(first, size_t(last - first), code);
+        if (length > 0)
+        {
+            first += length;
+            continue;
+        }
+
+        memcpy(out, valid, size_t(first - valid));
+        out  += first - valid;
+        out   = _utf8_encode(utf_replacement, out);
+
+        first -= length;
+        valid  = first;
+    }
+
+    memcpy(out, valid, size_t(last - valid));
+    out += last - valid;
+
+    return size_t(out - output);
+}
+
+} // detail
+} // conv
+} // util
+
+#endif // string_conv_utf_h__
@@ -7,6 +7,7 @@
 
 #include <assert.h>
 #include <windows.h>
+#include "string_conv_utf.hpp"
 
 namespace util {
 namespace conv {
@@ -36,30 +37,6 @@ inline const uintptr_t _utf162ansi(const wchar_t* input, char* output)
     return (uintptr_t)output;
 }
 
-inline const uintptr_t _utf82utf16(const char* input, wchar_t* output)
-{
-    assert(input);
-    int len = ::MultiByteToWideChar(CP_UTF8, 0, input, -1, NULL, 0);
-
-    if( !output )
-        return (uintptr_t)len;
-
-    ::MultiByteToWideChar(CP_UTF8, 0, input, -1, (LPWSTR)output, len);
-    return (uintptr_t)output;
-}
-
-inline const uintptr_t _utf162utf8(const wchar_t* input, char* output)
-{
-    assert(input);
-    int len = ::WideCharToMultiByte(CP_UTF8, 0, input, -1, NULL, 
-        0, NULL, NULL);
-
-    if( !output )
-        return (uintptr_t)len;
-    ::WideCharToMultiByte(CP_UTF8, 0, input, -1, output, len, NULL, NULL);
-    return (uintptr_t)output;
-}
-
 } // detail
 
 std::wstring& string_to_wstring(
@@ -90,32 +67,18 @@ std::string& wstring_to_string(
     return output;
 }
 
+// 与MultiByteToWideChar()相同, 无效的序列替换为U+FFFD; 但不需要两次调用系统的API,
+// 纯ASCII 的部分每次转换16个字节, 并且支持字符串中的'\0'.
 std::wstring& utf8_to_wstring(
     const std::string& input, std::wstring& output)
 {
-    size_t len = detail::_utf82utf16(input.c_str(), 0);
-
-    output.resize(len);
-    detail::_utf82utf16(input.c_str(), const_cast<wchar_t*>(output.data()));
-
-    if (output[output.size() - 1] == '\0')
-        output.erase(output.begin() + (output.size() - 1));
-
-    return output;
+    return utf8_to_wstring(input, output, utf_replace);
 }
 
 std::string& wstring_to_utf8(
-    const std::wstring& str, std::string& output)
+    const std::wstring& input, std::string& output)
 {
-    size_t len = detail::_utf162utf8(str.c_str(), 0);
-
-    output.resize(len);
-    detail::_utf162utf8(str.c_str(), const_cast<char*>(output.data()));
-
-    if (output[output.size() - 1] == '\0')
-        output.erase(output.begin() + (output.size() - 1));
-
-    return output;
+    return wstring_to_utf8(input, output, utf_replace);
 }
 
 std::string& utf8_to_string(
@@ -138,18 +101,5 @@ std::string& string_to_utf8(
     return output;
 }
 
-float wstring_replacement_character_persents(
-    const std::wstring& utf16)
-{
-    float count = 0;
-    for (auto it = utf16.begin(); it != utf16.end(); ++it)
-    {
-        if (*it == 0xfffd)
-            ++count;
-    }
-
-    return count / utf16.size() * 100;
-}
-
 } // conv
 } // util
\ No newline at end of file
@@ -10,380 +10,986 @@
 #endif
 
 #include <stdarg.h>
+#include <cstring>
+#include <cwctype>
 #include <string>
+#include <vector>
 #include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <stdexcept>
+#include <string/format.h>
+
+#if defined(COMPILER_MSVC)
+#   include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define UTILITY_STRING_SSE2 1
+#endif
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#   define UTILITY_STRING_AVX2 1
+#endif
 
 namespace util {
 namespace detail {
 
-template<class _TString>
-inline _TString __to_lower(const _TString& str)
+// 返回mask最低的置位的位置, mask不能为0.
+inline unsigned _lowest_bit(uint32_t mask)
 {
-    _TString result(str.length(), 0);
+#if defined(COMPILER_GCC)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#elif defined(COMPILER_MSVC)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    unsigned index = 0;
+    for (; (mask & 1) == 0; mask >>= 1)
+        ++index;
+    return index;
+#endif
+}
 
-    std::transform(str.begin(), str.end(), result.begin(), ::tolower); 
+// 查找子串, 返回位置或npos
+template<class _Char>
+inline size_t _search(std::basic_string_view<_Char> text, std::basic_string_view<_Char> pattern, size_t from)
+{
+    return text.find(pattern, from);
+}
 
-    return result;
+// 同时比较模式的首尾字节以过滤候选的位置, 仅对候选位置比较其余的字节.
+// 由于string 模块不依赖platform, 仅使用编译时已启用的指令集.
+inline size_t _search(std::string_view text, std::string_view pattern, size_t from)
+{
+    const size_t n = text.size();
+    const size_t m = pattern.size();
+
+    if (m <= 1 || from >= n || n - from < m)
+        return text.find(pattern, from);
+
+    const char* data = text.data();
+    size_t      i    = from;
+
+#if defined(UTILITY_STRING_AVX2)
+    const __m256i first32 = _mm256_set1_epi8(pattern[0]);
+    const __m256i last32  = _mm256_set1_epi8(pattern[m - 1]);
+    for (; i + m - 1 + 32 <= n; i += 32)
+    {
+        __m256i block_first = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i block_last  = _mm256_loadu_si256((const __m256i*)(data + i + m - 1));
+        uint32_t mask = uint32_t(_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(block_first, first32), _mm256_cmpeq_epi8(block_last, last32))));
+
+        for (; mask != 0; mask &= mask - 1)
+        {
+            size_t pos = i + _lowest_bit(mask);
+            if (std::memcmp(data + pos + 1, pattern.data() + 1, m - 2) == 0)
+                return pos;
+        }
+    }
+#endif
+
+#if defined(UTILITY_STRING_SSE2)
+    const __m128i first16 = _mm_set1_epi8(pattern[0]);
+    const __m128i last16  = _mm_set1_epi8(pattern[m - 1]);
+    for (; i + m - 1 + 16 <= n; i += 16)
+    {
+        __m128i block_first = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i block_last  = _mm_loadu_si128((const __m128i*)(data + i + m - 1));
+        uint32_t mask = uint32_t(_mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(block_first, first16), _mm_cmpeq_epi8(block_last, last16))));
+
+        for (; mask != 0; mask &= mask - 1)
+        {
+            size_t pos = i + _lowest_bit(mask);
+            if (std::memcmp(data + pos + 1, pattern.data() + 1, m - 2) == 0)
+                return pos;
+        }
+    }
+#endif
+
+    return text.find(pattern, i);
+}
+
+// 返回不重叠的匹配数量
+template<class _Char>
+inline size_t _count_matches(std::basic_string_view<_Char> text, std::basic_string_view<_Char> before)
+{
+    size_t count = 0;
+    for (size_t pos = _search(text, before, 0); pos != text.npos; pos = _search(text, before, pos + before.size()))
+        ++count;
+
+    return count;
 }
 
-template<class _TString>
-inline _TString __to_upper(const _TString& str)
+template<class _Char>
+inline std::basic_string<_Char> _replace_copy(
+    std::basic_string_view<_Char> target,
+    std::basic_string_view<_Char> before,
+    std::basic_string_view<_Char> after)
 {
-    _TString result(str.length(), 0);
+    size_t count = before.empty() ? 0 : _count_matches(target, before);
+    if (count == 0)
+        return std::basic_string<_Char>(target);
 
-    std::transform(str.begin(), str.end(), result.begin(), ::toupper); 
+    std::basic_string<_Char> result;
+    result.reserve(target.size() - count * before.size() + count * after.size());
+
+    size_t last = 0;
+    for (size_t pos = _search(target, before, 0); pos != target.npos; pos = _search(target, before, last))
+    {
+        result.append(target.data() + last, pos - last);
+        result.append(after.data(), after.size());
+        last = pos + before.size();
+    }
+    result.append(target.data() + last, target.size() - last);
 
     return result;
 }
 
-template<class _TString>
-inline _TString& _replace(
-          _TString& target,
-    const _TString& before,
-    const _TString& after)
-{  
-    typename _TString::size_type beforeLen = before.length();
-    typename _TString::size_type afterLen = after.length();
-    typename _TString::size_type pos = target.find(before, 0);
-
-    while(pos != _TString::npos)
-    {  
-        target.replace(pos, beforeLen, after);  
-        pos = target.find(before, (pos + afterLen));  
+template<class _Char>
+inline bool _overlaps(const std::basic_string<_Char>& target, std::basic_string_view<_Char> view)
+{
+    return !view.empty() &&
+        std::less_equal<const _Char*>()(target.data(), view.data()) &&
+        std::less<const _Char*>()(view.data(), target.data() + target.size());
+}
+
+template<class _Char>
+inline std::basic_string<_Char>& _replace(
+    std::basic_string<_Char>&     target,
+    std::basic_string_view<_Char> before,
+    std::basic_string_view<_Char> after)
+{
+    typedef std::char_traits<_Char> traits;
+
+    if (before.empty())
+        return target;
+
+    // after 更长或者参数指向target 自身时, 生成新的字符串
+    if (after.size() > before.size() || _overlaps(target, before) || _overlaps(target, after))
+    {
+        std::basic_string<_Char> result = _replace_copy(std::basic_string_view<_Char>(target), before, after);
+        target.swap(result);
+        return target;
+    }
+
+    // 就地向前移动, 写入位置不会超过下一次查找的位置
+    _Char*                        data = &target[0];
+    std::basic_string_view<_Char> text(data, target.size());
+
+    size_t pos = _search(text, before, 0);
+    if (pos == text.npos)
+        return target;
+
+    size_t write = pos;
+    size_t read  = pos;
+    for (; pos != text.npos; pos = _search(text, before, read))
+    {
+        if (write != pos)
+            traits::move(data + write, data + read, pos - read);
+        write += pos - read;
+
+        traits::copy(data + write, after.data(), after.size());
+        write += after.size();
+        read   = pos + before.size();
+    }
+
+    if (write != read)
+    {
+        traits::move(data + write, data + read, text.size() - read);
+        target.resize(write + text.size() - read);
     }
 
     return target;
 }
 
-template<class _TString>
-inline _TString _left(const _TString& target, const _TString& mark)
+/*
+ *  Aho-Corasick 自动机, 节点的边按字符排序, 根节点另有直接索引的表.
+ *  匹配采用最左最长的语义: 找到匹配后继续扫描, 直到不可能出现更靠左或更长的匹配.
+ */
+template<class _Char>
+class _replace_automaton
 {
-    typename _TString::size_type index;
-    if ((index = target.find(mark)) != _TString::npos)
+public:
+    typedef std::basic_string_view<_Char> view_type;
+    typedef std::vector<std::pair<view_type, view_type>> table_type;
+    typedef typename std::make_unsigned<_Char>::type unsigned_type;
+
+    explicit _replace_automaton(const table_type& table)
+        : _table(table)
+        , _nodes(1)
     {
-        return target.substr(0, index);
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            view_type pattern = table[i].first;
+            if (pattern.empty())
+                continue;
+
+            int32_t state = 0;
+            for (_Char ch : pattern)
+            {
+                int32_t next = _child(state, ch);
+                if (next < 0)
+                {
+                    next = int32_t(_nodes.size());
+                    _nodes.emplace_back();
+                    _nodes.back().depth = _nodes[state].depth + 1;
+                    _insert_edge(state, ch, next);
+                }
+                state = next;
+            }
+
+            if (_nodes[state].output < 0)
+                _nodes[state].output = int32_t(i);
+        }
+
+        _build_links();
     }
 
-    return _TString();
+    std::basic_string<_Char> replace(view_type text) const
+    {
+        // 先收集匹配, 以便按精确的长度分配结果
+        std::vector<std::pair<size_t, int32_t>> matches;
+        size_t size = text.size();
+
+        size_t i = 0;
+        while (i < text.size())
+        {
+            size_t  best_start = text.npos;
+            int32_t best       = -1;
+            int32_t state      = 0;
+
+            for (; i < text.size(); ++i)
+            {
+                if (state == 0 && best < 0)
+                {
+                    i = _skip(text, i);
+                    if (i == text.size())
+                        break;
+                }
+
+                state = _next(state, text[i]);
+
+                // 当前的部分匹配开始于best_start 之后, 不可能再找到更好的匹配
+                if (best >= 0 && i + 1 - size_t(_nodes[state].depth) > best_start)
+                    break;
+
+                int32_t found = _nodes[state].output >= 0 ? state : _nodes[state].dict;
+                if (found >= 0)
+                {
+                    size_t start = i + 1 - size_t(_nodes[found].depth);
+                    if (best < 0 || start < best_start ||
+                        (start == best_start && _nodes[found].depth > _nodes[best].depth))
+                    {
+                        best_start = start;
+                        best       = found;
+                    }
+                }
+            }
+
+            if (best < 0)
+                break;
+
+            const auto& entry = _table[size_t(_nodes[best].output)];
+            matches.emplace_back(best_start, _nodes[best].output);
+            size = size - entry.first.size() + entry.second.size();
+            i = best_start + entry.first.size();
+        }
+
+        std::basic_string<_Char> result;
+        result.reserve(size);
+
+        size_t last = 0;
+        for (const auto& match : matches)
+        {
+            const auto& entry = _table[size_t(match.second)];
+            result.append(text.data() + last, match.first - last);
+            result.append(entry.second.data(), entry.second.size());
+            last = match.first + entry.first.size();
+        }
+        result.append(text.data() + last, text.size() - last);
+
+        return result;
+    }
+
+protected:
+    struct node
+    {
+        std::vector<std::pair<_Char, int32_t>> edges;   // 按字符排序
+        int32_t fail   = 0;
+        int32_t output = -1;    // 以此节点结束的模式
+        int32_t dict   = -1;    // 沿失败链接的下一个有输出的节点
+        int32_t depth  = 0;
+    };
+
+    int32_t _child(int32_t state, _Char ch) const
+    {
+        const auto& edges = _nodes[state].edges;
+        auto it = std::lower_bound(edges.begin(), edges.end(), ch,
+            [](const std::pair<_Char, int32_t>& edge, _Char value) { return edge.first < value; });
+
+        return it != edges.end() && it->first == ch ? it->second : -1;
+    }
+
+    void _insert_edge(int32_t state, _Char ch, int32_t next)
+    {
+        auto& edges = _nodes[state].edges;
+        auto it = std::lower_bound(edges.begin(), edges.end(), ch,
+            [](const std::pair<_Char, int32_t>& edge, _Char value) { return edge.first < value; });
+
+        edges.insert(it, std::make_pair(ch, next));
+
+        if (state == 0 && unsigned_type(ch) < 256)
+            _root[unsigned_type(ch)] = next;
+    }
+
+    int32_t _next(int32_t state, _Char ch) const
+    {
+        for (;;)
+        {
+            if (state == 0)
+            {
+                if (unsigned_type(ch) < 256)
+                    return _root[unsigned_type(ch)];
+
+                int32_t next = _child(0, ch);
+                return next < 0 ? 0 : next;
+            }
+
+            int32_t next = _child(state, ch);
+            if (next >= 0)
+                return next;
+
+            state = _nodes[state].fail;
+        }
+    }
+
+    // 在根节点时跳过不能开始任何模式的字符
+    size_t _skip(view_type text, size_t i) const
+    {
+        for (; i < text.size(); ++i)
+        {
+            unsigned_type ch = unsigned_type(text[i]);
+            if (ch >= 256 || _root[ch] != 0)
+                break;
+        }
+        return i;
+    }
+
+    // 按广度优先的顺序计算失败链接与输出链接
+    void _build_links()
+    {
+        std::vector<int32_t> queue;
+        queue.reserve(_nodes.size());
+
+        for (const auto& edge : _nodes[0].edges)
+            queue.push_back(edge.second);
+
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            int32_t state = queue[head];
+            for (const auto& edge : _nodes[state].edges)
+            {
+                int32_t fail = _nodes[state].fail;
+                int32_t next = -1;
+                while ((next = (fail == 0 ? _root_child(edge.first) : _child(fail, edge.first))) < 0 && fail != 0)
+                    fail = _nodes[fail].fail;
+
+                int32_t target = next < 0 ? 0 : next;
+                node&   child  = _nodes[edge.second];
+
+                child.fail = target;
+                child.dict = _nodes[target].output >= 0 ? target : _nodes[target].dict;
+                queue.push_back(edge.second);
+            }
+        }
+    }
+
+    int32_t _root_child(_Char ch) const
+    {
+        return unsigned_type(ch) < 256 ? (_root[unsigned_type(ch)] != 0 ? _root[unsigned_type(ch)] : -1) : _child(0, ch);
+    }
+
+    const table_type&  _table;
+    std::vector<node>  _nodes;
+    int32_t            _root[256] = {};
+};
+
+template<class _Char>
+inline std::basic_string<_Char> _replace_all_many(
+    std::basic_string_view<_Char> target,
+    const std::vector<std::pair<std::basic_string_view<_Char>, std::basic_string_view<_Char>>>& table)
+{
+    if (table.empty() || target.empty())
+        return std::basic_string<_Char>(target);
+
+    if (table.size() == 1)
+        return _replace_copy(target, table[0].first, table[0].second);
+
+    return _replace_automaton<_Char>(table).replace(target);
 }
 
-template<class _TString>
-inline _TString _right(const _TString& target, const _TString& mark)
+// 将[first, first + 26)中的字节的0x20位翻转, 即ASCII字母的大小写转换; out 可以与in 相同.
+inline void _ascii_flip_case(char* out, const char* in, size_t size, char first)
 {
-    typename _TString::size_type index;
-    if ((index = target.rfind(mark)) != _TString::npos)
+    size_t i = 0;
+
+    // 将范围平移到[-128, -102), 以便通过一次有符号比较判断
+#if defined(UTILITY_STRING_AVX2)
+    const __m256i bias32  = _mm256_set1_epi8(char(0x80 - first));
+    const __m256i limit32 = _mm256_set1_epi8(char(-128 + 26));
+    const __m256i flip32  = _mm256_set1_epi8(0x20);
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i m = _mm256_cmpgt_epi8(limit32, _mm256_add_epi8(v, bias32));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_xor_si256(v, _mm256_and_si256(m, flip32)));
+    }
+#endif
+
+#if defined(UTILITY_STRING_SSE2)
+    const __m128i bias16  = _mm_set1_epi8(char(0x80 - first));
+    const __m128i limit16 = _mm_set1_epi8(char(-128 + 26));
+    const __m128i flip16  = _mm_set1_epi8(0x20);
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i m = _mm_cmplt_epi8(_mm_add_epi8(v, bias16), limit16);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(v, _mm_and_si128(m, flip16)));
+    }
+#endif
+
+    for (; i < size; ++i)
     {
-        return target.substr(index + mark.length());
+        unsigned char ch = static_cast<unsigned char>(in[i]);
+        out[i] = static_cast<unsigned char>(ch - first) < 26 ? char(ch ^ 0x20) : char(ch);
     }
+}
 
-    return _TString();
+inline char _ascii_lower(char ch)
+{
+    return static_cast<unsigned char>(ch - 'A') < 26 ? char(ch | 0x20) : ch;
 }
 
-template<class _TString>
-inline std::pair<_TString, _TString> _right_in_half(
-    const _TString& target, const _TString& mark)
+#if defined(UTILITY_STRING_SSE2)
+inline __m128i _ascii_lower16(__m128i v)
 {
-    _TString::size_type index;
-    if ((index = target.rfind(mark)) != _TString::npos)
+    __m128i m = _mm_cmplt_epi8(_mm_add_epi8(v, _mm_set1_epi8(char(0x80 - 'A'))), _mm_set1_epi8(char(-128 + 26)));
+    return _mm_or_si128(v, _mm_and_si128(m, _mm_set1_epi8(0x20)));
+}
+#endif
+
+// 忽略ASCII字母的大小写比较size个字节
+inline bool _ascii_iequal(const char* a, const char* b, size_t size)
+{
+    size_t i = 0;
+
+#if defined(UTILITY_STRING_SSE2)
+    for (; i + 16 <= size; i += 16)
     {
-        return std::make_pair(
-            target.substr(0, index),
-            target.substr(index + mark.length()));
+        __m128i x = _ascii_lower16(_mm_loadu_si128((const __m128i*)(a + i)));
+        __m128i y = _ascii_lower16(_mm_loadu_si128((const __m128i*)(b + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF)
+            return false;
     }
-    return std::pair<_TString, _TString>();
+#endif
+
+    for (; i < size; ++i)
+    {
+        if (_ascii_lower(a[i]) != _ascii_lower(b[i]))
+            return false;
+    }
+
+    return true;
 }
 
-template<class _TString>
-inline std::pair<_TString, _TString> _left_in_half(
-    const _TString& target, const _TString& mark)
+/*
+ *  不依赖区域设置的简单大小写映射, 覆盖拉丁文(Latin-1, 扩展A), 希腊文, 西里尔文与全角字母,
+ *  其他字符交由towlower()/towupper().
+ */
+inline wchar_t _unicode_lower(wchar_t ch)
+{
+    uint32_t c = static_cast<uint32_t>(ch);
+
+    if (c < 0x80)
+        return (c - 'A') < 26 ? wchar_t(c | 0x20) : ch;
+    if (c >= 0xC0 && c <= 0xDE && c != 0xD7)
+        return wchar_t(c + 0x20);
+    if ((c >= 0x100 && c <= 0x12F) || (c >= 0x132 && c <= 0x137) || (c >= 0x14A && c <= 0x177))
+        return wchar_t(c | 1);
+    if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E))
+        return (c & 1) ? wchar_t(c + 1) : ch;
+    if (c == 0x178)
+        return wchar_t(0xFF);
+    if (c >= 0x391 && c <= 0x3A9 && c != 0x3A2)
+        return wchar_t(c + 0x20);
+    if (c >= 0x410 && c <= 0x42F)
+        return wchar_t(c + 0x20);
+    if (c >= 0x400 && c <= 0x40F)
+        return wchar_t(c + 0x50);
+    if ((c >= 0x460 && c <= 0x481) || (c >= 0x48A && c <= 0x4BF))
+        return wchar_t(c | 1);
+    if (c >= 0xFF21 && c <= 0xFF3A)
+        return wchar_t(c + 0x20);
+
+    return static_cast<wchar_t>(std::towlower(static_cast<wint_t>(ch)));
+}
+
+inline wchar_t _unicode_upper(wchar_t ch)
+{
+    uint32_t c = static_cast<uint32_t>(ch);
+
+    if (c < 0x80)
+        return (c - 'a') < 26 ? wchar_t(c & ~0x20u) : ch;
+    if (c >= 0xE0 && c <= 0xFE && c != 0xF7)
+        return wchar_t(c - 0x20);
+    if (c == 0xFF)
+        return wchar_t(0x178);
+    if ((c >= 0x100 && c <= 0x12F) || (c >= 0x132 && c <= 0x137) || (c >= 0x14A && c <= 0x177))
+        return wchar_t(c & ~1u);
+    if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E))
+        return (c & 1) ? ch : wchar_t(c - 1);
+    if (c >= 0x3B1 && c <= 0x3C9)
+        return c == 0x3C2 ? wchar_t(0x3A3) : wchar_t(c - 0x20);
+    if (c >= 0x430 && c <= 0x44F)
+        return wchar_t(c - 0x20);
+    if (c >= 0x450 && c <= 0x45F)
+        return wchar_t(c - 0x50);
+    if ((c >= 0x460 && c <= 0x481) || (c >= 0x48A && c <= 0x4BF))
+        return wchar_t(c & ~1u);
+    if (c >= 0xFF41 && c <= 0xFF5A)
+        return wchar_t(c - 0x20);
+
+    return static_cast<wchar_t>(std::towupper(static_cast<wint_t>(ch)));
+}
+
+inline bool _unicode_iequal(const wchar_t* a, const wchar_t* b, size_t size)
 {
-    _TString::size_type index;
-    if ((index = target.find(mark)) != _TString::npos)
+    for (size_t i = 0; i < size; ++i)
     {
-        return std::make_pair(
-            target.substr(0, index),
-            target.substr(index + mark.length()));
+        if (a[i] != b[i] && _unicode_lower(a[i]) != _unicode_lower(b[i]))
+            return false;
     }
-    return std::pair<_TString, _TString>();
+
+    return true;
 }
 
-template<class _TString>
-inline _TString _between(
-    const _TString& target,
-    const _TString& left,
-    const _TString& right,
-    between_policy policy)
+inline size_t _ascii_ifind(std::string_view target, std::string_view pattern, size_t pos)
 {
-    typename _TString::size_type begin, end, middle;
-    if ((begin = target.find(left)) != _TString::npos)
+    const size_t n = target.size();
+    const size_t m = pattern.size();
+
+    if (pos > n || n - pos < m)
+        return target.npos;
+    if (m == 0)
+        return pos;
+
+    const char* data  = target.data();
+    const char  first = _ascii_lower(pattern[0]);
+    const char  last  = _ascii_lower(pattern[m - 1]);
+    size_t      i     = pos;
+
+#if defined(UTILITY_STRING_SSE2)
+    // 与_search()相同, 先比较转换为小写的首尾字节
+    const __m128i first16 = _mm_set1_epi8(first);
+    const __m128i last16  = _mm_set1_epi8(last);
+    for (; i + m - 1 + 16 <= n; i += 16)
     {
-        if ((end = target.find(right, begin + 1)) != _TString::npos)
-        {
-            if (left != right)
-            {
-                // 寻找最小匹配
-                // 例如: a...a...b, a~b
-                middle = begin + 1;
-                while (middle < end && (middle = target.find(left, middle)) != _TString::npos)
-                {
-                    if (middle < end)
-                        begin = middle++;
-                }
-            }
+        __m128i block_first = _ascii_lower16(_mm_loadu_si128((const __m128i*)(data + i)));
+        __m128i block_last  = _ascii_lower16(_mm_loadu_si128((const __m128i*)(data + i + m - 1)));
+        uint32_t mask = uint32_t(_mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(block_first, first16), _mm_cmpeq_epi8(block_last, last16))));
 
-            if (policy & contains_mark)
-                return target.substr(begin, end + right.length() - begin);
-            else
-                return target.substr(begin + left.length(), end - begin - left.length());
+        for (; mask != 0; mask &= mask - 1)
+        {
+            size_t found = i + _lowest_bit(mask);
+            if (m <= 2 || _ascii_iequal(data + found + 1, pattern.data() + 1, m - 2))
+                return found;
         }
     }
+#endif
+
+    for (; i + m <= n; ++i)
+    {
+        if (_ascii_lower(data[i]) == first && _ascii_iequal(data + i, pattern.data(), m))
+            return i;
+    }
+
+    return target.npos;
+}
+
+inline size_t _unicode_ifind(std::wstring_view target, std::wstring_view pattern, size_t pos)
+{
+    const size_t n = target.size();
+    const size_t m = pattern.size();
+
+    if (pos > n || n - pos < m)
+        return target.npos;
+    if (m == 0)
+        return pos;
+
+    const wchar_t first = _unicode_lower(pattern[0]);
+    for (size_t i = pos; i + m <= n; ++i)
+    {
+        if (_unicode_lower(target[i]) == first && _unicode_iequal(target.data() + i, pattern.data(), m))
+            return i;
+    }
 
-    return _TString();
+    return target.npos;
 }
 
 } //detail
 
 std::string  sformat(const char * format, ...)
 {
-#if OS_WIN
     va_list list;
     va_start(list, format);
 
-    std::string text(_vscprintf(format, list) + 1, 0);
-    vsprintf_s(&text[0], text.size(), format, list);
+    std::string text = vsformat(format, list);
 
     va_end(list);
 
-    return text.data();
+    return text;
+}
 
-#else
+std::wstring sformat(const wchar_t * format, ...)
+{
     va_list list;
     va_start(list, format);
 
-    std::string text(vsnprintf(nullptr, 0, format, list) + 1, 0);
+    std::wstring text = vsformat(format, list);
 
-    // These functions do not call the va_end macro. 
-    // Because they invoke the va_arg macro, the value of ap is 
-    // undefined after the call.
-    // https://linux.die.net/man/3/vsnprintf
-    va_start(list, format);
-
-    size_t size = vsnprintf(&text[0], text.size(), format, list);
+    va_end(list);
 
-    return text.data();
-#endif
+    return text;
 }
 
-std::wstring sformat(const wchar_t * format, ...)
+std::string  vsformat(const char * format, va_list args)
 {
-#if OS_WIN
+    // vsnprintf() 会改变参数列表, 重试时需要另一份副本
     va_list list;
-    va_start(list, format);
+    va_copy(list, args);
 
-    std::wstring text(_vscwprintf(format, list) + 1, 0);
-    vswprintf_s(&text[0], text.size(), format, list);
+    memory_buffer buffer;
+    int size = vsnprintf(buffer.data(), buffer.capacity(), format, list);
 
     va_end(list);
 
-    return text.data();
+    if (size < 0)
+        return std::string();
+    if (static_cast<size_t>(size) < buffer.capacity())
+        return std::string(buffer.data(), size);
 
-#else
+    // 已知精确的长度, '\0' 写入text[size] 是允许的
+    std::string text(size, 0);
+    vsnprintf(&text[0], text.size() + 1, format, args);
 
+    return text;
+}
+
+std::wstring vsformat(const wchar_t * format, va_list args)
+{
     va_list list;
-    va_start(list, format);
+    va_copy(list, args);
+
+    wmemory_buffer buffer;
+    int size = vswprintf(buffer.data(), buffer.capacity(), format, list);
+
+    va_end(list);
+
+    if (size >= 0)
+        return std::wstring(buffer.data(), size);
 
+#if OS_WIN
+    va_copy(list, args);
+    size = _vscwprintf(format, list);
+    va_end(list);
+
+    if (size < 0)
+        return std::wstring();
+
+    std::wstring text(size, 0);
+    vswprintf(&text[0], text.size() + 1, format, args);
+
+    return text;
+#else
     // 窄字符串提供 std::vsnprintf ，它使得程序能够确定要求的输出缓冲区大小。
     // 不过宽字符串无等价版本，而且为确定缓冲区大小，程序需要调用 std::vswprintf 并检查结果值，
     // 再重新分配更大的缓冲区，反复尝试直至成功。
     // https://zh.cppreference.com/w/cpp/io/c/vfwprintf
-    
-    int size = 0;
-    std::wstring text(1024, 0);
 
-    while ((size = vswprintf(&text[0], text.size(), format, list)) < 0)
+    std::wstring text(buffer.capacity() * 4, 0);
+
+    for (;;)
     {
+        va_copy(list, args);
+        size = vswprintf(&text[0], text.size(), format, list);
+        va_end(list);
+
+        if (size >= 0)
+            break;
+
         if (text.size() > 0x500000) // 上限5MB
             throw std::runtime_error("The formatted content is too long, over 5MB.");
 
-        text.resize(text.size() + 1024);
-
-        va_start(list, format);
+        text.resize(text.size() * 2);
     }
 
-    va_end(list);
-
     text.resize(size);
 
     return text;
 #endif
 }
 
-std::string  to_lower(const std::string& str)
+std::string to_lower(std::string_view str)
+{
+    std::string result(str.size(), '\0');
+    detail::_ascii_flip_case(&result[0], str.data(), str.size(), 'A');
+
+    return result;
+}
+
+std::wstring to_lower(std::wstring_view str)
+{
+    std::wstring result(str);
+    to_lower_inplace(result);
+
+    return result;
+}
+
+std::string to_upper(std::string_view str)
+{
+    std::string result(str.size(), '\0');
+    detail::_ascii_flip_case(&result[0], str.data(), str.size(), 'a');
+
+    return result;
+}
+
+std::wstring to_upper(std::wstring_view str)
 {
-    return detail::__to_lower(str);
+    std::wstring result(str);
+    to_upper_inplace(result);
+
+    return result;
 }
 
-std::wstring to_lower(const std::wstring& str)
+std::string& to_lower_inplace(std::string& str)
 {
-    return detail::__to_lower(str);
+    detail::_ascii_flip_case(&str[0], str.data(), str.size(), 'A');
+    return str;
 }
 
-std::string  to_upper(const std::string& str)
+std::wstring& to_lower_inplace(std::wstring& str)
 {
-    return detail::__to_upper(str);
+    for (wchar_t& ch : str)
+        ch = detail::_unicode_lower(ch);
+
+    return str;
 }
 
-std::wstring to_upper(const std::wstring& str)
+std::string& to_upper_inplace(std::string& str)
 {
-    return detail::__to_upper(str);
+    detail::_ascii_flip_case(&str[0], str.data(), str.size(), 'a');
+    return str;
 }
 
-std::string&  replace(std::string& target,
-    const std::string& before,
-    const std::string& after)
+std::wstring& to_upper_inplace(std::wstring& str)
+{
+    for (wchar_t& ch : str)
+        ch = detail::_unicode_upper(ch);
+
+    return str;
+}
+
+bool iequals(std::string_view a, std::string_view b)
+{
+    return a.size() == b.size() && detail::_ascii_iequal(a.data(), b.data(), a.size());
+}
+
+bool iequals(std::wstring_view a, std::wstring_view b)
+{
+    return a.size() == b.size() && detail::_unicode_iequal(a.data(), b.data(), a.size());
+}
+
+bool istarts_with(std::string_view target, std::string_view head)
+{
+    return head.size() <= target.size() && detail::_ascii_iequal(target.data(), head.data(), head.size());
+}
+
+bool istarts_with(std::wstring_view target, std::wstring_view head)
+{
+    return head.size() <= target.size() && detail::_unicode_iequal(target.data(), head.data(), head.size());
+}
+
+bool iends_with(std::string_view target, std::string_view tail)
+{
+    return tail.size() <= target.size() &&
+        detail::_ascii_iequal(target.data() + target.size() - tail.size(), tail.data(), tail.size());
+}
+
+bool iends_with(std::wstring_view target, std::wstring_view tail)
+{
+    return tail.size() <= target.size() &&
+        detail::_unicode_iequal(target.data() + target.size() - tail.size(), tail.data(), tail.size());
+}
+
+size_t ifind(std::string_view target, std::string_view pattern, size_t pos/* = 0*/)
+{
+    return detail::_ascii_ifind(target, pattern, pos);
+}
+
+size_t ifind(std::wstring_view target, std::wstring_view pattern, size_t pos/* = 0*/)
+{
+    return detail::_unicode_ifind(target, pattern, pos);
+}
+
+std::string& replace(
+    std::string&     target,
+    std::string_view before,
+    std::string_view after)
 {
     return detail::_replace(target, before, after);
 }
 
-std::wstring& replace(std::wstring& target,
-    const std::wstring& before,
-    const std::wstring& after)
+std::wstring& replace(
+    std::wstring&     target,
+    std::wstring_view before,
+    std::wstring_view after)
 {
     return detail::_replace(target, before, after);
 }
 
 std::string replace_copy(
-    const std::string& target,
-    const std::string& before,
-    const std::string& after)
+    std::string_view target,
+    std::string_view before,
+    std::string_view after)
 {
-    std::string result(target);
-
-    return detail::_replace(result, before, after);
+    return detail::_replace_copy(target, before, after);
 }
 
 std::wstring replace_copy(
-    const std::wstring& target,
-    const std::wstring& before,
-    const std::wstring& after)
+    std::wstring_view target,
+    std::wstring_view before,
+    std::wstring_view after)
+{
+    return detail::_replace_copy(target, before, after);
+}
+
+std::string replace_all_many(
+    std::string_view target,
+    const std::vector<std::pair<std::string_view, std::string_view>>& table)
 {
-    std::wstring result(target);
+    return detail::_replace_all_many(target, table);
+}
 
-    return detail::_replace(result, before, after);
+std::wstring replace_all_many(
+    std::wstring_view target,
+    const std::vector<std::pair<std::wstring_view, std::wstring_view>>& table)
+{
+    return detail::_replace_all_many(target, table);
 }
 
 std::string left(
     const std::string& target,
-    const std::string& mark)
+    std::string_view   mark)
 {
-    return detail::_left(target, mark);
+    return std::string(left(std::string_view(target), mark));
 }
 
 std::wstring left(
     const std::wstring& target,
-    const std::wstring& mark)
+    std::wstring_view   mark)
 {
-    return detail::_left(target, mark);
+    return std::wstring(left(std::wstring_view(target), mark));
 }
 
 std::string right(
     const std::string& target,
-    const std::string& mark)
+    std::string_view   mark)
 {
-    return detail::_right(target, mark);
+    return std::string(right(std::string_view(target), mark));
 }
 
 std::wstring right(
     const std::wstring& target,
-    const std::wstring& mark)
+    std::wstring_view   mark)
 {
-    return detail::_right(target, mark);
+    return std::wstring(right(std::wstring_view(target), mark));
 }
 
 std::pair<std::string, std::string> in_half_from_left(
-    const std::string& target, const std::string& mark)
+    const std::string& target, std::string_view mark)
 {
-    return detail::_left_in_half(target, mark);
+    auto result = in_half_from_left(std::string_view(target), mark);
+    return std::make_pair(std::string(result.first), std::string(result.second));
 }
 
 std::pair<std::wstring, std::wstring> in_half_from_left(
-    const std::wstring& target, const std::wstring& mark)
+    const std::wstring& target, std::wstring_view mark)
 {
-    return detail::_left_in_half(target, mark);
+    auto result = in_half_from_left(std::wstring_view(target), mark);
+    return std::make_pair(std::wstring(result.first), std::wstring(result.second));
 }
 
 std::pair<std::string, std::string> in_half_from_right(
-    const std::string& target, const std::string& mark)
+    const std::string& target, std::string_view mark)
 {
-    return detail::_right_in_half(target, mark);
+    auto result = in_half_from_right(std::string_view(target), mark);
+    return std::make_pair(std::string(result.first), std::string(result.second));
 }
 
 std::pair<std::wstring, std::wstring> in_half_from_right(
-    const std::wstring& target, const std::wstring& mark)
+    const std::wstring& target, std::wstring_view mark)
 {
-    return detail::_right_in_half(target, mark);
+    auto result = in_half_from_right(std::wstring_view(target), mark);
+    return std::make_pair(std::wstring(result.first), std::wstring(result.second));
 }
 
 std::string between(
     const std::string& target,
-    const std::string& left,
-    const std::string& right,
+    std::string_view   left,
+    std::string_view   right,
     between_policy policy/* = without_mark*/)
 {
-    return detail::_between(target, left, right, policy);
+    return std::string(between(std::string_view(target), left, right, policy));
 }
 
 std::wstring between(
     const std::wstring& target,
-    const std::wstring& left,
-    const std::wstring& right,
+    std::wstring_view   left,
+    std::wstring_view   right,
     between_policy policy/* = without_mark*/)
 {
-    return detail::_between(target, left, right, policy);
+    return std::wstring(between(std::wstring_view(target), left, right, policy));
 }
 
-bool start_with(const std::string& target, const std::string& head)
+bool start_with(std::string_view target, std::string_view head)
 {
-    if (head.empty())
-        return true;
-
-    if (head.length() > target.length())
-        return false;
-
-    return target.compare(0, head.length(), head) == 0;
+    return head.length() <= target.length() &&
+        target.compare(0, head.length(), head) == 0;
 }
 
-bool start_with(const std::wstring& target, const std::wstring& head)
+bool start_with(std::wstring_view target, std::wstring_view head)
 {
-    if (head.empty())
-        return true;
-
-    if (head.length() > target.length())
-        return false;
-
-    return target.compare(0, head.length(), head) == 0;
+    return head.length() <= target.length() &&
+        target.compare(0, head.length(), head) == 0;
 }
 
-bool end_with(const std::string& target, const std::string& tail)
+bool end_with(std::string_view target, std::string_view tail)
 {
-    if (tail.empty())
-        return true;
-
-    if (tail.length() > target.length())
-        return false;
-
-    return target.compare(target.size() - tail.length(), tail.length(), tail) == 0;
+    return tail.length() <= target.length() &&
+        target.compare(target.size() - tail.length(), tail.length(), tail) == 0;
 }
 
-bool end_with(const std::wstring& target, const std::wstring& tail)
+bool end_with(std::wstring_view target, std::wstring_view tail)
 {
-    if (tail.empty())
-        return true;
-
-    if (tail.length() > target.length())
-        return false;
-
-    return target.compare(target.size() - tail.length(), tail.length(), tail) == 0;
+    return tail.length() <= target.length() &&
+        target.compare(target.size() - tail.length(), tail.length(), tail) == 0;
 }
 
 } // util
\ No newline at end of file
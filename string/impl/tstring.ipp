@@ -2,6 +2,7 @@
 #   include "../tstring.h"
 #endif
 
+#include <charconv>
 #include <string/string_util.h>
 #include <string/string_conv.h>
 #include <string/string_conv_easy.hpp>
@@ -15,6 +16,20 @@ using namespace util::conv::easy;
 #endif
 
 namespace util {
+namespace detail {
+
+// 返回占位符"{index}"
+template<class _Char>
+inline std::basic_string<_Char> _tstring_specifier(int index)
+{
+    char  buffer[16] = { '{' };
+    char* last = std::to_chars(buffer + 1, buffer + sizeof(buffer) - 1, index).ptr;
+    *last++ = '}';
+
+    return std::basic_string<_Char>(buffer, last);
+}
+
+} // detail
 
 tstring::tstring()
     : m_index(0)
@@ -146,7 +161,7 @@ util::tstring& tstring::operator%(const std::string& arg)
 #else
 
     std::string specifier =
-        util::sformat("{%d}", ++UTILITY_PRIVATE(tstring).index);
+        detail::_tstring_specifier<char>(++m_index);
     util::replace(*this, specifier, arg);
 
     return *this;
@@ -157,7 +172,7 @@ util::tstring& tstring::operator%(const std::wstring& arg)
 {
 #if COMPILER_MSVC
     std::wstring specifier =
-        util::sformat(L"{%d}", ++m_index);
+        detail::_tstring_specifier<wchar_t>(++m_index);
     util::replace(*this, specifier, arg);
 
     return *this;
@@ -14,6 +14,13 @@
 namespace util {
 namespace conv {
 
+//! 遇到无效的UTF-8, UTF-16 或UTF-32 序列时的处理方式.
+enum utf_policy
+{
+    utf_strict  = 0,    // 抛出std::runtime_error
+    utf_replace = 1,    // 每个无效的最长子序列替换为U+FFFD
+};
+
 //! local 8 bit string or std::string to std::wstring.
 UTILITY_FUNCT_DECL std::wstring& string_to_wstring(
     const std::string& input, std::wstring& output);
@@ -30,6 +37,13 @@ UTILITY_FUNCT_DECL std::wstring& utf8_to_wstring(
 UTILITY_FUNCT_DECL std::string& wstring_to_utf8(
     const std::wstring& input, std::string& output);
 
+//! 同上, 由policy 指定无效序列的处理方式;
+//! 不带policy 的版本在Windows 上为utf_replace, 在Linux 上为utf_strict.
+UTILITY_FUNCT_DECL std::wstring& utf8_to_wstring(
+    const std::string& input, std::wstring& output, utf_policy policy);
+UTILITY_FUNCT_DECL std::string& wstring_to_utf8(
+    const std::wstring& input, std::string& output, utf_policy policy);
+
 //! utf8 string to local 8 bit string or std::string.
 //! On Linux, no conversion is done, because UTF-8 is the default.
 UTILITY_FUNCT_DECL std::string& utf8_to_string(
@@ -40,15 +54,25 @@ UTILITY_FUNCT_DECL std::string& utf8_to_string(
 UTILITY_FUNCT_DECL std::string& string_to_utf8(
     const std::string& input, std::string& output);
 
-#if OS_WIN
+//! return whether the input is valid utf8.
+//! 处理器支持SSSE3 时每次验证16个字节, 否则逐个字符验证.
+UTILITY_FUNCT_DECL bool utf8_is_valid(
+    const std::string& input);
+
+//! return the number of invalid sequences in utf8,
+//! that is, the number of U+FFFD produced by utf8_sanitize().
+UTILITY_FUNCT_DECL size_t utf8_invalid_count(
+    const std::string& input);
 
-//! return the persents of replacement character in utf16.
+//! 将utf8 中无效的最长子序列替换为U+FFFD, 有效的输入直接复制.
+UTILITY_FUNCT_DECL std::string& utf8_sanitize(
+    const std::string& input, std::string& output);
+
+//! return the persents of replacement character in utf16 or utf32.
 //! https://en.wikipedia.org/wiki/Specials_(Unicode_block)
 //! 
 UTILITY_FUNCT_DECL float wstring_replacement_character_persents(
-    const std::wstring& utf16);
-
-#endif
+    const std::wstring& wide);
 
 } // conv
 } // util
@@ -9,69 +9,161 @@
 */
 
 #include <string>
+#include <vector>
+#include <cstdarg>
+#include <utility>
+#include <string_view>
 #include <string/string_cfg.h>
 
 namespace util {
+namespace detail {
+
+// 使参数不参与模板推导, 视图版本的字符类型仅由target 决定
+template<class _Char>
+struct _string_view_of
+{
+    typedef std::basic_string_view<_Char> type;
+};
+
+} // detail
 
 /*!
  *   宽字节, 多字节字符版本的格式化
+ *
+ *   /note  1. 保留printf 风格的接口以便兼容, 新的代码应使用类型安全的util::format(), 见format.h.
+ *          2. 先格式化到栈上的缓冲区, 只有超出时才按精确的长度重新格式化, 多数情况下只分配一次内存.
  */
 UTILITY_FUNCT_DECL std::string  sformat(const char * format, ...);
 UTILITY_FUNCT_DECL std::wstring sformat(const wchar_t * format, ...);
 
+UTILITY_FUNCT_DECL std::string  vsformat(const char * format, va_list args);
+UTILITY_FUNCT_DECL std::wstring vsformat(const wchar_t * format, va_list args);
+
 /*!
- *   字符串替换
+ *  /brief  字符串替换, 将target 中所有不重叠的before 替换为after;
+ *  /note   1. 一次扫描完成, 耗时与target 的长度成线性关系, 与匹配的数量无关;
+ *             after 不长于before 时replace()就地完成, 否则与replace_copy()相同,
+ *             按精确的长度分配一次内存.
+ *          2. before 为空时不做任何替换.
  */
 UTILITY_FUNCT_DECL std::string& replace(
-    std::string& target,
-    const std::string& before,
-    const std::string& after);
+    std::string&     target,
+    std::string_view before,
+    std::string_view after);
 UTILITY_FUNCT_DECL std::wstring& replace(
-    std::wstring& target,
-    const std::wstring& before,
-    const std::wstring& after);
+    std::wstring&     target,
+    std::wstring_view before,
+    std::wstring_view after);
 UTILITY_FUNCT_DECL std::string replace_copy(
-    const std::string& target,
-    const std::string& before,
-    const std::string& after);
+    std::string_view target,
+    std::string_view before,
+    std::string_view after);
 UTILITY_FUNCT_DECL std::wstring replace_copy(
-    const std::wstring& target,
-    const std::wstring& before,
-    const std::wstring& after);
+    std::wstring_view target,
+    std::wstring_view before,
+    std::wstring_view after);
 
 /*!
- *   大小写转换
+ *  /brief  以table 中的{before, after}一次性替换target 中的多个模式, 返回替换后的副本;
+ *  /note   1. 通过Aho-Corasick 自动机一次扫描完成, 耗时与模式的数量无关;
+ *          2. 从左至右替换不重叠的匹配, 同一位置有多个匹配时选择最长的模式,
+ *             替换后的内容不会再被匹配; 空的模式将被忽略, 重复的模式以第一个为准.
+ *
+ *          replace_all_many("{name} is {age}", {{"{name}", "Tom"}, {"{age}", "18"}});
  */
-UTILITY_FUNCT_DECL std::string  to_lower(const std::string& str);
-UTILITY_FUNCT_DECL std::wstring to_lower(const std::wstring& str);
-UTILITY_FUNCT_DECL std::string  to_upper(const std::string& str);
-UTILITY_FUNCT_DECL std::wstring to_upper(const std::wstring& str);
+UTILITY_FUNCT_DECL std::string replace_all_many(
+    std::string_view target,
+    const std::vector<std::pair<std::string_view, std::string_view>>& table);
+UTILITY_FUNCT_DECL std::wstring replace_all_many(
+    std::wstring_view target,
+    const std::vector<std::pair<std::wstring_view, std::wstring_view>>& table);
+
+/*!
+ *  /brief  大小写转换
+ *  /note   1. 多字节版本仅转换ASCII字母, 其他字节(如UTF-8的多字节序列)保持不变, 与区域设置无关;
+ *             按编译时启用的SSE2/AVX2 每次处理16/32字节.
+ *          2. 宽字节版本除ASCII外还转换拉丁文, 希腊文, 西里尔文与全角字母, 其他字符交由towlower()/towupper().
+ *          3. *_inplace() 就地转换, 不分配内存.
+ */
+UTILITY_FUNCT_DECL std::string  to_lower(std::string_view  str);
+UTILITY_FUNCT_DECL std::wstring to_lower(std::wstring_view str);
+UTILITY_FUNCT_DECL std::string  to_upper(std::string_view  str);
+UTILITY_FUNCT_DECL std::wstring to_upper(std::wstring_view str);
+
+UTILITY_FUNCT_DECL std::string&  to_lower_inplace(std::string&  str);
+UTILITY_FUNCT_DECL std::wstring& to_lower_inplace(std::wstring& str);
+UTILITY_FUNCT_DECL std::string&  to_upper_inplace(std::string&  str);
+UTILITY_FUNCT_DECL std::wstring& to_upper_inplace(std::wstring& str);
+
+/*!
+ *  /brief  忽略大小写的比较与查找, 不生成转换后的副本;
+ *  /note   大小写的规则与to_lower()相同.
+ *  /return ifind()返回pos 之后第一个匹配的位置, 不存在时返回npos.
+ */
+UTILITY_FUNCT_DECL bool iequals(std::string_view  a, std::string_view  b);
+UTILITY_FUNCT_DECL bool iequals(std::wstring_view a, std::wstring_view b);
+
+UTILITY_FUNCT_DECL bool istarts_with(std::string_view  target, std::string_view  head);
+UTILITY_FUNCT_DECL bool istarts_with(std::wstring_view target, std::wstring_view head);
+
+UTILITY_FUNCT_DECL bool iends_with(std::string_view  target, std::string_view  tail);
+UTILITY_FUNCT_DECL bool iends_with(std::wstring_view target, std::wstring_view tail);
+
+UTILITY_FUNCT_DECL size_t ifind(std::string_view  target, std::string_view  pattern, size_t pos = 0);
+UTILITY_FUNCT_DECL size_t ifind(std::wstring_view target, std::wstring_view pattern, size_t pos = 0);
 
 /*!
  *  /brief  在给定的目标字符串从左边截取一段子串并返回;
  *  /param  target  给定的目标字符串;
  *  /param  mark    给定的标记;
  *  /return         返回从mark标记处(不包含该标记)的左边截取字符串, 若给定的标记不存在则返回空字符串;
+ *  /note   target 为std::basic_string_view 时返回指向target 的视图, 不分配内存;
+ *          其他版本返回结果的副本.
  */
 UTILITY_FUNCT_DECL std::string  left(
     const std::string& target,
-    const std::string& mark);
+    std::string_view   mark);
 UTILITY_FUNCT_DECL std::wstring left(
     const std::wstring& target,
-    const std::wstring& mark);
+    std::wstring_view   mark);
+
+template<class _Char>
+inline std::basic_string_view<_Char> left(
+    std::basic_string_view<_Char> target,
+    typename detail::_string_view_of<_Char>::type mark)
+{
+    size_t index = target.find(mark);
+    if (index != target.npos)
+        return target.substr(0, index);
+
+    return std::basic_string_view<_Char>();
+}
 
 /*!
  *  /brief  在给定的目标字符串从右边截取一段子串并返回;
  *  /param  target  给定的目标字符串;
  *  /param  mark    给定的标记;
  *  /return         返回从mark标记处(不包含该标记)的右边截取字符串, 若给定的标记不存在则返回空字符串;
+ *  /note   与left()相同, target 为视图时返回视图.
  */
 UTILITY_FUNCT_DECL std::string  right(
     const std::string& target,
-    const std::string& mark);
+    std::string_view   mark);
 UTILITY_FUNCT_DECL std::wstring right(
     const std::wstring& target,
-    const std::wstring& mark);
+    std::wstring_view   mark);
+
+template<class _Char>
+inline std::basic_string_view<_Char> right(
+    std::basic_string_view<_Char> target,
+    typename detail::_string_view_of<_Char>::type mark)
+{
+    size_t index = target.rfind(mark);
+    if (index != target.npos)
+        return target.substr(index + mark.length());
+
+    return std::basic_string_view<_Char>();
+}
 
 /*!
  *  /brief  给定标记, 从左起将目标字符串分成两半
@@ -79,16 +171,39 @@ UTILITY_FUNCT_DECL std::wstring right(
  *  /param  mark   若target字符串中存在mark指定的标记则从该位置分割字符串.
  *  /return        若存在mark指定的标记, 则返回分割结果: {left, right}, 否则返回: {}.
  *                 需要注意的是该结果不包含mark.
+ *  /note   与left()相同, target 为视图时返回一对视图.
  */
 UTILITY_FUNCT_DECL std::pair<std::string, std::string> in_half_from_left(
-    const std::string& target, const std::string& mark);
+    const std::string& target, std::string_view mark);
 UTILITY_FUNCT_DECL std::pair<std::wstring, std::wstring> in_half_from_left(
-    const std::wstring& target, const std::wstring& mark);
+    const std::wstring& target, std::wstring_view mark);
 
 UTILITY_FUNCT_DECL std::pair<std::string, std::string> in_half_from_right(
-    const std::string& target, const std::string& mark);
+    const std::string& target, std::string_view mark);
 UTILITY_FUNCT_DECL std::pair<std::wstring, std::wstring> in_half_from_right(
-    const std::wstring& target, const std::wstring& mark);
+    const std::wstring& target, std::wstring_view mark);
+
+template<class _Char>
+inline std::pair<std::basic_string_view<_Char>, std::basic_string_view<_Char>> in_half_from_left(
+    std::basic_string_view<_Char> target, typename detail::_string_view_of<_Char>::type mark)
+{
+    size_t index = target.find(mark);
+    if (index != target.npos)
+        return std::make_pair(target.substr(0, index), target.substr(index + mark.length()));
+
+    return std::pair<std::basic_string_view<_Char>, std::basic_string_view<_Char>>();
+}
+
+template<class _Char>
+inline std::pair<std::basic_string_view<_Char>, std::basic_string_view<_Char>> in_half_from_right(
+    std::basic_string_view<_Char> target, typename detail::_string_view_of<_Char>::type mark)
+{
+    size_t index = target.rfind(mark);
+    if (index != target.npos)
+        return std::make_pair(target.substr(0, index), target.substr(index + mark.length()));
+
+    return std::pair<std::basic_string_view<_Char>, std::basic_string_view<_Char>>();
+}
 
 enum UTILITY_CLASS_DECL between_policy
 {
@@ -103,26 +218,62 @@ enum UTILITY_CLASS_DECL between_policy
  *  /param  right   给定的右标记;
  *  /param  policy  给定的截取策略, 若为without_mark则不包含left与right本身, 否则包含它;
  *  /return         返回从left~right 之间间截取字符串, 若给定的标记不存在则返回空字符串;
+ *  /note   与left()相同, target 为视图时返回视图.
  */
 UTILITY_FUNCT_DECL std::string  between(
     const std::string& target, 
-    const std::string& left, 
-    const std::string& right,
+    std::string_view   left, 
+    std::string_view   right,
     between_policy policy = without_mark);
 UTILITY_FUNCT_DECL std::wstring between(
     const std::wstring& target,
-    const std::wstring& left,
-    const std::wstring& right,
+    std::wstring_view   left,
+    std::wstring_view   right,
     between_policy policy = without_mark);
 
+template<class _Char>
+inline std::basic_string_view<_Char> between(
+    std::basic_string_view<_Char> target,
+    typename detail::_string_view_of<_Char>::type left,
+    typename detail::_string_view_of<_Char>::type right,
+    between_policy policy = without_mark)
+{
+    size_t begin, end, middle;
+    if ((begin = target.find(left)) != target.npos)
+    {
+        if ((end = target.find(right, begin + 1)) != target.npos)
+        {
+            if (left != right)
+            {
+                // 寻找最小匹配
+                // 例如: a...a...b, a~b
+                middle = begin + 1;
+                while (middle < end && (middle = target.find(left, middle)) != target.npos)
+                {
+                    if (middle < end)
+                        begin = middle++;
+                }
+            }
+
+            if (policy & contains_mark)
+                return target.substr(begin, end + right.length() - begin);
+            else
+                return target.substr(begin + left.length(), end - begin - left.length());
+        }
+    }
+
+    return std::basic_string_view<_Char>();
+}
+
 /*!
  *  /brief  判断目标字符串是否以指定内容作为开头;
  *  /param  target  给定的目标字符串;
  *  /param  head    给定的字符串;
  *  /return         成立返回true, 否者false;
+ *  /note   参数为视图, 字符串与字面量都不需要复制.
  */
-UTILITY_FUNCT_DECL bool start_with(const std::string& target, const std::string& head);
-UTILITY_FUNCT_DECL bool start_with(const std::wstring& target, const std::wstring& head);
+UTILITY_FUNCT_DECL bool start_with(std::string_view  target, std::string_view  head);
+UTILITY_FUNCT_DECL bool start_with(std::wstring_view target, std::wstring_view head);
 
 /*!
  *  /brief  判断目标字符串是否以指定内容作为结束;
@@ -130,8 +281,8 @@ UTILITY_FUNCT_DECL bool start_with(const std::wstring& target, const std::wstrin
  *  /param  tail    给定的匹配字符串;
  *  /return         成立返回true, 否者false;
  */
-UTILITY_FUNCT_DECL bool end_with(const std::string& target, const std::string& tail);
-UTILITY_FUNCT_DECL bool end_with(const std::wstring& target, const std::wstring& tail);
+UTILITY_FUNCT_DECL bool end_with(std::string_view  target, std::string_view  tail);
+UTILITY_FUNCT_DECL bool end_with(std::wstring_view target, std::wstring_view tail);
 
 } // util
 
@@ -10,8 +10,11 @@
 
 #include <string>
 #include <sstream>
+#include <charconv>
+#include <type_traits>
 #include <string/string_cfg.h>
 #include <string/string_conv.h>
+#include <string/format.h>
 
 #ifdef UTILITY_SUPPORT_QT
 #   include <string/string_conv_easy.hpp>
@@ -95,6 +98,7 @@ public:
     UTILITY_MEMBER_DECL std::wstring wstring() const;
 
     //! 以指定的内容替换字符串中的占位符, 如: {1},{2}
+    //! 每次调用都会扫描整个字符串, 反复使用的模板应通过tformat 预先解析.
     template<class _Type>
     UTILITY_MEMBER_DECL tstring& operator%(const _Type& arg);
     UTILITY_MEMBER_DECL tstring& operator%(const char* arg);
@@ -113,11 +117,27 @@ private:
 template<class _Type>
 tstring& util::tstring::operator%(const _Type& arg)
 {
-    stream_type stream;
-    stream << arg;
-    return (*this) % stream.str();
+    // 整数通过std::to_chars()转换, 结果与流相同; 字符类型仍通过流输出字符
+    if constexpr (std::is_integral<_Type>::value && sizeof(_Type) > 1 &&
+        !std::is_same<_Type, wchar_t>::value && !std::is_same<_Type, char16_t>::value && !std::is_same<_Type, char32_t>::value)
+    {
+        char  buffer[24];
+        char* last = std::to_chars(buffer, buffer + sizeof(buffer), arg).ptr;
+        return (*this) % supper_type(buffer, last);
+    }
+    else
+    {
+        stream_type stream;
+        stream << arg;
+        return (*this) % stream.str();
+    }
 }
 
+/*!
+ *  \brief 以tstring 的字符类型预先解析的"{N}"模板, 见basic_tformat.
+ */
+typedef basic_tformat<tstring::element_type> tformat;
+
 //!
 //! 为了避免库产生Qt Core 的依赖, 这在编写非Qt应用程序时非常重要
 //! 
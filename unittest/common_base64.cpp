@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <common/base64.h>
+
+namespace {
+
+util::bytedata random_bytes(size_t size)
+{
+    std::mt19937 engine(static_cast<unsigned>(size));
+    util::bytedata bytes(size, 0);
+    for (size_t i = 0; i < size; ++i)
+        bytes[i] = char(engine());
+    return bytes;
+}
+
+std::string encode(const util::bytedata& bytes, int flags = util::base64_default)
+{
+    std::string result(util::base64_encoded_size(bytes.size(), flags), '\0');
+    result.resize(util::base64_encode(&result[0], bytes.data(), bytes.size(), flags));
+    return result;
+}
+
+bool decode(util::bytedata& bytes, const std::string& text, int flags = util::base64_default)
+{
+    size_t size = 0;
+    bytes.assign(util::base64_decoded_size(text.size()), '\0');
+    bool result = util::base64_decode(&bytes[0], size, text.data(), text.size(), flags);
+    bytes.resize(size);
+    return result;
+}
+
+// 逐字节的参考实现
+std::string encode_reference(const util::bytedata& bytes, bool url)
+{
+    const char* alphabet = url ?
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_" :
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string result;
+    uint32_t bits = 0;
+    int count = 0;
+    for (unsigned char c : bytes)
+    {
+        bits = bits << 8 | c;
+        for (count += 8; count >= 6; count -= 6)
+            result += alphabet[(bits >> (count - 6)) & 0x3F];
+    }
+    if (count > 0)
+        result += alphabet[(bits << (6 - count)) & 0x3F];
+    while (result.size() % 4)
+        result += '=';
+    return result;
+}
+
+} // namespace
+
+TEST(common_base64, vectors)
+{
+    // RFC 4648 §10
+    const char* vectors[][2] = {
+        { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+        { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" },
+    };
+
+    util::bytedata bytes;
+    for (auto& v : vectors)
+    {
+        EXPECT_EQ(encode(v[0]), v[1]);
+        EXPECT_TRUE(decode(bytes, v[1]));
+        EXPECT_EQ(bytes, v[0]);
+    }
+
+    EXPECT_EQ(encode("fo", util::base64_nopad), "Zm8");
+    EXPECT_EQ(util::base64_encoded_size(2, util::base64_nopad), 3u);
+    EXPECT_TRUE(decode(bytes, "Zm8"));
+    EXPECT_EQ(bytes, "fo");
+
+    // URL安全的字母表
+    util::bytedata binary("\xfb\xff\xbf", 3);
+    EXPECT_EQ(encode(binary), "+/+/");
+    EXPECT_EQ(encode(binary, util::base64_url), "-_-_");
+    EXPECT_TRUE(decode(bytes, "-_-_", util::base64_url));
+    EXPECT_EQ(bytes, binary);
+    EXPECT_FALSE(decode(bytes, "-_-_"));
+
+    // 无效的输入
+    for (const char* text : { "Zm9v!", "Z===", "Zg=a", "Zg==Zg==", "Z", "Zm9vY" })
+        EXPECT_FALSE(decode(bytes, text)) << text;
+
+    EXPECT_TRUE(decode(bytes, " Zm9v\r\nYmFy \t"));
+    EXPECT_EQ(bytes, "foobar");
+}
+
+TEST(common_base64, nopad_tail)
+{
+    // 1, 2字节的尾部, 按base64_encoded_size()分配的缓冲区不能越界
+    for (int flags : { int(util::base64_nopad), util::base64_url | util::base64_nopad })
+    {
+        for (size_t size = 1; size <= 5; ++size)
+        {
+            util::bytedata bytes = random_bytes(size);
+            size_t length = util::base64_encoded_size(size, flags);
+            EXPECT_EQ(length, size / 3 * 4 + (size % 3 ? size % 3 + 1 : 0));
+
+            std::unique_ptr<char[]> exact(new char[length]);
+            EXPECT_EQ(util::base64_encode(exact.get(), bytes.data(), size, flags), length);
+
+            std::string guarded(length + 2, '#');
+            EXPECT_EQ(util::base64_encode(&guarded[0], bytes.data(), size, flags), length);
+            EXPECT_EQ(guarded.substr(length), "##") << size;
+
+            std::string expected = encode_reference(bytes, (flags & util::base64_url) != 0);
+            EXPECT_EQ(std::string(exact.get(), length), expected.substr(0, expected.find('=')));
+        }
+    }
+}
+
+TEST(common_base64, mime)
+{
+    util::bytedata bytes = random_bytes(1000);
+    std::string text = encode(bytes, util::base64_mime);
+    EXPECT_EQ(text.size(), util::base64_encoded_size(bytes.size(), util::base64_mime));
+
+    // 每行76个字符, 最后一行之后没有换行
+    size_t begin = 0;
+    for (size_t end; (end = text.find("\r\n", begin)) != std::string::npos; begin = end + 2)
+        EXPECT_EQ(end - begin, 76u);
+    EXPECT_LE(text.size() - begin, 76u);
+
+    util::bytedata decoded;
+    EXPECT_TRUE(decode(decoded, text));
+    EXPECT_EQ(decoded, bytes);
+
+    text = encode(random_bytes(57 * 3), util::base64_mime | util::base64_wrap_lf);
+    EXPECT_EQ(text.size(), 76u * 3 + 2);
+    EXPECT_EQ(text.find('\r'), std::string::npos);
+
+    std::string legacy;
+    util::bytes_into_base64(legacy, bytes, false);
+    EXPECT_TRUE(util::bytes_from_base64(decoded, legacy) == bytes);
+}
+
+TEST(common_base64, round_trip)
+{
+    // 覆盖向量化实现与标量实现的各种边界
+    for (size_t size = 0; size < 300; ++size)
+    {
+        for (int flags : { util::base64_default, util::base64_url })
+        {
+            util::bytedata bytes = random_bytes(size);
+            std::string text = encode(bytes, flags);
+            EXPECT_EQ(text, encode_reference(bytes, flags == util::base64_url)) << size;
+
+            util::bytedata decoded;
+            EXPECT_TRUE(decode(decoded, text, flags)) << size;
+            EXPECT_EQ(decoded, bytes) << size;
+        }
+    }
+
+    util::bytedata bytes = random_bytes(1 << 20);
+    std::string text;
+    util::bytes_into_base64(text, bytes);
+    EXPECT_EQ(text, encode_reference(bytes, false));
+
+    util::bytedata decoded;
+    EXPECT_EQ(util::bytes_from_base64(decoded, text), bytes);
+
+    // 向量化的实现遇到无效字符时, 应在准确的位置停止
+    text[5000] = '*';
+    EXPECT_FALSE(decode(decoded, text));
+    EXPECT_EQ(decoded, bytes.substr(0, 3750));
+}
+
+TEST(common_base64, streaming)
+{
+    util::bytedata bytes = random_bytes(10000);
+    std::mt19937 engine(42);
+
+    for (int flags : { int(util::base64_default), util::base64_url | util::base64_nopad, int(util::base64_mime) })
+    {
+        std::string expected = encode(bytes, flags);
+
+        for (int round = 0; round < 10; ++round)
+        {
+            util::base64_encoder encoder(flags);
+            std::string text;
+            for (size_t offset = 0; offset < bytes.size(); )
+            {
+                size_t size = std::min<size_t>(engine() % 200, bytes.size() - offset);
+                encoder.update(bytes.data() + offset, size, text);
+                offset += size;
+            }
+            encoder.finalize(text);
+            EXPECT_EQ(text, expected) << flags;
+
+            util::base64_decoder decoder(flags);
+            util::bytedata decoded;
+            for (size_t offset = 0; offset < text.size(); )
+            {
+                size_t size = std::min<size_t>(engine() % 200, text.size() - offset);
+                EXPECT_TRUE(decoder.update(text.data() + offset, size, decoded));
+                offset += size;
+            }
+            EXPECT_TRUE(decoder.finalize(decoded));
+            EXPECT_EQ(decoded, bytes) << flags;
+        }
+    }
+
+    util::base64_decoder decoder;
+    util::bytedata decoded;
+    EXPECT_TRUE(decoder.update("Zm9vY", 5, decoded));
+    EXPECT_FALSE(decoder.finalize(decoded));
+    EXPECT_FALSE(decoder.update("Zm9v*", 5, decoded));
+    EXPECT_FALSE(decoder.finalize(decoded));
+}
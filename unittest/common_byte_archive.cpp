@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <common/byte_archive.hpp>
+
+#ifdef UTILITY_SUPPORT_BOOST
+#   include <sstream>
+#   include <boost/serialization/map.hpp>
+#   include <boost/serialization/string.hpp>
+#   include <boost/serialization/vector.hpp>
+#endif
+
+namespace {
+
+struct point
+{
+    int32_t x, y;
+};
+
+enum class color : uint8_t { red, green };
+
+struct cache_entry
+{
+    std::string                  key;
+    uint64_t                     timestamp = 0;
+    color                        tint = color::red;
+    std::vector<uint32_t>        blocks;
+    std::vector<std::string>     tags;
+    std::map<std::string, int>   counters;
+
+    template<class Archive>
+    void serialize(Archive& ar, const unsigned int /*version*/)
+    {
+        ar & key;
+        ar & timestamp;
+        ar & tint;
+        ar & blocks;
+        ar & tags;
+        ar & counters;
+    }
+
+    bool operator==(const cache_entry& other) const
+    {
+        return key == other.key && timestamp == other.timestamp && tint == other.tint &&
+            blocks == other.blocks && tags == other.tags && counters == other.counters;
+    }
+};
+
+// 通过ADL 找到的非成员 serialize()
+struct legacy
+{
+    std::wstring name;
+    std::vector<point> points;
+};
+
+template<class Archive>
+void serialize(Archive& ar, legacy& value, const unsigned int /*version*/)
+{
+    ar & value.name & value.points;
+}
+
+cache_entry make_entry(int i)
+{
+    cache_entry entry;
+    entry.key       = "/cache/entry/" + std::to_string(i);
+    entry.timestamp = 1687000000000ull + i;
+    entry.tint      = color::green;
+    entry.blocks.assign(64, uint32_t(i));
+    entry.tags      = { "hot", "compressed" };
+    entry.counters  = { { "hits", i }, { "misses", 3 } };
+    return entry;
+}
+
+} // namespace
+
+TEST(common_byte_archive, round_trip)
+{
+    util::bytedata arena;
+    cache_entry entry = make_entry(42), loaded;
+    util::bytes_unpack(loaded, util::bytes_pack(arena, entry));
+    EXPECT_EQ(loaded, entry);
+
+    // 再次使用同一个arena 不会重新分配
+    const char* buffer = arena.data();
+    util::bytes_pack(arena, make_entry(43));
+    EXPECT_EQ(arena.data(), buffer);
+
+    legacy value = { L"名称", { { 1, 2 }, { -3, 4 } } }, value1;
+    util::bytes_unpack(value1, util::bytes_pack(arena, value));
+    EXPECT_EQ(value1.name, value.name);
+    ASSERT_EQ(value1.points.size(), 2u);
+    EXPECT_EQ(value1.points[1].x, -3);
+
+    std::vector<bool> bits = { true, false, true }, bits1;
+    std::deque<std::pair<int, std::string>> pairs = { { 1, "a" }, { 2, "b" } }, pairs1;
+    int array[3] = { 1, 2, 3 }, array1[3] = { 0 };
+
+    util::bytedata bytes;
+    util::byte_oarchive oa(bytes);
+    oa << bits << pairs << array;
+
+    util::byte_iarchive ia(bytes);
+    ia >> bits1 >> pairs1 >> array1;
+    EXPECT_EQ(bits1, bits);
+    EXPECT_EQ(pairs1, pairs);
+    EXPECT_EQ(array1[2], 3);
+    EXPECT_TRUE(ia.empty());
+
+    // 损坏的数据
+    util::bytes_pack(arena, entry);
+    arena.resize(arena.size() - 1);
+    EXPECT_THROW(util::bytes_unpack(loaded, arena), std::runtime_error);
+
+    std::vector<uint64_t> huge;
+    EXPECT_THROW(util::bytes_unpack(huge, util::bytes_view("\xff\xff\xff\xff\x0f", 5)), std::runtime_error);
+}
+
+// 性能测试, 默认不运行; 通过 --gtest_also_run_disabled_tests 运行, 比较gtest 报告的各测试耗时
+TEST(common_byte_archive, DISABLED_benchmark_pack)
+{
+    std::vector<cache_entry> entries;
+    for (int i = 0; i < 100; ++i)
+        entries.push_back(make_entry(i));
+
+    util::bytedata arena;
+    cache_entry    loaded;
+    for (int i = 0; i < 20000; ++i)
+        util::bytes_unpack(loaded, util::bytes_pack(arena, entries[i % entries.size()]));
+
+    EXPECT_EQ(loaded, entries[19999 % entries.size()]);
+}
+
+#ifdef UTILITY_SUPPORT_BOOST
+TEST(common_byte_archive, DISABLED_benchmark_serialize)
+{
+    std::vector<cache_entry> entries;
+    for (int i = 0; i < 100; ++i)
+        entries.push_back(make_entry(i));
+
+    util::bytedata bytes;
+    cache_entry    loaded;
+    for (int i = 0; i < 20000; ++i)
+        util::bytes_deserialize(loaded, util::bytes_serialize(bytes, entries[i % entries.size()]));
+
+    EXPECT_EQ(loaded, entries[19999 % entries.size()]);
+}
+#endif
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <common/byte_stream.hpp>
+
+TEST(common_byte_stream, endian)
+{
+    for (int order : { util::byte_order_little, util::byte_order_big })
+    {
+        util::bytedata bytes;
+        util::byte_writer writer(bytes, order);
+        writer.put<uint16_t>(0x0102).put<uint32_t>(0x03040506).put<double>(1.5);
+        writer.put_all(uint8_t(7), int64_t(-2), float(0.25f));
+
+        const uint32_t values[] = { 1, 2, 0xdeadbeef };
+        writer.put_array(values, 3);
+
+        EXPECT_EQ(bytes.size(), 2u + 4 + 8 + 1 + 8 + 4 + 12);
+        EXPECT_EQ(uint8_t(bytes[0]), order == util::byte_order_big ? 0x01 : 0x02);
+
+        util::byte_reader reader(bytes, order);
+        EXPECT_EQ(reader.get<uint16_t>(), 0x0102);
+        EXPECT_EQ(reader.get<uint32_t>(), 0x03040506u);
+        EXPECT_EQ(reader.get<double>(), 1.5);
+
+        uint8_t a = 0; int64_t b = 0; float c = 0;
+        reader.get_all(a, b, c);
+        EXPECT_EQ(a, 7);
+        EXPECT_EQ(b, -2);
+        EXPECT_EQ(c, 0.25f);
+
+        uint32_t read_values[3] = { 0 };
+        reader.get_array(read_values, 3);
+        EXPECT_EQ(read_values[2], 0xdeadbeefu);
+        EXPECT_TRUE(reader.empty());
+    }
+
+    EXPECT_EQ(util::hton_type<uint32_t>(0x01020304), 0x04030201u);
+}
+
+TEST(common_byte_stream, varint)
+{
+    util::bytedata bytes;
+    util::byte_writer writer(bytes);
+
+    const uint64_t unsigneds[] = { 0, 1, 127, 128, 300, 16383, 16384, 0xffffffffull, ~0ull };
+    const int64_t  signeds[]   = { 0, -1, 1, -64, 64, INT64_MIN, INT64_MAX };
+
+    for (uint64_t v : unsigneds)
+        writer.put_varint(v);
+    for (int64_t v : signeds)
+        writer.put_zigzag(v);
+    writer.put_string("hello").put_string("");
+
+    util::byte_reader reader(bytes);
+    for (uint64_t v : unsigneds)
+        EXPECT_EQ(reader.get_varint(), v);
+    for (int64_t v : signeds)
+        EXPECT_EQ(reader.get_zigzag(), v);
+    EXPECT_EQ(reader.get_string(), util::bytes_view("hello"));
+    EXPECT_TRUE(reader.get_string().empty());
+    EXPECT_TRUE(reader.empty());
+
+    // 编码的长度
+    util::bytedata small;
+    util::byte_writer(small).put_varint(300).put_zigzag(-1);
+    EXPECT_EQ(small, util::bytedata("\xac\x02\x01", 3));
+
+    // 截断与溢出
+    util::byte_reader truncated(util::bytes_view("\x80\x80", 2));
+    EXPECT_THROW(truncated.get_varint(), std::runtime_error);
+    EXPECT_EQ(truncated.position(), 0u);
+
+    util::byte_reader overflow(util::bytes_view("\xff\xff\xff\xff\xff\xff\xff\xff\xff\x02", 10));
+    EXPECT_THROW(overflow.get_varint(), std::runtime_error);
+
+    util::byte_reader short_string(util::bytes_view("\x05" "abc", 4));
+    EXPECT_THROW(short_string.get_string(), std::runtime_error);
+    EXPECT_EQ(short_string.remaining(), 4u);
+    EXPECT_THROW(short_string.get<uint64_t>(), std::runtime_error);
+    EXPECT_EQ(short_string.read(4), util::bytes_view("\x05" "abc", 4));
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <common/bytedata.hpp>
+#include <common/digest.hpp>
+#include <common/encryption.h>
+
+TEST(common_bytes_view, slice)
+{
+    util::bytedata bytes("0123456789");
+    util::bytes_view view = bytes;
+
+    EXPECT_EQ(view.size(), bytes.size());
+    EXPECT_EQ(view.chars(), bytes.data());
+    EXPECT_EQ(view.subview(3, 4), util::bytes_view("3456"));
+    EXPECT_EQ(view.subview(8), util::bytes_view("89"));
+    EXPECT_EQ(view.subview(10).size(), 0u);
+    EXPECT_EQ(view.slice(2, 5).bytes(), "234");
+    EXPECT_THROW(view.subview(11), std::runtime_error);
+    EXPECT_THROW(view.slice(5, 2), std::runtime_error);
+    EXPECT_THROW(view.slice(0, 11), std::runtime_error);
+    EXPECT_THROW(view.at(10), std::runtime_error);
+
+    util::bytes_view rest = view;
+    rest.remove_prefix(2);
+    rest.remove_suffix(2);
+    EXPECT_EQ(rest, util::bytes_view("234567"));
+    EXPECT_EQ(std::string(rest.begin(), rest.end()), "234567");
+    EXPECT_NE(rest, view);
+}
+
+TEST(common_bytes_view, load)
+{
+    const uint8_t data[] = { 0xff, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+    util::bytes_view view(data, sizeof(data));
+
+    // 奇数偏移, 不要求对齐
+    EXPECT_EQ(view.load_be<uint16_t>(1), 0x0102u);
+    EXPECT_EQ(view.load_le<uint16_t>(1), 0x0201u);
+    EXPECT_EQ(view.load_be<uint32_t>(1), 0x01020304u);
+    EXPECT_EQ(view.load_le<uint32_t>(1), 0x04030201u);
+    EXPECT_EQ(view.load_be<uint64_t>(1), 0x0102030405060708ull);
+    EXPECT_EQ(view.load_le<int64_t>(1), 0x0807060504030201ll);
+    EXPECT_EQ(view.load<uint8_t>(), 0xffu);
+    EXPECT_THROW(view.load<uint64_t>(2), std::runtime_error);
+    EXPECT_THROW(view.load<uint8_t>(9), std::runtime_error);
+
+    struct header { uint16_t type; uint32_t length; };
+    header h = { 7, 1000 };
+    util::bytedata bytes = std::string("abc") + util::bytes_from(h);
+    header h1 = util::bytes_cast<header>(bytes, 3);
+    EXPECT_EQ(h1.type, 7);
+    EXPECT_EQ(h1.length, 1000u);
+    EXPECT_THROW(util::bytes_cast<header>(bytes, 4), std::runtime_error);
+}
+
+TEST(common_bytes_view, apis)
+{
+    util::bytedata bytes("The quick brown fox jumps over the lazy dog");
+    util::bytes_view view = util::bytes_view(bytes).subview(4, 5);
+
+    EXPECT_EQ(util::bytes_into_hex(view), "717569636b");
+    EXPECT_EQ(util::bytes_md5_digest(view), util::bytes_md5_digest(util::bytedata("quick")));
+
+    std::string base64;
+    EXPECT_EQ(util::bytes_into_base64(base64, view), "cXVpY2s=");
+
+    // 超过16字节的密钥仅使用前16字节
+    util::bytedata cipher = bytes;
+    util::encryption::encrypt_with_tea32(cipher, util::bytes_view(bytes).subview(0, 16));
+    util::encryption::decrypt_with_tea32(cipher, bytes);
+    EXPECT_EQ(cipher, bytes);
+
+    char memory[5] = { 0 };
+    util::bytes_into_memory(memory, sizeof(memory), view);
+    EXPECT_EQ(std::string(memory, sizeof(memory)), "quick");
+    EXPECT_THROW(util::bytes_into_memory(memory, sizeof(memory), bytes), std::runtime_error);
+}
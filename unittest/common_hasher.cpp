@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <common/hasher.h>
+#include <common/digest.hpp>
+#include <common/impl/hasher_kernels.hpp>
+
+namespace {
+
+// 测试向量通用的输入: 0, 1, ..., 250, 0, 1, ...
+util::bytedata pattern_bytes(size_t size)
+{
+    util::bytedata bytes(size, 0);
+    for (size_t i = 0; i < size; ++i)
+        bytes[i] = char(i % 251);
+    return bytes;
+}
+
+util::bytedata random_bytes(size_t size)
+{
+    std::mt19937 engine(static_cast<unsigned>(size));
+    util::bytedata bytes(size, 0);
+    for (size_t i = 0; i < size; ++i)
+        bytes[i] = char(engine());
+    return bytes;
+}
+
+util::bytedata digest_of(int algorithm, const util::bytedata& bytes)
+{
+    auto hasher = util::hasher_create(algorithm);
+    hasher->update(bytes);
+    return hasher->finalize();
+}
+
+} // namespace
+
+TEST(common_hasher, vectors)
+{
+    struct { int algorithm; size_t size; const char* hex; } vectors[] = {
+        { util::hash_md5,    0,      "d41d8cd98f00b204e9800998ecf8427e" },
+        { util::hash_md5,    102400, "1a0f81547e5ba2e9c4a4b94a74731993" },
+        { util::hash_sha1,   0,      "da39a3ee5e6b4b0d3255bfef95601890afd80709" },
+        { util::hash_sha1,   102400, "f18b928d893ae172a000efa19b80e1c04fb36414" },
+        { util::hash_sha256, 0,      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+        { util::hash_sha256, 102400, "74588b7f0bcc354ac14d9cf199fa3a20c05f0c7293b9075b2f2e146e718de800" },
+        { util::hash_blake3, 0,      "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262" },
+        { util::hash_blake3, 1,      "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213" },
+        { util::hash_blake3, 64,     "4eed7141ea4a5cd4b788606bd23f46e212af9cacebacdc7d1f4c6dc7f2511b98" },
+        { util::hash_blake3, 65,     "de1e5fa0be70df6d2be8fffd0e99ceaa8eb6e8c93a63f2d8d1c30ecb6b263dee" },
+        { util::hash_blake3, 1024,   "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7" },
+        { util::hash_blake3, 1025,   "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444" },
+        { util::hash_blake3, 3073,   "7124b49501012f81cc7f11ca069ec9226cecb8a2c850cfe644e327d22d3e1cd3" },
+        { util::hash_blake3, 31744,  "62b6960e1a44bcc1eb1a611a8d6235b6b4b78f32e7abc4fb4c6cdcce94895c47" },
+        { util::hash_blake3, 102400, "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085" },
+    };
+
+    for (auto& v : vectors)
+        EXPECT_EQ(digest_of(v.algorithm, pattern_bytes(v.size)), util::bytes_from_hex(v.hex)) << v.algorithm << " " << v.size;
+
+    EXPECT_EQ(digest_of(util::hash_md5,    "abc"), util::bytes_from_hex("900150983cd24fb0d6963f7d28e17f72"));
+    EXPECT_EQ(digest_of(util::hash_sha1,   "abc"), util::bytes_from_hex("a9993e364706816aba3e25717850c26c9cd0d89d"));
+    EXPECT_EQ(digest_of(util::hash_sha256, "abc"), util::bytes_from_hex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    EXPECT_EQ(digest_of(util::hash_blake3, "abc"), util::bytes_from_hex("6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85"));
+
+    util::crc32c_hasher crc;
+    crc.update("123456789", 9);
+    EXPECT_EQ(crc.value(), 0xE3069283u);
+    EXPECT_EQ(crc.finalize(), util::bytes_from_hex("e3069283"));
+
+    EXPECT_EQ(util::hasher_create(-1), nullptr);
+}
+
+TEST(common_hasher, incremental)
+{
+    const int algorithms[] = {
+        util::hash_md5, util::hash_sha1, util::hash_sha256, util::hash_crc32c, util::hash_blake3 };
+
+    util::bytedata bytes = random_bytes(5000);
+
+    for (int algorithm : algorithms)
+    {
+        util::bytedata expected = digest_of(algorithm, bytes);
+        auto hasher = util::hasher_create(algorithm);
+
+        EXPECT_EQ(hasher->digest_size(), expected.size());
+
+        // 以不同的分段输入, 覆盖块边界的各种情况
+        for (size_t step : { 1, 3, 63, 64, 65, 1000, 1024, 4096 })
+        {
+            hasher->reset();
+            for (size_t offset = 0; offset < bytes.size(); offset += step)
+                hasher->update(bytes.data() + offset, std::min(step, bytes.size() - offset));
+
+            EXPECT_EQ(hasher->finalize(), expected) << algorithm << " " << step;
+        }
+    }
+}
+
+TEST(common_hasher, sha256_digest_many)
+{
+    std::vector<util::bytedata> messages;
+    for (size_t size : { 0, 1, 55, 56, 64, 100, 128, 1000, 4096, 4097, 333, 777, 65536, 64, 0, 12345, 20000 })
+        messages.push_back(random_bytes(size));
+
+    std::vector<const void*> datas;
+    std::vector<size_t> sizes;
+    for (auto& message : messages)
+    {
+        datas.push_back(message.data());
+        sizes.push_back(message.size());
+    }
+
+    std::vector<uint8_t> digests(messages.size() * 32);
+    util::sha256_digest_many(datas.data(), sizes.data(), messages.size(), digests.data());
+
+    for (size_t i = 0; i < messages.size(); ++i)
+        EXPECT_EQ(util::bytedata(&digests[i * 32], 32), digest_of(util::hash_sha256, messages[i])) << i;
+}
+
+#if defined(UTILITY_HASHER_X86)
+// 处理器支持SHA-NI 时sha256_digest_many() 不使用8路的实现, 故直接与单路的实现比较
+TEST(common_hasher, sha256_compress_x8)
+{
+    if (!util::detail::_hash_cpu().has_avx2())
+        return;
+
+    const size_t blocks = 5;
+    std::vector<util::bytedata> messages;
+    const uint8_t* lanes[8];
+    for (size_t n = 0; n < 8; ++n)
+    {
+        messages.push_back(random_bytes(blocks * 64 + n));
+        lanes[n] = reinterpret_cast<const uint8_t*>(messages[n].data());
+    }
+
+    uint32_t state[8][8];
+    for (int i = 0; i < 8; ++i)
+        std::fill(state[i], state[i] + 8, util::detail::_sha256_iv()[i]);
+
+    util::detail::_sha256_compress_x8_avx2(state, lanes, blocks);
+
+    for (size_t n = 0; n < 8; ++n)
+    {
+        uint32_t expected[8];
+        std::memcpy(expected, util::detail::_sha256_iv(), sizeof(expected));
+        util::detail::_sha256_compress_scalar(expected, lanes[n], blocks);
+
+        for (int i = 0; i < 8; ++i)
+            EXPECT_EQ(state[i][n], expected[i]) << n << " " << i;
+    }
+}
+#endif
+
+TEST(common_hasher, files_digest)
+{
+    util::fpath dir = "files_digest_test";
+    util::directories_remove(dir);
+    util::directories_create(dir);
+
+    std::vector<util::fpath>    names;
+    std::vector<util::bytedata> contents;
+    for (size_t size : { 0, 1, 4096, 1000000, 3 * 1024 * 1024 + 7, 123 })
+    {
+        names.push_back(util::path_append(dir, std::to_string(size)));
+        contents.push_back(random_bytes(size));
+        util::bytes_into_file(names.back(), contents.back());
+    }
+    names.push_back(util::path_append(dir, "not_exist"));
+
+    util::fdigest_options options(util::hash_sha256, 4);
+    options.chunk_size = 256 * 1024;
+
+    util::fsize last = 0, total = 0;
+    auto call = [&](util::fsize processed, util::fsize size) -> bool {
+        EXPECT_GT(processed, last);
+        last  = processed;
+        total = size;
+        return true;
+    };
+
+    // 普通摘要
+    std::vector<util::bytedata> digests;
+    std::vector<util::ferror>   errors;
+    EXPECT_FALSE(util::files_digest(names, digests, errors, options, call));
+    EXPECT_EQ(last, total);
+    for (size_t i = 0; i < contents.size(); ++i)
+    {
+        EXPECT_FALSE(errors[i]) << i;
+        EXPECT_EQ(digests[i], digest_of(util::hash_sha256, contents[i])) << i;
+    }
+    EXPECT_TRUE(errors.back());
+    EXPECT_TRUE(digests.back().empty());
+
+    // 树摘要: 多个分块的文件为各块摘要串联后的摘要
+    options.tree_threshold = 1;
+    EXPECT_FALSE(util::files_digest(names, digests, errors, options));
+    for (size_t i = 0; i < contents.size(); ++i)
+    {
+        util::bytedata expected;
+        if (contents[i].size() <= options.chunk_size)
+            expected = digest_of(util::hash_sha256, contents[i]);
+        else
+        {
+            util::bytedata leaves;
+            for (size_t offset = 0; offset < contents[i].size(); offset += size_t(options.chunk_size))
+                leaves += digest_of(util::hash_sha256, contents[i].substr(offset, size_t(options.chunk_size)));
+            expected = digest_of(util::hash_sha256, leaves);
+        }
+
+        EXPECT_EQ(digests[i], expected) << i;
+    }
+    EXPECT_EQ(util::file_tree_digest(names[4], util::hash_sha256, options.chunk_size), digests[4]);
+
+    // 取消
+    names.pop_back();
+    EXPECT_FALSE(util::files_digest(names, digests, errors, options, [](util::fsize, util::fsize) { return false; }));
+    EXPECT_TRUE(std::any_of(errors.begin(), errors.end(), [](const util::ferror& e) { return e.code() == ECANCELED; }));
+    EXPECT_TRUE(util::file_tree_digest(names[4], util::hash_sha256, options.chunk_size, 2,
+        [](util::fsize, util::fsize) { return false; }).empty());
+
+    util::directories_remove(dir);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <common/hex.h>
+#include <common/bytedata.hpp>
+
+namespace {
+
+util::bytedata random_bytes(size_t size)
+{
+    std::mt19937 engine(static_cast<unsigned>(size));
+    util::bytedata bytes(size, 0);
+    for (size_t i = 0; i < size; ++i)
+        bytes[i] = char(engine());
+    return bytes;
+}
+
+// 逐字节的参考实现
+std::string encode_reference(const util::bytedata& bytes, const std::string& separator, size_t group, bool upper)
+{
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    std::string result;
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        if (i > 0 && i % group == 0)
+            result += separator;
+        result += digits[uint8_t(bytes[i]) >> 4];
+        result += digits[uint8_t(bytes[i]) & 0x0F];
+    }
+    return result;
+}
+
+std::string encode(const util::bytedata& bytes, const std::string& separator, size_t group, int flags)
+{
+    std::string result(util::hex_encoded_size(bytes.size(), separator.size(), group), '\0');
+    EXPECT_EQ(util::hex_encode(&result[0], bytes.data(), bytes.size(), separator, group, flags), result.size());
+    return result;
+}
+
+} // namespace
+
+TEST(common_hex, encode_decode)
+{
+    struct { const char* separator; size_t group; } formats[] = {
+        { "", 1 }, { ":", 1 }, { " ", 2 }, { "-", 4 }, { ", ", 1 }, { "\r\n", 16 },
+    };
+
+    for (size_t size = 0; size < 200; ++size)
+    {
+        util::bytedata bytes = random_bytes(size);
+        for (auto& f : formats)
+        {
+            for (int flags : { util::hex_lower, util::hex_upper })
+            {
+                std::string text = encode(bytes, f.separator, f.group, flags);
+                EXPECT_EQ(text, encode_reference(bytes, f.separator, f.group, flags == util::hex_upper)) << size;
+
+                util::bytedata decoded(size, '\0');
+                size_t decoded_size = 0;
+                EXPECT_TRUE(util::hex_decode(&decoded[0], decoded_size, text.data(), text.size(), f.separator, f.group));
+                EXPECT_EQ(decoded_size, size);
+                EXPECT_EQ(decoded, bytes);
+            }
+        }
+    }
+
+    // 兼容原有的接口, 分隔符按percount 个字节分组
+    util::bytedata bytes("\x01\x23\x45\x67\x89", 5);
+    EXPECT_EQ(util::bytes_into_hex(bytes), "0123456789");
+    EXPECT_EQ(util::bytes_into_hex(bytes, " ", 2), "0123 4567 89");
+    EXPECT_EQ(util::bytes_from_hex("0x0123456789"), bytes);
+    EXPECT_EQ(util::bytes_from_hex("01 23:45-67 89"), bytes);
+    EXPECT_EQ(util::bytes_from_hex("01234567890"), bytes);
+
+    util::bytedata large = random_bytes(100000);
+    EXPECT_EQ(util::bytes_from_hex(util::bytes_into_hex(large)), large);
+    EXPECT_EQ(util::bytes_from_hex(util::bytes_into_hex(large, ":")), large);
+}
+
+TEST(common_hex, strict_decode)
+{
+    std::string text = util::bytes_into_hex(random_bytes(1000));
+    util::bytedata out(text.size() / 2, '\0');
+    size_t size = 0, offset = 0;
+
+    // 无效的字符分别位于向量化的块内与块外
+    for (size_t position : { 0, 1, 31, 64, 127, 1000, 1999 })
+    {
+        std::string bad = text;
+        bad[position] = 'g';
+        EXPECT_FALSE(util::hex_decode(&out[0], size, bad.data(), bad.size(), &offset));
+        EXPECT_EQ(offset, position);
+        EXPECT_EQ(size, position / 2);
+    }
+
+    EXPECT_FALSE(util::hex_decode(&out[0], size, "abc", 3, &offset));
+    EXPECT_EQ(offset, 3u);
+    EXPECT_EQ(size, 1u);
+
+    EXPECT_TRUE(util::hex_decode(&out[0], size, "AbCdEf", 6));
+    EXPECT_EQ(out.substr(0, size), util::bytedata("\xab\xcd\xef", 3));
+
+    // 分隔符不匹配或位于末尾
+    EXPECT_FALSE(util::hex_decode(&out[0], size, "ab:cd;ef", 8, ":", 1, &offset));
+    EXPECT_EQ(offset, 5u);
+    EXPECT_FALSE(util::hex_decode(&out[0], size, "ab:cd:", 6, ":", 1, &offset));
+    EXPECT_EQ(offset, 6u);
+    EXPECT_FALSE(util::hex_decode(&out[0], size, "abcd:ef", 7, ":", 1, &offset));
+    EXPECT_EQ(offset, 2u);
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include <filesystem/aio.h>
+#include <filesystem/path_util.h>
+
+namespace {
+
+std::string random_bytes(size_t size)
+{
+    std::mt19937 engine(static_cast<unsigned>(size));
+    std::string bytes(size, 0);
+    for (size_t i = 0; i < size; ++i)
+        bytes[i] = char(engine());
+    return bytes;
+}
+
+void test_backend(int backend)
+{
+    util::aio   io(64, backend);
+    util::fpath name  = util::path_from_temp("utility_aio.bin");
+    std::string content = random_bytes(4096 * 256 + 100);
+
+    // 打开并分块写入, 请求数量超过队列的长度
+    auto opened = io.open(name, O_RDWR | O_CREAT | O_TRUNC);
+    io.submit();
+
+    util::ffile file = opened.get();
+    ASSERT_TRUE(file.vaild());
+
+    std::atomic<size_t> written(0);
+    for (size_t offset = 0; offset < content.size(); offset += 4096)
+    {
+        size_t size = std::min<size_t>(4096, content.size() - offset);
+        io.write(file, content.data() + offset, size, offset, [&](util::fsize result, const util::ferror& ferr) {
+            EXPECT_FALSE(ferr) << ferr.what();
+            written += size_t(result);
+        });
+    }
+
+    auto synced = io.fsync(file, true);
+    io.wait();
+    EXPECT_EQ(written, content.size());
+    EXPECT_NO_THROW(synced.get());
+
+    auto status = io.stat(name);
+    io.submit();
+    EXPECT_EQ(status.get().size, content.size());
+
+    // 读取, 其中一部分通过注册的缓冲区
+    std::string buffer(content.size(), '\0');
+    util::fiovec iov = { &buffer[0], buffer.size() };
+    io.register_buffers(&iov, 1);
+
+    std::vector<std::future<util::fsize>> reads;
+    for (size_t offset = 0; offset < content.size(); offset += 65536)
+    {
+        size_t size = std::min<size_t>(65536, content.size() - offset);
+        if ((offset / 65536) % 2)
+        {
+            io.read_fixed(file, 0, &buffer[offset], size, offset, [size](util::fsize result, const util::ferror& ferr) {
+                EXPECT_FALSE(ferr);
+                EXPECT_EQ(result, size);
+            });
+        }
+        else
+            reads.push_back(io.read(file, &buffer[offset], size, offset));
+    }
+
+    io.submit();
+    for (auto& result : reads)
+        EXPECT_GT(result.get(), 0u);
+    io.wait();
+    io.unregister_buffers();
+    EXPECT_TRUE(buffer == content);
+    EXPECT_EQ(io.pending(), 0u);
+
+    // 错误: 读取超出文件末尾, 打开不存在的文件
+    char data[16];
+    auto past_end = io.read(file, data, sizeof(data), content.size() - 8);
+    auto missing  = io.open(util::path_from_temp("utility_aio_missing/none.bin"), O_RDONLY);
+    auto stat_missing = io.stat(util::path_from_temp("utility_aio_missing/none.bin"));
+    io.submit();
+    EXPECT_THROW(past_end.get(), util::ferror);
+    EXPECT_THROW(missing.get(), util::ferror);
+    EXPECT_THROW(stat_missing.get(), util::ferror);
+
+    util::ffile invalid;
+    util::ferror ferr;
+    io.read(invalid, data, sizeof(data), 0, [&](util::fsize, const util::ferror& e) { ferr = e; });
+    io.wait();
+    EXPECT_TRUE(ferr);
+
+    file.close();
+    util::file_remove(name);
+}
+
+void read_throughput(int backend)
+{
+    util::fpath name = util::path_from_temp("utility_aio_bench.bin");
+    std::string content = random_bytes(64 << 20);
+
+    {
+        util::ffile file = util::file_open(name, O_WRONLY | O_CREAT | O_TRUNC);
+        util::file_write(file, content.data(), content.size());
+    }
+
+    const size_t block = 4096;
+    std::string buffer(content.size(), '\0');
+    util::ffile file = util::file_open(name, O_RDONLY);
+
+    {
+        util::aio io(256, backend);
+        for (size_t offset = 0; offset < content.size(); offset += block)
+            io.read(file, &buffer[offset], block, offset, [](util::fsize, const util::ferror&) {});
+        io.wait();
+    }
+    EXPECT_TRUE(buffer == content);
+
+    file.close();
+    util::file_remove(name);
+}
+
+} // namespace
+
+TEST(filesystem_aio, io_uring)
+{
+    test_backend(util::aio_io_uring);
+}
+
+TEST(filesystem_aio, thread_pool)
+{
+    test_backend(util::aio_thread_pool);
+}
+
+// 以4KB 为单位读取64MB 的文件, 默认不运行; 两个后端的耗时见gtest 的输出
+TEST(filesystem_aio, DISABLED_throughput_io_uring)
+{
+    read_throughput(util::aio_io_uring);
+}
+
+TEST(filesystem_aio, DISABLED_throughput_thread_pool)
+{
+    read_throughput(util::aio_thread_pool);
+}
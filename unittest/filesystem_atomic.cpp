@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <common/bytedata.hpp>
+#include <filesystem/file_util.h>
+#include <filesystem/path_util.h>
+
+namespace {
+
+// 目录中除指定文件外是否还有其他文件(遗留的临时文件)
+size_t count_entries(const util::fpath& dir)
+{
+    size_t count = 0;
+    for (auto& entry : util::directory_iterator(dir))
+        count += entry.is_file();
+    return count;
+}
+
+} // namespace
+
+TEST(filesystem_atomic, write_atomic)
+{
+    util::fpath dir  = util::path_from_temp("utility_atomic");
+    util::fpath name = util::path_append(dir, "data.bin");
+    util::ferror ferr;
+    util::directories_remove(dir, ferr);
+
+    util::bytes_into_file_atomic(name, "first");
+    EXPECT_EQ(util::file_size(name), 5u);
+
+    for (int policy : { int(util::fsync_none), int(util::fsync_data), int(util::fsync_full) })
+    {
+        util::bytedata content(1000 + policy, char('a' + policy));
+        util::file_write_atomic(name, content.data(), content.size(), policy);
+
+        util::bytedata bytes;
+        EXPECT_TRUE(util::bytes_from_file(bytes, name) == content);
+    }
+    EXPECT_EQ(count_entries(dir), 1u);
+
+    // 目录不存在时出错, 且不会遗留临时文件
+    util::file_write_atomic(util::path_append(dir, "missing/data.bin"), "x", 1, util::fsync_data, ferr);
+    EXPECT_TRUE(ferr);
+    EXPECT_EQ(count_entries(dir), 1u);
+
+    util::directories_remove(dir);
+}
+
+TEST(filesystem_atomic, batch)
+{
+    util::fpath dir = util::path_from_temp("utility_atomic_batch");
+    util::ferror ferr;
+    util::directories_remove(dir, ferr);
+    util::directories_create(dir);
+
+    const int count = 200;
+    auto name_of = [&](int i) { return util::path_append(dir, std::to_string(i) + ".txt"); };
+
+    // 未提交的写入不可见, 且回滚后不遗留临时文件
+    {
+        util::fatomic_batch batch;
+        batch.write(name_of(0), "rollback", 8);
+        EXPECT_EQ(batch.size(), 1u);
+        EXPECT_FALSE(util::file_exist(name_of(0)));
+    }
+    EXPECT_EQ(count_entries(dir), 0u);
+
+    util::fatomic_batch batch(util::fsync_data);
+    for (int i = 0; i < count; ++i)
+    {
+        std::string content = "content " + std::to_string(i);
+        batch.write(name_of(i), content.data(), content.size());
+    }
+    batch.commit();
+    EXPECT_EQ(batch.size(), 0u);
+    EXPECT_EQ(count_entries(dir), size_t(count));
+
+    for (int i = 0; i < count; ++i)
+    {
+        util::bytedata bytes;
+        EXPECT_EQ(util::bytes_from_file(bytes, name_of(i)), "content " + std::to_string(i));
+    }
+
+    util::directories_remove(dir);
+}
+
+// 性能测试, 默认不运行; 与batch 的耗时比较, 即为组提交相对于逐个文件同步的收益
+TEST(filesystem_atomic, DISABLED_benchmark_per_file_sync)
+{
+    util::fpath dir = util::path_from_temp("utility_atomic_single");
+    util::ferror ferr;
+    util::directories_remove(dir, ferr);
+    util::directories_create(dir);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        std::string content = "content " + std::to_string(i);
+        util::file_write_atomic(util::path_append(dir, std::to_string(i) + ".txt"), 
+            content.data(), content.size(), util::fsync_data);
+    }
+    EXPECT_EQ(count_entries(dir), 200u);
+
+    util::directories_remove(dir);
+}
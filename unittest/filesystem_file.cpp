@@ -104,6 +104,55 @@ TEST(file_util, file_copy)
     // 缺少判断空洞文件代码
 }
 
+TEST(file_util, file_copy_progress)
+{
+    util::ferror ferr;
+
+    {
+        util::ffile file = util::file_open(current_directory_temp_file, O_CREAT | O_WRONLY | O_TRUNC, ferr);
+
+        // 含空洞的文件
+        util::file_write(file, gloabl_buffer.data(), gloabl_buffer.size());
+        util::file_pwrite(file, gloabl_buffer.data(), gloabl_buffer.size(), 1024 * 1024);
+        util::file_pwrite(file, gloabl_buffer.data(), gloabl_buffer.size(), 3 * 1024 * 1024 - gloabl_buffer.size());
+    }
+
+    if (util::file_exist(current_directory_temp_file2, ferr))
+        util::file_remove(current_directory_temp_file2, ferr);
+
+    util::fsize lastCopied = 0, lastTotal = 0;
+    util::file_copy(current_directory_temp_file, current_directory_temp_file2, 
+        [&](util::fsize copied, util::fsize total) {
+            EXPECT_GE(copied, lastCopied);
+            lastCopied = copied;
+            lastTotal  = total;
+            return true;
+        }, ferr);
+    EXPECT_FALSE(ferr);
+    EXPECT_EQ   (lastCopied, lastTotal);
+    EXPECT_EQ   (3 * 1024 * 1024, lastTotal);
+
+    {
+        std::string bytes1(3 * 1024 * 1024, 0), bytes2(3 * 1024 * 1024, 1);
+        util::file_pread(util::file_open(current_directory_temp_file, O_RDONLY), &bytes1[0], bytes1.size(), 0);
+        util::file_pread(util::file_open(current_directory_temp_file2, O_RDONLY), &bytes2[0], bytes2.size(), 0);
+        EXPECT_TRUE (bytes1 == bytes2);
+    }
+
+    // 取消拷贝将删除目标文件
+    util::file_copy(current_directory_temp_file, current_directory_temp_file2, 
+        [](util::fsize, util::fsize) { return false; }, ferr);
+    EXPECT_TRUE (ferr);
+    EXPECT_FALSE(util::file_exist(current_directory_temp_file2));
+
+    // 源与目标相同
+    util::file_copy(current_directory_temp_file, current_directory_temp_file, util::fprogress(), ferr);
+    EXPECT_TRUE (ferr);
+    EXPECT_EQ   (3 * 1024 * 1024, util::file_size(current_directory_temp_file));
+
+    util::file_remove(current_directory_temp_file, ferr);
+}
+
 TEST(file_util, file_move)
 {
     util::ferror ferr;
@@ -156,7 +205,8 @@ TEST(file_util, file_time_and_set)
     EXPECT_NE(ft.create_time, -1);
     EXPECT_EQ(ft.change_time, -1);
 #else
-    EXPECT_EQ(ft.create_time, -1);
+    // Linux 中通过statx()获取创建时间, 文件系统不支持时为-1
+    EXPECT_TRUE(ft.create_time == -1 || ft.create_time > 0);
     EXPECT_NE(ft.change_time, -1);
 #endif
 
@@ -181,12 +231,75 @@ TEST(file_util, file_time_and_set)
     EXPECT_EQ(ft.create_time, ft1.create_time);
     EXPECT_EQ(ft.change_time, -1);
 #else
-    EXPECT_EQ(ft.create_time, -1);
+    // Linux 中通过statx()获取创建时间, 文件系统不支持时为-1
+    EXPECT_TRUE(ft.create_time == -1 || ft.create_time > 0);
     EXPECT_NE(ft.change_time, -1);
 #endif
     // 缺以文件描述符的时间
 }
 
+TEST(file_util, file_status)
+{
+    util::ferror ferr;
+
+    {
+        util::ffile file = util::file_open(current_directory_temp_file, O_CREAT | O_WRONLY | O_TRUNC, ferr);
+        util::file_write(file, gloabl_buffer.data(), gloabl_buffer.size());
+
+        auto status = util::file_status(file, ferr);
+        EXPECT_FALSE(ferr);
+        EXPECT_EQ   (util::entry_file, status.type);
+        EXPECT_EQ   (gloabl_buffer.size(), status.size);
+    }
+
+    auto status = util::file_status(current_directory_temp_file, true, ferr);
+    EXPECT_FALSE(ferr);
+    EXPECT_EQ   (util::entry_file, status.type);
+    EXPECT_EQ   (gloabl_buffer.size(), status.size);
+    EXPECT_EQ   (util::file_size(current_directory_temp_file), status.size);
+    EXPECT_EQ   (util::file_time(current_directory_temp_file).modify_time, status.time.modify_time);
+    EXPECT_NE   (0, status.inode);
+    EXPECT_EQ   (1, status.nlink);
+
+    auto inode = status.inode;
+
+    status = util::file_status(exist_directory, true, ferr);
+    EXPECT_FALSE(ferr);
+    EXPECT_EQ   (util::entry_directory, status.type);
+
+    status = util::file_status("./none", true, ferr);
+    EXPECT_TRUE (ferr);
+
+    // 批量获取, 失败项不影响其余项
+    std::vector<util::fpath>   names;
+    std::vector<util::fstatus> results;
+    std::vector<int>           errors;
+
+    for (int i = 0; i < 200; ++i)
+        names.push_back(i % 50 == 49 ? "none" : current_directory_temp_file);
+
+    util::file_status_batch(".", names, results, errors, 4, ferr);
+    EXPECT_TRUE (ferr);
+    ASSERT_EQ   (names.size(), results.size());
+    ASSERT_EQ   (names.size(), errors.size());
+
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (i % 50 == 49)
+        {
+            EXPECT_NE(0, errors[i]);
+        }
+        else
+        {
+            EXPECT_EQ(0, errors[i]);
+            EXPECT_EQ(inode, results[i].inode);
+            EXPECT_EQ(gloabl_buffer.size(), results[i].size);
+        }
+    }
+
+    util::file_remove(current_directory_temp_file, ferr);
+}
+
 // file_open 只读模式
 TEST(file_util, file_open_reonly_and_creat)
 {
@@ -441,48 +554,242 @@ TEST(file_util, directories_create_and_remove)
     //util::directories_remove("………………………………..", ferr);
     //EXPECT_FALSE(ferr);
 }
-#endif
 
-TEST(file_util, directory_authorization)
+TEST(file_util, directories_remove_concurrency)
 {
     util::ferror ferr;
-    util::fpath  file = util::path_append(util::path_from_sysdir(CSIDL_COMMON_APPDATA), L"TestDir");
-    util::directories_create(file, ferr);
-    EXPECT_FALSE(ferr);
 
-    util::win::directory_authorization(file, ferr);
-    EXPECT_FALSE(ferr);
+    // 较宽的目录树, 包含隐藏文件与符号链接
+    for (int i = 0; i < 16; ++i)
+    {
+        std::string child = "./parent/child" + std::to_string(i);
+        util::directories_create(child + "/grandson", ferr);
+        EXPECT_FALSE(ferr);
 
-    util::directories_remove(file, ferr);
-    EXPECT_FALSE(ferr);
-}
+        for (int j = 0; j < 16; ++j)
+            util::file_open(child + "/file" + std::to_string(j), O_CREAT, ferr);
 
+        util::file_open(child + "/grandson/.hidden", O_CREAT, ferr);
+        EXPECT_FALSE(ferr);
+    }
 
+#if OS_POSIX
+    // 不跟随符号链接, 只删除链接自身
+    util::directories_create("./outside", ferr);
+    util::file_open("./outside/file", O_CREAT, ferr);
+    EXPECT_EQ   (0, ::symlink("../outside", "./parent/link"));
+#endif
 
+    auto failed = util::directories_remove("./parent", 0, ferr);
+    EXPECT_FALSE(ferr);
+    EXPECT_TRUE (failed.empty());
+    EXPECT_FALSE(util::file_exist("./parent"));
 
+#if OS_POSIX
+    EXPECT_TRUE (util::file_exist("./outside/file"));
+    util::directories_remove("./outside", ferr);
+    EXPECT_FALSE(ferr);
+#endif
+
+    // 不存在的目录不视为错误
+    failed = util::directories_remove("./parent", 4, ferr);
+    EXPECT_FALSE(ferr);
+    EXPECT_TRUE (failed.empty());
+}
 
+TEST(file_util, directory_iterator)
+{
+    util::ferror ferr;
+    util::directories_remove("./walk", ferr);
 
+    util::directories_create("./walk/a/b", ferr);
+    util::directories_create("./walk/.hidden", ferr);
+    util::file_open("./walk/a/b/c.txt", O_CREAT, ferr);
+    util::file_open("./walk/a/d.log", O_CREAT, ferr);
+    util::file_open("./walk/.hidden/e.txt", O_CREAT, ferr);
+    {
+        util::ffile file = util::file_open("./walk/f.txt", O_CREAT | O_WRONLY, ferr);
+        util::file_write(file, gloabl_buffer.data(), gloabl_buffer.size());
+    }
 
+    int links = 0;
+#if OS_POSIX
+    // 不会进入指向目录的符号链接
+    EXPECT_EQ   (0, ::symlink("a", "./walk/link"));
+    links = 1;
+#endif
 
+    auto count = [](const util::fwalk_options& options) {
+        int result = 0;
+        for (auto& entry : util::directory_iterator("./walk", options))
+        {
+            EXPECT_EQ(entry.path(), "./walk/" + std::string(entry.path().c_str() + 7));
+            ++result;
+        }
+        return result;
+    };
+
+    EXPECT_EQ   (3 + links, count(util::fwalk_options()));
+    EXPECT_EQ   (7 + links, count(util::fwalk_options(util::walk_recursive)));
+    EXPECT_EQ   (6 + links, count(util::fwalk_options(util::walk_recursive, 1)));
+    EXPECT_EQ   (5 + links, count(util::fwalk_options(util::walk_recursive | util::walk_skip_hidden)));
+
+    util::fwalk_options options(util::walk_recursive | util::walk_files_only);
+    options.extensions.push_back("txt");
+    EXPECT_EQ   (3, count(options));
+
+    // 类型与惰性获取的文件信息
+    for (util::directory_iterator iter("./walk", util::fwalk_options(util::walk_recursive), ferr); iter; iter.next(ferr))
+    {
+        EXPECT_FALSE(ferr);
+
+        std::string name = iter->name();
+        if (name == "f.txt")
+        {
+            EXPECT_TRUE (iter->is_file());
+            EXPECT_EQ   (gloabl_buffer.size(), iter->size());
+            EXPECT_LT   (0, iter->time().modify_time);
+        }
+        else if (name == "a" || name == "b" || name == ".hidden")
+        {
+            EXPECT_TRUE (iter->is_directory());
+        }
+        else if (name == "link")
+        {
+            EXPECT_TRUE (iter->is_symlink());
+        }
+
+        // 不进入a目录
+        if (name == "a")
+            iter.skip();
+        else
+            EXPECT_EQ   (name != "c.txt" && name != "e.txt" ? 0 : 1, iter->depth());
+    }
 
+    // 提前停止遍历
+    int visited = 0;
+    util::directory_walk("./walk", [&](const util::directory_entry&) { return ++visited < 2; }, 
+        util::fwalk_options(util::walk_recursive), ferr);
+    EXPECT_FALSE(ferr);
+    EXPECT_EQ   (2, visited);
 
+    // 不存在的目录
+    util::directory_iterator iter("./walk/none", util::fwalk_options(), ferr);
+    EXPECT_TRUE (ferr);
+    EXPECT_FALSE(iter.vaild());
+    EXPECT_TRUE (iter == util::directory_iterator());
 
+    util::directories_remove("./walk", ferr);
+    EXPECT_FALSE(ferr);
+}
 
+TEST(file_util, file_map)
+{
+    util::ferror ferr;
+    util::ffile  file = util::file_open(current_directory_temp_file, O_RDWR | O_CREAT | O_TRUNC, ferr);
+    EXPECT_FALSE(ferr);
 
+    // 空文件返回空视图
+    util::fmapping view = util::file_map(file, util::map_read, 0, -1, ferr);
+    EXPECT_FALSE(ferr);
+    EXPECT_FALSE(view.vaild());
+    EXPECT_EQ   (0, view.size());
 
+    std::string wbuff(100000, 0);
+    for (size_t i = 0; i < wbuff.size(); ++i)
+        wbuff[i] = static_cast<char>(i % 251);
 
+    util::file_write(file, wbuff.data(), wbuff.size(), ferr);
+    EXPECT_FALSE(ferr);
 
+    // 映射整个文件
+    view = util::file_map(file, util::map_read, 0, -1, ferr);
+    EXPECT_FALSE(ferr);
+    EXPECT_TRUE (view.vaild());
+    EXPECT_EQ   (wbuff.size(), view.size());
+    EXPECT_EQ   (wbuff, std::string(view.begin(), view.end()));
 
+    util::file_map_advise(view, util::advise_sequential | util::advise_willneed, ferr);
+    EXPECT_FALSE(ferr);
 
+    // 映射未对齐的范围
+    view = util::file_map(file, util::map_read, 12345, 5000, ferr);
+    EXPECT_FALSE(ferr);
+    EXPECT_EQ   (12345, view.offset());
+    EXPECT_EQ   (wbuff.substr(12345, 5000), std::string(view.data(), view.size()));
 
+    // 超出文件末尾
+    view = util::file_map(file, util::map_read, wbuff.size() - 10, 11, ferr);
+    EXPECT_TRUE (ferr);
+    EXPECT_FALSE(view.vaild());
 
+    // 读写映射, 修改写回文件
+    view = util::file_map(file, util::map_write, 4097, 3, ferr);
+    EXPECT_FALSE(ferr);
+    memcpy(view.data(), "abc", 3);
+    util::file_map_flush(view, true, ferr);
+    EXPECT_FALSE(ferr);
 
+    std::string rbuff(3, 0);
+    util::file_seek(file, 4097, SEEK_SET, ferr);
+    util::file_read(file, &rbuff[0], rbuff.size(), ferr);
+    EXPECT_FALSE(ferr);
+    EXPECT_EQ   ("abc", rbuff);
+}
 
+TEST(file_util, file_pread_and_pwrite)
+{
+    util::ferror ferr;
+    util::ffile  file = util::file_open(current_directory_temp_file, O_RDWR | O_CREAT | O_TRUNC, ferr);
+    EXPECT_FALSE(ferr);
 
+    // 写入指定位置, 不影响文件指针
+    EXPECT_EQ   (gloabl_buffer.size(), util::file_pwrite(file, gloabl_buffer.data(), gloabl_buffer.size(), 100, ferr));
+    EXPECT_FALSE(ferr);
+    EXPECT_EQ   (100 + gloabl_buffer.size(), util::file_size(file, ferr));
 
+    std::string rbuff(gloabl_buffer.size(), 0);
+    EXPECT_EQ   (rbuff.size(), util::file_pread(file, &rbuff[0], rbuff.size(), 100, ferr));
+    EXPECT_FALSE(ferr);
+    EXPECT_EQ   (gloabl_buffer, rbuff);
 
+    // 读取超出文件末尾, 返回实际读取的长度
+    EXPECT_EQ   (4, util::file_pread(file, &rbuff[0], rbuff.size(), 100 + gloabl_buffer.size() - 4, ferr));
+    EXPECT_TRUE (ferr);
 
+    // 聚集写, 分散读
+    std::string head = "HEAD", body = "payload";
+    util::fiovec wvec[] = {
+        { &head[0], head.size() },
+        { &body[0], body.size() },
+    };
+    EXPECT_EQ   (head.size() + body.size(), util::file_writev(file, wvec, 2, 0, ferr));
+    EXPECT_FALSE(ferr);
 
+    std::string rhead(head.size(), 0), rbody(body.size(), 0);
+    util::fiovec rvec[] = {
+        { &rhead[0], rhead.size() },
+        { &rbody[0], rbody.size() },
+    };
+    EXPECT_EQ   (head.size() + body.size(), util::file_readv(file, rvec, 2, 0, ferr));
+    EXPECT_FALSE(ferr);
+    EXPECT_EQ   (head, rhead);
+    EXPECT_EQ   (body, rbody);
+}
+#endif
 
+#if OS_WIN
+TEST(file_util, directory_authorization)
+{
+    util::ferror ferr;
+    util::fpath  file = util::path_append(util::path_from_sysdir(CSIDL_COMMON_APPDATA), L"TestDir");
+    util::directories_create(file, ferr);
+    EXPECT_FALSE(ferr);
 
+    util::win::directory_authorization(file, ferr);
+    EXPECT_FALSE(ferr);
 
+    util::directories_remove(file, ferr);
+    EXPECT_FALSE(ferr);
+}
+#endif
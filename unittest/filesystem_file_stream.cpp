@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <filesystem/file_stream.h>
+#include <filesystem/path_util.h>
+
+TEST(filesystem_file_stream, read_write)
+{
+    util::fpath name = util::path_from_temp("utility_file_stream.txt");
+    std::string expected;
+
+    {
+        util::ffile file = util::file_open(name, O_WRONLY | O_CREAT | O_TRUNC);
+        util::fstream_writer writer(file, 100); // 调整为4096
+
+        for (int i = 0; i < 10000; ++i)
+        {
+            std::string line = "line " + std::to_string(i);
+            if (i % 1000 == 999)
+                line += std::string(10000, 'x'); // 超过缓冲区的行
+            if (i % 7 == 0)
+                line += '\r';
+
+            writer.write_line(line);
+            expected += line + "\n";
+        }
+
+        writer.put('e');
+        writer.write("nd", 2);
+        expected += "end";
+
+        EXPECT_EQ(writer.position(), expected.size());
+        writer.flush();
+    }
+    EXPECT_EQ(util::file_size(name), expected.size());
+
+    util::ffile file = util::file_open(name, O_RDONLY);
+    util::fstream_reader reader(file, 4096);
+
+    EXPECT_EQ(reader.peek(), 'l');
+    EXPECT_EQ(reader.peek(6), "line 0");
+
+    std::string_view line;
+    for (int i = 0; i < 10000; ++i)
+    {
+        ASSERT_TRUE(reader.read_line(line));
+
+        std::string text = "line " + std::to_string(i);
+        if (i % 1000 == 999)
+            text += std::string(10000, 'x');
+        EXPECT_EQ(line, text);
+    }
+
+    EXPECT_TRUE(reader.read_line(line));
+    EXPECT_EQ(line, "end");
+    EXPECT_FALSE(reader.read_line(line));
+    EXPECT_TRUE(reader.eof());
+    EXPECT_EQ(reader.peek(), -1);
+
+    // 随机位置的块读取, 包括绕过缓冲区的大块
+    for (size_t offset : { size_t(0), size_t(5), size_t(9000), expected.size() - 100 })
+    {
+        for (size_t size : { size_t(1), size_t(100), size_t(5000), size_t(60000) })
+        {
+            reader.seek(offset);
+
+            std::string buffer(size, '\0');
+            size_t count = reader.read(&buffer[0], size);
+            buffer.resize(count);
+            EXPECT_EQ(buffer, expected.substr(offset, size));
+            EXPECT_EQ(reader.position(), offset + count);
+        }
+    }
+
+    reader.seek(0);
+    reader.skip(10000);
+    EXPECT_EQ(reader.position(), 10000u);
+    EXPECT_EQ(reader.peek(3), expected.substr(10000, 3));
+
+    file.close();
+    util::file_remove(name);
+}
+
+// 写入并逐行读取一百万行, 默认不运行; 对比标准库与fstream_writer/fstream_reader 的耗时
+TEST(filesystem_file_stream, DISABLED_benchmark_std_fstream)
+{
+    util::fpath name  = util::path_from_temp("utility_file_stream_bench.csv");
+    const int   count = 1000000;
+    std::string line  = "12345,abcdefgh,3.1415926,some text in the record";
+
+    {
+        std::ofstream stream(name.c_str(), std::ios::binary);
+        for (int i = 0; i < count; ++i)
+            stream << line << '\n';
+    }
+
+    size_t total = 0;
+    {
+        std::ifstream stream(name.c_str(), std::ios::binary);
+        std::string text;
+        while (std::getline(stream, text))
+            total += text.size();
+    }
+    EXPECT_EQ(total, line.size() * count);
+
+    util::file_remove(name);
+}
+
+TEST(filesystem_file_stream, DISABLED_benchmark_file_stream)
+{
+    util::fpath name  = util::path_from_temp("utility_file_stream_bench.csv");
+    const int   count = 1000000;
+    std::string line  = "12345,abcdefgh,3.1415926,some text in the record";
+
+    {
+        util::ffile file = util::file_open(name, O_WRONLY | O_CREAT | O_TRUNC);
+        util::fstream_writer writer(file);
+        for (int i = 0; i < count; ++i)
+            writer.write_line(line);
+    }
+
+    size_t total = 0;
+    {
+        util::ffile file = util::file_open(name, O_RDONLY);
+        util::fstream_reader reader(file);
+        std::string_view text;
+        while (reader.read_line(text))
+            total += text.size();
+    }
+    EXPECT_EQ(total, line.size() * count);
+
+    util::file_remove(name);
+}
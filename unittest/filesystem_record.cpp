@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include <numeric>
+#include <filesystem/record_scanner.h>
+#include <filesystem/file_stream.h>
+#include <filesystem/path_util.h>
+
+namespace {
+
+// 逐字节切分的参考实现
+std::vector<std::string> split_naive(const std::string& data, char delim)
+{
+    std::vector<std::string> records;
+    size_t begin = 0;
+    while (begin < data.size())
+    {
+        size_t end = data.find(delim, begin);
+        if (end == std::string::npos)
+            end = data.size();
+
+        std::string record = data.substr(begin, end - begin);
+        if (delim == '\n' && !record.empty() && record.back() == '\r')
+            record.pop_back();
+
+        records.push_back(record);
+        begin = end + 1;
+    }
+    return records;
+}
+
+std::string random_records(std::mt19937& random, size_t count, char delim)
+{
+    std::string data;
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t length = random() % 8 == 0 ? random() % 300 : random() % 20;
+        for (size_t j = 0; j < length; ++j)
+            data += char('a' + random() % 26);
+        if (random() % 5 == 0)
+            data += '\r';
+        if (i + 1 < count || random() % 2 == 0)
+            data += delim;
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(filesystem_record, scanner)
+{
+    std::mt19937 random(2023);
+
+    for (char delim : { '\n', ',', '\0' })
+    {
+        for (size_t count : { 0, 1, 2, 7, 64, 1000 })
+        {
+            std::string data = random_records(random, count, delim);
+            std::vector<std::string> expected = split_naive(data, delim);
+
+            util::record_scanner scanner(data, delim);
+            std::vector<std::string> records;
+            for (std::string_view record; scanner.next(record); )
+            {
+                EXPECT_GE(record.data(), data.data());  // 指向原数据
+                records.emplace_back(record);
+            }
+
+            EXPECT_EQ(records, expected);
+            EXPECT_TRUE(scanner.eof());
+            EXPECT_EQ(scanner.position(), data.size());
+            EXPECT_EQ(util::record_count(data, delim), size_t(std::count(data.begin(), data.end(), delim)));
+
+            const char* found = util::record_find(data.data(), data.data() + data.size(), delim);
+            EXPECT_EQ(size_t(found - data.data()), std::min(data.find(delim), data.size()));
+        }
+    }
+
+    std::string text = "a\r\n\r\nbc\n";
+    std::vector<std::string_view> lines;
+    util::record_scanner(text).for_each([&](std::string_view line) { lines.push_back(line); });
+    EXPECT_EQ(lines, std::vector<std::string_view>({ "a", "", "bc" }));
+}
+
+TEST(filesystem_record, split)
+{
+    std::mt19937 random(7);
+    std::string data = random_records(random, 10000, '\n');
+
+    for (size_t parts : { 1, 2, 3, 8, 64, 100000 })
+    {
+        std::vector<std::string_view> ranges = util::record_split(data, parts);
+        EXPECT_LE(ranges.size(), parts);
+
+        std::string joined;
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            EXPECT_FALSE(ranges[i].empty());
+            if (i + 1 < ranges.size())
+            {
+                EXPECT_EQ(ranges[i].back(), '\n');
+            }
+            joined.append(ranges[i].data(), ranges[i].size());
+        }
+        EXPECT_EQ(joined, data);
+    }
+
+    EXPECT_TRUE(util::record_split(std::string_view(), 4).empty());
+    EXPECT_EQ(util::record_split("abc", 4).size(), 1u);
+}
+
+TEST(filesystem_record, file)
+{
+    util::fpath name = util::path_from_temp("utility_record_scanner.csv");
+
+    std::mt19937 random(42);
+    std::string data = random_records(random, 200000, '\n');
+    util::file_write_atomic(name, data.data(), data.size(), util::fsync_none);
+
+    std::vector<std::string> expected = split_naive(data, '\n');
+
+    // 映射整个文件, 分为多个范围并行统计
+    util::fmapping mapping = util::record_map(name);
+    ASSERT_EQ(mapping.size(), data.size());
+
+    std::vector<std::string_view> ranges = util::record_split(std::string_view(mapping.data(), size_t(mapping.size())), 4);
+    std::vector<size_t> counts(ranges.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < ranges.size(); ++i)
+        threads.emplace_back([&, i]() { counts[i] = util::record_scanner(ranges[i]).for_each([](std::string_view) {}); });
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(std::accumulate(counts.begin(), counts.end(), size_t(0)), expected.size());
+
+    // 缓冲读取
+    util::ffile file = util::file_open(name, O_RDONLY);
+    util::fstream_reader reader(file, 4096);
+    size_t index = 0;
+    for (std::string_view line; reader.read_line(line); ++index)
+    {
+        ASSERT_LT(index, expected.size());
+        EXPECT_EQ(line, expected[index]);
+    }
+    EXPECT_EQ(index, expected.size());
+
+    reader.seek(0);
+    std::string_view record;
+    EXPECT_TRUE(reader.read_record(record, 'a'));
+    EXPECT_EQ(record, data.substr(0, data.find('a')));
+
+    file.close();
+    mapping.close();
+
+    // 单线程切分整个文件
+    mapping = util::record_map(name);
+    size_t total = 0;
+    util::record_scanner(mapping).for_each([&](std::string_view line) { total += line.size(); });
+
+    size_t expected_total = 0;
+    for (auto& line : expected)
+        expected_total += line.size();
+    EXPECT_EQ(total, expected_total);
+
+    mapping.close();
+    util::file_remove(name);
+}
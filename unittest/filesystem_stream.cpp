@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <common/bytedata.hpp>
+#include <filesystem/file_util.h>
+#include <filesystem/path_util.h>
+
+namespace {
+
+util::bytedata random_bytes(size_t size)
+{
+    std::mt19937 engine(static_cast<unsigned>(size));
+    util::bytedata bytes(size, 0);
+    for (size_t i = 0; i < size; ++i)
+        bytes[i] = char(engine());
+    return bytes;
+}
+
+} // namespace
+
+TEST(filesystem_stream, read_write)
+{
+    // 跨越多个4MB的块, 且长度与偏移量均不对齐
+    util::bytedata content = random_bytes(0x400000 * 2 + 12345);
+    util::fpath    name    = util::path_from_temp("utility_stream.bin");
+
+    for (int flags : { int(util::fstream_default), int(util::fstream_nocache), int(util::fstream_direct) })
+    {
+        // 每次只提供少量数据的source
+        size_t position = 0;
+        util::fsize written = util::bytes_into_file(name, [&](void* buffer, size_t size) {
+            size = std::min<size_t>({ size, 100000, content.size() - position });
+            std::memcpy(buffer, content.data() + position, size);
+            position += size;
+            return size;
+        }, flags);
+        EXPECT_EQ(written, content.size());
+        EXPECT_EQ(util::file_size(name), content.size());
+
+        struct { util::fsize offset; util::fsize length; } ranges[] = {
+            { 0, util::fsize(-1) }, { 1, util::fsize(-1) }, { 4097, 0x400000 }, { content.size() - 10, 10 }, { 0, 0 },
+        };
+
+        for (auto& range : ranges)
+        {
+            util::bytedata streamed;
+            util::fsize size = util::bytes_from_file(name, [&](util::bytes_view chunk) {
+                streamed.append(chunk.chars(), chunk.size());
+                return true;
+            }, range.offset, range.length, flags);
+
+            util::bytedata expected = content.substr(size_t(range.offset), size_t(range.length));
+            EXPECT_EQ(size, expected.size());
+            EXPECT_TRUE(streamed == expected) << flags << " " << range.offset;
+
+            util::bytedata bytes;
+            EXPECT_TRUE(util::bytes_from_file(bytes, name, range.offset, range.length, flags) == expected);
+        }
+
+        // sink 返回false时停止
+        int chunks = 0;
+        EXPECT_EQ(util::bytes_from_file(name, [&](util::bytes_view) { return ++chunks < 2; }), 0x400000u * 2);
+        EXPECT_EQ(chunks, 2);
+    }
+
+    // 长度超出文件末尾
+    util::ferror ferr;
+    util::file_read_stream(name, [](const void*, size_t) { return true; }, 10, content.size(), 0, ferr);
+    EXPECT_TRUE(ferr);
+
+    util::bytedata bytes;
+    EXPECT_THROW(util::bytes_from_file(bytes, name, content.size() + 1), std::runtime_error);
+
+    // 64位长度的file_read()/file_write()
+    util::ffile file = util::file_open(name, O_RDWR | O_TRUNC);
+    util::file_write(file, content.data(), util::fsize(content.size()));
+    util::file_seek(file, 0);
+
+    bytes.assign(content.size(), '\0');
+    util::file_read(file, &bytes[0], util::fsize(bytes.size()));
+    EXPECT_TRUE(bytes == content);
+
+    util::file_read(file, &bytes[0], 1, ferr);
+    EXPECT_TRUE(ferr);
+
+    file.close();
+    util::file_remove(name);
+}
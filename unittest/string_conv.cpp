@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <string/string_conv.h>
+#include <string/impl/string_conv_utf.hpp>
+
+#if OS_POSIX
+#   include <string/impl/string_conv_iconv.hpp>
+#endif
+
+using namespace util;
+using namespace util::conv;
+
+namespace {
+
+// 随机的码点, 包括ASCII, 双字节, 三字节与四字节的UTF-8
+std::u32string random_text(std::mt19937& engine, size_t size, int ascii_percent)
+{
+    std::uniform_int_distribution<int>      percent(0, 99);
+    std::uniform_int_distribution<uint32_t> ascii(0x01, 0x7F);
+    std::uniform_int_distribution<uint32_t> other(0x80, 0x10FFFF);
+
+    std::u32string text;
+    while (text.size() < size)
+    {
+        uint32_t code = percent(engine) < ascii_percent ? ascii(engine) : other(engine);
+        if (code >= 0xD800 && code <= 0xDFFF)
+            continue;
+        text.push_back(code);
+    }
+
+    return text;
+}
+
+std::string encode_utf8(const std::u32string& text)
+{
+    std::string utf8;
+    for (char32_t code : text)
+    {
+        char buffer[4];
+        utf8.append(buffer, conv::detail::_utf8_encode(code, buffer));
+    }
+
+    return utf8;
+}
+
+template<class _Wide>
+std::basic_string<_Wide> to_wide(const std::string& utf8, bool lossy = true)
+{
+    std::basic_string<_Wide> wide(utf8.size(), 0);
+    size_t size = conv::detail::utf8_to_wide(utf8.data(), utf8.size(), &wide[0], lossy);
+
+    wide.resize(size == std::string::npos ? 0 : size);
+    return wide;
+}
+
+template<class _Wide>
+std::string to_utf8(const std::basic_string<_Wide>& wide, bool lossy = true)
+{
+    std::string utf8(conv::detail::wide_to_utf8_length(wide.data(), wide.size()), 0);
+    size_t size = conv::detail::wide_to_utf8(wide.data(), wide.size(), &utf8[0], lossy);
+
+    utf8.resize(size == std::string::npos ? 0 : size);
+    return utf8;
+}
+
+// 接近实际的中英文混合文本
+std::string mixed_text(size_t size)
+{
+    std::string text;
+    while (text.size() < size)
+        text += u8"路径 /home/user/文档/报告-2023.txt 已保存, 共 42 个文件; The quick brown fox 跳过了懒狗. ";
+    return text;
+}
+
+// 各1MB 的纯ASCII 与混合文本
+std::vector<std::string> benchmark_inputs()
+{
+    std::mt19937 engine(1);
+    return { encode_utf8(random_text(engine, 1 << 20, 100)), mixed_text(1 << 20) };
+}
+
+} // namespace
+
+TEST(string_conv, utf8_wstring)
+{
+    std::wstring wide;
+    std::string  utf8;
+
+    EXPECT_EQ(utf8_to_wstring("", wide), L"");
+    EXPECT_EQ(wstring_to_utf8(L"", utf8), "");
+    EXPECT_EQ(utf8_to_wstring("Hello World!", wide), L"Hello World!");
+    EXPECT_EQ(utf8_to_wstring(u8"我们的征程是星辰大海~~~", wide), L"我们的征程是星辰大海~~~");
+    EXPECT_EQ(wstring_to_utf8(L"我们的征程是星辰大海~~~", utf8), u8"我们的征程是星辰大海~~~");
+    EXPECT_EQ(wstring_to_utf8(std::wstring(L"a\0b", 3), utf8), std::string("a\0b", 3));
+
+    std::string emoji = u8"long ascii prefix......\U0001F600 and more ascii after it";
+    EXPECT_EQ(wstring_to_utf8(utf8_to_wstring(emoji, wide), utf8), emoji);
+
+#if OS_POSIX
+    EXPECT_THROW(utf8_to_wstring("abc\xC3", wide), std::runtime_error);
+    EXPECT_THROW(utf8_to_wstring("\xED\xA0\x80", wide), std::runtime_error);
+    EXPECT_THROW(wstring_to_utf8(std::wstring(1, wchar_t(0x110000)), utf8), std::runtime_error);
+#endif
+}
+
+TEST(string_conv, utf_roundtrip)
+{
+    std::mt19937 engine(2023);
+
+    for (int percent : { 100, 90, 50, 0 })
+    {
+        for (size_t size : { 1, 15, 16, 17, 33, 100, 1000 })
+        {
+            std::u32string text = random_text(engine, size, percent);
+            std::string    utf8 = encode_utf8(text);
+
+            std::u32string utf32 = to_wide<char32_t>(utf8, false);
+            EXPECT_EQ(utf32, text);
+            EXPECT_EQ(to_utf8(utf32, false), utf8);
+
+            std::u16string utf16 = to_wide<char16_t>(utf8, false);
+            EXPECT_EQ(utf16.size(), text.size() + std::count_if(text.begin(), text.end(), [](char32_t c) { return c >= 0x10000; }));
+            EXPECT_EQ(to_utf8(utf16, false), utf8);
+
+#if OS_POSIX
+            std::wstring expect;
+            convert_with_iconv(utf8, expect, "UTF-8", "WCHAR_T");
+
+            std::wstring actual;
+            EXPECT_EQ(utf8_to_wstring(utf8, actual), expect);
+#endif
+        }
+    }
+}
+
+TEST(string_conv, utf_replacement)
+{
+    // 每个无效的最长子序列替换为一个U+FFFD
+    EXPECT_EQ(to_wide<char32_t>("a\xC3(b"), U"a�(b");
+    EXPECT_EQ(to_wide<char32_t>("\xF0\x9F\x98"), U"�");
+    EXPECT_EQ(to_wide<char32_t>("\xED\xA0\x80"), U"���");
+    EXPECT_EQ(to_wide<char32_t>("\xC0\xAF"), U"��");
+    EXPECT_EQ(to_wide<char32_t>("\xF4\x90\x80\x80"), U"����");
+    EXPECT_EQ(to_wide<char32_t>("0123456789abcdef\x80z"), U"0123456789abcdef�z");
+    EXPECT_EQ(to_wide<char32_t>("\x80", false), U"");
+
+    EXPECT_EQ(to_utf8(std::u16string(u"a\xD800" u"b")), u8"a�b");
+    EXPECT_EQ(to_utf8(std::u16string(1, char16_t(0xDC00))), u8"�");
+    EXPECT_EQ(to_utf8(std::u32string(1, char32_t(0x110000))), u8"�");
+}
+
+TEST(string_conv, utf8_validate)
+{
+    const char* invalid[] = {
+        "\x80", "\xC3", "\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80", "\xF0\x8F\xBF\xBF",
+        "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xFF", "\xE4\xB8", "\xF0\x9F\x98", "\xE4\xB8\xAD\x80",
+    };
+
+    // 无效的序列出现在块内, 跨越块的边界, 以及在最后的不完整的块中
+    for (const char* bad : invalid)
+    {
+        for (size_t offset : { 0, 13, 14, 15, 16, 31, 40 })
+        {
+            std::string text = std::string(offset, 'a') + bad + std::string(5, 'b');
+            EXPECT_FALSE(utf8_is_valid(text)) << offset;
+            EXPECT_FALSE(utf8_is_valid(std::string(offset, 'a') + bad)) << offset;
+
+            std::u32string expect = to_wide<char32_t>(text);
+            EXPECT_EQ(utf8_invalid_count(text), size_t(std::count(expect.begin(), expect.end(), char32_t(detail::utf_replacement))));
+        }
+    }
+
+    std::mt19937 engine(2023);
+    std::uniform_int_distribution<size_t> position(0, 999);
+    std::uniform_int_distribution<int>    byte(0x80, 0xFF);
+
+    for (int percent : { 100, 90, 50, 0 })
+    {
+        std::string utf8 = encode_utf8(random_text(engine, 1000, percent));
+        EXPECT_TRUE(utf8_is_valid(utf8));
+        EXPECT_TRUE(detail::_utf8_invalid_scalar((const unsigned char*)utf8.data(), (const unsigned char*)utf8.data() + utf8.size(), true) == 0);
+        EXPECT_EQ(utf8_invalid_count(utf8), 0u);
+
+        // 随机地破坏一个字节, 与逐个字符解码的结果比较
+        for (int i = 0; i < 200; ++i)
+        {
+            std::string broken = utf8;
+            broken[position(engine) % broken.size()] = char(byte(engine));
+
+            std::u32string expect = to_wide<char32_t>(broken);
+            size_t count = std::count(expect.begin(), expect.end(), char32_t(detail::utf_replacement));
+
+            EXPECT_EQ(utf8_is_valid(broken), count == 0);
+            EXPECT_EQ(utf8_invalid_count(broken), count);
+        }
+    }
+
+    EXPECT_TRUE(utf8_is_valid(""));
+    EXPECT_TRUE(utf8_is_valid(std::string("a\0b", 3)));
+}
+
+TEST(string_conv, utf8_sanitize)
+{
+    std::string  output;
+    std::wstring wide;
+
+    EXPECT_EQ(utf8_sanitize("", output), "");
+    EXPECT_EQ(utf8_sanitize(u8"有效的UTF-8", output), u8"有效的UTF-8");
+    EXPECT_EQ(utf8_sanitize("a\xC3(b", output), u8"a\uFFFD(b");
+    EXPECT_EQ(utf8_sanitize("\xED\xA0\x80z", output), u8"\uFFFD\uFFFD\uFFFDz");
+    EXPECT_EQ(utf8_sanitize("0123456789abcdef\xF0\x9F\x98", output), u8"0123456789abcdef\uFFFD");
+
+    // 与转换为宽字符时的替换相同
+    std::string broken = "head \xF4\x90\x80\x80 \xE4\xB8 tail \xC0";
+    utf8_sanitize(broken, output);
+    EXPECT_TRUE(utf8_is_valid(output));
+    EXPECT_EQ(output, wstring_to_utf8(utf8_to_wstring(broken, wide, utf_replace), output));
+    EXPECT_FLOAT_EQ(wstring_replacement_character_persents(wide), 100.0f * utf8_invalid_count(broken) / wide.size());
+
+    EXPECT_EQ(wstring_replacement_character_persents(L""), 0.0f);
+    EXPECT_THROW(utf8_to_wstring(broken, wide, utf_strict), std::runtime_error);
+    EXPECT_THROW(wstring_to_utf8(std::wstring(1, wchar_t(0xDC00)), output, utf_strict), std::runtime_error);
+}
+
+// 往返转换十次, 默认不运行; 对比直接转换与iconv 的耗时
+TEST(string_conv, DISABLED_benchmark_native)
+{
+    for (const std::string& input : benchmark_inputs())
+    {
+        std::wstring wide;
+        std::string  utf8;
+        for (int i = 0; i < 10; ++i)
+            wstring_to_utf8(utf8_to_wstring(input, wide), utf8);
+
+        EXPECT_EQ(utf8, input);
+    }
+}
+
+#if OS_POSIX
+TEST(string_conv, DISABLED_benchmark_iconv)
+{
+    for (const std::string& input : benchmark_inputs())
+    {
+        std::wstring wide;
+        std::string  utf8;
+        for (int i = 0; i < 10; ++i)
+        {
+            convert_with_iconv(input, wide, "UTF-8", "WCHAR_T");
+            convert_with_iconv(wide, utf8, "WCHAR_T", "UTF-8");
+        }
+
+        EXPECT_EQ(utf8, input);
+    }
+}
+#endif
+
+// 验证4MB 的混合文本十次, 默认不运行; 对比SSSE3 与逐个字符验证的耗时
+TEST(string_conv, DISABLED_benchmark_validate)
+{
+    std::string text = mixed_text(1 << 22);
+
+    size_t valid = 0;
+    for (int i = 0; i < 10; ++i)
+        valid += utf8_is_valid(text);
+
+    EXPECT_EQ(valid, 10u);
+}
+
+TEST(string_conv, DISABLED_benchmark_validate_scalar)
+{
+    std::string text = mixed_text(1 << 22);
+    const unsigned char* first = reinterpret_cast<const unsigned char*>(text.data());
+
+    size_t valid = 0;
+    for (int i = 0; i < 10; ++i)
+        valid += detail::_utf8_invalid_scalar(first, first + text.size(), true) == 0;
+
+    EXPECT_EQ(valid, 10u);
+}
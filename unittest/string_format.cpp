@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <string/format.h>
+#include <string/string_util.h>
+#include <string/tstring.h>
+
+using namespace util;
+
+namespace {
+
+struct point
+{
+    int x, y;
+};
+
+std::ostream& operator<<(std::ostream& os, const point& p)
+{
+    return os << "(" << p.x << ", " << p.y << ")";
+}
+
+enum color { red = 1, green = 2 };
+
+} // namespace
+
+TEST(string_format, basic)
+{
+    EXPECT_EQ(util::format("hello"), "hello");
+    EXPECT_EQ(util::format("{} + {} = {}", 1, 2, 3), "1 + 2 = 3");
+    EXPECT_EQ(util::format("{1}-{0}-{1}", "a", std::string("b")), "b-a-b");
+    EXPECT_EQ(util::format("{{{}}}", 7), "{7}");
+    EXPECT_EQ(util::format("{} {} {}", true, 'c', std::string_view("sv")), "true c sv");
+    EXPECT_EQ(util::format("{} {}", (const char*)nullptr, nullptr), " 0x0");
+    EXPECT_EQ(util::format("{} {}", point{ 1, 2 }, green), "(1, 2) 2");
+    EXPECT_EQ(util::format(L"{}={}", L"key", 42), L"key=42");
+    EXPECT_EQ(util::format(L"{:>4}|{}", L'x', "narrow"), L"   x|narrow");
+
+    EXPECT_THROW(util::format("{", 1), std::runtime_error);
+    EXPECT_THROW(util::format("}", 1), std::runtime_error);
+    EXPECT_THROW(util::format("{1}", 1), std::runtime_error);
+    EXPECT_THROW(util::format("{}{0}", 1), std::runtime_error);
+    EXPECT_THROW(util::format("{:d}", "s"), std::runtime_error);
+    EXPECT_THROW(util::format("{:q}", 1), std::runtime_error);
+}
+
+TEST(string_format, integer)
+{
+    EXPECT_EQ(util::format("{}", std::numeric_limits<int64_t>::min()), "-9223372036854775808");
+    EXPECT_EQ(util::format("{}", std::numeric_limits<uint64_t>::max()), "18446744073709551615");
+    EXPECT_EQ(util::format("{:x} {:#X} {:#o} {:#b}", 255, 255, 8, 5), "ff 0XFF 010 0b101");
+    EXPECT_EQ(util::format("{:08x}", 0xBEEFu), "0000beef");
+    EXPECT_EQ(util::format("{:+06d}|{: d}|{:#010x}", 42, 7, 255), "+00042| 7|0x000000ff");
+    EXPECT_EQ(util::format("{:<5}|{:>5}|{:^5}|{:*^6}", 1, 2, 3, 4), "1    |    2|  3  |**4***");
+    EXPECT_EQ(util::format("{:c}{:d}", 65, 'A'), "A65");
+    EXPECT_EQ(util::format("{:d}", true), "1");
+}
+
+TEST(string_format, floating)
+{
+    EXPECT_EQ(util::format("{}", 0.1), "0.1");
+    EXPECT_EQ(util::format("{}", 1e300), "1e+300");
+    EXPECT_EQ(util::format("{:.2f}", 3.14159), "3.14");
+    EXPECT_EQ(util::format("{:08.3f}", -3.14159), "-003.142");
+    EXPECT_EQ(util::format("{:e}", 1234.5), "1.234500e+03");
+    EXPECT_EQ(util::format("{:G}", 1e-10), "1E-10");
+    EXPECT_EQ(util::format("{:.1%}", 0.256), "25.6%");
+    EXPECT_EQ(util::format("{:+}", 1.5f), "+1.5");
+    EXPECT_EQ(util::format("{:>6}", std::numeric_limits<double>::infinity()), "   inf");
+    EXPECT_EQ(util::format("{:.0f}", 1e100).size(), 101u);
+}
+
+TEST(string_format, string)
+{
+    EXPECT_EQ(util::format("[{:6}]", "ab"), "[ab    ]");
+    EXPECT_EQ(util::format("[{:>6}]", "ab"), "[    ab]");
+    EXPECT_EQ(util::format("[{:.3}]", "abcdef"), "[abc]");
+    EXPECT_EQ(util::format("[{:-^7}]", "abc"), "[--abc--]");
+    EXPECT_EQ(util::format("[{:>8}]", point{ 1, 2 }), "[  (1, 2)]");
+
+    std::string large(1000, 'x');
+    EXPECT_EQ(util::format("<{}>", large), "<" + large + ">");
+}
+
+TEST(string_format, format_to)
+{
+    memory_buffer buffer;
+    format_to(buffer, "{}:{}", "a", 1);
+    format_to(buffer, "-{}", 2);
+    EXPECT_EQ(buffer.view(), "a:1-2");
+
+    std::string text = "head ";
+    format_to(text, "{:03}", 5);
+    EXPECT_EQ(text, "head 005");
+
+    char fixed[8] = { 0 };
+    EXPECT_EQ(format_to(fixed, 4, "{}", 123456), 6u);
+    EXPECT_EQ(std::string(fixed), "1234");
+
+    EXPECT_EQ(formatted_size("{:10}", 1), 10u);
+    EXPECT_EQ(formatted_size(L"{}", L"abc"), 3u);
+
+    EXPECT_EQ(util::format(UTILITY_FORMAT("{} {:.1f}"), "pi", 3.14159), "pi 3.1");
+    EXPECT_EQ(util::format(UTILITY_FORMAT(L"{1}{0}"), 1, 2), L"21");
+    static_assert(detail::check_format<char>("{0}{1}", 2), "");
+    static_assert(!detail::check_format<char>("{0}{2}", 2), "");
+    static_assert(!detail::check_format<char>("{}{0}", 2), "");
+    static_assert(!detail::check_format<char>("{:}}", 1), "");
+}
+
+TEST(string_format, sformat)
+{
+    EXPECT_EQ(sformat("%d-%s", 1, "a"), "1-a");
+    EXPECT_EQ(sformat(L"%d-%ls", 1, L"a"), L"1-a");
+
+    std::string large(2000, 'y');
+    EXPECT_EQ(sformat("[%s]", large.c_str()), "[" + large + "]");
+
+    std::wstring wlarge(5000, L'z');
+    EXPECT_EQ(sformat(L"[%ls]", wlarge.c_str()), L"[" + wlarge + L"]");
+}
+
+TEST(string_format, tformat)
+{
+    basic_tformat<char> report("{1}: {2} items, {3}% {2}");
+    EXPECT_EQ(report.arity(), 3u);
+    EXPECT_EQ(report.segments().size(), 5u);
+    EXPECT_EQ(report("disk", 42, 87.5), "disk: 42 items, 87.5% 42");
+    EXPECT_EQ(report("disk", 42), "disk: 42 items, {3}% 42");
+    EXPECT_EQ(report(), "{1}: {2} items, {3}% {2}");
+
+    EXPECT_EQ(basic_tformat<char>("{0}{x}{}{1")("a"), "{0}{x}{}{1");
+    EXPECT_EQ(basic_tformat<char>("{1}{1}{1}")('a'), "aaa");
+    EXPECT_EQ(basic_tformat<char>("no placeholder")(1), "no placeholder");
+    EXPECT_EQ(basic_tformat<wchar_t>(L"{2}/{1}")(L"a", 0.5), L"0.5/a");
+
+    memory_buffer buffer;
+    report.render_to(buffer, "a", 1, 2);
+    report.render_to(buffer, "b", 3, 4);
+    EXPECT_EQ(buffer.view(), "a: 1 items, 2% 1b: 3 items, 4% 3");
+
+    // 与tstring::operator% 的结果相同
+    tstring expect = tstring("{1}({2},{3})") % "error" % 12345 % std::string("message");
+    tstring actual = tformat("{1}({2},{3})")("error", 12345, "message");
+    EXPECT_EQ(expect, actual);
+}
+
+// 重复格式化十万次, 默认不运行; 对比tstring::operator% 与预先解析的tformat 的耗时
+TEST(string_format, DISABLED_benchmark_tstring)
+{
+    size_t total = 0;
+    for (int i = 0; i < 100000; ++i)
+        total += (tstring("{1} of {2}: {3} ({4})") % "item" % i % 100000 % "ok").size();
+
+    EXPECT_EQ(total, 2588890u);
+}
+
+TEST(string_format, DISABLED_benchmark_tformat)
+{
+    const tformat report("{1} of {2}: {3} ({4})");
+
+    size_t total = 0;
+    for (int i = 0; i < 100000; ++i)
+        total += report("item", i, 100000, "ok").size();
+
+    EXPECT_EQ(total, 2588890u);
+}
+
+// 重复格式化二十万次, 默认不运行; 对比printf 风格的sformat 与format 的耗时
+TEST(string_format, DISABLED_benchmark_sformat)
+{
+    size_t total = 0;
+    for (int i = 0; i < 200000; ++i)
+        total += sformat("%s(0x%08x,%d,%.3f)", "error", i, i * 7, i * 0.5).size();
+
+    EXPECT_EQ(total, 6819047u);
+}
+
+TEST(string_format, DISABLED_benchmark_format)
+{
+    size_t total = 0;
+    for (int i = 0; i < 200000; ++i)
+        total += util::format("{}(0x{:08x},{},{:.3f})", "error", i, i * 7, i * 0.5).size();
+
+    EXPECT_EQ(total, 6819047u);
+}
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <random>
 #include <string/string_util.h>
 #include <string/string_conv_easy.hpp>
 
@@ -126,6 +127,243 @@ TEST(string_util, end_with)
     EXPECT_FALSE(end_with(L"string_conv_easy.hpp", L".string_conv_easy.hpp"));
 }
 
+TEST(string_util, view)
+{
+    using namespace std::literals;
+
+    // 视图版本返回指向原数据的视图
+    std::string_view target = "key=value=1";
+    std::string_view result = left(target, "=");
+    EXPECT_EQ(result, "key");
+    EXPECT_EQ(result.data(), target.data());
+
+    EXPECT_EQ(right(target, "="), "1");
+    EXPECT_EQ(right(target, "="sv).data(), target.data() + 10);
+    EXPECT_TRUE(left(target, "#").empty());
+    EXPECT_TRUE(right(target, "#").empty());
+
+    auto half = in_half_from_left(target, "=");
+    EXPECT_EQ(half.first, "key");
+    EXPECT_EQ(half.second, "value=1");
+    EXPECT_EQ(half.second.data(), target.data() + 4);
+
+    half = in_half_from_right(target, "=");
+    EXPECT_EQ(half.first, "key=value");
+    EXPECT_EQ(half.second, "1");
+
+    EXPECT_EQ(between("a...a123b"sv, "a", "b"), "123");
+    EXPECT_EQ(between("%Program%Data%/AomeiMB"sv, "%", "%", contains_mark), "%Program%");
+    EXPECT_EQ(between(L"<x>"sv, L"<", L">"), L"x");
+
+    std::wstring_view wide = L"string/string_conv_easy.hpp";
+    EXPECT_EQ(left(wide, L"/"), L"string");
+    EXPECT_EQ(right(wide, L"/").data(), wide.data() + 7);
+
+    // 拥有所有权的版本可以直接使用视图作为标记
+    std::string owned = "key=value";
+    EXPECT_EQ(left(owned, "="sv), "key");
+    EXPECT_EQ(in_half_from_left(owned, "="sv).second, "value");
+
+    EXPECT_TRUE(start_with(target, "key"));
+    EXPECT_TRUE(start_with(owned, "key"sv));
+    EXPECT_TRUE(end_with(target, "=1"));
+    EXPECT_FALSE(end_with(wide, L".h"));
+}
+
+TEST(string_util, replace)
+{
+    // 逐个位置比较的参考实现
+    auto naive = [](const std::string& target, const std::string& before, const std::string& after) {
+        std::string result;
+        for (size_t i = 0; i < target.size(); )
+        {
+            if (!before.empty() && target.compare(i, before.size(), before) == 0)
+            {
+                result += after;
+                i += before.size();
+            }
+            else
+                result += target[i++];
+        }
+        return result;
+    };
+
+    std::mt19937 random(2023);
+    for (int round = 0; round < 2000; ++round)
+    {
+        std::string target, before, after;
+        for (size_t i = random() % 200; i > 0; --i)
+            target += char('a' + random() % 3);
+        for (size_t i = 1 + random() % 40; i > 0; --i)
+            before += char('a' + random() % 3);
+        for (size_t i = random() % 6; i > 0; --i)
+            after += char('x' + random() % 3);
+
+        std::string expected = naive(target, before, after);
+        EXPECT_EQ(replace_copy(target, before, after), expected);
+
+        std::string inplace = target;
+        EXPECT_EQ(replace(inplace, before, after), expected);
+    }
+
+    std::string text = "a-b-c";
+    EXPECT_EQ(replace(text, "-", ""), "abc");
+    EXPECT_EQ(replace(text, "", "x"), "abc");
+    EXPECT_EQ(replace_copy(L"a-b-c", L"-", L"--"), L"a--b--c");
+
+    // 参数指向目标自身
+    text = "abcabc";
+    EXPECT_EQ(replace(text, std::string_view(text).substr(0, 3), std::string_view(text).substr(1, 1)), "bb");
+
+    // 大量长度不同的替换
+    std::string large, expect;
+    for (int i = 0; i < 200000; ++i)
+    {
+        large  += "{x}.";
+        expect += "value.";
+    }
+    EXPECT_EQ(replace(large, "{x}", "value"), expect);
+}
+
+TEST(string_util, replace_all_many)
+{
+    EXPECT_EQ(replace_all_many("{name} is {age}, {name}!", {{"{name}", "Tom"}, {"{age}", "18"}}),
+        "Tom is 18, Tom!");
+
+    // 最左最长, 替换后的内容不再匹配
+    EXPECT_EQ(replace_all_many("abcd", {{"bcd", "1"}, {"abc", "2"}, {"ab", "3"}}), "2d");
+    EXPECT_EQ(replace_all_many("abcd", {{"ab", "3"}, {"abcd", "4"}}), "4");
+    EXPECT_EQ(replace_all_many("aaaa", {{"aa", "a"}, {"a", "b"}}), "aa");
+    EXPECT_EQ(replace_all_many("she sells", {{"he", "x"}, {"she", "y"}, {"s", "z"}}), "y zellz");
+    EXPECT_EQ(replace_all_many("abc", {{"", "x"}, {"b", "B"}, {"b", "C"}}), "aBc");
+    EXPECT_EQ(replace_all_many("", {{"a", "b"}, {"c", "d"}}), "");
+    EXPECT_EQ(replace_all_many(L"\u4f60\u597d, world", {{L"\u4f60\u597d", L"hello"}, {L"world", L"\u4e16\u754c"}}),
+        L"hello, \u4e16\u754c");
+
+    // 与逐个位置尝试所有模式的参考实现比较
+    std::mt19937 random(7);
+    for (int round = 0; round < 500; ++round)
+    {
+        std::vector<std::string> patterns(1 + random() % 6);
+        std::vector<std::string> afters(patterns.size());
+        std::vector<std::pair<std::string_view, std::string_view>> table;
+        for (size_t i = 0; i < patterns.size(); ++i)
+        {
+            for (size_t j = 1 + random() % 4; j > 0; --j)
+                patterns[i] += char('a' + random() % 3);
+
+            afters[i] = "<" + std::to_string(i) + ">";
+            table.emplace_back(patterns[i], afters[i]);
+        }
+
+        std::string target;
+        for (size_t i = random() % 100; i > 0; --i)
+            target += char('a' + random() % 3);
+
+        std::string expected;
+        for (size_t i = 0; i < target.size(); )
+        {
+            int best = -1;
+            for (size_t j = 0; j < table.size(); ++j)
+            {
+                if (target.compare(i, table[j].first.size(), table[j].first) == 0 &&
+                    (best < 0 || table[j].first.size() > table[best].first.size()))
+                    best = int(j);
+            }
+
+            if (best < 0)
+                expected += target[i++];
+            else
+            {
+                expected += table[best].second;
+                i += table[best].first.size();
+            }
+        }
+
+        EXPECT_EQ(replace_all_many(target, table), expected) << target;
+    }
+}
+
+TEST(string_util, case_conversion)
+{
+    // 覆盖所有字节值以及向量化的块与尾部
+    std::string bytes;
+    for (int round = 0; round < 3; ++round)
+        for (int i = 0; i < 256; ++i)
+            bytes += char(i);
+
+    for (size_t size : { 0, 1, 15, 16, 17, 31, 32, 33, 100, 768 })
+    {
+        std::string_view input(bytes.data(), size);
+        std::string lower = to_lower(input);
+        std::string upper = to_upper(input);
+        ASSERT_EQ(lower.size(), size);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            char ch = input[i];
+            EXPECT_EQ(lower[i], ch >= 'A' && ch <= 'Z' ? char(ch + 32) : ch);
+            EXPECT_EQ(upper[i], ch >= 'a' && ch <= 'z' ? char(ch - 32) : ch);
+        }
+
+        std::string inplace(input);
+        EXPECT_EQ(to_lower_inplace(inplace), lower);
+        EXPECT_EQ(to_upper_inplace(inplace), to_upper(lower));
+    }
+
+    // UTF-8的多字节序列保持不变
+    EXPECT_EQ(to_lower("ABC\xC3\x84Z"), "abc\xC3\x84z");
+
+    EXPECT_EQ(to_lower(L"Hello \u00C4\u00D6\u0100\u0391\u0416\u0401\uFF21"), L"hello \u00E4\u00F6\u0101\u03B1\u0436\u0451\uFF41");
+    EXPECT_EQ(to_upper(L"hello \u00E4\u00FF\u017E\u03C2\u0436\u0451\uFF41"), L"HELLO \u00C4\u0178\u017D\u03A3\u0416\u0401\uFF21");
+    EXPECT_EQ(to_upper(L"\u00DF\u4F60"), L"\u00DF\u4F60");
+
+    std::wstring wide = L"\u0416ABC";
+    EXPECT_EQ(to_lower_inplace(wide), L"\u0436abc");
+}
+
+TEST(string_util, case_insensitive)
+{
+    EXPECT_TRUE(iequals("Content-Length", "content-length"));
+    EXPECT_TRUE(iequals("", ""));
+    EXPECT_FALSE(iequals("Content-Length", "content-lengt"));
+    EXPECT_FALSE(iequals("a[", "A{"));  // '[' 与 '{' 仅相差0x20, 但不是字母
+    EXPECT_TRUE(iequals("The quick brown fox jumps over the lazy dog",
+                        "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG"));
+    EXPECT_FALSE(iequals("The quick brown fox jumps over the lazy dog",
+                         "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOH"));
+    EXPECT_TRUE(iequals(L"\u0416\u00C4x", L"\u0436\u00E4X"));
+
+    EXPECT_TRUE(istarts_with("Accept-Encoding: gzip", "accept-"));
+    EXPECT_FALSE(istarts_with("Accept", "accept-"));
+    EXPECT_TRUE(istarts_with(L"README.md", L"readme"));
+    EXPECT_TRUE(iends_with("archive.TAR.GZ", ".tar.gz"));
+    EXPECT_FALSE(iends_with("gz", ".gz"));
+    EXPECT_TRUE(iends_with(L"photo.JPG", L".jpg"));
+
+    std::string text = "Transfer-Encoding: chunked; X-Transfer-Id: 1";
+    EXPECT_EQ(ifind(text, "TRANSFER"), 0u);
+    EXPECT_EQ(ifind(text, "transfer", 1), text.find("Transfer-Id"));
+    EXPECT_EQ(ifind(text, "x-transfer-id: 1"), text.size() - 16);
+    EXPECT_EQ(ifind(text, "missing"), std::string::npos);
+    EXPECT_EQ(ifind(text, ""), 0u);
+    EXPECT_EQ(ifind(text, "", text.size() + 1), std::string::npos);
+    EXPECT_EQ(ifind(L"abc\u0416\u0416", L"\u0436\u0436"), 3u);
+
+    // 与转换后再查找的结果比较
+    std::mt19937 random(11);
+    for (int round = 0; round < 1000; ++round)
+    {
+        std::string target, pattern;
+        for (size_t i = random() % 80; i > 0; --i)
+            target += "aAbB-"[random() % 5];
+        for (size_t i = 1 + random() % 4; i > 0; --i)
+            pattern += "aAbB-"[random() % 5];
+
+        EXPECT_EQ(ifind(target, pattern), to_lower(target).find(to_lower(pattern)));
+    }
+}
+
 TEST(string_util, sformat)
 {
     {